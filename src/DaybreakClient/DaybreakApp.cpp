@@ -85,6 +85,9 @@ void DaybreakApp::Run()
         // Process platform windowinng events.
         ProcessPendingEvents();
 
+        // Reload the resources whose files changed before drawing with them.
+        m_sceneRenderer->Update();
+
         // Draw current frame.
         RenderFrame(timespan_t::fromSeconds(deltaSeconds));
     }
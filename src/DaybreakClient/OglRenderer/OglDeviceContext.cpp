@@ -29,6 +29,23 @@ std::unique_ptr<ITexture2d> OglDeviceContext::createTexture2d(
     return OglTexture2d::generate(image, params);
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<std::unique_ptr<ITexture2d>> OglDeviceContext::createTextures2d(
+    const std::vector<texture2d_upload_t>& uploads)
+{
+    auto oglTextures = OglTexture2d::generate(uploads);
+    std::vector<std::unique_ptr<ITexture2d>> textures;
+
+    textures.reserve(oglTextures.size());
+
+    for (auto& texture : oglTextures)
+    {
+        textures.push_back(std::move(texture));
+    }
+
+    return textures;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 std::unique_ptr<IndexBuffer> OglDeviceContext::createIndexBuffer(const MeshData& mesh)
 {
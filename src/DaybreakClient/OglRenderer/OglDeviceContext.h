@@ -20,6 +20,10 @@ namespace Daybreak::OpenGlRenderer
             const Image& image,                                     ///< Source image.
             const TextureParameters& params) override;              ///< Texture sampling and generation parameters.
 
+        /** Create many 2d textures in one batch. */
+        virtual std::vector<std::unique_ptr<ITexture2d>> createTextures2d(
+            const std::vector<texture2d_upload_t>& uploads) override;
+
         /** Create a new index buffer. */
         virtual std::unique_ptr<IndexBuffer> createIndexBuffer(
             const MeshData& mesh) override;                         ///< Source index data.
@@ -32,6 +32,8 @@ namespace
             return GL_FLOAT;
         case InputAttribute::StorageType::Double:
             return GL_DOUBLE;
+        case InputAttribute::StorageType::PackedInt2101010:
+            return GL_INT_2_10_10_10_REV;
         default:
             throw std::runtime_error("unknwon enum");
         }
@@ -137,7 +139,7 @@ std::unique_ptr<OglInputLayout> OglInputLayout::generate(const InputLayoutDescri
             static_cast<GLuint>(i),
             attribute.count(),
             ToGlElementType(attribute.type()),
-            GL_FALSE,
+            attribute.normalized() ? GL_TRUE : GL_FALSE,
             static_cast<GLsizei>(layoutDescription.elementSizeInBytes()),
             reinterpret_cast<void*>(layoutDescription.attributeOffsetByIndex(i)));
         glCheckForErrors();
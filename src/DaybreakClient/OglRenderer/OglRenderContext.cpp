@@ -8,6 +8,7 @@
 #include "OglTexture.h"
 
 #include "Renderer/RendererEffect.h"
+#include "Graphics/Mesh/IndexBufferElement.h"
 
 #include <glad\glad.h>
 #include <glm\glm.hpp>
@@ -159,11 +160,30 @@ void OglRenderContext::drawTriangles(unsigned int offset, unsigned int count)
     // TODO: Check that vertex, index everything bound as expected.
     EXPECT(offset + count <= m_currentIndexElementCount, "Can not exceed number of index elements when drawing");
 
+    // The offset is given in indices, while OpenGL expects a byte offset into the index buffer.
+    const auto byteOffset = offset * indexElementSizeInBytes(m_currentIndexElementType);
+
     glDrawElements(
         GL_TRIANGLES,
         count,
         ToGlType(m_currentIndexElementType),
-        reinterpret_cast<void *>(static_cast<uintptr_t>(offset)));
+        reinterpret_cast<void *>(static_cast<uintptr_t>(byteOffset)));
+    glCheckForErrors();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void OglRenderContext::drawTriangles(unsigned int offset, unsigned int count, int baseVertex)
+{
+    EXPECT(offset + count <= m_currentIndexElementCount, "Can not exceed number of index elements when drawing");
+
+    const auto byteOffset = offset * indexElementSizeInBytes(m_currentIndexElementType);
+
+    glDrawElementsBaseVertex(
+        GL_TRIANGLES,
+        count,
+        ToGlType(m_currentIndexElementType),
+        reinterpret_cast<void *>(static_cast<uintptr_t>(byteOffset)),
+        baseVertex);
     glCheckForErrors();
 }
 
@@ -79,6 +79,7 @@ namespace Daybreak::OpenGlRenderer
     // Contextual commands.
     public:
         virtual void drawTriangles(unsigned int offset, unsigned int count) override;
+        virtual void drawTriangles(unsigned int offset, unsigned int count, int baseVertex) override;
 
     // Properties.
     public:
@@ -2,6 +2,7 @@
 #include "OglTexture.h"
 #include "OglError.h"
 #include "Content\Images\Image.h"
+#include "Renderer\DeviceContext.h"
 #include "Renderer\RendererExceptions.h"
 
 #include <glad\glad.h>
@@ -10,6 +11,15 @@
 #include <string>
 #include <cassert>
 
+// S3TC is an extension that is not in the OpenGL headers, but every desktop driver supports it.
+#if !defined(GL_COMPRESSED_RGB_S3TC_DXT1_EXT)
+#   define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+#if !defined(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+#   define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 using namespace Daybreak;
 using namespace Daybreak::OpenGlRenderer;
 
@@ -64,6 +74,14 @@ namespace
             return GL_RGB;
         case TextureFormat::RGBA:
             return GL_RGBA;
+        case TextureFormat::BC1:
+            return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case TextureFormat::BC3:
+            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case TextureFormat::BC4:
+            return GL_COMPRESSED_RED_RGTC1;
+        case TextureFormat::BC5:
+            return GL_COMPRESSED_RG_RGTC2;
         default:
             THROW_ENUM_SWITCH_NOT_HANDLED(TextureFormat, format);
         }
@@ -128,6 +146,68 @@ std::unique_ptr<OglTexture2d> OglTexture2d::generate(
     unsigned int texture;
 
     glGenTextures(1, &texture);
+    glCheckForErrors();
+
+    try
+    {
+        upload(texture, image, settings, hardwareFormat);
+    }
+    catch (...)
+    {
+        glDeleteTextures(1, &texture);
+        throw;
+    }
+
+    // Return a newly created texture.
+    return std::unique_ptr<OglTexture2d>(new OglTexture2d(texture, image.Name()));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<std::unique_ptr<OglTexture2d>> OglTexture2d::generate(
+    const std::vector<texture2d_upload_t>& uploads)
+{
+    std::vector<GLuint> ids(uploads.size(), 0);
+    std::vector<std::unique_ptr<OglTexture2d>> textures;
+
+    if (uploads.empty())
+    {
+        return textures;
+    }
+
+    glGenTextures(static_cast<GLsizei>(ids.size()), ids.data());
+    glCheckForErrors();
+
+    textures.reserve(uploads.size());
+
+    try
+    {
+        for (size_t i = 0; i < uploads.size(); ++i)
+        {
+            upload(ids[i], *uploads[i].image, uploads[i].params, uploads[i].params.format());
+            textures.push_back(std::unique_ptr<OglTexture2d>(new OglTexture2d(ids[i], uploads[i].image->Name())));
+        }
+    }
+    catch (...)
+    {
+        // Textures that were created delete themselves, but the remaining texture objects have no owner yet.
+        const auto createdCount = textures.size();
+        glDeleteTextures(static_cast<GLsizei>(ids.size() - createdCount), ids.data() + createdCount);
+
+        throw;
+    }
+
+    // Leave no texture bound rather than whichever one was uploaded last.
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return textures;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void OglTexture2d::upload(
+    GLuint texture,
+    const Image& image,
+    TextureParameters settings,
+    TextureFormat hardwareFormat)
+{
     glBindTexture(GL_TEXTURE_2D, texture);
     glCheckForErrors();
 
@@ -178,26 +258,57 @@ std::unique_ptr<OglTexture2d> OglTexture2d::generate(
         glCheckForErrors();
     }
 
-    // Upload the image to the GPU.
-    glTexImage2D(
-        GL_TEXTURE_2D,
-        0,
-        ToGl(hardwareFormat),
-        static_cast<GLsizei>(image.Width()),
-        static_cast<GLsizei>(image.Height()),
-        0,
-        ToGl(image.Format()),
-        GL_UNSIGNED_BYTE,
-        image.RawPixels(0));
+    // Upload the image and every mipmap it has to the GPU. Rows of small mipmaps are not padded to four bytes.
+    // Block compressed images are uploaded in their own format rather than the requested hardware format.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glCheckForErrors();
 
-    // Handle image mipmaps.
-    //  TODO: Add option if mipmaps should be forced generated.
-    //  TODO: Handle when image has mipmaps -> upload them.
-    //  TODO: Handle when image does not have mipmaps -> generate them (unless disabled).
-    glGenerateMipmap(GL_TEXTURE_2D);
-    glCheckForErrors();
+    for (size_t level = 0; level < image.MipMapCount(); ++level)
+    {
+        const auto mipMapIndex = static_cast<unsigned int>(level);
 
-    // Return a newly created texture.
-    return std::unique_ptr<OglTexture2d>(new OglTexture2d(texture, image.Name()));
+        if (image.IsBlockCompressed())
+        {
+            const auto& compressedImage = static_cast<const BlockCompressedImage&>(image);
+
+            glCompressedTexImage2D(
+                GL_TEXTURE_2D,
+                static_cast<GLint>(level),
+                ToGl(compressedImage.CompressedFormat()),
+                static_cast<GLsizei>(image.MipMapWidth(level)),
+                static_cast<GLsizei>(image.MipMapHeight(level)),
+                0,
+                static_cast<GLsizei>(compressedImage.RawPixelsSize(mipMapIndex)),
+                compressedImage.RawPixels(mipMapIndex));
+        }
+        else
+        {
+            glTexImage2D(
+                GL_TEXTURE_2D,
+                static_cast<GLint>(level),
+                ToGl(hardwareFormat),
+                static_cast<GLsizei>(image.MipMapWidth(level)),
+                static_cast<GLsizei>(image.MipMapHeight(level)),
+                0,
+                ToGl(image.Format()),
+                GL_UNSIGNED_BYTE,
+                image.RawPixels(mipMapIndex));
+        }
+
+        glCheckForErrors();
+    }
+
+    // Use the mipmaps from the image if it has them, otherwise let the driver generate them. Drivers cannot generate
+    // the mipmaps of block compressed textures.
+    // TODO: Add option if mipmaps should be forced generated.
+    if (image.MipMapCount() > 1 || image.IsBlockCompressed())
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.MipMapCount() - 1));
+        glCheckForErrors();
+    }
+    else
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glCheckForErrors();
+    }
 }
\ No newline at end of file
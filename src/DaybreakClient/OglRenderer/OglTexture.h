@@ -2,10 +2,12 @@
 #include "Renderer/Texture.h"
 #include <glad\glad.h>
 #include <memory>
+#include <vector>
 
 namespace Daybreak
 {
     class Image;
+    struct texture2d_upload_t;
 }
 
 namespace Daybreak::OpenGlRenderer
@@ -40,9 +42,20 @@ namespace Daybreak::OpenGlRenderer
             TextureParameters settings,
             TextureFormat hardwareFormat);
 
+        // Create 2d textures from many images at once, reserving every texture object with one call.
+        static std::vector<std::unique_ptr<OglTexture2d>> generate(
+            const std::vector<texture2d_upload_t>& uploads);
+
     private:
         void destroy();
 
+        // Set the parameters of a texture object and upload an image into it.
+        static void upload(
+            GLuint texture,
+            const Image& image,
+            TextureParameters settings,
+            TextureFormat hardwareFormat);
+
     private:
         GLuint m_id = 0;
         std::string m_name;
@@ -15,6 +15,7 @@
 #include "Scene/Scene.h"
 #include "Scene/Camera.h"
 #include "Content/ResourcesManager.h"
+#include "Content/ResourceReloader.h"
 #include "Content/DefaultFileSystem.h"
 
 #include "Renderer\RenderContext.h"
@@ -27,6 +28,7 @@
 #include <glad\glad.h>
 #include <string>
 #include <memory>
+#include <utility>
 #include <cassert>
 
 using namespace Daybreak;
@@ -68,6 +70,29 @@ SceneRenderer::~SceneRenderer()
 {
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+void SceneRenderer::Update()
+{
+    if (m_reloader->update() == 0)
+    {
+        return;
+    }
+
+    // Rebuild what was created from a reloaded resource. A failed reload keeps the old resource, and with it the old
+    // mesh or effect.
+    if (m_model->reloadCount() != m_modelReloadCount)
+    {
+        m_modelReloadCount = m_model->reloadCount();
+        CreateMesh(*m_model->get());
+    }
+
+    if (m_standardShader->reloadCount() != m_standardShaderReloadCount)
+    {
+        m_standardShaderReloadCount = m_standardShader->reloadCount();
+        m_phong = std::make_unique<OglPhongLightingEffect>(m_standardShader->get());
+    }
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 void SceneRenderer::Render(const Daybreak::Scene& scene, timespan_t deltaTime)
 {
@@ -123,10 +148,11 @@ void SceneRenderer::Render(const Daybreak::Scene& scene, timespan_t deltaTime)
 
         i += 1.0f;
 
-        m_phong->setModelMatrix(model);
+        m_phong->setModelMatrix(model * m_meshDequantization);
 
         // Generate normal transformation matrix by taking the transpose of the inverse of the upper left corner
-        // of the model matrix.
+        // of the model matrix. Normals are not quantized relative to the mesh bounds, so the position dequantization
+        // is left out.
         glm::mat3 normal;
         
         normal[0][0] = model[0][0]; normal[0][1] = model[0][1]; normal[0][2] = model[0][2];
@@ -138,34 +164,38 @@ void SceneRenderer::Render(const Daybreak::Scene& scene, timespan_t deltaTime)
         
         m_phong->setNormalMatrix(normal);
 
-        // Draw cube.
-        m_phong->startRenderObject(
-            *m_renderContext.get(),
-            0,
-            static_cast<unsigned int>(m_mesh->indexBuffer()->elementCount()));
+        // Draw cube. Large models are split into groups whose indices start at their own base vertex.
+        for (const auto& group : m_meshGroups)
+        {
+            m_phong->startRenderObject(*m_renderContext.get(), group.indexOffset, group.indexCount, group.baseVertex);
+        }
     }
 
     // Finish pass.
     m_phong->finishPass(*m_renderContext.get());
 
     // Draw the lamp.
-    m_renderContext->bindShader(m_lightDebugShader);
+    const auto& lightDebugShader = m_lightDebugShader->get();
+    m_renderContext->bindShader(lightDebugShader);
     
     auto view = m_camera->view();
     auto projection = m_camera->perspective();
 
-    m_renderContext->setShaderMatrix4(m_lightDebugShader->getVariable("view"), view);
-    m_renderContext->setShaderMatrix4(m_lightDebugShader->getVariable("projection"), projection);;
+    m_renderContext->setShaderMatrix4(lightDebugShader->getVariable("view"), view);
+    m_renderContext->setShaderMatrix4(lightDebugShader->getVariable("projection"), projection);;
 
     glm::mat4 model(1);
 
     model = glm::translate(model, m_scene->pointLight(0).position());
     model = glm::scale(model, glm::vec3{ 0.2f, 0.2f, 0.2f });
 
-    m_renderContext->setShaderMatrix4(m_lightDebugShader->getVariable("model"), model);
-    m_renderContext->setShaderVector3f(m_lightDebugShader->getVariable("tint"), m_scene->pointLight(0).diffuseColor());
+    m_renderContext->setShaderMatrix4(lightDebugShader->getVariable("model"), model * m_meshDequantization);
+    m_renderContext->setShaderVector3f(lightDebugShader->getVariable("tint"), m_scene->pointLight(0).diffuseColor());
      
-    m_renderContext->drawTriangles(0, static_cast<unsigned int>(m_mesh->indexBuffer()->elementCount()));
+    for (const auto& group : m_meshGroups)
+    {
+        m_renderContext->drawTriangles(group.indexOffset, group.indexCount, group.baseVertex);
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -174,7 +204,8 @@ void SceneRenderer::CreateDefaultScene()
     m_deviceContext = std::make_shared<OglDeviceContext>();
     m_renderContext = std::make_unique<OglRenderContext>();
 
-    m_resources = std::make_shared<ResourcesManager>(
+    // Resources are loaded through the reloader, which reloads them in Update() when their files change.
+    m_reloader = std::make_unique<ResourceReloader>(
         m_deviceContext,
         std::make_shared<DefaultFileSystem>("Content"));
 
@@ -186,40 +217,24 @@ void SceneRenderer::CreateDefaultScene()
     m_camera->setPerspective(45.0f, 0.1f, 100.0f);
 
     // Create a simple cube to render.
-    auto modelData = m_resources->loadModel("cube.obj");
-    auto material = std::make_shared<PhongMaterial>(modelData->group(0).materialRef());
-
-    m_mesh = std::make_unique<Mesh>(
-        m_deviceContext->createVertexBuffer(modelData->mesh()),
-        m_deviceContext->createIndexBuffer(modelData->mesh()),
-        material);
-
-    // Generate vertex attributes for the standard shader.
-    // TODO: Move this work into a fluent-ish interface inside InputLayout.
-    m_renderContext->bindVertexBuffer(m_mesh->vertexBuffer());
-
-    // Create the standard VAO which defines Daybreak's standard vertex attribute layout.
-    //  TODO: Use render context -> device -> createInputLayout
-    auto standardVertexAttributes = std::make_shared<InputLayoutDescription>(std::vector<InputAttribute>
-    {
-        { InputAttribute::SemanticName::Position, 0, InputAttribute::StorageType::Float, 3 },
-        { InputAttribute::SemanticName::Texture, 0, InputAttribute::StorageType::Float, 2 },
-        { InputAttribute::SemanticName::Normal, 0, InputAttribute::StorageType::Float, 3 }
-    });
+    m_model = m_reloader->loadModel("cube.obj");
+    CreateMesh(*m_model->get());
 
-    m_standardInputLayout = m_deviceContext->createInputLayout(deref(standardVertexAttributes));
+    // Construct scene shaders. The sources are read on a background thread when they change, and compiled in Update().
+    auto loadShader = [this](const std::string& name, const std::string& vertexPath, const std::string& fragmentPath) {
+        return m_reloader->load<IShader>(
+            [vertexPath, fragmentPath](ResourcesManager& resources) {
+                return std::make_pair(resources.loadTextFile(vertexPath), resources.loadTextFile(fragmentPath));
+            },
+            [this, name](std::pair<std::string, std::string>&& sources, ResourcesManager&) {
+                return m_deviceContext->compileShader(name, sources.first, sources.second);
+            });
+    };
 
-    // Construct scene shader.
-    m_phong = std::make_unique<OglPhongLightingEffect>(
-        m_deviceContext->compileShader(
-            "Standard",
-            m_resources->loadTextFile("Shaders\\Standard_vs.glsl"),
-            m_resources->loadTextFile("Shaders\\Standard_fs.glsl")));
+    m_standardShader = loadShader("Standard", "Shaders\\Standard_vs.glsl", "Shaders\\Standard_fs.glsl");
+    m_phong = std::make_unique<OglPhongLightingEffect>(m_standardShader->get());
 
-    m_lightDebugShader = m_deviceContext->compileShader(
-        "LightDebug",
-        m_resources->loadTextFile("Shaders\\LightDebug_vs.glsl"),
-        m_resources->loadTextFile("Shaders\\LightDebug_fs.glsl"));
+    m_lightDebugShader = loadShader("LightDebug", "Shaders\\LightDebug_vs.glsl", "Shaders\\LightDebug_fs.glsl");
 
     // Configure scene lights.
     m_scene->setDirectionalLightCount(1);
@@ -240,6 +255,44 @@ void SceneRenderer::CreateDefaultScene()
     });
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+void SceneRenderer::CreateMesh(const ModelData& modelData)
+{
+    auto material = std::make_shared<PhongMaterial>(modelData.group(0).materialRef());
+
+    m_mesh = std::make_unique<Mesh>(
+        m_deviceContext->createVertexBuffer(modelData.mesh()),
+        m_deviceContext->createIndexBuffer(modelData.mesh()),
+        material);
+
+    // Quantized positions are stored relative to the mesh bounds, and are moved back into model space by the model
+    // matrix.
+    const auto& dequantization = modelData.positionDequantization();
+    m_meshDequantization = glm::scale(glm::translate(glm::mat4(1), dequantization.offset), dequantization.scale);
+
+    m_meshGroups.clear();
+
+    for (const auto& group : modelData.groups())
+    {
+        m_meshGroups.push_back({
+            static_cast<unsigned int>(group.indexOffset()),
+            static_cast<unsigned int>(group.indexCount()),
+            static_cast<int>(group.baseVertex())
+        });
+    }
+
+    // Generate vertex attributes for the standard shader.
+    // TODO: Move this work into a fluent-ish interface inside InputLayout.
+    m_renderContext->bindVertexBuffer(m_mesh->vertexBuffer());
+
+    // Create the standard VAO from the model's vertex layout, which has tangents appended when the model's material
+    // uses a normal map.
+    //  TODO: Use render context -> device -> createInputLayout
+    const auto& standardVertexAttributes = modelData.mesh().vertexElementTypeRef();
+
+    m_standardInputLayout = m_deviceContext->createInputLayout(standardVertexAttributes);
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 void SceneRenderer::SetViewportSize(unsigned int width, unsigned int height)
 {
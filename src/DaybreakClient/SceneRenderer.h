@@ -15,11 +15,24 @@ namespace Daybreak
     class IDeviceContext;
     class IRenderContext;
     class PhongLightingEffect;
-    class ResourcesManager;
+    class ModelData;
+    class ResourceReloader;
+
+    template<typename TResource>
+    class ReloadableResource;
 
     /** Renders a graphical scene. */
     class SceneRenderer
     {
+    private:
+        // Range of the mesh's index buffer that is drawn with one call. Indices are relative to the base vertex.
+        struct mesh_group_t
+        {
+            unsigned int indexOffset;
+            unsigned int indexCount;
+            int baseVertex;
+        };
+
     public:
         // Constructor.
         SceneRenderer(
@@ -29,6 +42,9 @@ namespace Daybreak
         // Destructor.
         ~SceneRenderer();
 
+        // Reload the model and shaders whose files changed. Call this between frames.
+        void Update();
+
         // Render the scene.
         void Render(const Daybreak::Scene& scene, Daybreak::timespan_t deltaTime);
 
@@ -47,6 +63,10 @@ namespace Daybreak
         // Creates a default scene to render (since there is no scene support yet).
         void CreateDefaultScene(); // TODO: Remove this once we have scene loading.
 
+    private:
+        // Create the mesh, its draw groups and the standard input layout from the model.
+        void CreateMesh(const Daybreak::ModelData& modelData);
+
     private:
         // Flag that is set if wireframe rendering should be used.
         bool m_wireframe = false;
@@ -56,13 +76,21 @@ namespace Daybreak
 
         std::shared_ptr<Daybreak::IDeviceContext> m_deviceContext;
         std::shared_ptr<Daybreak::IRenderContext> m_renderContext;
-        std::shared_ptr<Daybreak::ResourcesManager> m_resources;
+        std::unique_ptr<Daybreak::ResourceReloader> m_reloader;
+
+        // Resources that are reloaded when their files change, and the reload counts the renderer was built from.
+        std::shared_ptr<Daybreak::ReloadableResource<Daybreak::ModelData>> m_model;
+        std::shared_ptr<Daybreak::ReloadableResource<Daybreak::IShader>> m_standardShader;
+        std::shared_ptr<Daybreak::ReloadableResource<Daybreak::IShader>> m_lightDebugShader;   // TODO: Move to effect.
+        unsigned int m_modelReloadCount = 0;
+        unsigned int m_standardShaderReloadCount = 0;
 
         std::shared_ptr<Daybreak::InputLayout> m_standardInputLayout; // TODO: Not here. Not sure where yet.
-        std::shared_ptr<Daybreak::IShader> m_lightDebugShader;        // TODO: Move to effect class.
         std::shared_ptr<Daybreak::Camera> m_camera;
 
         std::shared_ptr<Daybreak::Mesh> m_mesh;                 // TODO: Move to scene.
+        std::vector<mesh_group_t> m_meshGroups;
+        glm::mat4 m_meshDequantization = glm::mat4(1);         // Turns quantized mesh positions into model space.
         std::unique_ptr<Daybreak::PhongLightingEffect> m_phong;
 
         // TODO: Move to caller of SceneRenderr.
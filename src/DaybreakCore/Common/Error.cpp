@@ -66,6 +66,13 @@ ContentReadException::ContentReadException(
 {
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+ContentWriteException::ContentWriteException(const std::string& contentFilePath, const std::string& errorMessage)
+    : DaybreakEngineException(errorMessage, "Failed to write content to file " + contentFilePath),
+      m_filePath(contentFilePath)
+{
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 std::string DaybreakDataException::format(const std::string& message, const std::string& fileName, size_t lineNumber)
 {
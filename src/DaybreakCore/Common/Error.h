@@ -131,6 +131,20 @@ private:
     std::string m_typeName;
 };
 
+/** Exceptions with writing content to disk. */
+class ContentWriteException : public DaybreakEngineException
+{
+public:
+    /** Constructor. */
+    ContentWriteException(const std::string& contentFilePath, const std::string& errorMessage);
+
+    /** Get the content file path. */
+    std::string FilePath() const { return m_filePath; }
+
+private:
+    std::string m_filePath;
+};
+
 //---------------------------------------------------------------------------------------------------------------------
 // Runtime check macros.
 //---------------------------------------------------------------------------------------------------------------------
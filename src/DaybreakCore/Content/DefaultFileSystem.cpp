@@ -1,6 +1,11 @@
 #include "stdafx.h"
 #include "DefaultFileSystem.h"
+#include "MappedFile.h"
+#include "FileChangeWatcher.h"
+#include "Common/Error.h"
 
+#include <atomic>
+#include <filesystem>
 #include <fstream>
 
 using namespace Daybreak;
@@ -31,6 +36,136 @@ std::future<std::string> DefaultFileSystem::loadFileAsText(const std::string& pa
     });
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+std::future<std::shared_ptr<const MappedFile>> DefaultFileSystem::mapFile(const std::string& path)
+{
+    auto fullPath = getFullPath(path);
+
+    return std::async(
+        std::launch::async | std::launch::deferred,
+        [fullPath]() {
+            return std::shared_ptr<const MappedFile>(std::make_shared<MappedFile>(fullPath));
+    });
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<std::istream> DefaultFileSystem::openFile(const std::string& path)
+{
+    auto fullPath = getFullPath(path);
+    auto stream = std::make_unique<std::ifstream>(fullPath, std::ios::binary);
+
+    if (!stream->is_open())
+    {
+        throw ContentReadException(fullPath, "File", "Could not open file for reading");
+    }
+
+    return stream;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void DefaultFileSystem::writeFile(
+    const std::string& path,
+    const std::function<void(std::ostream&)>& writeContents)
+{
+    // Give every write its own temporary file so threads writing the same file do not write over each other.
+    static std::atomic<uint64_t> nextTemporaryId(0);
+
+    const auto fullPath = getFullPath(path);
+    const auto temporaryPath = fullPath + "." + std::to_string(nextTemporaryId++) + ".tmp";
+    std::error_code error;
+
+    try
+    {
+        std::ofstream stream(temporaryPath, std::ios::binary | std::ios::trunc);
+
+        if (!stream.is_open())
+        {
+            throw ContentWriteException(fullPath, "Could not open file for writing");
+        }
+
+        writeContents(stream);
+        stream.close();
+
+        if (!stream)
+        {
+            throw ContentWriteException(fullPath, "Could not write file");
+        }
+    }
+    catch (...)
+    {
+        std::filesystem::remove(temporaryPath, error);
+        throw;
+    }
+
+    // Renaming replaces the file in one step. Files that are open or mapped keep their old contents, or on Windows
+    // cannot be replaced at all, in which case the old file is kept.
+    std::filesystem::rename(temporaryPath, fullPath, error);
+
+    if (error)
+    {
+        std::filesystem::remove(temporaryPath, error);
+        throw ContentWriteException(fullPath, "Could not replace file");
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool DefaultFileSystem::tryGetFileStamp(const std::string& path, file_stamp_t& stamp)
+{
+    std::error_code error;
+    const std::filesystem::path fullPath(getFullPath(path));
+
+    auto size = std::filesystem::file_size(fullPath, error);
+
+    if (error)
+    {
+        return false;
+    }
+
+    auto lastWriteTime = std::filesystem::last_write_time(fullPath, error);
+
+    if (error)
+    {
+        return false;
+    }
+
+    stamp.size = static_cast<uint64_t>(size);
+    stamp.lastWriteTime = static_cast<int64_t>(lastWriteTime.time_since_epoch().count());
+
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void DefaultFileSystem::watchFile(const std::string& path)
+{
+    auto fullPath = getFullPath(path);
+    std::lock_guard<std::mutex> lock(m_watcherMutex);
+
+    if (m_watcher == nullptr)
+    {
+        m_watcher = std::make_unique<FileChangeWatcher>();
+    }
+
+    m_watcher->watch(fullPath);
+    m_watchedPaths[fullPath] = path;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<std::string> DefaultFileSystem::takeChangedFiles()
+{
+    std::lock_guard<std::mutex> lock(m_watcherMutex);
+    std::vector<std::string> changedFiles;
+
+    if (m_watcher != nullptr)
+    {
+        for (const auto& fullPath : m_watcher->takeChangedFiles())
+        {
+            changedFiles.push_back(m_watchedPaths.at(fullPath));
+        }
+    }
+
+    return changedFiles;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 std::string DefaultFileSystem::getFullPath(const std::string& path)
 {
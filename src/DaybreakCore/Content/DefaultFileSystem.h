@@ -1,8 +1,13 @@
 #pragma once
 #include "IFileSystem.h"
 
+#include <mutex>
+#include <unordered_map>
+
 namespace Daybreak
 {
+    class FileChangeWatcher;
+
     /** File system abstraction layer implemented using standard C++ API. */
     class DefaultFileSystem : public IFileSystem
     {
@@ -10,11 +15,22 @@ namespace Daybreak
         DefaultFileSystem(const std::string& rootDirectory);
         ~DefaultFileSystem();
         virtual std::future<std::string> loadFileAsText(const std::string& path) override;
+        virtual std::future<std::shared_ptr<const MappedFile>> mapFile(const std::string& path) override;
+        virtual std::unique_ptr<std::istream> openFile(const std::string& path) override;
+        virtual void writeFile(
+            const std::string& path,
+            const std::function<void(std::ostream&)>& writeContents) override;
+        virtual bool tryGetFileStamp(const std::string& path, file_stamp_t& stamp) override;
+        virtual void watchFile(const std::string& path) override;
+        virtual std::vector<std::string> takeChangedFiles() override;
 
     private:
         std::string getFullPath(const std::string& path);
 
     private:
         std::string m_rootDirectory;
+        std::mutex m_watcherMutex;
+        std::unique_ptr<FileChangeWatcher> m_watcher;       ///< Created when the first file is watched.
+        std::unordered_map<std::string, std::string> m_watchedPaths;   ///< Watched path by its full path.
     };
 }
\ No newline at end of file
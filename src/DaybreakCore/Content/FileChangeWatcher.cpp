@@ -0,0 +1,156 @@
+#include "stdafx.h"
+#include "FileChangeWatcher.h"
+#include "Common/Error.h"
+
+#include <algorithm>
+
+#if defined(__linux__)
+#   include <sys/inotify.h>
+#   include <unistd.h>
+#   include <cerrno>
+#   include <cstring>
+#else
+#   include <filesystem>
+#endif
+
+using namespace Daybreak;
+
+#if defined(__linux__)
+//---------------------------------------------------------------------------------------------------------------------
+FileChangeWatcher::FileChangeWatcher()
+    : m_inotify(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+    if (m_inotify < 0)
+    {
+        throw DaybreakEngineException("Could not create inotify instance to watch files", std::strerror(errno));
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+FileChangeWatcher::~FileChangeWatcher()
+{
+    close(m_inotify);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void FileChangeWatcher::watch(const std::string& filePath)
+{
+    // Watch the directory rather than the file, because a file that is replaced is a new file that a watch on the
+    // old one would not see.
+    const auto separator = filePath.find_last_of('/');
+    const auto directory = (separator == std::string::npos ? std::string(".") :
+        separator == 0 ? std::string("/") : filePath.substr(0, separator));
+    const auto name = (separator == std::string::npos ? filePath : filePath.substr(separator + 1));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Watching a directory again returns its existing watch.
+    const auto watch = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE);
+
+    if (watch < 0)
+    {
+        throw ContentReadException(filePath, "File", std::strerror(errno));
+    }
+
+    m_directories[watch] = directory;
+    m_files[directory + '/' + name] = filePath;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<std::string> FileChangeWatcher::takeChangedFiles()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> changedFiles;
+
+    alignas(inotify_event) char buffer[16 * 1024];
+    ssize_t bytesRead = 0;
+
+    while ((bytesRead = read(m_inotify, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t offset = 0; offset < bytesRead;)
+        {
+            const auto& event = *reinterpret_cast<const inotify_event *>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event.len);
+
+            auto directory = m_directories.find(event.wd);
+
+            if (event.len == 0 || directory == m_directories.end())
+            {
+                continue;
+            }
+
+            auto file = m_files.find(directory->second + '/' + event.name);
+
+            if (file != m_files.end())
+            {
+                changedFiles.push_back(file->second);
+            }
+        }
+    }
+
+    // Saving a file often writes it more than once, but each change only needs to be reported once.
+    std::sort(changedFiles.begin(), changedFiles.end());
+    changedFiles.erase(std::unique(changedFiles.begin(), changedFiles.end()), changedFiles.end());
+
+    return changedFiles;
+}
+#else
+//---------------------------------------------------------------------------------------------------------------------
+FileChangeWatcher::FileChangeWatcher() = default;
+
+//---------------------------------------------------------------------------------------------------------------------
+FileChangeWatcher::~FileChangeWatcher() = default;
+
+//---------------------------------------------------------------------------------------------------------------------
+FileChangeWatcher::file_state_t FileChangeWatcher::readFileState(const std::string& filePath)
+{
+    file_state_t state;
+    std::error_code error;
+
+    const auto size = std::filesystem::file_size(filePath, error);
+    const auto lastWriteTime = std::filesystem::last_write_time(filePath, error);
+
+    if (!error)
+    {
+        state.exists = true;
+        state.size = static_cast<uint64_t>(size);
+        state.lastWriteTime = static_cast<int64_t>(lastWriteTime.time_since_epoch().count());
+    }
+
+    return state;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void FileChangeWatcher::watch(const std::string& filePath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_files.find(filePath) == m_files.end())
+    {
+        m_files[filePath] = readFileState(filePath);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<std::string> FileChangeWatcher::takeChangedFiles()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::string> changedFiles;
+
+    for (auto& file : m_files)
+    {
+        const auto state = readFileState(file.first);
+
+        if (state.exists != file.second.exists ||
+            state.size != file.second.size ||
+            state.lastWriteTime != file.second.lastWriteTime)
+        {
+            file.second = state;
+            changedFiles.push_back(file.first);
+        }
+    }
+
+    std::sort(changedFiles.begin(), changedFiles.end());
+    return changedFiles;
+}
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Daybreak
+{
+    /**
+     * Watches files for changes. On Linux the directories holding the files are watched with inotify, so changes are
+     * seen without touching the files again and a file replaced by renaming a new file over it (which many editors
+     * do when saving) is still reported. Other platforms compare the size and last write time of every watched file
+     * each time changes are asked for.
+     */
+    class FileChangeWatcher
+    {
+    public:
+        /** Constructor. Throws DaybreakEngineException if the platform's change notifications are not available. */
+        FileChangeWatcher();
+
+        /** Destructor. */
+        ~FileChangeWatcher();
+
+        FileChangeWatcher(const FileChangeWatcher&) = delete;
+        FileChangeWatcher& operator =(const FileChangeWatcher&) = delete;
+
+        /** Start watching a file. Watching a file again does nothing. */
+        void watch(const std::string& filePath);
+
+        /** Get the watched files that were written, replaced or deleted since the last call. Does not wait. */
+        std::vector<std::string> takeChangedFiles();
+
+    private:
+        std::mutex m_mutex;
+
+#if defined(__linux__)
+        int m_inotify = -1;
+        std::unordered_map<int, std::string> m_directories;     ///< Directory of each inotify watch.
+        std::unordered_map<std::string, std::string> m_files;   ///< Watched path by its directory + '/' + name.
+#else
+        /** Size and last write time of a watched file the last time it was checked. */
+        struct file_state_t
+        {
+            bool exists = false;
+            uint64_t size = 0;
+            int64_t lastWriteTime = 0;
+        };
+
+        /** Get the current size and last write time of a file. */
+        static file_state_t readFileState(const std::string& filePath);
+
+        std::unordered_map<std::string, file_state_t> m_files;
+#endif
+    };
+}
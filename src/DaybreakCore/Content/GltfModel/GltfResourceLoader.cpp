@@ -0,0 +1,1000 @@
+#include "stdafx.h"
+#include "GltfResourceLoader.h"
+#include "Content/GltfModel/JsonValue.h"
+#include "Content/ResourcesManager.h"
+#include "Content/MappedFile.h"
+#include "Content\Models\ModelData.h"
+#include "Content\Materials\MaterialData.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/Mesh/VertexFormat.h"
+#include "Graphics/InputLayoutDescription.h"
+#include "Common/Error.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+using namespace Daybreak;
+
+const char * const GltfResourceLoader::FileExtension = ".glb";
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    const uint32_t GlbMagic = 0x46546C67;           ///< "glTF" read as a little endian number.
+    const uint32_t GlbVersion = 2;
+    const uint32_t JsonChunkType = 0x4E4F534A;      ///< "JSON" read as a little endian number.
+    const uint32_t BinaryChunkType = 0x004E4942;    ///< "BIN\0" read as a little endian number.
+    const size_t TrianglesMode = 4;
+
+    /** Marks a missing index into one of the glTF arrays. */
+    const size_t NoIndex = SIZE_MAX;
+
+    /** Bytes of a glTF buffer, which belong to the mapped glb file or to a mapped external buffer file. */
+    struct buffer_t
+    {
+        const uint8_t * data = nullptr;
+        size_t byteLength = 0;
+        std::shared_ptr<const MappedFile> owner;
+        std::string filePath;                       ///< Path of the file the buffer is stored in.
+    };
+
+    struct buffer_view_t
+    {
+        size_t buffer = 0;
+        const uint8_t * data = nullptr;
+        size_t byteLength = 0;
+        size_t byteStride = 0;                      ///< Zero when the elements are tightly packed.
+    };
+
+    struct accessor_t
+    {
+        size_t bufferView = NoIndex;                ///< No buffer view means every element is zero.
+        size_t byteOffset = 0;
+        size_t count = 0;
+        size_t componentType = 0;
+        InputAttribute attribute;                   ///< Storage type, count and normalization of each element.
+    };
+
+    /** Vertex attribute of a primitive and the accessor holding its values. */
+    using primitive_attribute_t = std::pair<InputAttribute, size_t>;
+
+    struct primitive_t
+    {
+        std::string name;
+        std::shared_ptr<MaterialData> material;
+        std::vector<primitive_attribute_t> attributes;
+        size_t indices = NoIndex;
+    };
+
+    /** Group of a model that is created after the mesh. */
+    struct group_range_t
+    {
+        size_t indexOffset;
+        size_t indexCount;
+        size_t baseVertex;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Read a little endian 32 bit number from a byte buffer. */
+    uint32_t readUInt32(const uint8_t * bytes) noexcept
+    {
+        uint32_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+
+        return value;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Get the order attributes are placed in when a model is repacked, which matches vertex_ptnt_t. */
+    int semanticOrder(InputAttribute::SemanticName name)
+    {
+        switch (name)
+        {
+        case InputAttribute::SemanticName::Position:
+            return 0;
+        case InputAttribute::SemanticName::Texture:
+            return 1;
+        case InputAttribute::SemanticName::Normal:
+            return 2;
+        case InputAttribute::SemanticName::Tangent:
+            return 3;
+        case InputAttribute::SemanticName::None:
+            return 4;
+        default:
+            THROW_ENUM_SWITCH_NOT_HANDLED(InputAttribute::SemanticName, name);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Reads the parts of a glb file that make up a model. */
+    class GlbReader
+    {
+    public:
+        GlbReader(const std::string& resourcePath, ResourcesManager& resources)
+            : m_resourcePath(resourcePath),
+              m_resources(resources)
+        {
+            const auto separator = resourcePath.find_last_of("/\\");
+            m_directory = (separator == std::string::npos ? "" : resourcePath.substr(0, separator + 1));
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        std::unique_ptr<ModelData> read()
+        {
+            m_file = m_resources.mapFile(m_resourcePath);
+
+            readChunks();
+            readBuffers();
+            readBufferViews();
+            readAccessors();
+            readPrimitives();
+
+            if (m_primitives.empty())
+            {
+                fail("Model does not have any triangles");
+            }
+
+            auto model = tryCreateMappedModel();
+            return (model != nullptr ? std::move(model) : createRepackedModel());
+        }
+
+    private:
+        //-------------------------------------------------------------------------------------------------------------
+        [[noreturn]] void fail(const std::string& message) const
+        {
+            throw ContentReadException(m_resourcePath, "Model", message);
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /** Find the JSON document and binary buffer chunks. */
+        void readChunks()
+        {
+            const auto bytes = m_file->data();
+            const auto size = m_file->size();
+
+            if (size < 12 || readUInt32(bytes) != GlbMagic)
+            {
+                fail("File is not a binary glTF file");
+            }
+
+            if (readUInt32(bytes + 4) != GlbVersion)
+            {
+                fail("Only glTF 2.0 files are supported");
+            }
+
+            const size_t length = readUInt32(bytes + 8);
+
+            if (length > size)
+            {
+                fail("File is shorter than the length in its header");
+            }
+
+            bool hasJson = false;
+
+            for (size_t offset = 12; offset + 8 <= length;)
+            {
+                const size_t chunkLength = readUInt32(bytes + offset);
+                const auto chunkType = readUInt32(bytes + offset + 4);
+                const auto chunkData = bytes + offset + 8;
+
+                if (chunkLength > length - offset - 8)
+                {
+                    fail("Chunk is longer than the file");
+                }
+
+                // The JSON chunk comes first and the optional binary chunk second. Other chunks are skipped.
+                if (!hasJson && chunkType == JsonChunkType)
+                {
+                    try
+                    {
+                        m_json = JsonValue::parse(
+                            std::string_view(reinterpret_cast<const char *>(chunkData), chunkLength));
+                    }
+                    catch (const DaybreakDataException& e)
+                    {
+                        fail(e.what());
+                    }
+
+                    hasJson = true;
+                }
+                else if (hasJson && chunkType == BinaryChunkType && m_binaryChunk.data == nullptr)
+                {
+                    m_binaryChunk.data = chunkData;
+                    m_binaryChunk.byteLength = chunkLength;
+                    m_binaryChunk.owner = m_file;
+                    m_binaryChunk.filePath = m_resourcePath;
+                }
+
+                offset += 8 + chunkLength;
+            }
+
+            if (!hasJson)
+            {
+                fail("File does not have a JSON chunk");
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /** Get an optional array member of the glTF document, which is empty when missing. */
+        const std::vector<JsonValue>& documentArray(const char * name) const
+        {
+            static const std::vector<JsonValue> Empty;
+            auto value = m_json.find(name);
+
+            return (value == nullptr ? Empty : value->asArray());
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void readBuffers()
+        {
+            for (const auto& json : documentArray("buffers"))
+            {
+                const auto byteLength = json.at("byteLength").asSize();
+                auto uri = json.find("uri");
+                buffer_t buffer;
+
+                if (uri == nullptr)
+                {
+                    // A buffer without a uri is the binary chunk of the glb file.
+                    buffer = m_binaryChunk;
+                }
+                else if (uri->asString().compare(0, 5, "data:") == 0)
+                {
+                    fail("Buffers embedded as data uris are not supported");
+                }
+                else
+                {
+                    buffer.filePath = m_directory + uri->asString();
+                    buffer.owner = m_resources.mapFile(buffer.filePath);
+                    buffer.data = buffer.owner->data();
+                    buffer.byteLength = buffer.owner->size();
+                }
+
+                if (buffer.data == nullptr || buffer.byteLength < byteLength)
+                {
+                    fail("Buffer is missing or shorter than its byte length");
+                }
+
+                buffer.byteLength = byteLength;
+                m_buffers.push_back(std::move(buffer));
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void readBufferViews()
+        {
+            for (const auto& json : documentArray("bufferViews"))
+            {
+                buffer_view_t view;
+                view.buffer = json.at("buffer").asSize();
+                view.byteLength = json.at("byteLength").asSize();
+                view.byteStride = json.sizeOr("byteStride", 0);
+
+                const auto byteOffset = json.sizeOr("byteOffset", 0);
+
+                if (view.buffer >= m_buffers.size() ||
+                    byteOffset > m_buffers[view.buffer].byteLength ||
+                    view.byteLength > m_buffers[view.buffer].byteLength - byteOffset)
+                {
+                    fail("Buffer view is outside of its buffer");
+                }
+
+                view.data = m_buffers[view.buffer].data + byteOffset;
+                m_views.push_back(view);
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void readAccessors()
+        {
+            for (const auto& json : documentArray("accessors"))
+            {
+                accessor_t accessor;
+                accessor.bufferView = json.sizeOr("bufferView", NoIndex);
+                accessor.byteOffset = json.sizeOr("byteOffset", 0);
+                accessor.count = json.at("count").asSize();
+                accessor.componentType = json.at("componentType").asSize();
+
+                if (json.find("sparse") != nullptr)
+                {
+                    fail("Sparse accessors are not supported");
+                }
+
+                const auto& type = json.at("type").asString();
+                const auto normalized = (json.find("normalized") != nullptr && json.at("normalized").asBool());
+                unsigned int count = 0;
+
+                if (type == "SCALAR")
+                {
+                    count = 1;
+                }
+                else if (type.size() == 4 && type.compare(0, 3, "VEC") == 0 && type[3] >= '2' && type[3] <= '4')
+                {
+                    count = static_cast<unsigned int>(type[3] - '0');
+                }
+
+                // Matrices and unknown component types are given a zero count and rejected when used.
+                InputAttribute::StorageType storageType = InputAttribute::StorageType::Float;
+
+                switch (accessor.componentType)
+                {
+                case 5120: storageType = InputAttribute::StorageType::Byte; break;
+                case 5121: storageType = InputAttribute::StorageType::UnsignedByte; break;
+                case 5122: storageType = InputAttribute::StorageType::Short; break;
+                case 5123: storageType = InputAttribute::StorageType::UnsignedShort; break;
+                case 5125: storageType = InputAttribute::StorageType::UnsignedInt; break;
+                case 5126: storageType = InputAttribute::StorageType::Float; break;
+                default: count = 0; break;
+                }
+
+                accessor.attribute =
+                    InputAttribute(InputAttribute::SemanticName::None, 0, storageType, count, normalized);
+
+                // Check every element is inside the buffer view.
+                if (accessor.bufferView != NoIndex && count > 0 && accessor.count > 0)
+                {
+                    if (accessor.bufferView >= m_views.size())
+                    {
+                        fail("Accessor buffer view does not exist");
+                    }
+
+                    const auto& view = m_views[accessor.bufferView];
+                    const auto elementSize = accessor.attribute.sizeInBytes();
+                    const auto stride = (view.byteStride != 0 ? view.byteStride : elementSize);
+
+                    if (accessor.byteOffset > view.byteLength ||
+                        elementSize > view.byteLength - accessor.byteOffset ||
+                        (accessor.count - 1) > (view.byteLength - accessor.byteOffset - elementSize) / stride)
+                    {
+                        fail("Accessor is outside of its buffer view");
+                    }
+                }
+
+                m_accessors.push_back(accessor);
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        const accessor_t& accessor(size_t index) const
+        {
+            if (index >= m_accessors.size())
+            {
+                fail("Accessor does not exist");
+            }
+
+            return m_accessors[index];
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /**
+         * Get the image used by a material texture, which is either an image file or an image stored in a buffer view.
+         * The path is empty if the texture does not have an image.
+         */
+        material_texture_t texture(const JsonValue& textureInfo) const
+        {
+            // glTF puts texture coordinate (0, 0) at the first (top) row of the image, which is where OpenGL samples
+            // it from when the image is not flipped. Flipping the texture coordinates instead would mean copying
+            // vertex buffers that are otherwise used straight from the file.
+            material_texture_t materialTexture;
+            materialTexture.flipVertically = false;
+
+            const auto& textureJson = m_json.at("textures").at(textureInfo.at("index").asSize());
+            auto source = textureJson.find("source");
+
+            if (source == nullptr)
+            {
+                return materialTexture;
+            }
+
+            const auto imageIndex = source->asSize();
+            const auto& image = m_json.at("images").at(imageIndex);
+
+            if (auto uri = image.find("uri"))
+            {
+                if (uri->asString().compare(0, 5, "data:") == 0)
+                {
+                    fail("Images embedded as data uris are not supported");
+                }
+
+                materialTexture.filepath = m_directory + uri->asString();
+            }
+            else if (auto bufferView = image.find("bufferView"))
+            {
+                // Images in a buffer view are decoded straight from the mapped buffer, and are named after the image
+                // so they can be cached like image files.
+                const auto viewIndex = bufferView->asSize();
+
+                if (viewIndex >= m_views.size())
+                {
+                    fail("Image buffer view does not exist");
+                }
+
+                const auto& view = m_views[viewIndex];
+                const auto& buffer = m_buffers[view.buffer];
+
+                materialTexture.filepath = m_resourcePath + "#images/" + std::to_string(imageIndex);
+                materialTexture.embeddedImage.containerPath = buffer.filePath;
+                materialTexture.embeddedImage.bytes = view.data;
+                materialTexture.embeddedImage.offset = static_cast<size_t>(view.data - buffer.owner->data());
+                materialTexture.embeddedImage.size = view.byteLength;
+                materialTexture.embeddedImage.bytesOwner = buffer.owner;
+            }
+            else
+            {
+                fail("Image does not have a uri or a buffer view");
+            }
+
+            return materialTexture;
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /** Get the material with an index, which is created the first time it is used. */
+        std::shared_ptr<MaterialData> material(size_t index)
+        {
+            if (index == NoIndex)
+            {
+                if (m_defaultMaterial == nullptr)
+                {
+                    m_defaultMaterial = std::make_shared<MaterialData>("default", MaterialType::Traditional);
+                }
+
+                return m_defaultMaterial;
+            }
+
+            const auto& materials = m_json.at("materials").asArray();
+
+            if (index >= materials.size())
+            {
+                fail("Material does not exist");
+            }
+
+            m_materials.resize(materials.size());
+
+            if (m_materials[index] != nullptr)
+            {
+                return m_materials[index];
+            }
+
+            const auto& json = materials[index];
+            auto name = json.stringOr("name", "");
+
+            auto material = std::make_shared<MaterialData>(
+                name.empty() ? "material" + std::to_string(index) : name,
+                MaterialType::Traditional);
+
+            if (auto pbr = json.find("pbrMetallicRoughness"))
+            {
+                if (auto factor = pbr->find("baseColorFactor"))
+                {
+                    const glm::vec4 color(
+                        factor->at(size_t(0)).asNumber(),
+                        factor->at(1).asNumber(),
+                        factor->at(2).asNumber(),
+                        factor->at(3).asNumber());
+
+                    material->setParameter(MaterialParameterType::DiffuseColor, glm::vec3(color));
+                    material->setParameter(MaterialParameterType::Opacity, color.a);
+                }
+
+                if (auto textureInfo = pbr->find("baseColorTexture"))
+                {
+                    auto diffuseMap = texture(*textureInfo);
+
+                    if (!diffuseMap.filepath.empty())
+                    {
+                        material->setParameter(MaterialParameterType::DiffuseMap, diffuseMap);
+                    }
+                }
+            }
+
+            if (auto textureInfo = json.find("normalTexture"))
+            {
+                auto normalMap = texture(*textureInfo);
+
+                if (!normalMap.filepath.empty())
+                {
+                    material->setParameter(MaterialParameterType::NormalMap, normalMap);
+                }
+            }
+
+            m_materials[index] = material;
+            return material;
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /** Get the vertex attribute for a glTF attribute name. Attributes Daybreak has no semantic for get None. */
+        static InputAttribute::SemanticName semanticOf(const std::string& name, unsigned int& index)
+        {
+            index = 0;
+
+            if (name == "POSITION")
+            {
+                return InputAttribute::SemanticName::Position;
+            }
+            else if (name == "NORMAL")
+            {
+                return InputAttribute::SemanticName::Normal;
+            }
+            else if (name == "TANGENT")
+            {
+                return InputAttribute::SemanticName::Tangent;
+            }
+            else if (name.compare(0, 9, "TEXCOORD_") == 0 && name.size() == 10 && name[9] >= '0' && name[9] <= '9')
+            {
+                index = static_cast<unsigned int>(name[9] - '0');
+                return InputAttribute::SemanticName::Texture;
+            }
+
+            return InputAttribute::SemanticName::None;
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void readPrimitives()
+        {
+            const auto& meshes = documentArray("meshes");
+
+            for (size_t m = 0; m < meshes.size(); ++m)
+            {
+                const auto& primitives = meshes[m].at("primitives").asArray();
+                auto meshName = meshes[m].stringOr("name", "");
+
+                if (meshName.empty())
+                {
+                    meshName = "mesh" + std::to_string(m);
+                }
+
+                for (size_t p = 0; p < primitives.size(); ++p)
+                {
+                    const auto& json = primitives[p];
+
+                    if (json.sizeOr("mode", TrianglesMode) != TrianglesMode)
+                    {
+                        fail("Only triangle list primitives are supported");
+                    }
+
+                    primitive_t primitive;
+                    primitive.name = (primitives.size() == 1 ? meshName : meshName + "_" + std::to_string(p));
+                    primitive.material = material(json.sizeOr("material", NoIndex));
+                    primitive.indices = json.sizeOr("indices", NoIndex);
+
+                    // Attributes without a semantic are numbered in name order, so the same attributes in another
+                    // primitive get the same numbers however they are ordered in the file.
+                    std::vector<std::pair<std::string, size_t>> others;
+
+                    for (const auto& member : json.at("attributes").asObject())
+                    {
+                        unsigned int semanticIndex = 0;
+                        const auto semantic = semanticOf(member.first, semanticIndex);
+                        const auto accessorIndex = member.second.asSize();
+                        const auto& attribute = accessor(accessorIndex).attribute;
+
+                        if (attribute.count() == 0)
+                        {
+                            fail("Vertex attributes must be scalars or vectors with a known component type");
+                        }
+
+                        if (semantic == InputAttribute::SemanticName::None)
+                        {
+                            others.emplace_back(member.first, accessorIndex);
+                        }
+                        else
+                        {
+                            primitive.attributes.emplace_back(
+                                InputAttribute(
+                                    semantic,
+                                    semanticIndex,
+                                    attribute.type(),
+                                    attribute.count(),
+                                    attribute.normalized()),
+                                accessorIndex);
+                        }
+                    }
+
+                    std::sort(others.begin(), others.end());
+
+                    for (size_t i = 0; i < others.size(); ++i)
+                    {
+                        auto attribute = accessor(others[i].second).attribute;
+                        attribute.setSemanticIndex(static_cast<unsigned int>(i));
+                        primitive.attributes.emplace_back(attribute, others[i].second);
+                    }
+
+                    checkPrimitive(primitive);
+                    m_primitives.push_back(std::move(primitive));
+                }
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /** Check a primitive has positions, that every attribute has the same count and that the indices are valid. */
+        void checkPrimitive(const primitive_t& primitive) const
+        {
+            const auto position = std::find_if(
+                primitive.attributes.begin(),
+                primitive.attributes.end(),
+                [](const primitive_attribute_t& a) {
+                    return a.first.semanticName() == InputAttribute::SemanticName::Position;
+                });
+
+            if (position == primitive.attributes.end())
+            {
+                fail("Primitive does not have a position attribute");
+            }
+
+            const auto vertexCount = accessor(position->second).count;
+
+            for (const auto& attribute : primitive.attributes)
+            {
+                if (accessor(attribute.second).count != vertexCount)
+                {
+                    fail("Every attribute of a primitive must have the same number of elements");
+                }
+            }
+
+            if (primitive.indices != NoIndex)
+            {
+                const auto& indices = accessor(primitive.indices);
+                const auto type = indices.attribute.type();
+
+                if (indices.attribute.count() != 1 ||
+                    (type != InputAttribute::StorageType::UnsignedByte &&
+                        type != InputAttribute::StorageType::UnsignedShort &&
+                        type != InputAttribute::StorageType::UnsignedInt))
+                {
+                    fail("Indices must be unsigned byte, short or int scalars");
+                }
+
+                if (indices.bufferView == NoIndex)
+                {
+                    fail("Indices must be stored in a buffer view");
+                }
+
+                for (size_t i = 0; i < indices.count; ++i)
+                {
+                    if (readIndex(indices, i) >= vertexCount)
+                    {
+                        fail("Primitive index is larger than its vertex count");
+                    }
+                }
+            }
+
+            const auto cornerCount = (primitive.indices != NoIndex ? accessor(primitive.indices).count : vertexCount);
+
+            if (cornerCount == 0 || cornerCount % 3 != 0)
+            {
+                fail("Triangle list primitives must have a multiple of three indices");
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /** Read an index from an index accessor. */
+        uint32_t readIndex(const accessor_t& indices, size_t i) const
+        {
+            const auto& view = m_views[indices.bufferView];
+            const auto elementSize = indices.attribute.sizeInBytes();
+            const auto stride = (view.byteStride != 0 ? view.byteStride : elementSize);
+            const auto bytes = view.data + indices.byteOffset + i * stride;
+
+            switch (elementSize)
+            {
+            case 1:
+                return *bytes;
+            case 2:
+                {
+                    uint16_t value;
+                    std::memcpy(&value, bytes, sizeof(value));
+                    return value;
+                }
+            default:
+                return readUInt32(bytes);
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /**
+         * Create a model whose buffers point into the glb file, or return null if the primitives do not share one
+         * interleaved vertex buffer view and one index buffer view laid out the way Daybreak draws them.
+         */
+        std::unique_ptr<ModelData> tryCreateMappedModel() const
+        {
+            const auto& first = m_primitives.front();
+
+            if (first.indices == NoIndex)
+            {
+                return nullptr;
+            }
+
+            const auto vertexView = accessor(first.attributes.front().second).bufferView;
+            const auto indexView = accessor(first.indices).bufferView;
+            const auto indexType = accessor(first.indices).attribute.type();
+            const auto indexSize = accessor(first.indices).attribute.sizeInBytes();
+
+            if (vertexView == NoIndex || m_views[indexView].byteStride != 0)
+            {
+                return nullptr;
+            }
+
+            std::vector<InputAttribute> layoutAttributes;
+            std::vector<group_range_t> ranges;
+            size_t stride = 0;
+
+            for (const auto& primitive : m_primitives)
+            {
+                // Order the attributes by where they are stored in each vertex, and check they are tightly packed.
+                auto attributes = primitive.attributes;
+
+                std::sort(
+                    attributes.begin(),
+                    attributes.end(),
+                    [&](const primitive_attribute_t& a, const primitive_attribute_t& b) {
+                        return accessor(a.second).byteOffset < accessor(b.second).byteOffset;
+                    });
+
+                const auto firstVertexOffset = accessor(attributes.front().second).byteOffset;
+                std::vector<InputAttribute> vertexAttributes;
+                size_t vertexSize = 0;
+
+                for (const auto& attribute : attributes)
+                {
+                    const auto& a = accessor(attribute.second);
+
+                    if (a.bufferView != vertexView || a.byteOffset != firstVertexOffset + vertexSize)
+                    {
+                        return nullptr;
+                    }
+
+                    vertexAttributes.push_back(attribute.first);
+                    vertexSize += attribute.first.sizeInBytes();
+                }
+
+                if (layoutAttributes.empty())
+                {
+                    layoutAttributes = vertexAttributes;
+                    stride = (m_views[vertexView].byteStride != 0 ? m_views[vertexView].byteStride : vertexSize);
+                }
+
+                if (vertexAttributes != layoutAttributes || vertexSize != stride || firstVertexOffset % stride != 0)
+                {
+                    return nullptr;
+                }
+
+                // Every primitive's indices are relative to its first vertex.
+                if (primitive.indices == NoIndex)
+                {
+                    return nullptr;
+                }
+
+                const auto& indices = accessor(primitive.indices);
+
+                if (indices.bufferView != indexView ||
+                    indices.attribute.type() != indexType ||
+                    indices.byteOffset % indexSize != 0)
+                {
+                    return nullptr;
+                }
+
+                ranges.push_back({ indices.byteOffset / indexSize, indices.count, firstVertexOffset / stride });
+            }
+
+            const auto& vertices = m_views[vertexView];
+            const auto& indices = m_views[indexView];
+
+            auto model = std::make_unique<ModelData>(
+                std::make_unique<MeshData>(
+                    std::make_unique<IndexBufferData>(
+                        (indices.byteLength / indexSize) * indexSize,
+                        indices.data,
+                        m_buffers[indices.buffer].owner,
+                        indexElementStorageSizeToType(indexSize)),
+                    std::make_unique<VertexBufferData>(
+                        (vertices.byteLength / stride) * stride,
+                        vertices.data,
+                        m_buffers[vertices.buffer].owner,
+                        std::make_shared<InputLayoutDescription>(layoutAttributes))));
+
+            addGroups(*model, ranges);
+            return model;
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /** Create a model by copying every primitive into one interleaved vertex buffer and one index buffer. */
+        std::unique_ptr<ModelData> createRepackedModel() const
+        {
+            // Attributes without a Daybreak semantic are dropped.
+            auto sortedAttributes = [](const primitive_t& primitive) {
+                std::vector<primitive_attribute_t> attributes;
+
+                for (const auto& attribute : primitive.attributes)
+                {
+                    if (attribute.first.semanticName() != InputAttribute::SemanticName::None)
+                    {
+                        attributes.push_back(attribute);
+                    }
+                }
+
+                std::sort(
+                    attributes.begin(),
+                    attributes.end(),
+                    [](const primitive_attribute_t& a, const primitive_attribute_t& b) {
+                        const auto orderA = semanticOrder(a.first.semanticName());
+                        const auto orderB = semanticOrder(b.first.semanticName());
+
+                        return orderA < orderB ||
+                            (orderA == orderB && a.first.semanticIndex() < b.first.semanticIndex());
+                    });
+
+                return attributes;
+            };
+
+            std::vector<InputAttribute> layoutAttributes;
+
+            for (const auto& attribute : sortedAttributes(m_primitives.front()))
+            {
+                layoutAttributes.push_back(attribute.first);
+            }
+
+            std::shared_ptr<const InputLayoutDescription> layout =
+                std::make_shared<InputLayoutDescription>(layoutAttributes);
+
+            for (const auto& standardLayout : { vertex_ptn_t::inputLayout, vertex_ptnt_t::inputLayout })
+            {
+                bool isSame = (standardLayout->attributeCount() == layoutAttributes.size());
+
+                for (size_t i = 0; isSame && i < layoutAttributes.size(); ++i)
+                {
+                    isSame = (standardLayout->getAttributeByIndex(i) == layoutAttributes[i]);
+                }
+
+                if (isSame)
+                {
+                    layout = standardLayout;
+                }
+            }
+
+            const auto stride = layout->elementSizeInBytes();
+            size_t vertexCount = 0;
+            size_t indexCount = 0;
+
+            for (const auto& primitive : m_primitives)
+            {
+                vertexCount += accessor(primitive.attributes.front().second).count;
+                indexCount += (primitive.indices != NoIndex ?
+                    accessor(primitive.indices).count :
+                    accessor(primitive.attributes.front().second).count);
+            }
+
+            std::unique_ptr<uint8_t[]> bytes(new uint8_t[vertexCount * stride]());
+            std::vector<uint32_t> indices;
+            std::vector<group_range_t> ranges;
+
+            indices.reserve(indexCount);
+
+            size_t firstVertex = 0;
+
+            for (const auto& primitive : m_primitives)
+            {
+                const auto attributes = sortedAttributes(primitive);
+                const auto primitiveVertexCount = accessor(primitive.attributes.front().second).count;
+
+                if (attributes.size() != layoutAttributes.size())
+                {
+                    fail("Every primitive must have the same vertex attributes");
+                }
+
+                for (size_t i = 0; i < attributes.size(); ++i)
+                {
+                    if (!(attributes[i].first == layoutAttributes[i]))
+                    {
+                        fail("Every primitive must have the same vertex attributes");
+                    }
+
+                    // Attributes without a buffer view are zero, which the buffer already is.
+                    const auto& source = accessor(attributes[i].second);
+
+                    if (source.bufferView == NoIndex)
+                    {
+                        continue;
+                    }
+
+                    const auto& view = m_views[source.bufferView];
+                    const auto elementSize = layoutAttributes[i].sizeInBytes();
+                    const auto sourceStride = (view.byteStride != 0 ? view.byteStride : elementSize);
+                    const auto sourceBytes = view.data + source.byteOffset;
+                    const auto destination = bytes.get() + firstVertex * stride + layout->attributeOffsetByIndex(i);
+
+                    for (size_t v = 0; v < primitiveVertexCount; ++v)
+                    {
+                        std::memcpy(destination + v * stride, sourceBytes + v * sourceStride, elementSize);
+                    }
+                }
+
+                ranges.push_back({ indices.size(), 0, 0 });
+
+                if (primitive.indices != NoIndex)
+                {
+                    const auto& primitiveIndices = accessor(primitive.indices);
+
+                    for (size_t i = 0; i < primitiveIndices.count; ++i)
+                    {
+                        indices.push_back(static_cast<uint32_t>(firstVertex + readIndex(primitiveIndices, i)));
+                    }
+                }
+                else
+                {
+                    for (size_t v = 0; v < primitiveVertexCount; ++v)
+                    {
+                        indices.push_back(static_cast<uint32_t>(firstVertex + v));
+                    }
+                }
+
+                ranges.back().indexCount = indices.size() - ranges.back().indexOffset;
+                firstVertex += primitiveVertexCount;
+            }
+
+            auto model = std::make_unique<ModelData>(
+                std::make_unique<MeshData>(
+                    createCompactIndexBuffer(indices.data(), indices.size()),
+                    std::make_unique<VertexBufferData>(vertexCount * stride, std::move(bytes), layout)));
+
+            addGroups(*model, ranges);
+            return model;
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /** Add a group to a model for every primitive. */
+        void addGroups(ModelData& model, const std::vector<group_range_t>& ranges) const
+        {
+            std::vector<ModelData::Group> groups;
+            groups.reserve(ranges.size());
+
+            for (size_t i = 0; i < ranges.size(); ++i)
+            {
+                groups.emplace_back(ModelData::Group(
+                    m_primitives[i].name,
+                    m_primitives[i].material,
+                    ranges[i].indexOffset,
+                    ranges[i].indexCount,
+                    ranges[i].baseVertex));
+            }
+
+            model.addGroup(std::move(groups));
+        }
+
+    private:
+        std::string m_resourcePath;
+        std::string m_directory;
+        ResourcesManager& m_resources;
+        std::shared_ptr<const MappedFile> m_file;
+        JsonValue m_json;
+        buffer_t m_binaryChunk;
+        std::vector<buffer_t> m_buffers;
+        std::vector<buffer_view_t> m_views;
+        std::vector<accessor_t> m_accessors;
+        std::vector<primitive_t> m_primitives;
+        std::vector<std::shared_ptr<MaterialData>> m_materials;
+        std::shared_ptr<MaterialData> m_defaultMaterial;
+    };
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<ModelData> GltfResourceLoader::load(
+    const std::string& resourcePath,
+    ResourcesManager& resources)
+{
+    GlbReader reader(resourcePath, resources);
+
+    // Errors in the structure of the JSON document (like a missing member) are reported as errors in the model file.
+    try
+    {
+        return reader.read();
+    }
+    catch (const DaybreakDataException& e)
+    {
+        throw ContentReadException(resourcePath, "Model", e.what());
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "Content/IResourceLoader.h"
+#include "Content\Models\ModelData.h"
+
+#include <memory>
+#include <string>
+
+namespace Daybreak
+{
+    /**
+     * Loads binary glTF 2.0 (glb) models. Every triangle primitive of every mesh becomes a group, and node transforms,
+     * skins and animations are ignored. The file is mapped rather than read, and when the vertex and index data
+     * already have a layout Daybreak can draw the model's buffers point straight into the mapped file without copying.
+     * This needs every primitive to be indexed and share one index buffer view and one interleaved vertex buffer view
+     * whose attributes are tightly packed with a stride equal to the vertex size (the layout gltfpack and most
+     * engine exporters write). The attributes then keep the order they are stored in. Any other file is repacked
+     * into one interleaved vertex buffer with the position, texture, normal and tangent attributes in that order.
+     *
+     * Texture coordinates are kept as written, with the glTF origin at the top left of the image, so material textures
+     * are loaded without flipping their images. Materials get the base color factor and the base color and normal
+     * textures, whose images are stored in separate files or in buffer views.
+     */
+    class GltfResourceLoader : public IResourceLoader<ModelData>
+    {
+    public:
+        /** File extension of binary glTF models. */
+        static const char * const FileExtension;
+
+    public:
+        virtual std::unique_ptr<ModelData> load(
+            const std::string& resourcePath,
+            ResourcesManager& resources) override;
+    };
+}
@@ -0,0 +1,501 @@
+#include "stdafx.h"
+#include "JsonValue.h"
+#include "Common/Error.h"
+
+#include <charconv>
+#include <cmath>
+
+using namespace Daybreak;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace Daybreak
+{
+    /** Recursive descent parser that builds JsonValue objects. */
+    class JsonParser
+    {
+    public:
+        /** Deepest nesting of arrays and objects that is parsed, so hostile files cannot overflow the stack. */
+        static const size_t MaxDepth = 256;
+
+    public:
+        explicit JsonParser(std::string_view text)
+            : m_next(text.data()),
+              m_last(text.data() + text.size())
+        {
+        }
+
+        /** Parse the whole text as one value. */
+        JsonValue parseDocument()
+        {
+            JsonValue value;
+            parseValue(value, 0);
+            skipWhitespace();
+
+            if (m_next != m_last)
+            {
+                fail("Unexpected text after the end of the JSON document");
+            }
+
+            return value;
+        }
+
+    private:
+        //-------------------------------------------------------------------------------------------------------------
+        [[noreturn]] void fail(const char * message) const
+        {
+            throw DaybreakDataException(message);
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void skipWhitespace() noexcept
+        {
+            while (m_next != m_last && (*m_next == ' ' || *m_next == '\t' || *m_next == '\n' || *m_next == '\r'))
+            {
+                ++m_next;
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /** Consume the given word if it comes next. */
+        bool tryConsume(std::string_view word) noexcept
+        {
+            if (static_cast<size_t>(m_last - m_next) >= word.size() && std::string_view(m_next, word.size()) == word)
+            {
+                m_next += word.size();
+                return true;
+            }
+
+            return false;
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void parseValue(JsonValue& value, size_t depth)
+        {
+            skipWhitespace();
+
+            if (m_next == m_last)
+            {
+                fail("Unexpected end of JSON document");
+            }
+
+            if (*m_next == '{' || *m_next == '[')
+            {
+                if (depth >= MaxDepth)
+                {
+                    fail("JSON arrays and objects are nested too deeply");
+                }
+
+                if (*m_next == '{')
+                {
+                    parseObject(value, depth + 1);
+                }
+                else
+                {
+                    parseArray(value, depth + 1);
+                }
+            }
+            else if (*m_next == '"')
+            {
+                value.m_type = JsonValue::Type::String;
+                parseString(value.m_string);
+            }
+            else if (tryConsume("true"))
+            {
+                value.m_type = JsonValue::Type::Boolean;
+                value.m_bool = true;
+            }
+            else if (tryConsume("false"))
+            {
+                value.m_type = JsonValue::Type::Boolean;
+                value.m_bool = false;
+            }
+            else if (tryConsume("null"))
+            {
+                value.m_type = JsonValue::Type::Null;
+            }
+            else
+            {
+                value.m_type = JsonValue::Type::Number;
+                parseNumber(value.m_number);
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void parseObject(JsonValue& value, size_t depth)
+        {
+            value.m_type = JsonValue::Type::Object;
+            ++m_next;
+            skipWhitespace();
+
+            if (m_next != m_last && *m_next == '}')
+            {
+                ++m_next;
+                return;
+            }
+
+            for (;;)
+            {
+                skipWhitespace();
+
+                if (m_next == m_last || *m_next != '"')
+                {
+                    fail("Expected a string as the name of a JSON object member");
+                }
+
+                value.m_members.emplace_back();
+                parseString(value.m_members.back().first);
+                skipWhitespace();
+
+                if (m_next == m_last || *m_next != ':')
+                {
+                    fail("Expected ':' after the name of a JSON object member");
+                }
+
+                ++m_next;
+                parseValue(value.m_members.back().second, depth);
+                skipWhitespace();
+
+                if (m_next != m_last && *m_next == ',')
+                {
+                    ++m_next;
+                }
+                else if (m_next != m_last && *m_next == '}')
+                {
+                    ++m_next;
+                    return;
+                }
+                else
+                {
+                    fail("Expected ',' or '}' after a JSON object member");
+                }
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void parseArray(JsonValue& value, size_t depth)
+        {
+            value.m_type = JsonValue::Type::Array;
+            ++m_next;
+            skipWhitespace();
+
+            if (m_next != m_last && *m_next == ']')
+            {
+                ++m_next;
+                return;
+            }
+
+            for (;;)
+            {
+                value.m_elements.emplace_back();
+                parseValue(value.m_elements.back(), depth);
+                skipWhitespace();
+
+                if (m_next != m_last && *m_next == ',')
+                {
+                    ++m_next;
+                }
+                else if (m_next != m_last && *m_next == ']')
+                {
+                    ++m_next;
+                    return;
+                }
+                else
+                {
+                    fail("Expected ',' or ']' after a JSON array element");
+                }
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /** Read the four hex digits of a \u escape. */
+        uint32_t parseHexDigits()
+        {
+            if (m_last - m_next < 4)
+            {
+                fail("Expected four hex digits after \\u in a JSON string");
+            }
+
+            uint32_t value = 0;
+            auto result = std::from_chars(m_next, m_next + 4, value, 16);
+
+            if (result.ptr != m_next + 4)
+            {
+                fail("Expected four hex digits after \\u in a JSON string");
+            }
+
+            m_next += 4;
+            return value;
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        /** Append a unicode code point to a string encoded as UTF-8. */
+        static void appendUtf8(std::string& text, uint32_t codePoint)
+        {
+            if (codePoint < 0x80)
+            {
+                text.push_back(static_cast<char>(codePoint));
+            }
+            else if (codePoint < 0x800)
+            {
+                text.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+                text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else if (codePoint < 0x10000)
+            {
+                text.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+                text.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+            else
+            {
+                text.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+                text.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+                text.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+                text.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void parseString(std::string& text)
+        {
+            // Skip the opening quote. Runs of characters without escapes are copied all at once.
+            ++m_next;
+
+            for (;;)
+            {
+                auto runEnd = m_next;
+
+                while (runEnd != m_last && *runEnd != '"' && *runEnd != '\\')
+                {
+                    if (static_cast<unsigned char>(*runEnd) < 0x20)
+                    {
+                        fail("Control characters must be escaped in JSON strings");
+                    }
+
+                    ++runEnd;
+                }
+
+                text.append(m_next, runEnd);
+                m_next = runEnd;
+
+                if (m_next == m_last)
+                {
+                    fail("Unexpected end of JSON document in a string");
+                }
+
+                if (*m_next++ == '"')
+                {
+                    return;
+                }
+
+                if (m_next == m_last)
+                {
+                    fail("Unexpected end of JSON document in a string");
+                }
+
+                switch (*m_next++)
+                {
+                case '"': text.push_back('"'); break;
+                case '\\': text.push_back('\\'); break;
+                case '/': text.push_back('/'); break;
+                case 'b': text.push_back('\b'); break;
+                case 'f': text.push_back('\f'); break;
+                case 'n': text.push_back('\n'); break;
+                case 'r': text.push_back('\r'); break;
+                case 't': text.push_back('\t'); break;
+                case 'u':
+                    {
+                        auto codePoint = parseHexDigits();
+
+                        // Characters outside the basic multilingual plane are written as a pair of surrogates.
+                        if (codePoint >= 0xD800 && codePoint < 0xDC00 && tryConsume("\\u"))
+                        {
+                            const auto low = parseHexDigits();
+
+                            if (low < 0xDC00 || low >= 0xE000)
+                            {
+                                fail("Invalid surrogate pair in a JSON string");
+                            }
+
+                            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        else if (codePoint >= 0xD800 && codePoint < 0xE000)
+                        {
+                            // A surrogate without its other half is not a character and cannot be written as UTF-8.
+                            fail("Invalid surrogate pair in a JSON string");
+                        }
+
+                        appendUtf8(text, codePoint);
+                    }
+                    break;
+                default:
+                    fail("Invalid escape sequence in a JSON string");
+                }
+            }
+        }
+
+        //-------------------------------------------------------------------------------------------------------------
+        void parseNumber(double& number)
+        {
+            // JSON does not allow a leading '+', leading zeros or a bare '.', which from_chars would accept.
+            auto first = m_next;
+            auto digits = (first != m_last && *first == '-' ? first + 1 : first);
+
+            if (digits == m_last || *digits < '0' || *digits > '9' ||
+                (*digits == '0' && digits + 1 != m_last && digits[1] >= '0' && digits[1] <= '9'))
+            {
+                fail("Expected a JSON value");
+            }
+
+            auto result = std::from_chars(first, m_last, number);
+
+            if (result.ec != std::errc() || !std::isfinite(number))
+            {
+                fail("JSON number is out of range");
+            }
+
+            m_next = result.ptr;
+        }
+
+    private:
+        const char * m_next;
+        const char * m_last;
+    };
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+JsonValue JsonValue::parse(std::string_view text)
+{
+    JsonParser parser(text);
+    return parser.parseDocument();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool JsonValue::asBool() const
+{
+    if (m_type != Type::Boolean)
+    {
+        throw DaybreakDataException("Expected JSON value to be a boolean");
+    }
+
+    return m_bool;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+double JsonValue::asNumber() const
+{
+    if (m_type != Type::Number)
+    {
+        throw DaybreakDataException("Expected JSON value to be a number");
+    }
+
+    return m_number;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+size_t JsonValue::asSize() const
+{
+    const auto number = asNumber();
+
+    // Stay below 2^53 so every value is exact as a double and fits in a 64 bit size.
+    if (number < 0.0 || number > 9007199254740991.0 || std::floor(number) != number)
+    {
+        throw DaybreakDataException("Expected JSON value to be a whole number no smaller than zero");
+    }
+
+    return static_cast<size_t>(number);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const std::string& JsonValue::asString() const
+{
+    if (m_type != Type::String)
+    {
+        throw DaybreakDataException("Expected JSON value to be a string");
+    }
+
+    return m_string;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const std::vector<JsonValue>& JsonValue::asArray() const
+{
+    if (m_type != Type::Array)
+    {
+        throw DaybreakDataException("Expected JSON value to be an array");
+    }
+
+    return m_elements;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const std::vector<JsonValue::member_t>& JsonValue::asObject() const
+{
+    if (m_type != Type::Object)
+    {
+        throw DaybreakDataException("Expected JSON value to be an object");
+    }
+
+    return m_members;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const JsonValue * JsonValue::find(std::string_view name) const noexcept
+{
+    for (const auto& member : m_members)
+    {
+        if (member.first == name)
+        {
+            return &member.second;
+        }
+    }
+
+    return nullptr;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const JsonValue& JsonValue::at(std::string_view name) const
+{
+    auto value = find(name);
+
+    if (value == nullptr)
+    {
+        throw DaybreakDataException("Expected JSON object to have member '" + std::string(name) + "'");
+    }
+
+    return *value;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const JsonValue& JsonValue::at(size_t index) const
+{
+    const auto& elements = asArray();
+
+    if (index >= elements.size())
+    {
+        throw DaybreakDataException("JSON array index is out of range");
+    }
+
+    return elements[index];
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+size_t JsonValue::sizeOr(std::string_view name, size_t defaultValue) const
+{
+    auto value = find(name);
+    return (value == nullptr ? defaultValue : value->asSize());
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+double JsonValue::numberOr(std::string_view name, double defaultValue) const
+{
+    auto value = find(name);
+    return (value == nullptr ? defaultValue : value->asNumber());
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::string JsonValue::stringOr(std::string_view name, const std::string& defaultValue) const
+{
+    auto value = find(name);
+    return (value == nullptr ? defaultValue : value->asString());
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Daybreak
+{
+    /**
+     * Value read from JSON text, like the document at the start of a glTF file. Objects keep their members in the
+     * order they were written and looking a member up is a linear search, which is fast for the small objects glTF
+     * uses.
+     */
+    class JsonValue
+    {
+    public:
+        /** Type of a JSON value. */
+        enum class Type
+        {
+            Null,
+            Boolean,
+            Number,
+            String,
+            Array,
+            Object
+        };
+
+        using member_t = std::pair<std::string, JsonValue>;
+
+    public:
+        /** Constructor for a null value. */
+        JsonValue() = default;
+
+        /** Parse a JSON document. Throws DaybreakDataException if the text is not valid JSON. */
+        static JsonValue parse(std::string_view text);
+
+        /** Get the type of the value. */
+        Type type() const noexcept { return m_type; }
+
+        /** Check if the value is null. */
+        bool isNull() const noexcept { return m_type == Type::Null; }
+
+        /** Get a boolean value. Throws DaybreakDataException if the value is not a boolean. */
+        bool asBool() const;
+
+        /** Get a number value. Throws DaybreakDataException if the value is not a number. */
+        double asNumber() const;
+
+        /**
+         * Get a number value that must be a whole number no smaller than zero, like an index or count. Throws
+         * DaybreakDataException if it is not.
+         */
+        size_t asSize() const;
+
+        /** Get a string value. Throws DaybreakDataException if the value is not a string. */
+        const std::string& asString() const;
+
+        /** Get the elements of an array. Throws DaybreakDataException if the value is not an array. */
+        const std::vector<JsonValue>& asArray() const;
+
+        /** Get the members of an object. Throws DaybreakDataException if the value is not an object. */
+        const std::vector<member_t>& asObject() const;
+
+        /** Get an object member by name, or null if the value is not an object or does not have the member. */
+        const JsonValue * find(std::string_view name) const noexcept;
+
+        /** Get an object member by name. Throws DaybreakDataException if the member is missing. */
+        const JsonValue& at(std::string_view name) const;
+
+        /** Get the array element at an index. Throws DaybreakDataException if there is no such element. */
+        const JsonValue& at(size_t index) const;
+
+        /** Get a whole number member, or defaultValue if the member is missing. */
+        size_t sizeOr(std::string_view name, size_t defaultValue) const;
+
+        /** Get a number member, or defaultValue if the member is missing. */
+        double numberOr(std::string_view name, double defaultValue) const;
+
+        /** Get a string member, or defaultValue if the member is missing. */
+        std::string stringOr(std::string_view name, const std::string& defaultValue) const;
+
+    private:
+        friend class JsonParser;
+
+        Type m_type = Type::Null;
+        bool m_bool = false;
+        double m_number = 0.0;
+        std::string m_string;
+        std::vector<JsonValue> m_elements;
+        std::vector<member_t> m_members;
+    };
+}
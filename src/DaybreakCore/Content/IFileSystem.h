@@ -1,14 +1,63 @@
 #pragma once
 #include <string>
+#include <functional>
 #include <future>
+#include <istream>
+#include <ostream>
+#include <memory>
+#include <cstdint>
+#include <vector>
 
 namespace Daybreak
 {
+    class MappedFile;
+
+    /** Size and last write time of a file, used to check if data derived from the file is out of date. */
+    struct file_stamp_t
+    {
+        uint64_t size = 0;
+        int64_t lastWriteTime = 0;
+
+        /** Equality operator. */
+        bool operator ==(const file_stamp_t& rhs) const noexcept
+        {
+            return size == rhs.size && lastWriteTime == rhs.lastWriteTime;
+        }
+
+        /** Inequality operator. */
+        bool operator !=(const file_stamp_t& rhs) const noexcept { return !(*this == rhs); }
+    };
+
     /** File system abstraction interface. */
     class IFileSystem
     { 
     public:
         virtual ~IFileSystem() = default;
         virtual std::future<std::string> loadFileAsText(const std::string& path) = 0;
+
+        /**
+         * Map a file into memory for reading without copying it. The returned file stays mapped until every
+         * reference to it is released.
+         */
+        virtual std::future<std::shared_ptr<const MappedFile>> mapFile(const std::string& path) = 0;
+
+        /** Open a file as a binary stream for reading it a piece at a time. */
+        virtual std::unique_ptr<std::istream> openFile(const std::string& path) = 0;
+
+        /**
+         * Create (or replace) a file with the binary contents written by writeContents. The contents are written to a
+         * temporary file that is renamed over the file once they are complete, so the old file is never seen partly
+         * written and mappings of it are left intact. Throws ContentWriteException if the file cannot be written.
+         */
+        virtual void writeFile(const std::string& path, const std::function<void(std::ostream&)>& writeContents) = 0;
+
+        /** Get the size and last write time of a file. Returns false if the file does not exist. */
+        virtual bool tryGetFileStamp(const std::string& path, file_stamp_t& stamp) = 0;
+
+        /** Start watching a file for changes. */
+        virtual void watchFile(const std::string& path) = 0;
+
+        /** Get the watched files that changed since the last call, using the paths they were watched with. */
+        virtual std::vector<std::string> takeChangedFiles() = 0;
     };
 }
\ No newline at end of file
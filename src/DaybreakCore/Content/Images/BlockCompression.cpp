@@ -0,0 +1,624 @@
+#include "stdafx.h"
+#include "BlockCompression.h"
+#include "Common/Error.h"
+#include "Utility/ParallelFor.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#   define DAYBREAK_BLOCK_COMPRESSION_SSE2
+#   include <emmintrin.h>
+#endif
+
+using namespace Daybreak;
+
+namespace
+{
+    /** Pixels of a 4x4 block as RGBA, row by row. */
+    using block_t = std::array<std::array<unsigned char, 4>, 16>;
+
+    /** RGB color with float channels between 0 and 255. */
+    using color_t = std::array<float, 3>;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    void readBlock(
+        const unsigned char * pixels,
+        size_t width,
+        size_t height,
+        size_t channelCount,
+        size_t blockX,
+        size_t blockY,
+        bool isColor,
+        block_t& block)
+    {
+        for (size_t i = 0; i < 16; ++i)
+        {
+            const auto x = std::min(blockX * 4 + i % 4, width - 1);
+            const auto y = std::min(blockY * 4 + i / 4, height - 1);
+            const auto * pixel = pixels + (y * width + x) * channelCount;
+            auto& out = block[i];
+
+            if (isColor)
+            {
+                // Grayscale is spread to every color channel, and images without alpha are opaque.
+                const auto isGray = channelCount < 3;
+
+                out[0] = pixel[0];
+                out[1] = pixel[isGray ? 0 : 1];
+                out[2] = pixel[isGray ? 0 : 2];
+                out[3] = (channelCount == 2 || channelCount == 4 ? pixel[channelCount - 1] : 255);
+            }
+            else
+            {
+                out[0] = pixel[0];
+                out[1] = pixel[std::min<size_t>(1, channelCount - 1)];
+                out[2] = 0;
+                out[3] = 255;
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    uint16_t packRgb565(const color_t& color)
+    {
+        auto quantize = [](float value, int maxValue) {
+            const auto q = static_cast<int>(value * static_cast<float>(maxValue) / 255.0f + 0.5f);
+            return static_cast<uint16_t>(std::min(std::max(q, 0), maxValue));
+        };
+
+        return static_cast<uint16_t>(
+            (quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) | quantize(color[2], 31));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    color_t unpackRgb565(uint16_t packed)
+    {
+        const auto r = (packed >> 11) & 31;
+        const auto g = (packed >> 5) & 63;
+        const auto b = packed & 31;
+
+        return {
+            static_cast<float>((r << 3) | (r >> 2)),
+            static_cast<float>((g << 2) | (g >> 4)),
+            static_cast<float>((b << 3) | (b >> 2)) };
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    float colorDistance(const color_t& a, const std::array<unsigned char, 4>& b)
+    {
+        const auto dr = a[0] - b[0];
+        const auto dg = a[1] - b[1];
+        const auto db = a[2] - b[2];
+
+        return dr * dr + dg * dg + db * db;
+    }
+
+#ifdef DAYBREAK_BLOCK_COMPRESSION_SSE2
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Load one channel of the four pixels of a block starting at pixel first. */
+    __m128 loadChannel(const block_t& block, size_t first, size_t channel)
+    {
+        return _mm_setr_ps(
+            static_cast<float>(block[first][channel]),
+            static_cast<float>(block[first + 1][channel]),
+            static_cast<float>(block[first + 2][channel]),
+            static_cast<float>(block[first + 3][channel]));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Get the squared distance from a color to four pixels, with each color channel of the pixels in channels. */
+    __m128 colorDistance(const color_t& a, const __m128 * channels)
+    {
+        const auto dr = _mm_sub_ps(_mm_set1_ps(a[0]), channels[0]);
+        const auto dg = _mm_sub_ps(_mm_set1_ps(a[1]), channels[1]);
+        const auto db = _mm_sub_ps(_mm_set1_ps(a[2]), channels[2]);
+
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)), _mm_mul_ps(db, db));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Keep the distance and palette index of every pixel that is strictly closer to another palette entry. */
+    void keepCloser(__m128& bestDistance, __m128i& bestIndex, __m128 distance, int index)
+    {
+        const auto closer = _mm_castps_si128(_mm_cmplt_ps(distance, bestDistance));
+
+        bestDistance = _mm_min_ps(distance, bestDistance);
+        bestIndex = _mm_or_si128(
+            _mm_and_si128(closer, _mm_set1_epi32(index)),
+            _mm_andnot_si128(closer, bestIndex));
+    }
+#endif
+
+    /** Endpoints and indices of a BC1 color block. */
+    struct color_block_t
+    {
+        uint16_t color0 = 0;
+        uint16_t color1 = 0;
+        uint32_t indices = 0;
+        float error = 0.0f;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    color_block_t selectColorIndices(const block_t& block, uint16_t color0, uint16_t color1)
+    {
+        // The first endpoint must be larger to use four colors. Equal endpoints decode index zero as the endpoint.
+        color_block_t result;
+        result.color0 = std::max(color0, color1);
+        result.color1 = std::min(color0, color1);
+
+        const auto c0 = unpackRgb565(result.color0);
+        const auto c1 = unpackRgb565(result.color1);
+        std::array<color_t, 4> palette = { c0, c1, c0, c1 };
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2.0f * c0[c] + c1[c]) / 3.0f;
+            palette[3][c] = (c0[c] + 2.0f * c1[c]) / 3.0f;
+        }
+
+        const auto paletteSize = (result.color0 == result.color1 ? 1 : 4);
+
+        std::array<uint32_t, 16> bestIndices;
+        std::array<float, 16> bestDistances;
+        size_t i = 0;
+
+#ifdef DAYBREAK_BLOCK_COMPRESSION_SSE2
+        // Find the closest palette entry of four pixels at a time. Ties keep the first entry like the loop below.
+        for (; i < 16; i += 4)
+        {
+            const __m128 channels[3] = { loadChannel(block, i, 0), loadChannel(block, i, 1), loadChannel(block, i, 2) };
+            auto bestDistance = colorDistance(palette[0], channels);
+            auto bestIndex = _mm_setzero_si128();
+
+            for (int p = 1; p < paletteSize; ++p)
+            {
+                keepCloser(bestDistance, bestIndex, colorDistance(palette[p], channels), p);
+            }
+
+            _mm_storeu_ps(&bestDistances[i], bestDistance);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(&bestIndices[i]), bestIndex);
+        }
+#endif
+
+        for (; i < 16; ++i)
+        {
+            bestIndices[i] = 0;
+            bestDistances[i] = colorDistance(palette[0], block[i]);
+
+            for (int p = 1; p < paletteSize; ++p)
+            {
+                const auto distance = colorDistance(palette[p], block[i]);
+
+                if (distance < bestDistances[i])
+                {
+                    bestIndices[i] = static_cast<uint32_t>(p);
+                    bestDistances[i] = distance;
+                }
+            }
+        }
+
+        for (i = 0; i < 16; ++i)
+        {
+            result.indices |= bestIndices[i] << (2 * i);
+            result.error += bestDistances[i];
+        }
+
+        return result;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    color_block_t refineColorBlock(const block_t& block, const color_block_t& previous)
+    {
+        // Find the endpoints that best fit the chosen indices with least squares, where each index is a fixed blend of
+        // the two endpoints.
+        const float Weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        color_t ax = { 0, 0, 0 }, bx = { 0, 0, 0 };
+
+        for (size_t i = 0; i < 16; ++i)
+        {
+            const auto a = Weights[(previous.indices >> (2 * i)) & 3];
+            const auto b = 1.0f - a;
+
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+                ax[c] += a * block[i][c];
+                bx[c] += b * block[i][c];
+            }
+        }
+
+        const auto determinant = aa * bb - ab * ab;
+
+        if (std::abs(determinant) < 1e-6f)
+        {
+            return previous;
+        }
+
+        color_t endpoint0, endpoint1;
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            endpoint0[c] = (bb * ax[c] - ab * bx[c]) / determinant;
+            endpoint1[c] = (aa * bx[c] - ab * ax[c]) / determinant;
+        }
+
+        auto refined = selectColorIndices(block, packRgb565(endpoint0), packRgb565(endpoint1));
+        return (refined.error < previous.error ? refined : previous);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    void encodeColorBlock(const block_t& block, unsigned char * out)
+    {
+        // Find the axis the colors vary the most along from their covariance, using power iteration.
+        color_t mean = { 0, 0, 0 };
+
+        for (const auto& pixel : block)
+        {
+            for (size_t c = 0; c < 3; ++c)
+            {
+                mean[c] += pixel[c] / 16.0f;
+            }
+        }
+
+        float covariance[3][3] = {};
+
+        for (const auto& pixel : block)
+        {
+            const color_t d = { pixel[0] - mean[0], pixel[1] - mean[1], pixel[2] - mean[2] };
+
+            for (size_t r = 0; r < 3; ++r)
+            {
+                for (size_t c = 0; c < 3; ++c)
+                {
+                    covariance[r][c] += d[r] * d[c];
+                }
+            }
+        }
+
+        // Start from the covariance row of the channel that varies the most, which is rarely far from the axis.
+        size_t startChannel = 0;
+
+        for (size_t c = 1; c < 3; ++c)
+        {
+            startChannel = (covariance[c][c] > covariance[startChannel][startChannel] ? c : startChannel);
+        }
+
+        color_t axis = { covariance[startChannel][0], covariance[startChannel][1], covariance[startChannel][2] };
+
+        if (covariance[startChannel][startChannel] < 1e-6f)
+        {
+            axis = { 1.0f, 1.0f, 1.0f };
+        }
+
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            color_t next = { 0, 0, 0 };
+
+            for (size_t r = 0; r < 3; ++r)
+            {
+                next[r] = covariance[r][0] * axis[0] + covariance[r][1] * axis[1] + covariance[r][2] * axis[2];
+            }
+
+            const auto length = std::max({ std::abs(next[0]), std::abs(next[1]), std::abs(next[2]) });
+
+            if (length < 1e-6f)
+            {
+                break;
+            }
+
+            axis = { next[0] / length, next[1] / length, next[2] / length };
+        }
+
+        // Use the ends of the colors along the axis as endpoints, inset slightly because the ends are rarely used.
+        const auto lengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+        float minProjection = 0.0f, maxProjection = 0.0f;
+
+        for (const auto& pixel : block)
+        {
+            const auto projection =
+                ((pixel[0] - mean[0]) * axis[0] + (pixel[1] - mean[1]) * axis[1] + (pixel[2] - mean[2]) * axis[2]) /
+                lengthSquared;
+
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+
+        const auto inset = (maxProjection - minProjection) / 16.0f;
+        color_t endpoint0, endpoint1;
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            endpoint0[c] = mean[c] + axis[c] * (maxProjection - inset);
+            endpoint1[c] = mean[c] + axis[c] * (minProjection + inset);
+        }
+
+        auto encoded = selectColorIndices(block, packRgb565(endpoint0), packRgb565(endpoint1));
+        encoded = refineColorBlock(block, encoded);
+
+        out[0] = static_cast<unsigned char>(encoded.color0 & 0xFF);
+        out[1] = static_cast<unsigned char>(encoded.color0 >> 8);
+        out[2] = static_cast<unsigned char>(encoded.color1 & 0xFF);
+        out[3] = static_cast<unsigned char>(encoded.color1 >> 8);
+
+        for (size_t b = 0; b < 4; ++b)
+        {
+            out[4 + b] = static_cast<unsigned char>((encoded.indices >> (8 * b)) & 0xFF);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    void encodeChannelBlock(const block_t& block, size_t channel, unsigned char * out)
+    {
+        unsigned char minValue = 255, maxValue = 0;
+
+        for (const auto& pixel : block)
+        {
+            minValue = std::min(minValue, pixel[channel]);
+            maxValue = std::max(maxValue, pixel[channel]);
+        }
+
+        // A larger first endpoint selects eight values evenly spaced between the endpoints.
+        out[0] = maxValue;
+        out[1] = minValue;
+        std::fill(out + 2, out + 8, static_cast<unsigned char>(0));
+
+        if (minValue == maxValue)
+        {
+            return;
+        }
+
+        float palette[8] = { static_cast<float>(maxValue), static_cast<float>(minValue) };
+
+        for (int i = 2; i < 8; ++i)
+        {
+            palette[i] = (static_cast<float>(8 - i) * maxValue + static_cast<float>(i - 1) * minValue) / 7.0f;
+        }
+
+        std::array<uint32_t, 16> bestIndices;
+        size_t i = 0;
+
+#ifdef DAYBREAK_BLOCK_COMPRESSION_SSE2
+        // Find the closest palette entry of four pixels at a time, taking the absolute value by clearing the sign bit.
+        const auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+        for (; i < 16; i += 4)
+        {
+            const auto values = loadChannel(block, i, channel);
+            auto bestDistance = _mm_and_ps(absMask, _mm_sub_ps(_mm_set1_ps(palette[0]), values));
+            auto bestIndex = _mm_setzero_si128();
+
+            for (int p = 1; p < 8; ++p)
+            {
+                const auto distance = _mm_and_ps(absMask, _mm_sub_ps(_mm_set1_ps(palette[p]), values));
+                keepCloser(bestDistance, bestIndex, distance, p);
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(&bestIndices[i]), bestIndex);
+        }
+#endif
+
+        for (; i < 16; ++i)
+        {
+            float bestDistance = std::abs(palette[0] - block[i][channel]);
+            bestIndices[i] = 0;
+
+            for (int p = 1; p < 8; ++p)
+            {
+                const auto distance = std::abs(palette[p] - block[i][channel]);
+
+                if (distance < bestDistance)
+                {
+                    bestIndices[i] = static_cast<uint32_t>(p);
+                    bestDistance = distance;
+                }
+            }
+        }
+
+        uint64_t indices = 0;
+
+        for (i = 0; i < 16; ++i)
+        {
+            indices |= static_cast<uint64_t>(bestIndices[i]) << (3 * i);
+        }
+
+        for (size_t b = 0; b < 6; ++b)
+        {
+            out[2 + b] = static_cast<unsigned char>((indices >> (8 * b)) & 0xFF);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    void flipColorBlock(unsigned char * block, size_t rowCount)
+    {
+        // Each row of the block has one byte of 2 bit indices after the two 16 bit endpoints.
+        std::reverse(block + 4, block + 4 + rowCount);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    void flipChannelBlock(unsigned char * block, size_t rowCount)
+    {
+        // Each row of the block has 12 bits of 3 bit indices after the two 8 bit endpoints.
+        uint64_t indices = 0;
+
+        for (size_t b = 0; b < 6; ++b)
+        {
+            indices |= static_cast<uint64_t>(block[2 + b]) << (8 * b);
+        }
+
+        std::array<uint64_t, 4> rows;
+
+        for (size_t r = 0; r < rows.size(); ++r)
+        {
+            rows[r] = (indices >> (12 * r)) & 0xFFF;
+        }
+
+        std::reverse(rows.begin(), rows.begin() + rowCount);
+        indices = rows[0] | (rows[1] << 12) | (rows[2] << 24) | (rows[3] << 36);
+
+        for (size_t b = 0; b < 6; ++b)
+        {
+            block[2 + b] = static_cast<unsigned char>((indices >> (8 * b)) & 0xFF);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool Daybreak::isBlockCompressed(TextureFormat format) noexcept
+{
+    return format == TextureFormat::BC1 ||
+        format == TextureFormat::BC3 ||
+        format == TextureFormat::BC4 ||
+        format == TextureFormat::BC5;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+size_t Daybreak::blockCompressedBlockSize(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::BC1:
+    case TextureFormat::BC4:
+        return 8;
+    case TextureFormat::BC3:
+    case TextureFormat::BC5:
+        return 16;
+    default:
+        THROW_ENUM_SWITCH_NOT_HANDLED(TextureFormat, format);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+size_t Daybreak::blockCompressedSize(TextureFormat format, size_t width, size_t height)
+{
+    return ((width + 3) / 4) * ((height + 3) / 4) * blockCompressedBlockSize(format);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+TextureFormat Daybreak::blockCompressionForChannels(size_t channelCount)
+{
+    switch (channelCount)
+    {
+    case 1:
+        return TextureFormat::BC4;
+    case 2:
+        return TextureFormat::BC5;
+    case 3:
+        return TextureFormat::BC1;
+    case 4:
+        return TextureFormat::BC3;
+    default:
+        THROW_ENUM_SWITCH_NOT_HANDLED(TextureFormat, channelCount);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<unsigned char> Daybreak::compressBlocks(
+    const unsigned char * pixels,
+    size_t width,
+    size_t height,
+    size_t channelCount,
+    TextureFormat format,
+    size_t maxWorkerCount)
+{
+    CHECK_NOT_NULL(pixels);
+    CHECK(width > 0 && height > 0 && channelCount > 0 && channelCount <= 4);
+
+    const auto blockSize = blockCompressedBlockSize(format);
+    const auto blocksWide = (width + 3) / 4;
+    const auto blocksHigh = (height + 3) / 4;
+    const auto isColor = (format == TextureFormat::BC1 || format == TextureFormat::BC3);
+
+    std::vector<unsigned char> blocks(blocksWide * blocksHigh * blockSize);
+
+    parallelFor(blocksHigh, maxWorkerCount, [&](size_t blockY) {
+        block_t block;
+
+        for (size_t blockX = 0; blockX < blocksWide; ++blockX)
+        {
+            auto * out = blocks.data() + (blockY * blocksWide + blockX) * blockSize;
+            readBlock(pixels, width, height, channelCount, blockX, blockY, isColor, block);
+
+            switch (format)
+            {
+            case TextureFormat::BC1:
+                encodeColorBlock(block, out);
+                break;
+            case TextureFormat::BC3:
+                encodeChannelBlock(block, 3, out);
+                encodeColorBlock(block, out + 8);
+                break;
+            case TextureFormat::BC4:
+                encodeChannelBlock(block, 0, out);
+                break;
+            case TextureFormat::BC5:
+                encodeChannelBlock(block, 0, out);
+                encodeChannelBlock(block, 1, out + 8);
+                break;
+            default:
+                THROW_ENUM_SWITCH_NOT_HANDLED(TextureFormat, format);
+            }
+        }
+    });
+
+    return blocks;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void Daybreak::flipBlocksVertically(unsigned char * blocks, size_t width, size_t height, TextureFormat format)
+{
+    CHECK_NOT_NULL(blocks);
+    CHECK(width > 0 && height > 0);
+
+    // Pixel rows only stay inside the same blocks when the image fits in one row of blocks or fills every block.
+    if (height > 4 && height % 4 != 0)
+    {
+        throw DaybreakDataException(
+            "Cannot flip a block compressed image whose height of " + std::to_string(height) +
+            " is not a multiple of four");
+    }
+
+    const auto blockSize = blockCompressedBlockSize(format);
+    const auto blocksWide = (width + 3) / 4;
+    const auto blocksHigh = (height + 3) / 4;
+    const auto rowSize = blocksWide * blockSize;
+    const auto rowCount = std::min<size_t>(height, 4);
+
+    for (size_t blockY = 0; blockY < blocksHigh / 2; ++blockY)
+    {
+        auto * row = blocks + blockY * rowSize;
+        std::swap_ranges(row, row + rowSize, blocks + (blocksHigh - 1 - blockY) * rowSize);
+    }
+
+    for (size_t i = 0; i < blocksWide * blocksHigh; ++i)
+    {
+        auto * block = blocks + i * blockSize;
+
+        switch (format)
+        {
+        case TextureFormat::BC1:
+            flipColorBlock(block, rowCount);
+            break;
+        case TextureFormat::BC3:
+            flipChannelBlock(block, rowCount);
+            flipColorBlock(block + 8, rowCount);
+            break;
+        case TextureFormat::BC4:
+            flipChannelBlock(block, rowCount);
+            break;
+        case TextureFormat::BC5:
+            flipChannelBlock(block, rowCount);
+            flipChannelBlock(block + 8, rowCount);
+            break;
+        default:
+            THROW_ENUM_SWITCH_NOT_HANDLED(TextureFormat, format);
+        }
+    }
+}
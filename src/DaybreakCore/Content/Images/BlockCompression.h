@@ -0,0 +1,47 @@
+#pragma once
+#include "Renderer/Texture.h"
+
+#include <vector>
+
+namespace Daybreak
+{
+    /** Check if a texture format is block compressed. */
+    bool isBlockCompressed(TextureFormat format) noexcept;
+
+    /** Get the number of bytes in each 4x4 block of a block compressed texture format. */
+    size_t blockCompressedBlockSize(TextureFormat format);
+
+    /** Get the number of bytes needed to store an image in a block compressed texture format. */
+    size_t blockCompressedSize(TextureFormat format, size_t width, size_t height);
+
+    /**
+     * Get the block compressed format that keeps every channel of an image with the given number of channels: BC4
+     * for one channel, BC5 for two, BC1 for three and BC3 for four.
+     */
+    TextureFormat blockCompressionForChannels(size_t channelCount);
+
+    /**
+     * Compress an image with byte channels into 4x4 blocks. BC1 and BC3 read the channels as RGB or RGBA, with one
+     * or two channel images read as grayscale, and BC1 drops alpha. BC4 compresses the first channel, and BC5 the
+     * first two. Pixels past the edge of the image repeat the edge pixels. Rows of blocks are compressed on up to
+     * maxWorkerCount threads.
+     */
+    std::vector<unsigned char> compressBlocks(
+        const unsigned char * pixels,               ///< Pixels of the image, stored row by row.
+        size_t width,                               ///< Width of the image in pixels.
+        size_t height,                              ///< Height of the image in pixels.
+        size_t channelCount,                        ///< Number of channels in each pixel.
+        TextureFormat format,                       ///< Block compressed format to compress into.
+        size_t maxWorkerCount);                     ///< Maximum number of threads to compress with.
+
+    /**
+     * Flip the rows of a block compressed image in place by reordering its blocks and the rows of indices inside them,
+     * which keeps every block exactly as it decodes. This throws DaybreakDataException when the height is larger than
+     * four and not a multiple of four, because the rows would no longer line up with the blocks.
+     */
+    void flipBlocksVertically(
+        unsigned char * blocks,                     ///< Compressed blocks of the image, stored row by row.
+        size_t width,                               ///< Width of the image in pixels.
+        size_t height,                              ///< Height of the image in pixels.
+        TextureFormat format);                      ///< Block compressed format of the image.
+}
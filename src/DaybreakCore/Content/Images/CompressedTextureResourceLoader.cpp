@@ -0,0 +1,450 @@
+#include "stdafx.h"
+#include "CompressedTextureResourceLoader.h"
+#include "Content\ResourcesManager.h"
+#include "Content\MappedFile.h"
+#include "Content\Images\BlockCompression.h"
+#include "Common/Error.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+using namespace Daybreak;
+
+const char * const CompressedTextureResourceLoader::DdsFileExtension = ".dds";
+const char * const CompressedTextureResourceLoader::Ktx2FileExtension = ".ktx2";
+
+namespace
+{
+    using compressed_mip_map_t = BlockCompressedImage::compressed_mip_map_t;
+
+    const size_t DdsHeaderSize = 128;                   ///< Magic number and DDS_HEADER.
+    const size_t DdsDx10HeaderSize = 20;                ///< DDS_HEADER_DXT10 that follows the header.
+    const uint32_t DdsMipMapCountFlag = 0x20000;
+    const uint32_t DdsFourCcFlag = 0x4;
+    const uint32_t DdsCubeMapFlag = 0x200;
+    const uint32_t DdsAllCubeMapFacesFlags = 0xFC00;
+    const uint32_t DdsVolumeFlag = 0x200000;
+    const uint32_t DdsDx10CubeMapFlag = 0x4;
+    const uint32_t DdsDx10Texture2d = 3;
+
+    const unsigned char Ktx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const size_t Ktx2HeaderSize = 80;                   ///< Identifier, header and index before the level index.
+    const size_t Ktx2LevelIndexSize = 24;               ///< Offset, length and uncompressed length of each level.
+
+    /** Blocks of a texture file and where each mipmap of each layer is stored. */
+    struct compressed_texture_t
+    {
+        TextureFormat format = TextureFormat::BC1;
+        size_t width = 0;
+        size_t height = 0;
+        size_t layerCount = 1;
+        size_t mipMapCount = 1;
+        std::vector<compressed_mip_map_t> mipMaps;      ///< Mipmaps of every layer, layer by layer.
+        bool isBottomFirst = false;                     ///< If the first row of every mipmap is the bottom row.
+    };
+
+    /** Reads little endian values from a mapped texture file, and throws if they are past the end of the file. */
+    class TextureFileReader
+    {
+    public:
+        TextureFileReader(const std::string& path, const MappedFile& file)
+            : m_path(path),
+              m_file(file)
+        {
+        }
+
+        const unsigned char * bytes(uint64_t offset, uint64_t size) const
+        {
+            if (offset > m_file.size() || size > m_file.size() - offset)
+            {
+                fail("Texture data is past the end of the file");
+            }
+
+            return m_file.data() + offset;
+        }
+
+        uint32_t readUint32(uint64_t offset) const
+        {
+            const auto * b = bytes(offset, 4);
+            return static_cast<uint32_t>(b[0] | (b[1] << 8) | (b[2] << 16)) | (static_cast<uint32_t>(b[3]) << 24);
+        }
+
+        uint64_t readUint64(uint64_t offset) const
+        {
+            return readUint32(offset) | (static_cast<uint64_t>(readUint32(offset + 4)) << 32);
+        }
+
+        size_t size() const noexcept { return m_file.size(); }
+
+        bool startsWith(const void * prefix, size_t prefixSize) const
+        {
+            return m_file.size() >= prefixSize && std::memcmp(m_file.data(), prefix, prefixSize) == 0;
+        }
+
+        [[noreturn]] void fail(const std::string& message) const
+        {
+            throw ContentReadException(m_path, "Image", message);
+        }
+
+    private:
+        const std::string& m_path;
+        const MappedFile& m_file;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    constexpr uint32_t fourCc(char a, char b, char c, char d) noexcept
+    {
+        return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+            (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    TextureFormat fromDxgiFormat(uint32_t dxgiFormat, const TextureFileReader& reader)
+    {
+        // The sRGB variants are read as their UNORM format, the same as images that are compressed when loaded.
+        switch (dxgiFormat)
+        {
+        case 70:                // DXGI_FORMAT_BC1_TYPELESS
+        case 71:                // DXGI_FORMAT_BC1_UNORM
+        case 72:                // DXGI_FORMAT_BC1_UNORM_SRGB
+            return TextureFormat::BC1;
+        case 76:                // DXGI_FORMAT_BC3_TYPELESS
+        case 77:                // DXGI_FORMAT_BC3_UNORM
+        case 78:                // DXGI_FORMAT_BC3_UNORM_SRGB
+            return TextureFormat::BC3;
+        case 79:                // DXGI_FORMAT_BC4_TYPELESS
+        case 80:                // DXGI_FORMAT_BC4_UNORM
+            return TextureFormat::BC4;
+        case 82:                // DXGI_FORMAT_BC5_TYPELESS
+        case 83:                // DXGI_FORMAT_BC5_UNORM
+            return TextureFormat::BC5;
+        default:
+            reader.fail("Unsupported DXGI format " + std::to_string(dxgiFormat));
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    TextureFormat fromVkFormat(uint32_t vkFormat, const TextureFileReader& reader)
+    {
+        switch (vkFormat)
+        {
+        case 131:               // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+        case 132:               // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+        case 133:               // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+        case 134:               // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+            return TextureFormat::BC1;
+        case 137:               // VK_FORMAT_BC3_UNORM_BLOCK
+        case 138:               // VK_FORMAT_BC3_SRGB_BLOCK
+            return TextureFormat::BC3;
+        case 139:               // VK_FORMAT_BC4_UNORM_BLOCK
+            return TextureFormat::BC4;
+        case 141:               // VK_FORMAT_BC5_UNORM_BLOCK
+            return TextureFormat::BC5;
+        default:
+            reader.fail("Unsupported Vulkan format " + std::to_string(vkFormat));
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    void checkSize(const compressed_texture_t& texture, const TextureFileReader& reader)
+    {
+        if (texture.width == 0 || texture.height == 0)
+        {
+            reader.fail("Texture does not have any pixels");
+        }
+
+        if (texture.mipMapCount > mipMapCount(texture.width, texture.height))
+        {
+            reader.fail("Texture has more mipmaps than its size allows");
+        }
+
+        // Every layer needs at least one block, which stops a bad layer count from allocating too much memory.
+        if (texture.layerCount > reader.size() / blockCompressedBlockSize(texture.format))
+        {
+            reader.fail("Texture has more layers than the file can hold");
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    compressed_texture_t readDds(const TextureFileReader& reader)
+    {
+        if (reader.readUint32(4) != DdsHeaderSize - 4)
+        {
+            reader.fail("DDS header has the wrong size");
+        }
+
+        compressed_texture_t texture;
+        texture.height = reader.readUint32(12);
+        texture.width = reader.readUint32(16);
+
+        const auto flags = reader.readUint32(8);
+        const auto pixelFormatFlags = reader.readUint32(80);
+        const auto caps2 = reader.readUint32(112);
+
+        if ((flags & DdsMipMapCountFlag) != 0)
+        {
+            texture.mipMapCount = std::max<size_t>(reader.readUint32(28), 1);
+        }
+
+        if ((caps2 & DdsVolumeFlag) != 0)
+        {
+            reader.fail("Volume textures are not supported");
+        }
+
+        if ((pixelFormatFlags & DdsFourCcFlag) == 0)
+        {
+            reader.fail("Only block compressed DDS textures are supported");
+        }
+
+        // Cube maps are read as six layers, one for each face.
+        auto dataOffset = DdsHeaderSize;
+
+        if ((caps2 & DdsCubeMapFlag) != 0)
+        {
+            if ((caps2 & DdsAllCubeMapFacesFlags) != DdsAllCubeMapFacesFlags)
+            {
+                reader.fail("Cube maps must have all six faces");
+            }
+
+            texture.layerCount = 6;
+        }
+
+        switch (reader.readUint32(84))
+        {
+        case fourCc('D', 'X', 'T', '1'):
+            texture.format = TextureFormat::BC1;
+            break;
+        case fourCc('D', 'X', 'T', '5'):
+            texture.format = TextureFormat::BC3;
+            break;
+        case fourCc('A', 'T', 'I', '1'):
+        case fourCc('B', 'C', '4', 'U'):
+            texture.format = TextureFormat::BC4;
+            break;
+        case fourCc('A', 'T', 'I', '2'):
+        case fourCc('B', 'C', '5', 'U'):
+            texture.format = TextureFormat::BC5;
+            break;
+        case fourCc('D', 'X', '1', '0'):
+        {
+            texture.format = fromDxgiFormat(reader.readUint32(DdsHeaderSize), reader);
+
+            if (reader.readUint32(DdsHeaderSize + 4) != DdsDx10Texture2d)
+            {
+                reader.fail("Only 2D DDS textures are supported");
+            }
+
+            const auto isCubeMap = (reader.readUint32(DdsHeaderSize + 8) & DdsDx10CubeMapFlag) != 0;
+            texture.layerCount = std::max<size_t>(reader.readUint32(DdsHeaderSize + 12), 1) * (isCubeMap ? 6 : 1);
+
+            dataOffset += DdsDx10HeaderSize;
+            break;
+        }
+        default:
+            reader.fail("Unsupported DDS pixel format");
+        }
+
+        checkSize(texture, reader);
+
+        // Every layer is stored with all of its mipmaps before the next layer.
+        for (size_t layer = 0; layer < texture.layerCount; ++layer)
+        {
+            for (size_t level = 0; level < texture.mipMapCount; ++level)
+            {
+                compressed_mip_map_t mipMap;
+                mipMap.size = blockCompressedSize(
+                    texture.format,
+                    std::max<size_t>(texture.width >> level, 1),
+                    std::max<size_t>(texture.height >> level, 1));
+                mipMap.blocks = reader.bytes(dataOffset, mipMap.size);
+
+                texture.mipMaps.push_back(mipMap);
+                dataOffset += mipMap.size;
+            }
+        }
+
+        return texture;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    bool isKtx2BottomFirst(const TextureFileReader& reader)
+    {
+        // Look for a KTXorientation key whose value starts with "ru", which means the rows go up from the first one.
+        const auto keyValueOffset = reader.readUint32(56);
+        const auto keyValueEnd = static_cast<uint64_t>(keyValueOffset) + reader.readUint32(60);
+        const std::string_view orientationKey("KTXorientation", 15);
+
+        for (auto offset = static_cast<uint64_t>(keyValueOffset); offset + 4 <= keyValueEnd;)
+        {
+            const auto length = reader.readUint32(offset);
+            const auto * keyValue = reinterpret_cast<const char *>(reader.bytes(offset + 4, length));
+            const std::string_view entry(keyValue, length);
+
+            if (entry.compare(0, orientationKey.size(), orientationKey) == 0)
+            {
+                return entry.compare(orientationKey.size(), 2, "ru") == 0;
+            }
+
+            // Every entry is padded to four bytes.
+            offset += 4 + ((static_cast<uint64_t>(length) + 3) & ~static_cast<uint64_t>(3));
+        }
+
+        return false;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    compressed_texture_t readKtx2(const TextureFileReader& reader)
+    {
+        if (reader.readUint32(28) != 0)
+        {
+            reader.fail("Volume textures are not supported");
+        }
+
+        if (reader.readUint32(44) != 0)
+        {
+            reader.fail("Supercompressed KTX2 textures are not supported");
+        }
+
+        const auto faceCount = reader.readUint32(36);
+
+        if (faceCount != 1 && faceCount != 6)
+        {
+            reader.fail("KTX2 textures must have one face or six cube map faces");
+        }
+
+        // Array layers and cube map faces are both read as layers, with the faces of each array layer together.
+        compressed_texture_t texture;
+        texture.format = fromVkFormat(reader.readUint32(12), reader);
+        texture.width = reader.readUint32(20);
+        texture.height = reader.readUint32(24);
+        texture.layerCount = std::max<size_t>(reader.readUint32(32), 1) * faceCount;
+        texture.mipMapCount = std::max<size_t>(reader.readUint32(40), 1);
+        texture.isBottomFirst = isKtx2BottomFirst(reader);
+
+        checkSize(texture, reader);
+
+        // Each level holds that mipmap of every layer, one after another.
+        texture.mipMaps.resize(texture.layerCount * texture.mipMapCount);
+
+        for (size_t level = 0; level < texture.mipMapCount; ++level)
+        {
+            const auto levelIndexOffset = Ktx2HeaderSize + level * Ktx2LevelIndexSize;
+            const auto levelOffset = reader.readUint64(levelIndexOffset);
+            const auto levelSize = reader.readUint64(levelIndexOffset + 8);
+            const auto mipMapSize = blockCompressedSize(
+                texture.format,
+                std::max<size_t>(texture.width >> level, 1),
+                std::max<size_t>(texture.height >> level, 1));
+
+            if (levelSize != static_cast<uint64_t>(mipMapSize) * texture.layerCount)
+            {
+                reader.fail("KTX2 level " + std::to_string(level) + " has the wrong size");
+            }
+
+            const auto * blocks = reader.bytes(levelOffset, levelSize);
+
+            for (size_t layer = 0; layer < texture.layerCount; ++layer)
+            {
+                auto& mipMap = texture.mipMaps[layer * texture.mipMapCount + level];
+                mipMap.blocks = blocks + layer * mipMapSize;
+                mipMap.size = mipMapSize;
+            }
+        }
+
+        return texture;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<Image> CompressedTextureResourceLoader::load(
+    const std::string& resourcePath,
+    ResourcesManager& resources)
+{
+    auto file = resources.mapFile(resourcePath);
+    TextureFileReader reader(resourcePath, *file);
+
+    // Pick the container from the identifier at the start of the file rather than trusting the file extension.
+    compressed_texture_t texture;
+
+    if (reader.startsWith("DDS ", 4))
+    {
+        texture = readDds(reader);
+    }
+    else if (reader.startsWith(Ktx2Identifier, sizeof(Ktx2Identifier)))
+    {
+        texture = readKtx2(reader);
+    }
+    else
+    {
+        reader.fail("Not a DDS or KTX2 texture");
+    }
+
+    // Materials only bind 2d textures, so the extra layers of texture arrays and cube maps would never be drawn.
+    if (texture.layerCount > 1)
+    {
+        reader.fail("Texture arrays and cube maps are not supported, only textures with a single layer");
+    }
+
+    // Textures already stored in the row order that was asked for point straight into the mapped file.
+    if (texture.isBottomFirst == m_flipVertically)
+    {
+        return BlockCompressedImage::FromBlocks(
+            resourcePath,
+            texture.width,
+            texture.height,
+            texture.format,
+            texture.layerCount,
+            std::move(texture.mipMaps),
+            std::move(file));
+    }
+
+    // Otherwise copy the blocks out of the file and flip them.
+    for (size_t level = 0; level < texture.mipMapCount; ++level)
+    {
+        const auto height = std::max<size_t>(texture.height >> level, 1);
+
+        if (height > 4 && height % 4 != 0)
+        {
+            reader.fail("Cannot flip a texture whose mipmap height of " + std::to_string(height) +
+                " is not a multiple of four, store it in the row order it is loaded with instead");
+        }
+    }
+
+    size_t totalSize = 0;
+
+    for (const auto& mipMap : texture.mipMaps)
+    {
+        totalSize += mipMap.size;
+    }
+
+    auto blocks = std::make_shared<std::vector<unsigned char>>(totalSize);
+    auto * flippedBlocks = blocks->data();
+
+    for (size_t i = 0; i < texture.mipMaps.size(); ++i)
+    {
+        const auto level = i % texture.mipMapCount;
+        auto& mipMap = texture.mipMaps[i];
+
+        std::copy(mipMap.blocks, mipMap.blocks + mipMap.size, flippedBlocks);
+        flipBlocksVertically(
+            flippedBlocks,
+            std::max<size_t>(texture.width >> level, 1),
+            std::max<size_t>(texture.height >> level, 1),
+            texture.format);
+
+        mipMap.blocks = flippedBlocks;
+        flippedBlocks += mipMap.size;
+    }
+
+    return BlockCompressedImage::FromBlocks(
+        resourcePath,
+        texture.width,
+        texture.height,
+        texture.format,
+        texture.layerCount,
+        std::move(texture.mipMaps),
+        std::move(blocks));
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "Content\IResourceLoader.h"
+#include "Content\Images\Image.h"
+
+#include <memory>
+#include <string>
+
+namespace Daybreak
+{
+    /**
+     * Loads textures that were block compressed ahead of time, with every mipmap, from DDS and KTX2 files. The file is
+     * mapped rather than read and the blocks are handed to the renderer as they are stored, without decoding or
+     * generating anything. Both BC1, BC3, BC4 and BC5 files and the DX10 DDS header are supported, while supercompressed
+     * KTX2 files, texture arrays, cube maps, volume textures and uncompressed pixel formats are not.
+     *
+     * Textures whose first row is the top row are flipped into the bottom first order OpenGL expects, which copies the
+     * blocks once. KTX2 files that are already stored bottom first (a KTXorientation of "ru") point straight into the
+     * mapped file. With flipping turned off the textures are kept top row first instead.
+     */
+    class CompressedTextureResourceLoader : public IResourceLoader<Image>
+    {
+    public:
+        /** File extension of DirectDraw surface textures. */
+        static const char * const DdsFileExtension;
+
+        /** File extension of Khronos texture 2.0 textures. */
+        static const char * const Ktx2FileExtension;
+
+    public:
+        virtual std::unique_ptr<Image> load(
+            const std::string& resourcePath,
+            ResourcesManager& resources) override;
+
+        /** Get if load stores textures with the bottom row first. On by default. */
+        bool flipVertically() const noexcept { return m_flipVertically; }
+
+        /** Set if load stores textures with the bottom row first, rather than the top row first. */
+        void setFlipVertically(bool shouldFlip) noexcept { m_flipVertically = shouldFlip; }
+
+    private:
+        bool m_flipVertically = true;
+    };
+}
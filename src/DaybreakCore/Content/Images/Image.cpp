@@ -1,26 +1,21 @@
 #include "stdafx.h"
 #include "Image.h"
 #include "Common/Error.h"
+#include "Content/MappedFile.h"
+#include "Content/Images/BlockCompression.h"
 
 #define STBI_NO_STDIO
 #include "stb\stb_image.h"
 
-#include <fstream>
 #include <vector>
 #include <string>
 #include <memory>
 #include <cassert>
 
-#include <mutex>
-
 using namespace Daybreak;
 
 namespace
 {
-    // stb_image error reporting is not thread safe so a global image lock is used to guard stb's image loading and
-    // error reporting code path.
-    std::mutex GImageLoadingMutex;
-
     //-----------------------------------------------------------------------------------------------------------------
     ImagePixelFormat FromStbChannelCount(int channelCount)
     {
@@ -38,36 +33,6 @@ namespace
             THROW_ENUM_SWITCH_NOT_HANDLED(ImagePixelFormat, channelCount);
         }
     }
-
-    //-----------------------------------------------------------------------------------------------------------------
-    std::unique_ptr<unsigned char[]> ReadBytesFromFile(const std::string& filePath, size_t * pFileSizeOut)
-    {
-        // Open binary file stream to given image and get the file size.
-        std::ifstream stream;
-
-        stream.exceptions(std::ifstream::failbit | std::ifstream::badbit);  // Enable exceptions on stream.
-        stream.open(filePath, std::ios::binary);
-
-        stream.seekg(0, std::ios::end);
-        auto size = stream.tellg();
-
-        stream.seekg(0, std::ios::beg);
-
-        // Read bytes from the stream.
-        std::unique_ptr<unsigned char[]> fileBytes(new unsigned char[static_cast<size_t>(size)]);
-
-        stream.read(reinterpret_cast<char *>(fileBytes.get()), size);       // TODO: Check cast.
-        stream.close();
-
-        // Write the file size if the caller passed a valid pointer.
-        if (pFileSizeOut != nullptr)
-        {
-            *pFileSizeOut = static_cast<size_t>(size);
-        }
-
-        // Return bytes read.
-        return fileBytes;
-    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -104,41 +69,48 @@ BytePerChannelImage::BytePerChannelImage(
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-std::unique_ptr<BytePerChannelImage> BytePerChannelImage::LoadFromFile(const std::string& imageFilePath)
+std::unique_ptr<BytePerChannelImage> BytePerChannelImage::LoadFromFile(
+    const std::string& imageFilePath,
+    bool flipVertically)
 {
-    // TODO: Do not do file loading here, instead take an IBuffer or IFileStream and let loading be handled by another
-    //       system.
-
-    // Read the file into memory.
-    size_t size = 0u;
-    auto fileBytes = ReadBytesFromFile(imageFilePath, &size);
+    // Map the file into memory and decode straight from the mapping rather than reading a copy of it.
+    MappedFile file(imageFilePath);
+    return LoadFromMemory(imageFilePath, file.data(), file.size(), flipVertically);
+}
 
-    // Use stb_image to load the image into memory. Note that stb_image's error reporting is not thread safe so access
-    // to image loading must be guarded. (Sadly).
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<BytePerChannelImage> BytePerChannelImage::LoadFromMemory(
+    const std::string& name,
+    const unsigned char * pFileBytes,
+    size_t fileSize,
+    bool flipVertically)
+{
+    // Use stb_image to load the image into memory. stb_image keeps its flip setting and error message per thread, so
+    // images can be decoded on many threads at once.
     int imageWidth = 0, imageHeight = 0, channelCount = 0;
     std::unique_ptr<unsigned char[], StbSupport::ImageDeleteFunctor> rawPixels;
     
+    stbi_set_flip_vertically_on_load_thread(flipVertically);
+
+    // Load the image into a raw pixel buffer.
+    rawPixels.reset(stbi_load_from_memory(
+        pFileBytes,
+        static_cast<int>(fileSize),
+        &imageWidth,
+        &imageHeight,
+        &channelCount,
+        0));
+
+    // Check for errors while loading. If there were any errors throw an exception rather than returning a null image.
+    if (rawPixels == nullptr)
     {
-        std::lock_guard<std::mutex> lock(GImageLoadingMutex);
-
-        // TODO: Make this a flag rather than always flip it for OpenGL.
-        stbi_set_flip_vertically_on_load(true);
-
-        // Load the image into a raw pixel buffer.
-        rawPixels.reset(stbi_load_from_memory(
-            fileBytes.get(),
-            static_cast<int>(size),
-            &imageWidth,
-            &imageHeight,
-            &channelCount,
-            0));
-
-        // Check for errors while loading. If there were any errors throw an exception rather than returning a null
-        // image.
-        if (rawPixels == nullptr)
-        {
-            throw ContentReadException(imageFilePath, "Image", stbi_failure_reason());
-        }
+        throw ContentReadException(name, "Image", stbi_failure_reason());
+    }
+
+    // stb_image decodes some truncated headers as an image without any pixels.
+    if (imageWidth <= 0 || imageHeight <= 0)
+    {
+        throw ContentReadException(name, "Image", "Image does not have any pixels");
     }
 
     assert(rawPixels != nullptr && "An exception should have be thrown if the image was not loaded");
@@ -146,12 +118,22 @@ std::unique_ptr<BytePerChannelImage> BytePerChannelImage::LoadFromFile(const std
     // Create and return new image.
     auto format = FromStbChannelCount(channelCount);
     return std::unique_ptr<BytePerChannelImage>(
-        new BytePerChannelImage(imageFilePath, imageWidth, imageHeight, format, std::move(rawPixels)));
+        new BytePerChannelImage(name, imageWidth, imageHeight, format, std::move(rawPixels)));
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 BytePerChannelImage::~BytePerChannelImage() = default;
 
+//---------------------------------------------------------------------------------------------------------------------
+void BytePerChannelImage::GenerateMipMaps(const mip_map_settings_t& settings)
+{
+    CHECK(IsValid());
+
+    // Pixel formats are numbered by their channel count.
+    m_mipMaps = generateMipMaps(m_pixels.get(), m_width, m_height, static_cast<size_t>(m_format), settings);
+    m_mipMapCount = m_mipMaps.size() + 1;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 HdrImage::HdrImage(
     const std::string& name,
@@ -170,41 +152,46 @@ HdrImage::HdrImage(
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-std::unique_ptr<HdrImage> HdrImage::LoadFromFile(const std::string& imageFilePath)
+std::unique_ptr<HdrImage> HdrImage::LoadFromFile(const std::string& imageFilePath, bool flipVertically)
 {
-    // TODO: Do not do file loading here, instead take an IBuffer or IFileStream and let loading be handled by another
-    //       system.
-
-    // Read the file into memory.
-    size_t size = 0u;
-    auto fileBytes = ReadBytesFromFile(imageFilePath, &size);
+    // Map the file into memory and decode straight from the mapping rather than reading a copy of it.
+    MappedFile file(imageFilePath);
+    return LoadFromMemory(imageFilePath, file.data(), file.size(), flipVertically);
+}
 
-    // Use stb_image to load the image into memory. Note that stb_image's error reporting is not thread safe so access
-    // to image loading must be guarded. (Sadly).
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<HdrImage> HdrImage::LoadFromMemory(
+    const std::string& name,
+    const unsigned char * pFileBytes,
+    size_t fileSize,
+    bool flipVertically)
+{
+    // Use stb_image to load the image into memory. stb_image keeps its flip setting and error message per thread, so
+    // images can be decoded on many threads at once.
     int imageWidth = 0, imageHeight = 0, channelCount = 0;
     std::unique_ptr<float[], StbSupport::ImageDeleteFunctor> rawPixels;
 
+    stbi_set_flip_vertically_on_load_thread(flipVertically);
+
+    // Load the image into a raw pixel buffer.
+    rawPixels.reset(stbi_loadf_from_memory(
+        pFileBytes,
+        static_cast<int>(fileSize),
+        &imageWidth,
+        &imageHeight,
+        &channelCount,
+        0));
+
+    // Check for errors while loading. If there were any errors throw an exception rather than returning a null image.
+    if (rawPixels == nullptr)
     {
-        std::lock_guard<std::mutex> lock(GImageLoadingMutex);
-
-        // TODO: Make this a flag rather than always flip it for OpenGL.
-        stbi_set_flip_vertically_on_load(true);
-
-        // Load the image into a raw pixel buffer.
-        rawPixels.reset(stbi_loadf_from_memory(
-            fileBytes.get(),
-            static_cast<int>(size),
-            &imageWidth,
-            &imageHeight,
-            &channelCount,
-            0));
-
-        // Check for errors while loading. If there were any errors throw an exception rather than returning a null
-        // image.
-        if (rawPixels == nullptr)
-        {
-            throw ContentReadException(imageFilePath, "Image", stbi_failure_reason());
-        }
+        throw ContentReadException(name, "Image", stbi_failure_reason());
+    }
+
+    // stb_image decodes some truncated headers as an image without any pixels.
+    if (imageWidth <= 0 || imageHeight <= 0)
+    {
+        throw ContentReadException(name, "Image", "Image does not have any pixels");
     }
 
     assert(rawPixels != nullptr && "An exception should have be thrown if the image was not loaded");
@@ -212,12 +199,151 @@ std::unique_ptr<HdrImage> HdrImage::LoadFromFile(const std::string& imageFilePat
     // Create and return new image.
     auto format = FromStbChannelCount(channelCount);
     return std::unique_ptr<HdrImage>(
-        new HdrImage(imageFilePath, imageWidth, imageHeight, format, std::move(rawPixels)));
+        new HdrImage(name, imageWidth, imageHeight, format, std::move(rawPixels)));
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 HdrImage::~HdrImage() = default;
 
+//---------------------------------------------------------------------------------------------------------------------
+void HdrImage::GenerateMipMaps(const mip_map_settings_t& settings)
+{
+    CHECK(IsValid());
+
+    // Pixel formats are numbered by their channel count.
+    m_mipMaps = generateMipMaps(m_pixels.get(), m_width, m_height, static_cast<size_t>(m_format), settings);
+    m_mipMapCount = m_mipMaps.size() + 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+BlockCompressedImage::BlockCompressedImage(
+    const std::string& name,
+    size_t imageWidth,
+    size_t imageHeight,
+    TextureFormat compressedFormat,
+    size_t layerCount,
+    std::vector<compressed_mip_map_t> mipMaps,
+    std::shared_ptr<const void> storage)
+    : Image(name, imageWidth, imageHeight, ImagePixelFormat::None),
+      m_compressedFormat(compressedFormat),
+      m_layerCount(layerCount),
+      m_mipMaps(std::move(mipMaps)),
+      m_storage(std::move(storage))
+{
+    // Every format has the channels left after decoding its blocks.
+    switch (compressedFormat)
+    {
+    case TextureFormat::BC1:
+        m_format = ImagePixelFormat::RGB;
+        break;
+    case TextureFormat::BC3:
+        m_format = ImagePixelFormat::RGBA;
+        break;
+    case TextureFormat::BC4:
+        m_format = ImagePixelFormat::Grayscale;
+        break;
+    case TextureFormat::BC5:
+        m_format = ImagePixelFormat::GrayscaleWithAlpha;
+        break;
+    default:
+        THROW_ENUM_SWITCH_NOT_HANDLED(TextureFormat, compressedFormat);
+    }
+
+    m_mipMapCount = m_mipMaps.size() / m_layerCount;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+BlockCompressedImage::~BlockCompressedImage() = default;
+
+//---------------------------------------------------------------------------------------------------------------------
+void BlockCompressedImage::GenerateMipMaps(const mip_map_settings_t&)
+{
+    throw DaybreakEngineException(
+        "Cannot generate mipmaps of a block compressed image",
+        "Generate the mipmaps of " + m_name + " before compressing it");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<BlockCompressedImage> BlockCompressedImage::Compress(
+    const Image& image,
+    TextureFormat compressedFormat,
+    size_t maxWorkerCount)
+{
+    CHECK(image.IsValid());
+
+    if (dynamic_cast<const BytePerChannelImage *>(&image) == nullptr)
+    {
+        throw DaybreakEngineException(
+            "Only images with byte channels can be block compressed",
+            image.Name() + " is not a byte per channel image");
+    }
+
+    // The compressed mipmaps live in one shared buffer that the image points into.
+    auto blocks = std::make_shared<std::vector<std::vector<unsigned char>>>(image.MipMapCount());
+    std::vector<compressed_mip_map_t> mipMaps(blocks->size());
+
+    for (size_t level = 0; level < mipMaps.size(); ++level)
+    {
+        auto& levelBlocks = (*blocks)[level];
+
+        levelBlocks = compressBlocks(
+            image.RawPixels(static_cast<unsigned int>(level)),
+            image.MipMapWidth(level),
+            image.MipMapHeight(level),
+            static_cast<size_t>(image.Format()),
+            compressedFormat,
+            maxWorkerCount);
+
+        mipMaps[level].blocks = levelBlocks.data();
+        mipMaps[level].size = levelBlocks.size();
+    }
+
+    return std::unique_ptr<BlockCompressedImage>(new BlockCompressedImage(
+        image.Name(),
+        image.Width(),
+        image.Height(),
+        compressedFormat,
+        1,
+        std::move(mipMaps),
+        std::move(blocks)));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<BlockCompressedImage> BlockCompressedImage::FromBlocks(
+    const std::string& name,
+    size_t imageWidth,
+    size_t imageHeight,
+    TextureFormat compressedFormat,
+    size_t layerCount,
+    std::vector<compressed_mip_map_t> mipMaps,
+    std::shared_ptr<const void> storage)
+{
+    CHECK(imageWidth > 0 && imageHeight > 0 && layerCount > 0);
+    CHECK(!mipMaps.empty() && mipMaps.size() % layerCount == 0);
+    CHECK_NOT_NULL(storage);
+
+    const auto levelCount = mipMaps.size() / layerCount;
+
+    for (size_t i = 0; i < mipMaps.size(); ++i)
+    {
+        const auto level = i % levelCount;
+        const auto width = std::max<size_t>(imageWidth >> level, 1);
+        const auto height = std::max<size_t>(imageHeight >> level, 1);
+
+        CHECK_NOT_NULL(mipMaps[i].blocks);
+        CHECK(mipMaps[i].size == blockCompressedSize(compressedFormat, width, height));
+    }
+
+    return std::unique_ptr<BlockCompressedImage>(new BlockCompressedImage(
+        name,
+        imageWidth,
+        imageHeight,
+        compressedFormat,
+        layerCount,
+        std::move(mipMaps),
+        std::move(storage)));
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 void StbSupport::ImageDeleteFunctor::operator()(unsigned char * pData) const
 {
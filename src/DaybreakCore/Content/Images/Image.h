@@ -1,7 +1,11 @@
 #pragma once
+#include "Content/Images/MipMapGenerator.h"
+#include "Renderer/Texture.h"
 
+#include <algorithm>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace StbSupport
 {
@@ -47,7 +51,19 @@ namespace Daybreak
         virtual bool IsValid() const noexcept = 0;
 
         /** Get the number of mipmaps contained in this image. A value one is just the image at normal size. */
-        size_t MipMapCount() const noexcept { return 1; }
+        size_t MipMapCount() const noexcept { return m_mipMapCount; }
+
+        /** Get the width of a mipmap in pixels. */
+        size_t MipMapWidth(size_t mipMapIndex) const noexcept { return std::max<size_t>(m_width >> mipMapIndex, 1); }
+
+        /** Get the height of a mipmap in pixels. */
+        size_t MipMapHeight(size_t mipMapIndex) const noexcept { return std::max<size_t>(m_height >> mipMapIndex, 1); }
+
+        /**
+         * Generate every mipmap of the image down to one pixel on the CPU, replacing any mipmaps it already has. Only
+         * byte images can be sRGB encoded.
+         */
+        virtual void GenerateMipMaps(const mip_map_settings_t& settings) = 0;
 
         /** Get width of image in pixels. This returns zero if there is no valid image data. */
         size_t Width() const noexcept { return m_width; }
@@ -61,11 +77,17 @@ namespace Daybreak
         /** Get read-only non-owned pointer to the raw pixel data. */
         virtual const unsigned char* RawPixels(unsigned int mipMapIndex = 0) const noexcept = 0;
 
+        /** Check if the pixels are stored in 4x4 blocks by a BlockCompressedImage rather than one at a time. */
+        virtual bool IsBlockCompressed() const noexcept { return false; }
+
     public:
         std::string m_name;
         size_t m_width;
         size_t m_height;
         ImagePixelFormat m_format;
+
+    protected:
+        size_t m_mipMapCount = 1;
     };
 
     /**
@@ -93,16 +115,29 @@ namespace Daybreak
         /** Get read-only non-owned pointer to the raw pixel data. */
         virtual const unsigned char* RawPixels(unsigned int mipMapIndex = 0) const noexcept override
         {
-            return m_pixels.get();
+            return (mipMapIndex == 0 ? m_pixels.get() : m_mipMaps[mipMapIndex - 1].pixels.data());
         }
 
-        // Load an image from file.
-        // TODO: Do not do file loading here, instead take an IBuffer or IFileStream and let loading be handled by another
-        //       system.
-        static std::unique_ptr<BytePerChannelImage> LoadFromFile(const std::string& imageFilePath);
+        /** Generate every mipmap of the image down to one pixel on the CPU. */
+        virtual void GenerateMipMaps(const mip_map_settings_t& settings) override;
+
+        // Load an image from file. Images are flipped so the first row is the bottom row by default, which is the
+        // order OpenGL expects. Images can be loaded on many threads at once.
+        static std::unique_ptr<BytePerChannelImage> LoadFromFile(
+            const std::string& imageFilePath,
+            bool flipVertically = true);
+
+        // Decode an image from an encoded file (PNG, JPG, etc) that is already in memory. The name is used for error
+        // reporting and the image name.
+        static std::unique_ptr<BytePerChannelImage> LoadFromMemory(
+            const std::string& name,
+            const unsigned char * pFileBytes,
+            size_t fileSize,
+            bool flipVertically = true);
 
     private:
         std::unique_ptr<unsigned char[], StbSupport::ImageDeleteFunctor> m_pixels;
+        std::vector<mip_map_t<unsigned char>> m_mipMaps;
     };
 
     /**
@@ -130,21 +165,118 @@ namespace Daybreak
         /** Get read-only non-owned pointer to the raw pixel data. */
         virtual const unsigned char* RawPixels(unsigned int mipMapIndex = 0) const noexcept override
         {
-            return reinterpret_cast<const unsigned char *>(m_pixels.get());
+            return reinterpret_cast<const unsigned char *>(RawPixelsAsFloatBuffer(mipMapIndex));
         }
 
         /** Get read-only non-owned pointer to the raw pixel data. */
         const float * RawPixelsAsFloatBuffer(unsigned int mipMapIndex = 0) const noexcept
         {
-            return m_pixels.get();
+            return (mipMapIndex == 0 ? m_pixels.get() : m_mipMaps[mipMapIndex - 1].pixels.data());
         }
 
-        // Load an image from file.
-        // TODO: Do not do file loading here, instead take an IBuffer or IFileStream and let loading be handled by another
-        //       system.
-        static std::unique_ptr<HdrImage> LoadFromFile(const std::string& imageFilePath);
+        /** Generate every mipmap of the image down to one pixel on the CPU. HDR images are never sRGB encoded. */
+        virtual void GenerateMipMaps(const mip_map_settings_t& settings) override;
+
+        // Load an image from file. Images are flipped so the first row is the bottom row by default, which is the
+        // order OpenGL expects. Images can be loaded on many threads at once.
+        static std::unique_ptr<HdrImage> LoadFromFile(const std::string& imageFilePath, bool flipVertically = true);
+
+        // Decode an image from an encoded file that is already in memory. The name is used for error reporting and the
+        // image name.
+        static std::unique_ptr<HdrImage> LoadFromMemory(
+            const std::string& name,
+            const unsigned char * pFileBytes,
+            size_t fileSize,
+            bool flipVertically = true);
 
     private:
         std::unique_ptr<float[], StbSupport::ImageDeleteFunctor> m_pixels;
+        std::vector<mip_map_t<float>> m_mipMaps;
+    };
+
+    /**
+     * Image whose pixels are compressed into 4x4 blocks that the GPU decodes when sampling, which uses four to eight
+     * times less memory than uncompressed pixels. Format() is the format of the pixels after decoding.
+     *
+     * The blocks can be stored anywhere, such as inside a memory mapped texture file, as long as the image shares
+     * ownership of the storage. An image can also hold several layers of the same size, each with every mipmap.
+     */
+    class BlockCompressedImage : public Image
+    {
+    public:
+        /** Location of the compressed blocks of one mipmap of one layer. */
+        struct compressed_mip_map_t
+        {
+            const unsigned char * blocks = nullptr;
+            size_t size = 0;
+        };
+
+    protected:
+        /** Constructor. */
+        BlockCompressedImage(
+            const std::string& name,
+            size_t imageWidth,
+            size_t imageHeight,
+            TextureFormat compressedFormat,
+            size_t layerCount,
+            std::vector<compressed_mip_map_t> mipMaps,
+            std::shared_ptr<const void> storage);
+
+    public:
+        /** Destructor. */
+        ~BlockCompressedImage();
+
+        /** Check if the image is valid. A valid image has pixel data and non-zero attributes. */
+        virtual bool IsValid() const noexcept override { return !m_mipMaps.empty(); }
+
+        /** Get read-only non-owned pointer to the compressed blocks of a mipmap of the first layer. */
+        virtual const unsigned char* RawPixels(unsigned int mipMapIndex = 0) const noexcept override
+        {
+            return m_mipMaps[mipMapIndex].blocks;
+        }
+
+        /** Get read-only non-owned pointer to the compressed blocks of a mipmap of any layer. */
+        const unsigned char* LayerPixels(size_t layer, unsigned int mipMapIndex = 0) const noexcept
+        {
+            return m_mipMaps[layer * m_mipMapCount + mipMapIndex].blocks;
+        }
+
+        /** Get the size of the compressed blocks of a mipmap in bytes, which is the same in every layer. */
+        size_t RawPixelsSize(unsigned int mipMapIndex = 0) const noexcept { return m_mipMaps[mipMapIndex].size; }
+
+        /** Get the number of layers in the image, such as the layers of a texture array or the faces of a cube map. */
+        size_t LayerCount() const noexcept { return m_layerCount; }
+
+        /** Check if the pixels are stored in 4x4 blocks. */
+        virtual bool IsBlockCompressed() const noexcept override { return true; }
+
+        /** Get the block compressed texture format of the pixels. */
+        TextureFormat CompressedFormat() const noexcept { return m_compressedFormat; }
+
+        /** Block compressed images cannot generate mipmaps, so generate them before compressing the image. */
+        virtual void GenerateMipMaps(const mip_map_settings_t& settings) override;
+
+        // Compress an image with byte channels and all of its mipmaps, using up to maxWorkerCount threads.
+        static std::unique_ptr<BlockCompressedImage> Compress(
+            const Image& image,
+            TextureFormat compressedFormat,
+            size_t maxWorkerCount = 1);
+
+        // Create an image from blocks that were compressed ahead of time without copying them. The mipmaps are given
+        // layer by layer, each layer with the same number of mipmaps, and storage keeps the blocks alive.
+        static std::unique_ptr<BlockCompressedImage> FromBlocks(
+            const std::string& name,
+            size_t imageWidth,
+            size_t imageHeight,
+            TextureFormat compressedFormat,
+            size_t layerCount,
+            std::vector<compressed_mip_map_t> mipMaps,
+            std::shared_ptr<const void> storage);
+
+    private:
+        TextureFormat m_compressedFormat;
+        size_t m_layerCount;
+        std::vector<compressed_mip_map_t> m_mipMaps;
+        std::shared_ptr<const void> m_storage;
     };
 }
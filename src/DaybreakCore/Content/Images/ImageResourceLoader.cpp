@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "ImageResourceLoader.h"
 #include "Content\ResourcesManager.h"
+#include "Content\MappedFile.h"
 #include "Content\Images\Image.h"
 
 using namespace Daybreak;
@@ -10,11 +11,13 @@ std::unique_ptr<Image> ImageResourceLoader::load(
     const std::string& resourcePath,
     ResourcesManager& resources)
 {
-    // TODO: Do not hard code the content directory here. Instead use the resource manager to load a binary blob
-    //       (which will add the content directory) and pass the buffer (instead of a file path) to the stb image
-    //       loader.
-    auto finalResourcePath = "content\\" + resourcePath;
+    // Decode straight from the mapped file rather than reading a copy of it into memory first.
+    auto file = resources.mapFile(resourcePath);
 
-    std::unique_ptr<Image> image(BytePerChannelImage::LoadFromFile(finalResourcePath));
+    std::unique_ptr<Image> image(BytePerChannelImage::LoadFromMemory(
+        resourcePath,
+        file->data(),
+        file->size(),
+        m_flipVertically));
     return std::move(image);
 }
@@ -10,5 +10,14 @@ namespace Daybreak
         virtual std::unique_ptr<Image> load(
             const std::string& resourcePath,
             ResourcesManager& resources) override;
+
+        /** Get if load flips images so the first row is the bottom row. On by default. */
+        bool flipVertically() const noexcept { return m_flipVertically; }
+
+        /** Set if load flips images so the first row is the bottom row. */
+        void setFlipVertically(bool shouldFlip) noexcept { m_flipVertically = shouldFlip; }
+
+    private:
+        bool m_flipVertically = true;
     };
 }
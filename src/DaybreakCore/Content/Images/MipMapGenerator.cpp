@@ -0,0 +1,362 @@
+#include "stdafx.h"
+#include "MipMapGenerator.h"
+#include "Common/Error.h"
+#include "Utility/ParallelFor.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#   define DAYBREAK_MIP_MAP_SSE2
+#   include <emmintrin.h>
+#endif
+
+using namespace Daybreak;
+
+namespace
+{
+    const float Pi = 3.14159265358979f;
+
+    /** Sources and weights of every destination pixel along one axis, with a fixed number of taps per pixel. */
+    struct axis_filter_t
+    {
+        size_t tapCount = 0;
+        std::vector<size_t> sources;            ///< Clamped source pixel index of every tap.
+        std::vector<float> weights;             ///< Normalised weight of every tap.
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    float sinc(float x)
+    {
+        return (x == 0.0f ? 1.0f : std::sin(Pi * x) / (Pi * x));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    float besselI0(float x)
+    {
+        // Power series of the zeroth order modified Bessel function of the first kind, which converges quickly for
+        // the small values the Kaiser window uses.
+        float sum = 1.0f;
+        float term = 1.0f;
+
+        for (int k = 1; k < 32 && term > sum * 1e-8f; ++k)
+        {
+            term *= (x * x) / (4.0f * static_cast<float>(k * k));
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    float filterRadius(MipMapFilter filter)
+    {
+        switch (filter)
+        {
+        case MipMapFilter::Box:
+            return 0.5f;
+        case MipMapFilter::Kaiser:
+        case MipMapFilter::Lanczos:
+            return 3.0f;
+        default:
+            THROW_ENUM_SWITCH_NOT_HANDLED(MipMapFilter, filter);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    float evaluateFilter(MipMapFilter filter, float x)
+    {
+        const float radius = filterRadius(filter);
+        x = std::abs(x);
+
+        if (x > radius)
+        {
+            return 0.0f;
+        }
+
+        switch (filter)
+        {
+        case MipMapFilter::Box:
+            return 1.0f;
+        case MipMapFilter::Kaiser:
+        {
+            const float Alpha = 4.0f;
+            const float t = x / radius;
+
+            return sinc(x) * besselI0(Alpha * std::sqrt(1.0f - t * t)) / besselI0(Alpha);
+        }
+        case MipMapFilter::Lanczos:
+            return sinc(x) * sinc(x / radius);
+        default:
+            THROW_ENUM_SWITCH_NOT_HANDLED(MipMapFilter, filter);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    axis_filter_t createAxisFilter(size_t sourceSize, size_t destinationSize, MipMapFilter filter)
+    {
+        // The filter is stretched by the scale so it covers the same part of the image as one destination pixel.
+        const float scale = static_cast<float>(sourceSize) / static_cast<float>(destinationSize);
+        const float support = filterRadius(filter) * scale;
+
+        axis_filter_t axis;
+        axis.tapCount = static_cast<size_t>(std::ceil(2.0f * support)) + 1;
+        axis.sources.resize(destinationSize * axis.tapCount);
+        axis.weights.resize(destinationSize * axis.tapCount);
+
+        for (size_t i = 0; i < destinationSize; ++i)
+        {
+            const float center = (static_cast<float>(i) + 0.5f) * scale;
+            const auto first = static_cast<int64_t>(std::floor(center - support));
+            float weightSum = 0.0f;
+
+            for (size_t t = 0; t < axis.tapCount; ++t)
+            {
+                const auto source = first + static_cast<int64_t>(t);
+                const float weight = evaluateFilter(filter, (static_cast<float>(source) + 0.5f - center) / scale);
+                const auto clamped = std::min(std::max<int64_t>(source, 0), static_cast<int64_t>(sourceSize) - 1);
+
+                axis.sources[i * axis.tapCount + t] = static_cast<size_t>(clamped);
+                axis.weights[i * axis.tapCount + t] = weight;
+                weightSum += weight;
+            }
+
+            for (size_t t = 0; t < axis.tapCount; ++t)
+            {
+                axis.weights[i * axis.tapCount + t] /= weightSum;
+            }
+        }
+
+        return axis;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    void addScaledRow(float * destination, const float * source, float weight, size_t count)
+    {
+        size_t i = 0;
+
+#ifdef DAYBREAK_MIP_MAP_SSE2
+        const auto w = _mm_set1_ps(weight);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            const auto sum = _mm_add_ps(_mm_loadu_ps(destination + i), _mm_mul_ps(w, _mm_loadu_ps(source + i)));
+            _mm_storeu_ps(destination + i, sum);
+        }
+#endif
+
+        for (; i < count; ++i)
+        {
+            destination[i] += weight * source[i];
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    void filterRow(
+        float * destination,
+        const float * source,
+        const axis_filter_t& axis,
+        size_t destinationWidth,
+        size_t channelCount)
+    {
+        for (size_t x = 0; x < destinationWidth; ++x)
+        {
+            const auto * sources = &axis.sources[x * axis.tapCount];
+            const auto * weights = &axis.weights[x * axis.tapCount];
+            auto * pixel = destination + x * channelCount;
+
+#ifdef DAYBREAK_MIP_MAP_SSE2
+            if (channelCount == 4)
+            {
+                auto sum = _mm_setzero_ps();
+
+                for (size_t t = 0; t < axis.tapCount; ++t)
+                {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[t]), _mm_loadu_ps(source + sources[t] * 4)));
+                }
+
+                _mm_storeu_ps(pixel, sum);
+                continue;
+            }
+#endif
+
+            std::fill(pixel, pixel + channelCount, 0.0f);
+
+            for (size_t t = 0; t < axis.tapCount; ++t)
+            {
+                const auto * sourcePixel = source + sources[t] * channelCount;
+
+                for (size_t c = 0; c < channelCount; ++c)
+                {
+                    pixel[c] += weights[t] * sourcePixel[c];
+                }
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    mip_map_t<float> downsample(
+        const float * pixels,
+        size_t width,
+        size_t height,
+        size_t channelCount,
+        const mip_map_settings_t& settings)
+    {
+        mip_map_t<float> mipMap;
+        mipMap.width = std::max<size_t>(width / 2, 1);
+        mipMap.height = std::max<size_t>(height / 2, 1);
+        mipMap.pixels.resize(mipMap.width * mipMap.height * channelCount);
+
+        const auto horizontal = createAxisFilter(width, mipMap.width, settings.filter);
+        const auto vertical = createAxisFilter(height, mipMap.height, settings.filter);
+        const auto sourceRowSize = width * channelCount;
+
+        // Filter vertically first, which adds whole rows together and halves the rows the horizontal pass filters.
+        parallelFor(mipMap.height, settings.maxWorkerCount, [&](size_t y) {
+            std::vector<float> row(sourceRowSize, 0.0f);
+
+            for (size_t t = 0; t < vertical.tapCount; ++t)
+            {
+                const auto sourceRow = pixels + vertical.sources[y * vertical.tapCount + t] * sourceRowSize;
+                addScaledRow(row.data(), sourceRow, vertical.weights[y * vertical.tapCount + t], sourceRowSize);
+            }
+
+            auto destinationRow = mipMap.pixels.data() + y * mipMap.width * channelCount;
+            filterRow(destinationRow, row.data(), horizontal, mipMap.width, channelCount);
+        });
+
+        return mipMap;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    bool isAlphaChannel(size_t channel, size_t channelCount) noexcept
+    {
+        return (channelCount == 2 || channelCount == 4) && channel == channelCount - 1;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+size_t Daybreak::mipMapCount(size_t width, size_t height) noexcept
+{
+    size_t count = 1;
+
+    for (auto size = std::max(width, height); size > 1; size /= 2)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<mip_map_t<float>> Daybreak::generateMipMaps(
+    const float * pixels,
+    size_t width,
+    size_t height,
+    size_t channelCount,
+    const mip_map_settings_t& settings)
+{
+    CHECK_NOT_NULL(pixels);
+    CHECK(width > 0 && height > 0 && channelCount > 0);
+
+    std::vector<mip_map_t<float>> mipMaps;
+    mipMaps.reserve(mipMapCount(width, height) - 1);
+
+    // Filter each mip map from the one above it, which needs far fewer taps than filtering from the full size image.
+    while (width > 1 || height > 1)
+    {
+        mipMaps.push_back(downsample(pixels, width, height, channelCount, settings));
+
+        pixels = mipMaps.back().pixels.data();
+        width = mipMaps.back().width;
+        height = mipMaps.back().height;
+    }
+
+    return mipMaps;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<mip_map_t<unsigned char>> Daybreak::generateMipMaps(
+    const unsigned char * pixels,
+    size_t width,
+    size_t height,
+    size_t channelCount,
+    const mip_map_settings_t& settings)
+{
+    CHECK_NOT_NULL(pixels);
+
+    std::vector<float> linearPixels(width * height * channelCount);
+
+    for (size_t i = 0; i < linearPixels.size(); ++i)
+    {
+        const auto isSrgb = settings.isSrgb && !isAlphaChannel(i % channelCount, channelCount);
+        linearPixels[i] = (isSrgb ? srgbToLinear(pixels[i]) : static_cast<float>(pixels[i]) / 255.0f);
+    }
+
+    auto linearMipMaps = generateMipMaps(linearPixels.data(), width, height, channelCount, settings);
+
+    std::vector<mip_map_t<unsigned char>> mipMaps(linearMipMaps.size());
+
+    for (size_t level = 0; level < linearMipMaps.size(); ++level)
+    {
+        const auto& source = linearMipMaps[level];
+        auto& mipMap = mipMaps[level];
+
+        mipMap.width = source.width;
+        mipMap.height = source.height;
+        mipMap.pixels.resize(source.pixels.size());
+
+        for (size_t i = 0; i < source.pixels.size(); ++i)
+        {
+            const auto value = std::min(std::max(source.pixels[i], 0.0f), 1.0f);
+            const auto isSrgb = settings.isSrgb && !isAlphaChannel(i % channelCount, channelCount);
+
+            mipMap.pixels[i] = (isSrgb ? linearToSrgb(value) : static_cast<unsigned char>(value * 255.0f + 0.5f));
+        }
+    }
+
+    return mipMaps;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+float Daybreak::srgbToLinear(unsigned char value) noexcept
+{
+    static const auto Table = []() {
+        std::array<float, 256> table;
+
+        for (size_t i = 0; i < table.size(); ++i)
+        {
+            const float c = static_cast<float>(i) / 255.0f;
+            table[i] = (c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f));
+        }
+
+        return table;
+    }();
+
+    return Table[value];
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+unsigned char Daybreak::linearToSrgb(float value) noexcept
+{
+    // Look up a table with 16 bits of linear precision rather than calling pow for every channel. This is precise
+    // enough that every sRGB byte converts to linear and back to itself.
+    static const auto Table = []() {
+        std::vector<unsigned char> table(65536);
+
+        for (size_t i = 0; i < table.size(); ++i)
+        {
+            const float c = static_cast<float>(i) / 65535.0f;
+            const float s = (c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f);
+
+            table[i] = static_cast<unsigned char>(std::min(std::max(s, 0.0f), 1.0f) * 255.0f + 0.5f);
+        }
+
+        return table;
+    }();
+
+    value = std::min(std::max(value, 0.0f), 1.0f);
+    return Table[static_cast<size_t>(value * 65535.0f + 0.5f)];
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+
+namespace Daybreak
+{
+    /** Filter used to shrink a mip map into the next smaller mip map. */
+    enum class MipMapFilter
+    {
+        Box,                            ///< Average of every 2x2 block of pixels. Fastest, but blurry and aliased.
+        Kaiser,                         ///< Kaiser windowed sinc. Sharp with very little ringing.
+        Lanczos                         ///< Lanczos windowed sinc with three lobes. Sharpest, but rings more.
+    };
+
+    /** Settings for generating the mip maps of an image. */
+    struct mip_map_settings_t
+    {
+        MipMapFilter filter = MipMapFilter::Kaiser;
+        bool isSrgb = false;            ///< Byte color channels are sRGB encoded and are filtered as linear values.
+        size_t maxWorkerCount = 1;      ///< Maximum number of threads that filter the rows of each mip map.
+    };
+
+    /** Size and pixels of a single mip map. Pixels are stored row by row, with every channel of a pixel together. */
+    template<typename TChannel>
+    struct mip_map_t
+    {
+        size_t width = 0;
+        size_t height = 0;
+        std::vector<TChannel> pixels;
+    };
+
+    /** Get the number of mip maps of an image including the image itself, down to a size of one by one pixel. */
+    size_t mipMapCount(size_t width, size_t height) noexcept;
+
+    /**
+     * Generate every mip map smaller than an image with float channels. Each mip map is half the size of the one
+     * above it rounded down, and is filtered from it in two separable passes with the edges of the image clamped.
+     */
+    std::vector<mip_map_t<float>> generateMipMaps(
+        const float * pixels,                       ///< Pixels of the full size image.
+        size_t width,                               ///< Width of the image in pixels.
+        size_t height,                              ///< Height of the image in pixels.
+        size_t channelCount,                        ///< Number of channels in each pixel.
+        const mip_map_settings_t& settings);        ///< Filter settings.
+
+    /**
+     * Generate every mip map smaller than an image with byte channels. Pixels with two or four channels have alpha
+     * in the last channel, which is never sRGB encoded. Channels are filtered as floats and are only rounded to bytes
+     * once, so errors do not build up from one mip map to the next.
+     */
+    std::vector<mip_map_t<unsigned char>> generateMipMaps(
+        const unsigned char * pixels,               ///< Pixels of the full size image.
+        size_t width,                               ///< Width of the image in pixels.
+        size_t height,                              ///< Height of the image in pixels.
+        size_t channelCount,                        ///< Number of channels in each pixel.
+        const mip_map_settings_t& settings);        ///< Filter settings.
+
+    /** Convert an sRGB encoded byte into a linear value between zero and one. */
+    float srgbToLinear(unsigned char value) noexcept;
+
+    /** Convert a linear value into an sRGB encoded byte, clamping it between zero and one first. */
+    unsigned char linearToSrgb(float value) noexcept;
+}
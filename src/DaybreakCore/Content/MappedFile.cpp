@@ -0,0 +1,120 @@
+#include "stdafx.h"
+#include "MappedFile.h"
+#include "Common/Error.h"
+
+#if defined(_WIN32)
+#   include <Windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   include <cerrno>
+#   include <cstring>
+#endif
+
+using namespace Daybreak;
+
+//---------------------------------------------------------------------------------------------------------------------
+#if defined(_WIN32)
+MappedFile::MappedFile(const std::string& filePath)
+    : m_filePath(filePath)
+{
+    auto file = CreateFileA(
+        filePath.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw ContentReadException(filePath, "File", "Could not open file for mapping");
+    }
+
+    LARGE_INTEGER fileSize = {};
+
+    if (!GetFileSizeEx(file, &fileSize))
+    {
+        CloseHandle(file);
+        throw ContentReadException(filePath, "File", "Could not get size of file");
+    }
+
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+
+    // Zero length files cannot be mapped, but they are valid and simply have no data.
+    if (m_size > 0)
+    {
+        auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if (mapping != nullptr)
+        {
+            m_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);           // The view keeps the mapping alive.
+        }
+    }
+
+    CloseHandle(file);
+
+    if (m_size > 0 && m_data == nullptr)
+    {
+        throw ContentReadException(filePath, "File", "Could not map file into memory");
+    }
+}
+#else
+MappedFile::MappedFile(const std::string& filePath)
+    : m_filePath(filePath)
+{
+    auto file = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (file < 0)
+    {
+        throw ContentReadException(filePath, "File", std::strerror(errno));
+    }
+
+    struct stat fileStat = {};
+
+    if (fstat(file, &fileStat) != 0)
+    {
+        auto error = errno;
+        close(file);
+        throw ContentReadException(filePath, "File", std::strerror(error));
+    }
+
+    m_size = static_cast<size_t>(fileStat.st_size);
+
+    // Zero length files cannot be mapped, but they are valid and simply have no data.
+    if (m_size > 0)
+    {
+        auto data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+        if (data == MAP_FAILED)
+        {
+            auto error = errno;
+            close(file);
+            throw ContentReadException(filePath, "File", std::strerror(error));
+        }
+
+        // Content is almost always parsed front to back so ask the kernel to read ahead aggressively.
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = data;
+    }
+
+    close(file);                            // The mapping keeps the file alive.
+}
+#endif
+
+//---------------------------------------------------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(m_data);
+#else
+        munmap(m_data, m_size);
+#endif
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace Daybreak
+{
+    /**
+     * Read-only view of a file's contents that is memory mapped into the process rather than copied into a buffer.
+     * The view remains valid for as long as the MappedFile object exists, so share ownership of the object (rather
+     * than copying pointers out of it) to keep the data alive.
+     */
+    class MappedFile
+    {
+    public:
+        /** Map the entire file at path into memory for reading. Throws ContentReadException on failure. */
+        explicit MappedFile(const std::string& filePath);
+
+        /** Destructor. Unmaps the file. */
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator =(const MappedFile&) = delete;
+
+        /** Get a read-only pointer to the first byte of the file, or null if the file is empty. */
+        const unsigned char * data() const noexcept { return static_cast<const unsigned char *>(m_data); }
+
+        /** Get the size of the file in bytes. */
+        size_t size() const noexcept { return m_size; }
+
+        /** Check if the file is empty. */
+        bool empty() const noexcept { return m_size == 0; }
+
+        /** Get the file contents as a view of characters. */
+        std::string_view text() const noexcept
+        {
+            return std::string_view(static_cast<const char *>(m_data), m_size);
+        }
+
+        /** Get the path of the file that was mapped. */
+        const std::string& filePath() const noexcept { return m_filePath; }
+
+    private:
+        std::string m_filePath;
+        void * m_data = nullptr;
+        size_t m_size = 0;
+    };
+}
@@ -26,12 +26,31 @@ namespace Daybreak
     /** Convert MaterialParameter to string. */
     std::string to_string(MaterialParameterType& param);
 
-    /** References a texture file on disk, and may or may not be loaded. */
+    /** Encoded image that is stored inside another file, such as an image in a buffer view of a glb model. */
+    struct embedded_image_t
+    {
+        std::string containerPath;                  ///< Path of the file that holds the image.
+        const unsigned char * bytes = nullptr;      ///< Encoded image, or null if the image is in its own file.
+        size_t offset = 0;                          ///< Offset of the image in the file that holds it.
+        size_t size = 0;
+        std::shared_ptr<const void> bytesOwner;     ///< Keeps the bytes alive.
+    };
+
+    /**
+     * References a texture file on disk, and may or may not be loaded. Textures stored inside another file have a
+     * filepath that names the image uniquely, and the image bytes in embeddedImage.
+     *
+     * Images are flipped when they are loaded so their first row is the bottom row, which matches formats like obj
+     * that put texture coordinate (0, 0) at the bottom left. Formats that put (0, 0) at the top left, like glTF, clear
+     * flipVertically instead.
+     */
     struct material_texture_t
     {
         std::string filepath;
         std::shared_ptr<ITexture2d> texture;
         TextureParameters textureParams;
+        embedded_image_t embeddedImage;
+        bool flipVertically = true;
     };
 
     /** Holds a material parameter value. */
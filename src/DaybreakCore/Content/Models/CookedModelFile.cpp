@@ -0,0 +1,529 @@
+#include "stdafx.h"
+#include "CookedModelFile.h"
+#include "Content/MappedFile.h"
+#include "Content\Models\ModelData.h"
+#include "Content\Materials\MaterialData.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/InputLayoutDescription.h"
+#include "Common/Error.h"
+
+#include <cstring>
+
+using namespace Daybreak;
+
+const char * const CookedModelFile::FileExtension = ".cooked";
+const uint32_t CookedModelFile::Version = 5;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    const char Magic[4] = { 'D', 'B', 'M', 'C' };
+
+    /** Alignment (in bytes) of the index and vertex data in the file. */
+    const uint64_t DataAlignment = 16;
+
+    /** File header. Every table that follows is stored directly after the one before it. */
+    struct file_header_t
+    {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceSize;
+        int64_t sourceLastWriteTime;
+        uint32_t indexElementType;
+        uint32_t attributeCount;
+        uint32_t groupCount;
+        uint32_t materialLibraryCount;
+        uint64_t stringDataSize;
+        uint64_t indexDataOffset;
+        uint64_t indexByteCount;
+        uint64_t vertexDataOffset;
+        uint64_t vertexByteCount;
+        float positionOffset[3];
+        float positionScale[3];
+        uint32_t meshletCount;
+        uint64_t optionsHash;
+    };
+
+    /** Reference to a string in the string data table. */
+    struct file_string_t
+    {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct file_material_library_t
+    {
+        file_string_t path;
+        uint64_t size;
+        int64_t lastWriteTime;
+    };
+
+    struct file_attribute_t
+    {
+        uint32_t semanticName;
+        uint32_t semanticIndex;
+        uint32_t storageType;
+        uint32_t count;
+        uint32_t normalized;
+    };
+
+    struct file_group_t
+    {
+        uint64_t indexOffset;
+        uint64_t indexCount;
+        uint64_t baseVertex;
+        file_string_t name;
+        file_string_t material;
+        uint32_t firstMeshlet;
+        uint32_t meshletCount;
+    };
+
+    struct file_meshlet_t
+    {
+        uint64_t indexOffset;
+        uint64_t indexCount;
+        uint64_t vertexCount;
+        float center[3];
+        float radius;
+        float coneAxis[3];
+        float coneCutoff;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    uint64_t alignUp(uint64_t offset) noexcept
+    {
+        return (offset + DataAlignment - 1) & ~(DataAlignment - 1);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Reads tables from a mapped file, throwing if a read goes past the end of the file. */
+    class TableReader
+    {
+    public:
+        explicit TableReader(const MappedFile& file)
+            : m_file(file)
+        {
+        }
+
+        template<typename T>
+        T read()
+        {
+            T value;
+            std::memcpy(&value, at(m_offset, sizeof(T)), sizeof(T));
+
+            m_offset += sizeof(T);
+            return value;
+        }
+
+        const unsigned char * at(uint64_t offset, uint64_t size) const
+        {
+            if (offset > m_file.size() || size > m_file.size() - offset)
+            {
+                throw ContentReadException(m_file.filePath(), "CookedModel", "File is truncated");
+            }
+
+            return m_file.data() + offset;
+        }
+
+        uint64_t offset() const noexcept { return m_offset; }
+
+    private:
+        const MappedFile& m_file;
+        uint64_t m_offset = 0;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Adds strings to a string data table. */
+    file_string_t addString(std::string& stringData, const std::string& value)
+    {
+        file_string_t ref = { static_cast<uint32_t>(stringData.size()), static_cast<uint32_t>(value.size()) };
+        stringData += value;
+
+        return ref;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    template<typename T>
+    void writeValue(std::ostream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    void writePadding(std::ostream& stream, uint64_t from, uint64_t to)
+    {
+        const char zeros[DataAlignment] = {};
+        stream.write(zeros, static_cast<std::streamsize>(to - from));
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+CookedModelFile::CookedModelFile(std::shared_ptr<const MappedFile> file)
+    : m_file(std::move(file))
+{
+    CHECK_NOT_NULL(m_file);
+
+    const auto& path = m_file->filePath();
+    TableReader reader(*m_file);
+
+    auto header = reader.read<file_header_t>();
+
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+    {
+        throw ContentReadException(path, "CookedModel", "File is not a cooked model");
+    }
+
+    if (header.version != Version)
+    {
+        throw ContentReadException(path, "CookedModel", "Cooked model version is not supported");
+    }
+
+    if (header.indexElementType > static_cast<uint32_t>(IndexElementType::UnsignedInt))
+    {
+        throw ContentReadException(path, "CookedModel", "Unknown index element type");
+    }
+
+    m_sourceStamp.size = header.sourceSize;
+    m_sourceStamp.lastWriteTime = header.sourceLastWriteTime;
+    m_optionsHash = header.optionsHash;
+    m_indexElementType = header.indexElementType;
+    m_positionDequantization.offset = glm::vec3(
+        header.positionOffset[0],
+        header.positionOffset[1],
+        header.positionOffset[2]);
+    m_positionDequantization.scale = glm::vec3(
+        header.positionScale[0],
+        header.positionScale[1],
+        header.positionScale[2]);
+
+    // Read the input layout.
+    std::vector<InputAttribute> attributes;
+
+    for (uint32_t i = 0; i < header.attributeCount; ++i)
+    {
+        auto attribute = reader.read<file_attribute_t>();
+
+        if (attribute.semanticName > static_cast<uint32_t>(InputAttribute::SemanticName::Tangent) ||
+            attribute.storageType > static_cast<uint32_t>(InputAttribute::StorageType::PackedInt2101010) ||
+            attribute.count == 0 ||
+            attribute.normalized > 1 ||
+            (attribute.storageType == static_cast<uint32_t>(InputAttribute::StorageType::PackedInt2101010) &&
+                attribute.count != 4))
+        {
+            throw ContentReadException(path, "CookedModel", "Invalid vertex input attribute");
+        }
+
+        attributes.emplace_back(
+            static_cast<InputAttribute::SemanticName>(attribute.semanticName),
+            attribute.semanticIndex,
+            static_cast<InputAttribute::StorageType>(attribute.storageType),
+            attribute.count,
+            attribute.normalized != 0);
+    }
+
+    if (attributes.empty())
+    {
+        throw ContentReadException(path, "CookedModel", "Vertex input layout is empty");
+    }
+
+    m_inputLayout = std::make_shared<InputLayoutDescription>(attributes);
+
+    // Read the groups, meshlets and material libraries, whose strings are stored after them.
+    std::vector<file_group_t> groups;
+    std::vector<file_meshlet_t> meshlets;
+    std::vector<file_material_library_t> materialLibraries;
+
+    for (uint32_t i = 0; i < header.groupCount; ++i)
+    {
+        groups.push_back(reader.read<file_group_t>());
+    }
+
+    for (uint32_t i = 0; i < header.meshletCount; ++i)
+    {
+        meshlets.push_back(reader.read<file_meshlet_t>());
+    }
+
+    for (uint32_t i = 0; i < header.materialLibraryCount; ++i)
+    {
+        materialLibraries.push_back(reader.read<file_material_library_t>());
+    }
+
+    auto stringData = reinterpret_cast<const char *>(reader.at(reader.offset(), header.stringDataSize));
+
+    auto getString = [&](const file_string_t& ref)
+    {
+        if (ref.offset > header.stringDataSize || ref.length > header.stringDataSize - ref.offset)
+        {
+            throw ContentReadException(path, "CookedModel", "String is outside of the string table");
+        }
+
+        return std::string(stringData + ref.offset, ref.length);
+    };
+
+    for (const auto& group : groups)
+    {
+        if (group.firstMeshlet > meshlets.size() || group.meshletCount > meshlets.size() - group.firstMeshlet)
+        {
+            throw ContentReadException(path, "CookedModel", "Invalid group");
+        }
+
+        m_groups.push_back({
+            getString(group.name),
+            getString(group.material),
+            static_cast<size_t>(group.indexOffset),
+            static_cast<size_t>(group.indexCount),
+            static_cast<size_t>(group.baseVertex),
+            {} });
+
+        for (auto m = group.firstMeshlet; m < group.firstMeshlet + group.meshletCount; ++m)
+        {
+            const auto& meshlet = meshlets[m];
+
+            if (meshlet.indexOffset < group.indexOffset ||
+                meshlet.indexCount > group.indexCount ||
+                meshlet.indexOffset - group.indexOffset > group.indexCount - meshlet.indexCount)
+            {
+                throw ContentReadException(path, "CookedModel", "Invalid meshlet");
+            }
+
+            meshlet_t result;
+            result.indexOffset = static_cast<size_t>(meshlet.indexOffset);
+            result.indexCount = static_cast<size_t>(meshlet.indexCount);
+            result.vertexCount = static_cast<size_t>(meshlet.vertexCount);
+            result.center = glm::vec3(meshlet.center[0], meshlet.center[1], meshlet.center[2]);
+            result.radius = meshlet.radius;
+            result.coneAxis = glm::vec3(meshlet.coneAxis[0], meshlet.coneAxis[1], meshlet.coneAxis[2]);
+            result.coneCutoff = meshlet.coneCutoff;
+
+            m_groups.back().meshlets.push_back(result);
+        }
+    }
+
+    for (const auto& materialLibrary : materialLibraries)
+    {
+        m_materialLibraries.push_back(getString(materialLibrary.path));
+        m_materialLibraryStamps.push_back({ materialLibrary.size, materialLibrary.lastWriteTime });
+    }
+
+    // Find the index and vertex data.
+    m_indexData = reader.at(header.indexDataOffset, header.indexByteCount);
+    m_indexByteCount = static_cast<size_t>(header.indexByteCount);
+    m_vertexData = reader.at(header.vertexDataOffset, header.vertexByteCount);
+    m_vertexByteCount = static_cast<size_t>(header.vertexByteCount);
+
+    // Check the buffers hold whole elements and every group is inside the index buffer, so creating the model cannot
+    // fail on a damaged file.
+    const auto indexSize = indexElementSizeInBytes(static_cast<IndexElementType>(m_indexElementType));
+    const auto indexCount = m_indexByteCount / indexSize;
+
+    if (m_indexByteCount == 0 || m_indexByteCount % indexSize != 0 ||
+        m_vertexByteCount == 0 || m_vertexByteCount % m_inputLayout->elementSizeInBytes() != 0)
+    {
+        throw ContentReadException(path, "CookedModel", "Buffer size is not a multiple of its element size");
+    }
+
+    const auto vertexCount = m_vertexByteCount / m_inputLayout->elementSizeInBytes();
+
+    for (const auto& group : m_groups)
+    {
+        if (group.name.empty() ||
+            group.indexOffset > indexCount ||
+            group.indexCount > indexCount - group.indexOffset ||
+            group.baseVertex >= vertexCount)
+        {
+            throw ContentReadException(path, "CookedModel", "Invalid group");
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unordered_set<std::string> CookedModelFile::materialNames() const
+{
+    std::unordered_set<std::string> names;
+
+    for (const auto& group : m_groups)
+    {
+        names.insert(group.material);
+    }
+
+    return names;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<ModelData> CookedModelFile::createModel(const material_lut_t& materials) const
+{
+    // The buffers share ownership of the mapped file so it is not unmapped while they point into it.
+    auto modelData = std::make_unique<ModelData>(
+        std::make_unique<MeshData>(
+            std::make_unique<IndexBufferData>(
+                m_indexByteCount,
+                m_indexData,
+                m_file,
+                static_cast<IndexElementType>(m_indexElementType)),
+            std::make_unique<VertexBufferData>(
+                m_vertexByteCount,
+                m_vertexData,
+                m_file,
+                m_inputLayout)));
+
+    modelData->setPositionDequantization(m_positionDequantization);
+
+    std::vector<ModelData::Group> groups;
+    groups.reserve(m_groups.size());
+
+    for (const auto& group : m_groups)
+    {
+        auto materialItr = materials.find(group.material);
+
+        groups.emplace_back(ModelData::Group(
+            group.name,
+            (materialItr == materials.end() ? nullptr : materialItr->second),
+            group.indexOffset,
+            group.indexCount,
+            group.baseVertex));
+
+        auto meshlets = group.meshlets;
+        groups.back().setMeshlets(std::move(meshlets));
+    }
+
+    modelData->addGroup(std::move(groups));
+    return modelData;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void CookedModelFile::write(
+    std::ostream& stream,
+    const ModelData& model,
+    const std::vector<std::string>& materialLibraries,
+    const std::vector<file_stamp_t>& materialLibraryStamps,
+    const file_stamp_t& sourceStamp,
+    uint64_t optionsHash)
+{
+    CHECK(materialLibraries.size() == materialLibraryStamps.size());
+
+    const auto& mesh = model.mesh();
+    const auto& inputLayout = mesh.vertexElementTypeRef();
+
+    // Build the tables first so the offset of the index and vertex data is known when writing the header.
+    std::string stringData;
+    std::vector<file_group_t> groups;
+    std::vector<file_meshlet_t> meshlets;
+    std::vector<file_material_library_t> libraries;
+
+    for (const auto& group : model.groups())
+    {
+        file_group_t g;
+
+        g.indexOffset = group.indexOffset();
+        g.indexCount = group.indexCount();
+        g.baseVertex = group.baseVertex();
+        g.name = addString(stringData, group.name());
+        g.material = addString(stringData, group.hasMaterial() ? group.material()->name() : std::string());
+        g.firstMeshlet = static_cast<uint32_t>(meshlets.size());
+        g.meshletCount = static_cast<uint32_t>(group.meshlets().size());
+
+        groups.push_back(g);
+
+        for (const auto& meshlet : group.meshlets())
+        {
+            meshlets.push_back(file_meshlet_t {
+                meshlet.indexOffset,
+                meshlet.indexCount,
+                meshlet.vertexCount,
+                { meshlet.center.x, meshlet.center.y, meshlet.center.z },
+                meshlet.radius,
+                { meshlet.coneAxis.x, meshlet.coneAxis.y, meshlet.coneAxis.z },
+                meshlet.coneCutoff });
+        }
+    }
+
+    for (size_t i = 0; i < materialLibraries.size(); ++i)
+    {
+        libraries.push_back(file_material_library_t {
+            addString(stringData, materialLibraries[i]),
+            materialLibraryStamps[i].size,
+            materialLibraryStamps[i].lastWriteTime });
+    }
+
+    file_header_t header = {};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+
+    header.version = Version;
+    header.sourceSize = sourceStamp.size;
+    header.sourceLastWriteTime = sourceStamp.lastWriteTime;
+    header.optionsHash = optionsHash;
+    header.indexElementType = static_cast<uint32_t>(mesh.indexElementType());
+    header.attributeCount = static_cast<uint32_t>(inputLayout.attributeCount());
+    header.groupCount = static_cast<uint32_t>(groups.size());
+    header.meshletCount = static_cast<uint32_t>(meshlets.size());
+    header.materialLibraryCount = static_cast<uint32_t>(libraries.size());
+    header.stringDataSize = stringData.size();
+
+    for (int i = 0; i < 3; ++i)
+    {
+        header.positionOffset[i] = model.positionDequantization().offset[i];
+        header.positionScale[i] = model.positionDequantization().scale[i];
+    }
+
+    const uint64_t stringDataEnd =
+        sizeof(file_header_t) +
+        sizeof(file_attribute_t) * header.attributeCount +
+        sizeof(file_group_t) * header.groupCount +
+        sizeof(file_meshlet_t) * header.meshletCount +
+        sizeof(file_material_library_t) * header.materialLibraryCount +
+        header.stringDataSize;
+
+    header.indexByteCount = mesh.indexCount() * mesh.indexElementSizeInBytes();
+    header.indexDataOffset = alignUp(stringDataEnd);
+    header.vertexByteCount = mesh.vertexCount() * mesh.vertexElementSizeInBytes();
+    header.vertexDataOffset = alignUp(header.indexDataOffset + header.indexByteCount);
+
+    // Write everything out in file order.
+    writeValue(stream, header);
+
+    for (size_t i = 0; i < inputLayout.attributeCount(); ++i)
+    {
+        auto attribute = inputLayout.getAttributeByIndex(i);
+
+        writeValue(stream, file_attribute_t {
+            static_cast<uint32_t>(attribute.semanticName()),
+            attribute.semanticIndex(),
+            static_cast<uint32_t>(attribute.type()),
+            attribute.count(),
+            attribute.normalized() ? 1u : 0u });
+    }
+
+    for (const auto& group : groups)
+    {
+        writeValue(stream, group);
+    }
+
+    for (const auto& meshlet : meshlets)
+    {
+        writeValue(stream, meshlet);
+    }
+
+    for (const auto& library : libraries)
+    {
+        writeValue(stream, library);
+    }
+
+    stream.write(stringData.data(), static_cast<std::streamsize>(stringData.size()));
+    writePadding(stream, stringDataEnd, header.indexDataOffset);
+
+    stream.write(
+        static_cast<const char *>(mesh.rawIndexBufferData()),
+        static_cast<std::streamsize>(header.indexByteCount));
+    writePadding(stream, header.indexDataOffset + header.indexByteCount, header.vertexDataOffset);
+
+    stream.write(
+        static_cast<const char *>(mesh.rawVertexBufferData()),
+        static_cast<std::streamsize>(header.vertexByteCount));
+
+    if (!stream)
+    {
+        throw DaybreakDataException("Failed to write cooked model");
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include "Content/IFileSystem.h"
+#include "Graphics/Mesh/MeshletBuilder.h"
+#include "Graphics/Mesh/VertexQuantization.h"
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Daybreak
+{
+    class InputLayoutDescription;
+    class MappedFile;
+    class MaterialData;
+    class ModelData;
+
+    /**
+     * Binary cooked copy of a model that can be loaded without parsing. A cooked model file holds the vertex and index
+     * buffers exactly as they are uploaded to the GPU, the vertex input layout, the groups along with the names of
+     * their materials and their meshlets, and the material libraries that define those materials. It also records the
+     * size and last write time of the source file and of every material library, and a hash of the options the model
+     * was loaded with, so out of date files can be detected.
+     *
+     * The file is written in the byte order of the machine that cooked it, and the buffers are aligned so a mapped
+     * file can be used in place without copying.
+     */
+    class CookedModelFile
+    {
+    public:
+        using material_lut_t = std::unordered_map<std::string, std::shared_ptr<MaterialData>>;
+
+        /** File extension appended to the path of a source model to get the path of its cooked model. */
+        static const char * const FileExtension;
+
+        /** Version of the cooked model format written by this code. Files with any other version are not read. */
+        static const uint32_t Version;
+
+    public:
+        /**
+         * Read the header and tables of a mapped cooked model file. Throws ContentReadException if the file is not a
+         * cooked model, was written by a different version, or is truncated.
+         */
+        explicit CookedModelFile(std::shared_ptr<const MappedFile> file);
+
+        /** Get the size and last write time of the source file the model was cooked from. */
+        const file_stamp_t& sourceStamp() const noexcept { return m_sourceStamp; }
+
+        /** Get the hash of the load options the model was cooked with. */
+        uint64_t optionsHash() const noexcept { return m_optionsHash; }
+
+        /** Get the material libraries that define the materials used by the model. */
+        const std::vector<std::string>& materialLibraries() const noexcept { return m_materialLibraries; }
+
+        /** Get the size and last write time of each material library when the model was cooked. */
+        const std::vector<file_stamp_t>& materialLibraryStamps() const noexcept { return m_materialLibraryStamps; }
+
+        /** Get the names of the materials used by the model's groups. */
+        std::unordered_set<std::string> materialNames() const;
+
+        /**
+         * Create a model whose vertex and index buffers point directly into the mapped file, which stays mapped for as
+         * long as the buffers exist. Each group is given the material with the same name from materials.
+         */
+        std::unique_ptr<ModelData> createModel(const material_lut_t& materials) const;
+
+        /** Write a model to a stream in the cooked model format. */
+        static void write(
+            std::ostream& stream,                                       ///< Stream to write to.
+            const ModelData& model,                                     ///< Model to write.
+            const std::vector<std::string>& materialLibraries,          ///< Libraries defining the model's materials.
+            const std::vector<file_stamp_t>& materialLibraryStamps,     ///< Stamp of each material library.
+            const file_stamp_t& sourceStamp,                            ///< Stamp of the file the model came from.
+            uint64_t optionsHash);                                      ///< Hash of the options used to load it.
+
+    private:
+        struct group_t
+        {
+            std::string name;
+            std::string material;
+            size_t indexOffset;
+            size_t indexCount;
+            size_t baseVertex;
+            std::vector<meshlet_t> meshlets;
+        };
+
+    private:
+        std::shared_ptr<const MappedFile> m_file;
+        file_stamp_t m_sourceStamp;
+        uint64_t m_optionsHash = 0;
+        std::vector<std::string> m_materialLibraries;
+        std::vector<file_stamp_t> m_materialLibraryStamps;
+        std::vector<group_t> m_groups;
+        std::shared_ptr<const InputLayoutDescription> m_inputLayout;
+        position_dequantization_t m_positionDequantization;
+        uint32_t m_indexElementType = 0;
+        const unsigned char * m_indexData = nullptr;
+        size_t m_indexByteCount = 0;
+        const unsigned char * m_vertexData = nullptr;
+        size_t m_vertexByteCount = 0;
+    };
+}
@@ -2,6 +2,9 @@
 #include "ModelData.h"
 #include "Content\Materials\MaterialData.h"
 #include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/TangentGenerator.h"
 #include "Common/Error.h"
 
 using namespace Daybreak;
@@ -11,11 +14,13 @@ ModelData::Group::Group(
     const std::string& name,
     std::shared_ptr<MaterialData> material,
     size_t indexOffset,
-    size_t indexCount)
+    size_t indexCount,
+    size_t baseVertex)
     : m_name(name),
       m_material(material),
       m_indexOffset(indexOffset),
-      m_indexCount(indexCount)
+      m_indexCount(indexCount),
+      m_baseVertex(baseVertex)
 {
     CHECK_NOT_EMPTY(m_name);
     CHECK_NOT_NULL(m_material);
@@ -35,6 +40,25 @@ MaterialData& ModelData::Group::materialRef()
     return *(m_material.get());
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+void ModelData::Group::setMeshlets(std::vector<meshlet_t>&& meshlets)
+{
+    for (const auto& meshlet : meshlets)
+    {
+        CHECK(meshlet.indexOffset >= m_indexOffset);
+        CHECK(meshlet.indexOffset + meshlet.indexCount <= m_indexOffset + m_indexCount);
+    }
+
+    m_meshlets = std::move(meshlets);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+ModelData::LevelOfDetail::LevelOfDetail(std::vector<Group>&& groups, float error)
+    : m_groups(std::move(groups)),
+      m_error(error)
+{
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //---------------------------------------------------------------------------------------------------------------------
 ModelData::ModelData(std::unique_ptr<MeshData> mesh)
@@ -52,6 +76,241 @@ const MeshData& ModelData::mesh() const noexcept
     return *m_mesh.get();
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+void ModelData::optimizeMesh(const mesh_optimization_options_t& options)
+{
+    std::vector<std::pair<size_t, size_t>> indexRanges;
+    indexRanges.reserve(m_groups.size());
+
+    for (const auto& group : m_groups)
+    {
+        CHECK(group.baseVertex() == 0);
+        indexRanges.emplace_back(group.indexOffset(), group.indexCount());
+    }
+
+    if (m_groups.empty())
+    {
+        indexRanges.emplace_back(0, m_mesh->indexCount());
+    }
+
+    for (const auto& level : m_levelsOfDetail)
+    {
+        for (const auto& group : level.groups())
+        {
+            indexRanges.emplace_back(group.indexOffset(), group.indexCount());
+        }
+    }
+
+    m_mesh = Daybreak::optimizeMesh(*m_mesh, indexRanges, options);
+
+    for (auto& group : m_groups)
+    {
+        group.setMeshlets({});
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ModelData::generateTangents(size_t maxWorkerCount)
+{
+    std::vector<std::pair<size_t, size_t>> indexRanges;
+    indexRanges.reserve(m_groups.size());
+
+    for (const auto& group : m_groups)
+    {
+        CHECK(group.baseVertex() == 0);
+        indexRanges.emplace_back(group.indexOffset(), group.indexCount());
+    }
+
+    if (m_groups.empty())
+    {
+        indexRanges.emplace_back(0, m_mesh->indexCount());
+    }
+
+    m_mesh = Daybreak::generateTangents(*m_mesh, indexRanges, maxWorkerCount);
+
+    // Split vertices change the vertex count of meshlets.
+    for (auto& group : m_groups)
+    {
+        group.setMeshlets({});
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ModelData::buildMeshlets(const meshlet_options_t& options, size_t maxWorkerCount)
+{
+    std::vector<meshlet_range_t> ranges;
+    ranges.reserve(m_groups.size());
+
+    for (const auto& group : m_groups)
+    {
+        ranges.push_back({ group.indexOffset(), group.indexCount(), group.baseVertex() });
+    }
+
+    auto meshlets = Daybreak::buildMeshlets(*m_mesh, ranges, options, maxWorkerCount);
+
+    for (size_t i = 0; i < m_groups.size(); ++i)
+    {
+        m_groups[i].setMeshlets(std::move(meshlets[i]));
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ModelData::generateLevelsOfDetail(const lod_chain_options_t& options)
+{
+    CHECK(!m_groups.empty());
+
+    auto indices = readIndices(*m_mesh);
+
+    // Drop the levels generated before, whose indices were appended after every group.
+    const bool hadLevels = !m_levelsOfDetail.empty();
+
+    if (hadLevels)
+    {
+        indices.resize(m_levelsOfDetail.front().groups().front().indexOffset());
+        m_levelsOfDetail.clear();
+    }
+
+    std::vector<std::pair<size_t, size_t>> indexRanges;
+    indexRanges.reserve(m_groups.size());
+
+    for (const auto& group : m_groups)
+    {
+        CHECK(group.baseVertex() == 0);
+        indexRanges.emplace_back(group.indexOffset(), group.indexCount());
+    }
+
+    auto levels = generateLodChain(*m_mesh, indexRanges, indices, options);
+
+    if (hadLevels || !levels.empty())
+    {
+        m_mesh->setIndexBuffer(createCompactIndexBuffer(indices.data(), indices.size()));
+    }
+
+    for (const auto& level : levels)
+    {
+        std::vector<Group> groups;
+        groups.reserve(m_groups.size());
+
+        for (size_t i = 0; i < m_groups.size(); ++i)
+        {
+            groups.emplace_back(Group(
+                m_groups[i].name(),
+                m_groups[i].material(),
+                level.indexRanges[i].first,
+                level.indexRanges[i].second));
+        }
+
+        m_levelsOfDetail.emplace_back(std::move(groups), level.error);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const ModelData::LevelOfDetail& ModelData::levelOfDetail(size_t levelIndex) const
+{
+    CHECK(levelIndex < m_levelsOfDetail.size());
+    return m_levelsOfDetail[levelIndex];
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+size_t ModelData::selectLevelOfDetail(float maxError) const noexcept
+{
+    size_t selected = 0;
+
+    while (selected < m_levelsOfDetail.size() && m_levelsOfDetail[selected].error() <= maxError)
+    {
+        ++selected;
+    }
+
+    return selected;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ModelData::narrowIndices(bool splitLargeMeshes)
+{
+    auto indices = readIndices(*m_mesh);
+    auto compactIndices = createCompactIndexBuffer(indices.data(), indices.size());
+
+    if (compactIndices->elementType() != IndexElementType::UnsignedInt || !splitLargeMeshes)
+    {
+        m_mesh->setIndexBuffer(std::move(compactIndices));
+        return;
+    }
+
+    // Split each group into parts that can use 16 bit indices. The groups must cover every index in order, because
+    // indices outside of a group could not be rebased. Groups with meshlets are only split between meshlets, so every
+    // meshlet moves to the part that holds it.
+    std::vector<Group> splitGroups;
+    std::vector<index_sub_range_t> subRanges;
+    std::vector<std::pair<size_t, size_t>> meshletRuns;
+    size_t nextIndex = 0;
+
+    for (const auto& group : m_groups)
+    {
+        const auto& meshlets = group.meshlets();
+        subRanges.clear();
+        meshletRuns.clear();
+
+        for (const auto& meshlet : meshlets)
+        {
+            meshletRuns.emplace_back(meshlet.indexOffset, meshlet.indexCount);
+        }
+
+        const auto wasSplit = meshlets.empty() ?
+            trySplitIndexRange(indices.data(), group.indexOffset(), group.indexCount(), subRanges) :
+            trySplitIndexRuns(indices.data(), meshletRuns, subRanges);
+
+        if (group.indexOffset() != nextIndex || group.baseVertex() != 0 || !wasSplit)
+        {
+            m_mesh->setIndexBuffer(std::move(compactIndices));
+            return;
+        }
+
+        size_t nextMeshlet = 0;
+
+        for (const auto& range : subRanges)
+        {
+            Group part(group.name(), group.material(), range.indexOffset, range.indexCount, range.baseVertex);
+            std::vector<meshlet_t> partMeshlets;
+
+            while (nextMeshlet < meshlets.size() &&
+                   meshlets[nextMeshlet].indexOffset < range.indexOffset + range.indexCount)
+            {
+                partMeshlets.push_back(meshlets[nextMeshlet++]);
+            }
+
+            part.setMeshlets(std::move(partMeshlets));
+            splitGroups.emplace_back(std::move(part));
+        }
+
+        nextIndex = group.indexOffset() + group.indexCount();
+    }
+
+    if (m_groups.empty() || nextIndex != indices.size())
+    {
+        m_mesh->setIndexBuffer(std::move(compactIndices));
+        return;
+    }
+
+    std::unique_ptr<uint16_t[]> shortIndices(new uint16_t[indices.size()]);
+
+    for (const auto& group : splitGroups)
+    {
+        for (auto i = group.indexOffset(); i < group.indexOffset() + group.indexCount(); ++i)
+        {
+            shortIndices[i] = static_cast<uint16_t>(indices[i] - group.baseVertex());
+        }
+    }
+
+    m_mesh->setIndexBuffer(std::make_unique<IndexBufferData>(indices.size(), std::move(shortIndices)));
+    m_groups = std::move(splitGroups);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ModelData::quantizeVertices(const vertex_quantization_options_t& options)
+{
+    m_mesh = Daybreak::quantizeVertices(*m_mesh, options, m_positionDequantization);
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 void ModelData::addGroup(Group&& group)
 {
@@ -1,4 +1,9 @@
 #pragma once
+#include "Graphics/Mesh/MeshletBuilder.h"
+#include "Graphics/Mesh/MeshOptimizer.h"
+#include "Graphics/Mesh/MeshSimplifier.h"
+#include "Graphics/Mesh/VertexQuantization.h"
+
 #include <string>
 #include <vector>
 #include <memory>
@@ -21,7 +26,8 @@ namespace Daybreak
                 const std::string& name,
                 std::shared_ptr<MaterialData> material,
                 size_t indexOffset,
-                size_t indexCount);
+                size_t indexCount,
+                size_t baseVertex = 0);
 
             /** Get group name. */
             const std::string& name() const { return m_name; }
@@ -44,11 +50,40 @@ namespace Daybreak
             /** Get the number of indices that belong to this group. */
             size_t indexCount() const noexcept { return m_indexCount; }
 
+            /** Get the value added to every index in this group before fetching a vertex. */
+            size_t baseVertex() const noexcept { return m_baseVertex; }
+
+            /** Get the meshlets that split this group's indices into contiguous clusters, or an empty list. */
+            const std::vector<meshlet_t>& meshlets() const noexcept { return m_meshlets; }
+
+            /** Set the meshlets that split this group's indices into contiguous clusters. */
+            void setMeshlets(std::vector<meshlet_t>&& meshlets);
+
         private:
             std::string m_name;
             std::shared_ptr<MaterialData> m_material;
             size_t m_indexOffset;
             size_t m_indexCount;
+            size_t m_baseVertex;
+            std::vector<meshlet_t> m_meshlets;
+        };
+
+        /** A simplified copy of the model's groups that draws from the same vertices as the model. */
+        class LevelOfDetail
+        {
+        public:
+            /** Initialize level of detail. */
+            LevelOfDetail(std::vector<Group>&& groups, float error);
+
+            /** Get the groups in this level. Each group is a simplified copy of the model group at the same index. */
+            const std::vector<Group>& groups() const noexcept { return m_groups; }
+
+            /** Get an estimate of how far, in model units, this level's surface is from the full detail model. */
+            float error() const noexcept { return m_error; }
+
+        private:
+            std::vector<Group> m_groups;
+            float m_error;
         };
 
     public:
@@ -61,6 +96,72 @@ namespace Daybreak
         /** Get unowned reference to mesh data. */
         const MeshData& mesh() const noexcept;
 
+        /**
+         * Replace the mesh with a copy optimized for drawing. Triangles are only reordered within each group, so the
+         * group index ranges stay valid. Every group must have a zero base vertex. Meshlets built before are removed.
+         */
+        void optimizeMesh(const mesh_optimization_options_t& options = mesh_optimization_options_t());
+
+        /**
+         * Generate a chain of progressively simplified levels of detail for the model's groups. The simplified
+         * indices are appended to the mesh's index buffer and the vertices are shared with the full detail model.
+         * Replaces any levels generated before. Every group must have a zero base vertex.
+         */
+        void generateLevelsOfDetail(const lod_chain_options_t& options = lod_chain_options_t());
+
+        /** Get the number of simplified levels of detail, not counting the full detail model. */
+        size_t levelOfDetailCount() const noexcept { return m_levelsOfDetail.size(); }
+
+        /** Get a simplified level of detail, where zero is the most detailed simplified level. */
+        const LevelOfDetail& levelOfDetail(size_t levelIndex) const;
+
+        /**
+         * Get the simplest level of detail whose error is no larger than maxError, for example the error that
+         * projects to one pixel at the model's distance. Returns zero for the full detail model and n for
+         * levelOfDetail(n - 1).
+         */
+        size_t selectLevelOfDetail(float maxError) const noexcept;
+
+        /**
+         * Replace the mesh with a copy that has tangents for normal mapping, generated for every group using up to
+         * maxWorkerCount threads. Vertices shared by mirrored and unmirrored texture mappings are split, but the
+         * triangles keep their order so the group index ranges stay valid. Generate tangents before levels of detail,
+         * whose indices are not updated. Every group must have a zero base vertex. Meshlets built before are removed.
+         */
+        void generateTangents(size_t maxWorkerCount = 1);
+
+        /**
+         * Split every group into meshlets of neighbouring triangles, using up to maxWorkerCount threads. The triangles
+         * in each group are reordered so every meshlet is a contiguous run of indices ordered for the vertex cache, and
+         * the vertices follow the new order unless the groups have base vertices. Build meshlets after optimizeMesh,
+         * which would reorder the triangles again and remove them.
+         */
+        void buildMeshlets(const meshlet_options_t& options = meshlet_options_t(), size_t maxWorkerCount = 1);
+
+        /**
+         * Store the mesh indices with the narrowest type that can address every vertex. When the mesh has too many
+         * vertices for 16 bit indices and splitLargeMeshes is set, groups are split into parts that each span fewer
+         * than 65536 vertices and whose 16 bit indices are relative to a base vertex. Meshes that cannot be split
+         * (for example when the groups do not cover the whole index buffer in order) keep 32 bit indices. Groups with
+         * meshlets are only split between meshlets, and each part keeps the meshlets it holds.
+         */
+        void narrowIndices(bool splitLargeMeshes);
+
+        /**
+         * Replace the mesh with a copy that stores vertices in fewer bytes. The transform that turns quantized
+         * positions back into model space is kept in positionDequantization.
+         */
+        void quantizeVertices(const vertex_quantization_options_t& options = vertex_quantization_options_t());
+
+        /** Get the transform from the mesh's vertex positions to model space. */
+        const position_dequantization_t& positionDequantization() const noexcept { return m_positionDequantization; }
+
+        /** Set the transform from the mesh's vertex positions to model space. */
+        void setPositionDequantization(const position_dequantization_t& dequantization) noexcept
+        {
+            m_positionDequantization = dequantization;
+        }
+
         /** Add a group to the model. */
         void addGroup(Group&& group);
 
@@ -85,5 +186,7 @@ namespace Daybreak
     private:
         std::unique_ptr<MeshData> m_mesh;
         std::vector<Group> m_groups;
+        std::vector<LevelOfDetail> m_levelsOfDetail;
+        position_dequantization_t m_positionDequantization;
     };
 }
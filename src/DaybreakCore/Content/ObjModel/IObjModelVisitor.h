@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <glm/glm.hpp>
+
+namespace Daybreak
+{
+    struct obj_face_t;
+
+    /**
+     * Receives obj model data from ObjModelParser::parseStream in file order as it is read, instead of the parser
+     * building a complete obj_model_t.
+     */
+    class IObjModelVisitor
+    {
+    public:
+        virtual ~IObjModelVisitor() = default;
+
+        /** Called for each vertex position (v). */
+        virtual void visitPosition(const glm::vec3& position) = 0;
+
+        /** Called for each texture coordinate (vt). */
+        virtual void visitUV(const glm::vec2& uv) = 0;
+
+        /** Called for each vertex normal (vn). */
+        virtual void visitNormal(const glm::vec3& normal) = 0;
+
+        /**
+         * Called before the first face of each group with the final name and material of the group. Groups without
+         * any faces are not reported.
+         */
+        virtual void visitGroup(const std::string& name, const std::string& material) = 0;
+
+        /**
+         * Called for each face. Indices are absolute and one based, and only refer to vertex data that has already
+         * been visited.
+         */
+        virtual void visitFace(const obj_face_t& face) = 0;
+
+        /**
+         * Called for each smoothing group command (s), with zero for "off". Faces also carry the smoothing group they
+         * are in, so this only tells the visitor that the file uses smoothing groups.
+         */
+        virtual void visitSmoothingGroup(uint32_t smoothingGroup) = 0;
+
+        /** Called for each material library (mtllib). */
+        virtual void visitMaterialLibrary(const std::string& path) = 0;
+    };
+}
@@ -12,14 +12,28 @@
 using namespace Daybreak;
 using namespace Daybreak::TextUtils;
 
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    /** Create a texture parameter that is read from a file. */
+    material_texture_t fileTexture(const std::string& filepath)
+    {
+        material_texture_t texture{};
+        texture.filepath = filepath;
+
+        return texture;
+    }
+}
 
 //---------------------------------------------------------------------------------------------------------------------
 std::vector<std::unique_ptr<MaterialData>>&& MtlMaterialParser::parse(
     const std::string_view& mtlData,
-    const std::string& fileName)
+    const std::string& fileName,
+    const std::unordered_set<std::string> * materialNames)
 {
     reset();
     m_fileName = fileName;
+    m_materialNames = materialNames;
     
     // Read the mtl data line by line (ignoring comments).
     StringLineReader lineReader(mtlData, '#');
@@ -50,7 +64,16 @@ void MtlMaterialParser::parseLine(const std::string_view& line)
     if (command == "newmtl")
     {
         auto name = readExpectedString(splitter);
-        m_materials.push_back(std::make_unique<MaterialData>(name, MaterialType::Traditional));
+        m_isSkippingMaterial = (m_materialNames != nullptr && m_materialNames->count(name) == 0);
+
+        if (!m_isSkippingMaterial)
+        {
+            m_materials.push_back(std::make_unique<MaterialData>(name, MaterialType::Traditional));
+        }
+    }
+    else if (m_isSkippingMaterial)
+    {
+        // The material is not wanted, so its commands are not parsed.
     }
     else if (command == "Ka")
     {
@@ -76,7 +99,7 @@ void MtlMaterialParser::parseLine(const std::string_view& line)
     else if (command == "map_Kd")
     {
         auto filepath = readExpectedString(splitter);
-        currentMaterial().setParameter(MaterialParameterType::DiffuseMap, material_texture_t{ filepath });
+        currentMaterial().setParameter(MaterialParameterType::DiffuseMap, fileTexture(filepath));
     }
     else if (command == "Ks")
     {
@@ -89,7 +112,7 @@ void MtlMaterialParser::parseLine(const std::string_view& line)
     else if (command == "map_Ks")
     {
         auto filepath = readExpectedString(splitter);
-        currentMaterial().setParameter(MaterialParameterType::SpecularMap, material_texture_t{ filepath });
+        currentMaterial().setParameter(MaterialParameterType::SpecularMap, fileTexture(filepath));
     }
     else if (command == "Ns")
     {
@@ -135,12 +158,12 @@ void MtlMaterialParser::parseLine(const std::string_view& line)
     else if (command == "disp")
     {
         auto filepath = readExpectedString(splitter);
-        currentMaterial().setParameter(MaterialParameterType::DisplacementMap, material_texture_t{ filepath });
+        currentMaterial().setParameter(MaterialParameterType::DisplacementMap, fileTexture(filepath));
     }
     else if (command == "map_Kn" || command == "norm")
     {
         auto filepath = readExpectedString(splitter);
-        currentMaterial().setParameter(MaterialParameterType::NormalMap, material_texture_t{ filepath });
+        currentMaterial().setParameter(MaterialParameterType::NormalMap, fileTexture(filepath));
     }
     else
     {
@@ -154,6 +177,8 @@ void MtlMaterialParser::reset() noexcept
     m_materials.clear();
     m_lineNumber = 0;
     m_fileName = "";
+    m_materialNames = nullptr;
+    m_isSkippingMaterial = false;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <memory>
+#include <unordered_set>
 #include <vector>
 
 namespace Daybreak
@@ -11,10 +12,14 @@ namespace Daybreak
     class MtlMaterialParser
     {
     public:
-        /** Return a list of materials parsed from the provided mtl file text data. */
+        /**
+         * Return a list of materials parsed from the provided mtl file text data. When materialNames is given only the
+         * materials it names are created, and the commands of every other material are skipped without being parsed.
+         */
         std::vector<std::unique_ptr<MaterialData>>&& parse(
             const std::string_view& mtlData,
-            const std::string& fileName = "");
+            const std::string& fileName = "",
+            const std::unordered_set<std::string> * materialNames = nullptr);
 
     private:
         /** Evaluate one line from the obj file. */
@@ -29,6 +34,8 @@ namespace Daybreak
     private:
         std::string m_fileName;
         size_t m_lineNumber = 0;
+        const std::unordered_set<std::string> * m_materialNames = nullptr;
+        bool m_isSkippingMaterial = false;
         std::vector<std::unique_ptr<MaterialData>> m_materials;
     };
 }
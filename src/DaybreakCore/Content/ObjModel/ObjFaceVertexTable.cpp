@@ -0,0 +1,172 @@
+#include "stdafx.h"
+#include "ObjFaceVertexTable.h"
+#include "Content/ObjModel/ObjModelParser.h"
+
+#include <algorithm>
+
+using namespace Daybreak;
+
+namespace
+{
+    // Keep the table at most 3/4 full so probe sequences stay short.
+    const size_t MaxLoadNumerator = 3;
+    const size_t MaxLoadDenominator = 4;
+    const size_t MinSlotCount = 16;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    uint64_t mix64(uint64_t x) noexcept
+    {
+        // Finalizer from MurmurHash3, every input bit affects every output bit.
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdull;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ull;
+        x ^= x >> 33;
+        return x;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    size_t slotCountFor(size_t count) noexcept
+    {
+        size_t slotCount = MinSlotCount;
+
+        while (slotCount * MaxLoadNumerator / MaxLoadDenominator < count)
+        {
+            slotCount *= 2;
+        }
+
+        return slotCount;
+    }
+
+    /** Face vertex and the position it was used at, for sort based deduplication. */
+    struct sort_entry_t
+    {
+        int32_t p;
+        int32_t t;
+        int32_t n;
+        uint32_t position;
+    };
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+uint64_t Daybreak::hashFaceVertex(const obj_face_vertex_t& v) noexcept
+{
+    // Mix the position and texture index together as one 64 bit value, then fold in the normal index and mix again so
+    // that all 96 bits of the key contribute to the result.
+    const auto pt = (static_cast<uint64_t>(static_cast<uint32_t>(v.p)) << 32) | static_cast<uint32_t>(v.t);
+    return mix64(mix64(pt) ^ (static_cast<uint64_t>(static_cast<uint32_t>(v.n)) * 0x9e3779b97f4a7c15ull));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+ObjFaceVertexTable::ObjFaceVertexTable(size_t expectedCount)
+{
+    rehash(slotCountFor(expectedCount));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::pair<uint32_t, bool> ObjFaceVertexTable::findOrInsert(const obj_face_vertex_t& key, uint32_t newIndex)
+{
+    if (m_count >= m_growThreshold)
+    {
+        rehash(m_slots.size() * 2);
+    }
+
+    auto i = static_cast<size_t>(hashFaceVertex(key)) & m_mask;
+
+    for (;;)
+    {
+        auto& slot = m_slots[i];
+
+        if (slot.p == 0)
+        {
+            slot = { key.p, key.t, key.n, newIndex };
+            m_count++;
+
+            return { newIndex, true };
+        }
+        else if (slot.p == key.p && slot.t == key.t && slot.n == key.n)
+        {
+            return { slot.value, false };
+        }
+
+        i = (i + 1) & m_mask;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjFaceVertexTable::rehash(size_t slotCount)
+{
+    std::vector<slot_t> oldSlots(slotCount, slot_t{ 0, 0, 0, 0 });
+    std::swap(oldSlots, m_slots);
+
+    m_mask = slotCount - 1;
+    m_growThreshold = slotCount * MaxLoadNumerator / MaxLoadDenominator;
+    m_count = 0;
+
+    for (const auto& slot : oldSlots)
+    {
+        if (slot.p != 0)
+        {
+            findOrInsert(obj_face_vertex_t{ slot.p, slot.t, slot.n }, slot.value);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void Daybreak::sortDeduplicateFaceVertices(
+    const std::vector<obj_face_vertex_t>& faceVertices,
+    std::vector<uint32_t>& indices,
+    std::vector<obj_face_vertex_t>& uniqueVertices)
+{
+    const auto count = faceVertices.size();
+
+    // Sort a copy of every face vertex along with its position, breaking ties by position so the first entry of each
+    // run of equal keys is the first use of that key. Entries are sorted directly (rather than sorting positions that
+    // point into faceVertices) so comparisons never chase pointers.
+    std::vector<sort_entry_t> entries(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& v = faceVertices[i];
+        entries[i] = { v.p, v.t, v.n, static_cast<uint32_t>(i) };
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const sort_entry_t& a, const sort_entry_t& b) {
+        if (a.p != b.p) { return a.p < b.p; }
+        if (a.t != b.t) { return a.t < b.t; }
+        if (a.n != b.n) { return a.n < b.n; }
+        return a.position < b.position;
+    });
+
+    // Point every face vertex at the first use of its key.
+    std::vector<uint32_t> firstUse(count);
+    uint32_t runFirstUse = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& entry = entries[i];
+
+        if (i == 0 || entry.p != entries[i - 1].p || entry.t != entries[i - 1].t || entry.n != entries[i - 1].n)
+        {
+            runFirstUse = entry.position;
+        }
+
+        firstUse[entry.position] = runFirstUse;
+    }
+
+    // Assign vertex indices in first use order. A first use always comes before the face vertices that refer to it.
+    indices.resize(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (firstUse[i] == i)
+        {
+            indices[i] = static_cast<uint32_t>(uniqueVertices.size());
+            uniqueVertices.push_back(faceVertices[i]);
+        }
+        else
+        {
+            indices[i] = indices[firstUse[i]];
+        }
+    }
+}
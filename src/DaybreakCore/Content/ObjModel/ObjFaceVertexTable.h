@@ -0,0 +1,67 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace Daybreak
+{
+    struct obj_face_vertex_t;
+
+    /** Hash all 96 bits of an obj face vertex (position, texture and normal index). */
+    uint64_t hashFaceVertex(const obj_face_vertex_t& v) noexcept;
+
+    /**
+     * Flat open addressing (linear probing) hash table that maps obj face vertices to output vertex indices. Keys and
+     * values are stored inline in one array so a lookup usually touches a single cache line, and inserting is done
+     * with the same probe as the lookup.
+     */
+    class ObjFaceVertexTable
+    {
+    public:
+        /** Constructor. Sizes the table to hold expectedCount vertices without growing. */
+        explicit ObjFaceVertexTable(size_t expectedCount = 0);
+
+        /**
+         * Get the index stored for a face vertex, or store newIndex if the face vertex is not in the table. Returns
+         * the stored index and true if newIndex was inserted.
+         */
+        std::pair<uint32_t, bool> findOrInsert(const obj_face_vertex_t& key, uint32_t newIndex);
+
+        /** Get the number of face vertices in the table. */
+        size_t size() const noexcept { return m_count; }
+
+        /** Get the number of slots in the table. */
+        size_t capacity() const noexcept { return m_slots.size(); }
+
+    private:
+        /** Key and value. Obj indices are one based so a position index of zero marks an empty slot. */
+        struct slot_t
+        {
+            int32_t p;
+            int32_t t;
+            int32_t n;
+            uint32_t value;
+        };
+
+        /** Resize the table to the given number of slots (a power of two) and reinsert every entry. */
+        void rehash(size_t slotCount);
+
+    private:
+        std::vector<slot_t> m_slots;
+        size_t m_mask = 0;
+        size_t m_count = 0;
+        size_t m_growThreshold = 0;
+    };
+
+    /**
+     * Deduplicate face vertices by sorting rather than hashing. For every face vertex in faceVertices this writes the
+     * index of the unique vertex it maps to in indices, and appends each unique face vertex to uniqueVertices in
+     * first use order. The result is identical to inserting every face vertex into an ObjFaceVertexTable in order,
+     * but the work is done with sorts and linear passes over arrays instead of random probes into a table, which
+     * scales better for very large meshes whose table would not fit in cache.
+     */
+    void sortDeduplicateFaceVertices(
+        const std::vector<obj_face_vertex_t>& faceVertices,
+        std::vector<uint32_t>& indices,
+        std::vector<obj_face_vertex_t>& uniqueVertices);
+}
@@ -1,14 +1,176 @@
 #include "stdafx.h"
 #include "ObjModelParser.h"
 #include "Utility/TextUtils.h"
+#include "Utility/ParallelFor.h"
 #include "Content/ObjModel/ObjModelException.h"
+#include "Content/ObjModel/IObjModelVisitor.h"
 #include "Content/ObjModel/TextParsingUtils.h"
 #include "Common/Error.h"
 
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <thread>
+
 using namespace Daybreak;
 using namespace Daybreak::TextUtils;
 
 const std::string ObjModelParser::DefaultGroupName = "Default";
+const size_t ObjModelParser::DefaultMinChunkSize = 4 * 1024 * 1024;
+const size_t ObjModelParser::DefaultStreamBlockSize = 1024 * 1024;
+
+//---------------------------------------------------------------------------------------------------------------------
+struct ObjModelParser::group_command_t
+{
+    enum class Type
+    {
+        Group,
+        Object,
+        Material,
+        SmoothingGroup
+    };
+
+    Type type;
+    std::string name;
+    size_t lineNumber;
+    size_t faceIndex;           ///< Number of faces in the chunk that precede the command.
+    uint32_t smoothingGroup;    ///< Smoothing group of a smoothing group command, zero when smoothing is off.
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+struct ObjModelParser::chunk_t
+{
+    // Input.
+    std::string_view text;
+    size_t firstLineNumber = 1;
+    size_t positionBase = 0;    ///< Number of positions defined in earlier chunks.
+    size_t uvBase = 0;          ///< Number of texture coordinates defined in earlier chunks.
+    size_t normalBase = 0;      ///< Number of normals defined in earlier chunks.
+
+    // Scan results.
+    size_t lineCount = 0;
+    size_t positionCount = 0;
+    size_t uvCount = 0;
+    size_t normalCount = 0;
+
+    // Face data layout. Found by the scan, or by the first face if the chunk was not scanned.
+    bool isLayoutKnown = false;
+    bool hasUV = false;
+    bool hasNormals = false;
+
+    // Parse results.
+    size_t lineNumber = 0;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uv;
+    std::vector<glm::vec3> normals;
+    std::vector<obj_face_t> faces;
+    std::vector<group_command_t> groupCommands;
+    std::vector<std::string> materialLibraries;
+
+    /** Face with more than three elements that is waiting to be ear clipped. */
+    struct polygon_t
+    {
+        size_t firstFace;       ///< Index of the first of the polygon's fan triangles in faces.
+        size_t firstCorner;     ///< Index of the first corner in polygonCorners.
+        size_t cornerCount;
+    };
+
+    std::vector<obj_face_vertex_t> faceElements;    ///< Scratch space for the elements of the face being read.
+    std::vector<obj_face_vertex_t> polygonCorners;
+    std::vector<polygon_t> polygons;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    /**
+     * Run func on every chunk with up to maxWorkerCount threads, and rethrow the error of the earliest chunk that
+     * failed so parallel parses report the same error as a front to back parse.
+     */
+    template<typename T, typename TFunc>
+    void parallelForEachChunk(std::vector<T>& chunks, size_t maxWorkerCount, TFunc func)
+    {
+        std::vector<std::exception_ptr> errors(chunks.size());
+
+        parallelFor(chunks.size(), maxWorkerCount, [&](size_t i)
+        {
+            try
+            {
+                func(chunks[i]);
+            }
+            catch (...)
+            {
+                errors[i] = std::current_exception();
+            }
+        });
+
+        for (auto& error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    /** Append elements from source to the end of destination, moving the whole vector when destination is empty. */
+    template<typename T>
+    void appendMoved(std::vector<T>& destination, std::vector<T>& source)
+    {
+        if (destination.empty())
+        {
+            destination = std::move(source);
+        }
+        else
+        {
+            destination.insert(destination.end(), source.begin(), source.end());
+        }
+    }
+
+    /** Consume and return the next token from arguments as a smoothing group, where "off" is smoothing group zero. */
+    uint32_t readSmoothingGroup(TextUtils::StringSplitter& arguments)
+    {
+        const auto smoothingGroup = readExpectedString(arguments);
+
+        if (smoothingGroup == "off")
+        {
+            return 0;
+        }
+
+        const auto group = parseInt(smoothingGroup);
+
+        if (group < 0)
+        {
+            throw std::runtime_error("Smoothing group must be a positive number or off");
+        }
+
+        return static_cast<uint32_t>(group);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+ObjModelParser::ObjModelParser()
+{
+    setMaxWorkerCount(std::thread::hardware_concurrency());
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjModelParser::setMaxWorkerCount(size_t count) noexcept
+{
+    m_maxWorkerCount = std::max<size_t>(count, 1);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjModelParser::setMinChunkSize(size_t bytes) noexcept
+{
+    m_minChunkSize = std::max<size_t>(bytes, 1);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjModelParser::setStreamBlockSize(size_t bytes) noexcept
+{
+    m_streamBlockSize = std::max<size_t>(bytes, 1);
+}
 
 //---------------------------------------------------------------------------------------------------------------------
 std::unique_ptr<obj_model_t> ObjModelParser::parse(const std::string_view& objData, const std::string& fileName)
@@ -19,21 +181,442 @@ std::unique_ptr<obj_model_t> ObjModelParser::parse(const std::string_view& objDa
     // Create a default starting group for faces.
     m_model->groups.push_back(obj_group_t(DefaultGroupName));
 
+    // Split the obj text into line aligned chunks. Small files end up as a single chunk that is parsed on the calling
+    // thread.
+    auto chunkText = splitIntoChunks(objData);
+    std::vector<chunk_t> chunks(chunkText.size());
+
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        chunks[i].text = chunkText[i];
+    }
+
+    if (chunks.size() == 1)
+    {
+        parseChunk(chunks[0]);
+    }
+    else
+    {
+        // Scan every chunk first to learn how many lines and v/vt/vn elements come before each chunk. Workers need
+        // this to report the same line numbers and resolve negative indices exactly like a front to back parse.
+        parallelForEachChunk(chunks, m_maxWorkerCount, [this](chunk_t& chunk) { scanChunk(chunk); });
+
+        const chunk_t * firstChunkWithFaces = nullptr;
+
+        for (size_t i = 1; i < chunks.size(); ++i)
+        {
+            const auto& previous = chunks[i - 1];
+
+            chunks[i].firstLineNumber = previous.firstLineNumber + previous.lineCount;
+            chunks[i].positionBase = previous.positionBase + previous.positionCount;
+            chunks[i].uvBase = previous.uvBase + previous.uvCount;
+            chunks[i].normalBase = previous.normalBase + previous.normalCount;
+        }
+
+        for (const auto& chunk : chunks)
+        {
+            if (chunk.isLayoutKnown)
+            {
+                firstChunkWithFaces = &chunk;
+                break;
+            }
+        }
+
+        // The first face in the file decides the face data layout for every chunk.
+        if (firstChunkWithFaces != nullptr)
+        {
+            auto hasUV = firstChunkWithFaces->hasUV;
+            auto hasNormals = firstChunkWithFaces->hasNormals;
+
+            for (auto& chunk : chunks)
+            {
+                chunk.isLayoutKnown = true;
+                chunk.hasUV = hasUV;
+                chunk.hasNormals = hasNormals;
+            }
+        }
+
+        parallelForEachChunk(chunks, m_maxWorkerCount, [this](chunk_t& chunk) { parseChunk(chunk); });
+    }
+
+    // Stitch the chunks together in file order.
+    for (auto& chunk : chunks)
+    {
+        mergeChunk(chunk);
+    }
+
+    return std::move(m_model);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<std::string_view> ObjModelParser::splitIntoChunks(const std::string_view& objData) const
+{
+    const auto size = objData.size();
+    const auto chunkCount = std::max<size_t>(std::min(m_maxWorkerCount, size / m_minChunkSize), 1);
+
+    std::vector<std::string_view> chunks;
+    chunks.reserve(chunkCount);
+
+    // Move each evenly spaced split point forward to the start of the next line.
+    size_t start = 0;
+
+    for (size_t i = 1; i < chunkCount; ++i)
+    {
+        auto newline = objData.find('\n', std::max(start, i * (size / chunkCount)));
+
+        if (newline == std::string_view::npos)
+        {
+            break;
+        }
+
+        chunks.push_back(objData.substr(start, newline + 1 - start));
+        start = newline + 1;
+    }
+
+    if (start < size || chunks.empty())
+    {
+        chunks.push_back(objData.substr(start));
+    }
+
+    return chunks;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjModelParser::scanChunk(chunk_t& chunk) const
+{
+    StringLineReader lineReader(chunk.text, '#');
+
+    while (lineReader.hasNextLine())
+    {
+        auto line = lineReader.readNextLine();
+        chunk.lineCount++;
+
+        if (isWhitespace(line))
+        {
+            continue;
+        }
+
+        StringSplitter splitter(line, " \t", true);
+        auto command = splitter.readNextToken();
+
+        if (command == "v")
+        {
+            chunk.positionCount++;
+        }
+        else if (command == "vt")
+        {
+            chunk.uvCount++;
+        }
+        else if (command == "vn")
+        {
+            chunk.normalCount++;
+        }
+        else if (command == "f" && !chunk.isLayoutKnown && splitter.hasNextToken())
+        {
+            // Only the first face element matters, readFace checks the rest when the chunk is parsed.
+            std::string_view parts[3];
+            auto partCount = splitFaceElement(splitter.readNextToken(), parts);
+
+            chunk.hasUV = partCount > 1 && parts[1].size() > 0;
+            chunk.hasNormals = partCount > 2 && parts[2].size() > 0;
+            chunk.isLayoutKnown = true;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjModelParser::parseChunk(chunk_t& chunk) const
+{
+    chunk.positions.reserve(chunk.positionCount);
+    chunk.uv.reserve(chunk.uvCount);
+    chunk.normals.reserve(chunk.normalCount);
+
     // Read the obj model data line by line (ignoring comments).
-    StringLineReader lineReader(objData, '#');
+    StringLineReader lineReader(chunk.text, '#');
+    chunk.lineNumber = chunk.firstLineNumber;
 
     while (lineReader.hasNextLine())
     {
-        parseLine(lineReader.readNextLine());
-        m_lineNumber++;
+        parseLine(chunk, lineReader.readNextLine());
+        chunk.lineNumber++;
     }
+}
 
-    return std::move(m_model);
+//---------------------------------------------------------------------------------------------------------------------
+void ObjModelParser::mergeChunk(chunk_t& chunk)
+{
+    appendMoved(m_model->positions, chunk.positions);
+    appendMoved(m_model->uv, chunk.uv);
+    appendMoved(m_model->normals, chunk.normals);
+    appendMoved(m_model->materialLibraries, chunk.materialLibraries);
+
+    earClipPolygons(chunk);
+
+    if (chunk.isLayoutKnown)
+    {
+        m_model->hasUV = chunk.hasUV;
+        m_model->hasNormals = chunk.hasNormals;
+    }
+
+    // Faces are added to whatever group is current when they are reached, so replay the group commands and add the
+    // faces between them in the same order they were read.
+    const auto faceCount = chunk.faces.size();
+    size_t nextFace = 0;
+
+    auto addFacesUntil = [&](size_t faceIndex) {
+        if (faceIndex == nextFace)
+        {
+            return;
+        }
+
+        // Faces are parsed before the smoothing group in effect at the start of the chunk is known.
+        if (m_activeSmoothingGroup != 0)
+        {
+            for (auto face = nextFace; face < faceIndex; ++face)
+            {
+                chunk.faces[face].smoothingGroup = m_activeSmoothingGroup;
+            }
+        }
+
+        auto& faces = currentGroup().faces;
+
+        if (faces.empty() && nextFace == 0 && faceIndex == faceCount)
+        {
+            faces = std::move(chunk.faces);
+        }
+        else
+        {
+            faces.insert(faces.end(), chunk.faces.begin() + nextFace, chunk.faces.begin() + faceIndex);
+        }
+
+        nextFace = faceIndex;
+    };
+
+    for (const auto& command : chunk.groupCommands)
+    {
+        addFacesUntil(command.faceIndex);
+        applyGroupCommand(command);
+    }
+
+    addFacesUntil(faceCount);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjModelParser::parseStream(std::istream& stream, IObjModelVisitor& visitor, const std::string& fileName)
+{
+    // Polygons can refer to any position before them, so ear clipping would need every position kept in memory.
+    if (m_triangulation == ObjTriangulation::EarClipping)
+    {
+        throw DaybreakEngineException(
+            "Obj files cannot be streamed with ear clipping triangulation",
+            "Use fan triangulation when streaming, or parse the whole file instead");
+    }
+
+    reset();
+    m_fileName = fileName;
+
+    // Create a default starting group for faces. Only the group names and materials are kept in the model when
+    // streaming, the faces go straight to the visitor.
+    m_model->groups.push_back(obj_group_t(DefaultGroupName));
+
+    // Each block is parsed as a chunk that carries line numbers, index bases and the face layout forward from the
+    // blocks before it.
+    std::vector<char> buffer(m_streamBlockSize);
+    size_t bufferSize = 0;
+    chunk_t chunk;
+
+    for (;;)
+    {
+        // Grow the buffer if a single line does not fit in it.
+        if (bufferSize == buffer.size())
+        {
+            buffer.resize(buffer.size() * 2);
+        }
+
+        stream.read(buffer.data() + bufferSize, static_cast<std::streamsize>(buffer.size() - bufferSize));
+        bufferSize += static_cast<size_t>(stream.gcount());
+
+        const bool isEndOfStream = stream.eof();
+
+        if (!isEndOfStream && stream.fail())
+        {
+            throw ObjModelException("Failed to read from obj stream", m_fileName, chunk.firstLineNumber, "", "");
+        }
+
+        // Only parse up to the end of the last complete line. The partial line that crosses into the next block is
+        // kept and parsed once the rest of it has been read.
+        std::string_view text(buffer.data(), bufferSize);
+        size_t blockSize = bufferSize;
+
+        if (!isEndOfStream)
+        {
+            auto lastNewline = text.rfind('\n');
+            blockSize = (lastNewline == std::string_view::npos ? 0 : lastNewline + 1);
+        }
+
+        if (blockSize > 0)
+        {
+            chunk.text = text.substr(0, blockSize);
+            parseChunk(chunk);
+            visitChunk(chunk, visitor);
+
+            chunk.firstLineNumber = chunk.lineNumber;
+            chunk.positionBase += chunk.positions.size();
+            chunk.uvBase += chunk.uv.size();
+            chunk.normalBase += chunk.normals.size();
+
+            chunk.positions.clear();
+            chunk.uv.clear();
+            chunk.normals.clear();
+            chunk.faces.clear();
+            chunk.groupCommands.clear();
+            chunk.materialLibraries.clear();
+            chunk.polygonCorners.clear();
+            chunk.polygons.clear();
+
+            std::copy(buffer.begin() + blockSize, buffer.begin() + bufferSize, buffer.begin());
+            bufferSize -= blockSize;
+        }
+
+        if (isEndOfStream)
+        {
+            break;
+        }
+    }
+
+    m_model.reset();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void ObjModelParser::parseLine(const std::string_view& line)
+void ObjModelParser::visitChunk(chunk_t& chunk, IObjModelVisitor& visitor)
 {
+    // Vertex data is visited before faces so that every index in a face refers to data the visitor has already seen.
+    for (const auto& position : chunk.positions)
+    {
+        visitor.visitPosition(position);
+    }
+
+    for (const auto& uv : chunk.uv)
+    {
+        visitor.visitUV(uv);
+    }
+
+    for (const auto& normal : chunk.normals)
+    {
+        visitor.visitNormal(normal);
+    }
+
+    for (const auto& materialLibrary : chunk.materialLibraries)
+    {
+        visitor.visitMaterialLibrary(materialLibrary);
+    }
+
+    // Replay the group commands between faces like mergeChunk. A group is reported just before its first face since
+    // its name and material cannot change after that.
+    size_t nextFace = 0;
+
+    auto visitFacesUntil = [&](size_t faceIndex) {
+        for (; nextFace < faceIndex; ++nextFace)
+        {
+            if (!m_currentGroupVisited)
+            {
+                visitor.visitGroup(currentGroup().name, currentGroup().material);
+                m_currentGroupVisited = true;
+            }
+
+            chunk.faces[nextFace].smoothingGroup = m_activeSmoothingGroup;
+            visitor.visitFace(chunk.faces[nextFace]);
+        }
+    };
+
+    for (const auto& command : chunk.groupCommands)
+    {
+        visitFacesUntil(command.faceIndex);
+        applyGroupCommand(command);
+
+        if (command.type == group_command_t::Type::SmoothingGroup)
+        {
+            visitor.visitSmoothingGroup(m_activeSmoothingGroup);
+        }
+    }
+
+    visitFacesUntil(chunk.faces.size());
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjModelParser::earClipPolygons(chunk_t& chunk)
+{
+    for (const auto& polygon : chunk.polygons)
+    {
+        const auto corners = chunk.polygonCorners.data() + polygon.firstCorner;
+
+        m_polygonPositions.clear();
+
+        for (size_t i = 0; i < polygon.cornerCount; ++i)
+        {
+            m_polygonPositions.push_back(m_model->positions[static_cast<size_t>(corners[i].p) - 1]);
+        }
+
+        m_triangulator.earClip(m_polygonPositions.data(), polygon.cornerCount, m_polygonTriangles);
+
+        // Ear clipping makes the same number of triangles as the fan, so overwrite the fan triangles in place.
+        for (size_t t = 0; t + 2 < polygon.cornerCount; ++t)
+        {
+            auto& face = chunk.faces[polygon.firstFace + t];
+
+            for (size_t j = 0; j < 3; ++j)
+            {
+                const auto& corner = corners[m_polygonTriangles[t * 3 + j]];
+
+                face.position[j] = corner.p;
+                face.uv[j] = corner.t;
+                face.normal[j] = corner.n;
+            }
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjModelParser::applyGroupCommand(const group_command_t& command)
+{
+    using command_type_t = group_command_t::Type;
+
+    try
+    {
+        switch (command.type)
+        {
+        case command_type_t::Group:
+            useGroupName(command.name);
+            break;
+        case command_type_t::Object:
+            useObjectName(command.name);
+            break;
+        case command_type_t::Material:
+            useMaterial(command.name);
+            break;
+        case command_type_t::SmoothingGroup:
+            useSmoothingGroup(command.smoothingGroup);
+            break;
+        default:
+            THROW_ENUM_SWITCH_NOT_HANDLED(command_type_t, command.type);
+        }
+    }
+    catch (const std::runtime_error& e)
+    {
+        const char * commandName =
+            (command.type == command_type_t::Group ? "g" :
+                (command.type == command_type_t::Object ? "o" :
+                    (command.type == command_type_t::Material ? "usemtl" : "s")));
+
+        throw ObjModelException(e.what(), m_fileName, command.lineNumber, commandName, "");
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjModelParser::parseLine(chunk_t& chunk, const std::string_view& line) const
+{
+    using command_type_t = group_command_t::Type;
+
     // Skip lines that are entirely empty space.
     if (isWhitespace(line))
     {
@@ -49,52 +632,61 @@ void ObjModelParser::parseLine(const std::string_view& line)
     {
         if (command == "v")
         {
-            m_model->positions.push_back({
+            chunk.positions.push_back({
                 readExpectedFloat(splitter),
                 readExpectedFloat(splitter),
                 readExpectedFloat(splitter) });
         }
         else if (command == "vt")
         {
-            m_model->uv.push_back({
+            chunk.uv.push_back({
                 readExpectedFloat(splitter),
                 readExpectedFloat(splitter) });
         }
         else if (command == "vn")
         {
-            m_model->normals.push_back({
+            chunk.normals.push_back({
                 readExpectedFloat(splitter),
                 readExpectedFloat(splitter),
                 readExpectedFloat(splitter) });
         }
         else if (command == "f")
         {
-            currentGroup().faces.push_back(readFace(splitter));
+            readFace(chunk, splitter);
         }
         else if (command == "g")
         {
-            useGroupName(readExpectedString(splitter));
+            chunk.groupCommands.push_back(
+                { command_type_t::Group, readExpectedString(splitter), chunk.lineNumber, chunk.faces.size(), 0 });
         }
         else if (command == "o")
         {
-            useObjectName(readExpectedString(splitter));
+            chunk.groupCommands.push_back(
+                { command_type_t::Object, readExpectedString(splitter), chunk.lineNumber, chunk.faces.size(), 0 });
         }
         else if (command == "usemtl")
         {
-            useMaterial(readExpectedString(splitter));
+            chunk.groupCommands.push_back(
+                { command_type_t::Material, readExpectedString(splitter), chunk.lineNumber, chunk.faces.size(), 0 });
+        }
+        else if (command == "s")
+        {
+            const auto smoothingGroup = readSmoothingGroup(splitter);
+            chunk.groupCommands.push_back(
+                { command_type_t::SmoothingGroup, "", chunk.lineNumber, chunk.faces.size(), smoothingGroup });
         }
         else if (command == "mtllib")
         {
-            m_model->materialLibraries.push_back(readExpectedString(splitter));
+            chunk.materialLibraries.push_back(readExpectedString(splitter));
         }
         else
         {
-            throw ObjModelException("Unknown obj command", m_fileName, m_lineNumber, "", "");
+            throw ObjModelException("Unknown obj command", m_fileName, chunk.lineNumber, "", "");
         }
     }
     catch (const std::runtime_error& e)
     {
-        throw ObjModelException(e.what(), m_fileName, m_lineNumber, command.data(), "");
+        throw ObjModelException(e.what(), m_fileName, chunk.lineNumber, std::string(command), "");
     }
 }
 
@@ -102,12 +694,12 @@ void ObjModelParser::parseLine(const std::string_view& line)
 void ObjModelParser::reset() noexcept
 {
     m_model.reset(new obj_model_t);
-    m_lineNumber = 1;
     m_fileName = "";
     m_activeObjectName = "";
     m_activeGroupName = "";
     m_activeMaterialName = "";
-    m_firstFace = true;
+    m_activeSmoothingGroup = 0;
+    m_currentGroupVisited = false;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -116,6 +708,12 @@ obj_group_t& ObjModelParser::currentGroup() noexcept
     return m_model->groups[m_model->groups.size() - 1];
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+bool ObjModelParser::currentGroupHasFaces() const noexcept
+{
+    return !m_model->groups.back().faces.empty() || m_currentGroupVisited;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 void ObjModelParser::useGroupName(const std::string& groupName)
 {
@@ -146,7 +744,7 @@ void ObjModelParser::startObjectGroupName()
     // if it does not already have a name.
     auto mergedName = createMergedObjectGroupName(m_activeObjectName, m_activeGroupName);
 
-    if (currentGroup().faces.size() == 0)
+    if (!currentGroupHasFaces())
     {
         currentGroup().name = mergedName;
     }
@@ -165,7 +763,7 @@ void ObjModelParser::useMaterial(const std::string& materialName)
     // property.
     m_activeMaterialName = materialName;
 
-    if (currentGroup().faces.size() == 0)
+    if (!currentGroupHasFaces())
     {
         // TODO: Warn if there was a material already set.
         currentGroup().material = materialName;
@@ -179,10 +777,19 @@ void ObjModelParser::useMaterial(const std::string& materialName)
     }
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+void ObjModelParser::useSmoothingGroup(uint32_t smoothingGroup) noexcept
+{
+    m_activeSmoothingGroup = smoothingGroup;
+    m_model->hasSmoothingGroups = true;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 obj_group_t& ObjModelParser::createNewGroup(const std::string& name)
 {    
     m_model->groups.push_back(obj_group_t(name));
+    m_currentGroupVisited = false;
+
     return m_model->groups[m_model->groups.size() - 1];
 }
 
@@ -218,60 +825,83 @@ std::string ObjModelParser::createMergedObjectGroupName(
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-obj_face_t ObjModelParser::readFace(Daybreak::TextUtils::StringSplitter& arguments)
+void ObjModelParser::readFace(chunk_t& chunk, Daybreak::TextUtils::StringSplitter& arguments) const
 {
-    // TODO: Handle face commands with more than three arguments by using the following:
-    //  face (0, i, i + 1) [for i in 1..(n - 2)]
-    // ref: http://stackoverflow.com/a/23724231
+    // Read every face element into the chunk's scratch buffer, which is reused for all faces in the chunk.
+    auto& elements = chunk.faceElements;
+    elements.clear();
+
+    do
+    {
+        // Field names are the element index, formatted without allocating.
+        char field[24] = {};
+        std::to_chars(field, field + sizeof(field) - 1, elements.size());
 
-    // Read first three face elements.
-    //  TODO: Handle face commands with more than three elments. Do not split it up here, instead add ability to have
-    //        obj_faces with more than three elements and update the obj -> model code to handle conversion.
-    auto a = resolveIndices(readFaceElement(arguments, "f", "0"), "f", "0");
-    auto b = resolveIndices(readFaceElement(arguments, "f", "1"), "f", "1");
-    auto c = resolveIndices(readFaceElement(arguments, "f", "2"), "f", "2");
+        elements.push_back(resolveIndices(chunk, readFaceElement(chunk, arguments, "f", field), "f", field));
+    } while (elements.size() < 3 || arguments.hasNextToken());
 
-    if (m_firstFace)
+    if (!chunk.isLayoutKnown)
     {
-        m_model->hasUV = a.hasUV();
-        m_model->hasNormals = a.hasNormals();
+        chunk.hasUV = elements[0].hasUV();
+        chunk.hasNormals = elements[0].hasNormals();
 
-        m_firstFace = false;
+        chunk.isLayoutKnown = true;
     }
 
     // Check that face elements have the same data types as previous faces in this model.
-    if (m_model->hasUV != a.hasUV() || m_model->hasNormals != a.hasNormals() ||
-        m_model->hasUV != b.hasUV() || m_model->hasNormals != b.hasNormals() ||
-        m_model->hasUV != c.hasUV() || m_model->hasNormals != c.hasNormals())
+    for (const auto& element : elements)
     {
-        throw ObjModelException(
-            "Face elements have inconsistent data layout",
-            m_fileName,
-            m_lineNumber,
-            "f",
-            "");
+        if (chunk.hasUV != element.hasUV() || chunk.hasNormals != element.hasNormals())
+        {
+            throw ObjModelException(
+                "Face elements have inconsistent data layout",
+                m_fileName,
+                chunk.lineNumber,
+                "f",
+                "");
+        }
     }
 
-    return { { a.p, b.p, c.p }, { a.t, b.t, c.t }, { a.n, b.n, c.n } };
+    // Split the face into a fan of triangles (0, i, i + 1). When ear clipping is enabled polygons are remembered so
+    // that the fan can be replaced once the positions of every corner are known.
+    if (elements.size() > 3 && m_triangulation == ObjTriangulation::EarClipping)
+    {
+        chunk.polygons.push_back({ chunk.faces.size(), chunk.polygonCorners.size(), elements.size() });
+        chunk.polygonCorners.insert(chunk.polygonCorners.end(), elements.begin(), elements.end());
+    }
+
+    const auto& a = elements[0];
+
+    for (size_t i = 1; i + 1 < elements.size(); ++i)
+    {
+        const auto& b = elements[i];
+        const auto& c = elements[i + 1];
+
+        chunk.faces.push_back({ { a.p, b.p, c.p }, { a.t, b.t, c.t }, { a.n, b.n, c.n } });
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 obj_face_vertex_t ObjModelParser::resolveIndices(
+    const chunk_t& chunk,
     const obj_face_vertex_t& element,
     const char * command,
     const char * field) const
 {
     obj_face_vertex_t result;
 
-    result.p = relativeToAbsoluteIndex(element.p, m_model->positions.size(), command, field);
-    result.t = relativeToAbsoluteIndex(element.t, m_model->uv.size(), command, field);
-    result.n = relativeToAbsoluteIndex(element.n, m_model->normals.size(), command, field);
+    // Indices are relative to all the data defined so far in the file, not just the data in this chunk.
+    result.p = relativeToAbsoluteIndex(
+        chunk, element.p, chunk.positionBase + chunk.positions.size(), command, field);
+    result.t = relativeToAbsoluteIndex(chunk, element.t, chunk.uvBase + chunk.uv.size(), command, field);
+    result.n = relativeToAbsoluteIndex(chunk, element.n, chunk.normalBase + chunk.normals.size(), command, field);
 
     return result;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 int ObjModelParser::relativeToAbsoluteIndex(
+    const chunk_t& chunk,
     int relativeIndex,
     size_t arrayLength,
     const char * command,
@@ -284,7 +914,7 @@ int ObjModelParser::relativeToAbsoluteIndex(
         throw ObjModelException(
             "Obj data array size is too large for converter (fix this!)",
             m_fileName,
-            m_lineNumber,
+            chunk.lineNumber,
             command,
             field);
     }
@@ -305,7 +935,7 @@ int ObjModelParser::relativeToAbsoluteIndex(
         throw ObjModelException(
             "Index must be smaller than size of data array",
             m_fileName,
-            m_lineNumber,
+            chunk.lineNumber,
             command,
             field);
     }
@@ -315,6 +945,7 @@ int ObjModelParser::relativeToAbsoluteIndex(
 
 //---------------------------------------------------------------------------------------------------------------------
 obj_face_vertex_t ObjModelParser::readFaceElement(
+    const chunk_t& chunk,
     Daybreak::TextUtils::StringSplitter& arguments,
     const char * command,
     const char * field) const
@@ -324,66 +955,56 @@ obj_face_vertex_t ObjModelParser::readFaceElement(
         obj_face_vertex_t element;
 
         // Split the face token into each part p/t/n and make sure empty tokens are not skipped.
-        auto faceToken = arguments.readNextToken();
-        StringSplitter splitter(faceToken, "/", false);
-         
+        std::string_view parts[3];
+        auto partCount = splitFaceElement(arguments.readNextToken(), parts);
+
         // Read position index.
-        if (splitter.hasNextToken())
+        if (partCount > 0)
         {
-            auto p = parseInt(splitter.readNextToken());
+            auto p = parseInt(parts[0]);
 
             if (p == 0)
             {
-                throw ObjModelException("Invalid index of zero", m_fileName, m_lineNumber, command, field);
+                throw ObjModelException("Invalid index of zero", m_fileName, chunk.lineNumber, command, field);
             }
 
             element.p = p;
         }
         else
         {
-            throw ObjModelException("Missing face position element", m_fileName, m_lineNumber, command, field);
+            throw ObjModelException("Missing face position element", m_fileName, chunk.lineNumber, command, field);
         }
 
         // Try to read texture index (if it exists).
-        if (splitter.hasNextToken())
+        if (partCount > 1 && parts[1].size() > 0)
         {
-            auto token = splitter.readNextToken();
+            auto t = parseInt(parts[1]);
 
-            if (token.size() > 0)
+            if (t == 0)
             {
-                auto t = parseInt(token);
-
-                if (t == 0)
-                {
-                    throw ObjModelException("Invalid index of zero", m_fileName, m_lineNumber, command, field);
-                }
-
-                element.t = t;
+                throw ObjModelException("Invalid index of zero", m_fileName, chunk.lineNumber, command, field);
             }
+
+            element.t = t;
         }
 
         // Try to read normal index (if it exists).
-        if (splitter.hasNextToken())
+        if (partCount > 2 && parts[2].size() > 0)
         {
-            auto token = splitter.readNextToken();
+            auto n = parseInt(parts[2]);
 
-            if (token.size() > 0)
+            if (n == 0)
             {
-                auto n = parseInt(token);
-
-                if (n == 0)
-                {
-                    throw ObjModelException("Invalid index of zero", m_fileName, m_lineNumber, command, field);
-                }
-
-                element.n = n;
+                throw ObjModelException("Invalid index of zero", m_fileName, chunk.lineNumber, command, field);
             }
+
+            element.n = n;
         }
 
         return element;
     }
     else
     {
-        throw ObjModelException("Missing face element", m_fileName, m_lineNumber, command, field);
+        throw ObjModelException("Missing face element", m_fileName, chunk.lineNumber, command, field);
     }
 }
@@ -3,13 +3,16 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <istream>
 #include <glm/glm.hpp>
 
 #include "Utility/TextUtils.h" // TODO: Remove!
+#include "Content/ObjModel/PolygonTriangulator.h"
 
 namespace Daybreak
 {
     class MeshData;
+    class IObjModelVisitor;
 
     /** One vertex in an obj face. Note indices are one based not zero based! */
     struct obj_face_vertex_t
@@ -37,6 +40,7 @@ namespace Daybreak
         int position[3];
         int uv[3];
         int normal[3];
+        uint32_t smoothingGroup = 0;    ///< Smoothing group (s) of the face, zero when smoothing is off.
 
         // TODO: Remove.
         obj_face_vertex_t vertex(size_t index) const
@@ -55,7 +59,8 @@ namespace Daybreak
                 uv[2] == rhs.uv[2] &&
                 normal[0] == rhs.normal[0] &&
                 normal[1] == rhs.normal[1] &&
-                normal[2] == rhs.normal[2];
+                normal[2] == rhs.normal[2] &&
+                smoothingGroup == rhs.smoothingGroup;
         }
     };
 
@@ -83,6 +88,14 @@ namespace Daybreak
 
         bool hasUV = false;
         bool hasNormals = false;
+        bool hasSmoothingGroups = false;    ///< Set if the file has any smoothing group (s) commands.
+    };
+
+    /** How faces with more than three elements are split into triangles. */
+    enum class ObjTriangulation
+    {
+        Fan,                        // Fan out from the first element. Fast, but only correct for convex polygons.
+        EarClipping                 // Clip ears off the polygon. Slower, but also handles concave polygons.
     };
 
     /** Configurable loader for obj models. */
@@ -91,12 +104,87 @@ namespace Daybreak
     public:
         static const std::string DefaultGroupName;
 
+        /** Default minimum number of bytes in a chunk before the parser will split work across threads. */
+        static const size_t DefaultMinChunkSize;
+
+        /** Default number of bytes read from a stream at a time by parseStream. */
+        static const size_t DefaultStreamBlockSize;
+
+        /** Constructor. */
+        ObjModelParser();
+
         /** Return an obj model parsed from the provided obj file text data. */
         std::unique_ptr<obj_model_t> parse(const std::string_view& objData, const std::string& fileName = "");
 
+        /**
+         * Parse obj text from a stream one fixed size block at a time, and pass the model data to a visitor in file
+         * order rather than building an obj model. Memory use is bounded by the block size (or the longest line if it
+         * is longer than a block) instead of the size of the file. Throws DaybreakEngineException when ear clipping
+         * triangulation is set, since ear clipping needs every position in the file.
+         */
+        void parseStream(std::istream& stream, IObjModelVisitor& visitor, const std::string& fileName = "");
+
+        /** Get the maximum number of worker threads used when parsing large obj files. */
+        size_t maxWorkerCount() const noexcept { return m_maxWorkerCount; }
+
+        /** Set the maximum number of worker threads used when parsing large obj files. One disables threading. */
+        void setMaxWorkerCount(size_t count) noexcept;
+
+        /** Get the minimum size (in bytes) of a chunk of obj text handed to a worker thread. */
+        size_t minChunkSize() const noexcept { return m_minChunkSize; }
+
+        /** Set the minimum size (in bytes) of a chunk of obj text handed to a worker thread. */
+        void setMinChunkSize(size_t bytes) noexcept;
+
+        /** Get how faces with more than three elements are split into triangles. */
+        ObjTriangulation triangulation() const noexcept { return m_triangulation; }
+
+        /** Set how faces with more than three elements are split into triangles. */
+        void setTriangulation(ObjTriangulation triangulation) noexcept { m_triangulation = triangulation; }
+
+        /** Get the number of bytes read from a stream at a time by parseStream. */
+        size_t streamBlockSize() const noexcept { return m_streamBlockSize; }
+
+        /** Set the number of bytes read from a stream at a time by parseStream. */
+        void setStreamBlockSize(size_t bytes) noexcept;
+
     private:
+        /** Line aligned span of obj text along with the data parsed from it. */
+        struct chunk_t;
+
+        /** Group, object, material or smoothing group change that must be applied to the model in file order. */
+        struct group_command_t;
+
+        /** Split obj text at line boundaries into one chunk per worker. */
+        std::vector<std::string_view> splitIntoChunks(const std::string_view& objData) const;
+
+        /**
+         * Count the lines and vertex data elements in a chunk, and find the data layout of the first face. This is
+         * the information later chunks need to resolve line numbers and relative indices without the earlier chunks
+         * being parsed first.
+         */
+        void scanChunk(chunk_t& chunk) const;
+
+        /** Parse every line in a chunk. Safe to call concurrently for different chunks. */
+        void parseChunk(chunk_t& chunk) const;
+
+        /** Append data parsed from a chunk to the obj model, replaying group and material changes in file order. */
+        void mergeChunk(chunk_t& chunk);
+
+        /** Pass data parsed from a chunk to a visitor, replaying group and material changes in file order. */
+        void visitChunk(chunk_t& chunk, IObjModelVisitor& visitor);
+
+        /**
+         * Replace the fan triangles of polygons in a chunk with ear clipped triangles. Requires the positions of every
+         * chunk up to and including this one to be in the obj model.
+         */
+        void earClipPolygons(chunk_t& chunk);
+
+        /** Apply a group, object, material or smoothing group change read from a chunk to the parser state. */
+        void applyGroupCommand(const group_command_t& command);
+
         /** Evaluate one line from the obj file. */
-        void parseLine(const std::string_view& line);
+        void parseLine(chunk_t& chunk, const std::string_view& line) const;
 
         /** Reset the state of the parser. */
         void reset() noexcept;
@@ -104,6 +192,9 @@ namespace Daybreak
         /** Get the last created group in the obj model. If none it defaults to the DefaultGroup. */
         obj_group_t& currentGroup() noexcept;
 
+        /** Check if any faces have been added to the current group, including faces passed to a visitor. */
+        bool currentGroupHasFaces() const noexcept;
+
         /**
          * Instruct parser to use the given group name for following faces. This will create a new group with the
          * active object name and this group name if the current group has existing faces.
@@ -129,19 +220,27 @@ namespace Daybreak
          */
         void startObjectGroupName();
 
+        /**
+         * Instruct parser to put following faces in the given smoothing group, where zero turns smoothing off.
+         * Smoothing groups do not start a new group.
+         */
+        void useSmoothingGroup(uint32_t smoothingGroup) noexcept;
+
         /** Adds a new group to the obj model and returns it. */
         obj_group_t& createNewGroup(const std::string& name);
 
         /**
-         * Reads the provided arguments and returns a face element (with absolute one based indices).
+         * Reads the provided arguments and adds the face (with absolute one based indices) to the chunk. Faces with
+         * more than three elements are split into multiple triangles.
          */
-        obj_face_t readFace(Daybreak::TextUtils::StringSplitter& arguments);
+        void readFace(chunk_t& chunk, Daybreak::TextUtils::StringSplitter& arguments) const;
 
         /**
          * Convert a face vertex from relative indices to absolute indices. This maintains the one based index nature
          * of obj indices.
          */
         obj_face_vertex_t resolveIndices( 
+            const chunk_t& chunk,               //< Chunk containing the face.
             const obj_face_vertex_t& element,   //< Face vertex to modify.
             const char * command,               //< Obj command that resulted in this function being called.
             const char * field) const;          //< Obj command field that resulted in this function being called.
@@ -158,6 +257,7 @@ namespace Daybreak
          * method maintains the one based index nature of obj indices.
          */
         int relativeToAbsoluteIndex(
+            const chunk_t& chunk,
             int relativeIndex,
             size_t arrayLength,
             const char * command,
@@ -165,6 +265,7 @@ namespace Daybreak
 
         /** Returns a face vertex parsed from the provided arguments. */
         obj_face_vertex_t readFaceElement(
+            const chunk_t& chunk,                           //< Chunk containing the face.
             Daybreak::TextUtils::StringSplitter& arguments, //< Arguments from face command.
             const char * command,           //< Obj command that resulted in this function being called.
             const char * field) const;      //< Obj command field that resulted in this function being called.
@@ -172,10 +273,17 @@ namespace Daybreak
     private:
         std::unique_ptr<obj_model_t> m_model;
         std::string m_fileName = "";
-        size_t m_lineNumber = 1;
         std::string m_activeObjectName;
         std::string m_activeGroupName;
         std::string m_activeMaterialName;
-        bool m_firstFace = true;
+        uint32_t m_activeSmoothingGroup = 0;
+        size_t m_maxWorkerCount = 1;
+        size_t m_minChunkSize = DefaultMinChunkSize;
+        size_t m_streamBlockSize = DefaultStreamBlockSize;
+        bool m_currentGroupVisited = false;
+        ObjTriangulation m_triangulation = ObjTriangulation::Fan;
+        PolygonTriangulator m_triangulator;
+        std::vector<glm::vec3> m_polygonPositions;
+        std::vector<uint32_t> m_polygonTriangles;
     };
 }
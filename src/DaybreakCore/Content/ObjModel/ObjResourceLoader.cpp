@@ -1,45 +1,168 @@
 #include "stdafx.h"
 #include "ObjResourceLoader.h"
-#include "app/support/hash.h"
 #include "Content/ResourcesManager.h"
+#include "Content/MappedFile.h"
+#include "Content/Models/CookedModelFile.h"
+#include "Common/Error.h"
 #include "Content/ObjModel/ObjModelParser.h"
 #include "Content\Models\ModelData.h"
 #include "Content\Materials\MaterialData.h"
 #include "Content\ObjModel\MtlMaterialParser.h"
 #include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
 #include "Graphics/Mesh/VertexBufferData.h"
 #include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/NormalGenerator.h"
 #include "Graphics/Mesh/VertexFormat.h"
+#include "Utility/ParallelFor.h"
 
-#include <functional>
+#include <algorithm>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 using namespace Daybreak;
 
 //---------------------------------------------------------------------------------------------------------------------
 namespace
 {
-    struct obj_face_vertex_hasher_t
+    /** Maximum number of faces deduplicated by one worker as a unit when converting an obj model. */
+    const size_t MaxFacesPerConvertBatch = 64 * 1024;
+
+    /** A range of faces from one obj group that is deduplicated independently of the rest of the model. */
+    struct convert_batch_t
     {
-    public:
-        std::size_t operator()(const obj_face_vertex_t& f) const noexcept
+        const obj_group_t * group = nullptr;
+        size_t firstFace = 0;
+        size_t faceCount = 0;
+        size_t firstIndex = 0;                          ///< Offset of the batch's indices in the model index buffer.
+        size_t firstVertex = 0;                         ///< Offset of the batch's vertices in the model vertex buffer.
+        std::vector<obj_face_vertex_t> uniqueVertices;  ///< Unique face vertices in first use order.
+        std::vector<uint32_t> indices;                  ///< Indices into uniqueVertices.
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Find the unique face vertices in a batch and the index of the unique vertex used by every face vertex. */
+    void deduplicateBatch(convert_batch_t& batch, ObjVertexDeduplication deduplication)
+    {
+        const auto firstFace = batch.group->faces.begin() + batch.firstFace;
+        const auto lastFace = firstFace + batch.faceCount;
+
+        batch.indices.reserve(batch.faceCount * 3);
+
+        if (deduplication == ObjVertexDeduplication::Sort)
         {
-            std::hash<decltype(f.p)> hasher;
-            auto h = hasher(f.p);
+            std::vector<obj_face_vertex_t> faceVertices;
+            faceVertices.reserve(batch.faceCount * 3);
 
-            if (f.hasUV())
+            for (auto face = firstFace; face != lastFace; ++face)
             {
-                h = combine_hash(h, f.t);
+                for (int j = 0; j < 3; ++j)
+                {
+                    faceVertices.push_back(face->vertex(j));
+                }
             }
 
-            if (f.hasNormals())
+            sortDeduplicateFaceVertices(faceVertices, batch.indices, batch.uniqueVertices);
+        }
+        else
+        {
+            // Size the table for one unique vertex per face, which is typical for closed triangle meshes. It grows if
+            // more are found.
+            ObjFaceVertexTable vertexCache(batch.faceCount);
+
+            for (auto face = firstFace; face != lastFace; ++face)
             {
-                h = combine_hash(h, f.n);
+                for (int j = 0; j < 3; ++j)
+                {
+                    auto objVertex = face->vertex(j);
+                    auto result = vertexCache.findOrInsert(
+                        objVertex,
+                        static_cast<uint32_t>(batch.uniqueVertices.size()));
+
+                    if (result.second)
+                    {
+                        batch.uniqueVertices.push_back(objVertex);
+                    }
+
+                    batch.indices.push_back(result.first);
+                }
             }
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Fill out a vertex from the obj data referenced by a face vertex. */
+    void writeVertex(
+        const std::vector<glm::vec3>& positions,
+        const std::vector<glm::vec2>& uv,
+        const std::vector<glm::vec3>& normals,
+        const obj_face_vertex_t& objVertex,
+        vertex_ptn_t& vertex)
+    {
+        auto position = positions[static_cast<size_t>(objVertex.p) - 1];
+        vertex.setPosition(position.x, position.y, position.z);
 
-            return h;
+        if (objVertex.hasUV())
+        {
+            auto t = uv[static_cast<size_t>(objVertex.t) - 1];
+            vertex.setUV(t.x, t.y);
         }
-    };
+        else
+        {
+            vertex.setUV(0.0f, 0.0f);
+        }
+
+        if (objVertex.hasNormals())
+        {
+            auto normal = normals[static_cast<size_t>(objVertex.n) - 1];
+            vertex.setNormal(normal.x, normal.y, normal.z);
+        }
+        else
+        {
+            vertex.setNormal(0.0f, 0.0f, 0.0f);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Check if any group of a model uses a material with a normal map. */
+    bool hasNormalMappedGroup(const ModelData& model)
+    {
+        for (size_t i = 0; i < model.groupCount(); ++i)
+        {
+            if (model.group(i).materialRef().isParameterDefined(MaterialParameterType::NormalMap))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /** Add the bytes of a value to a 64 bit FNV-1a hash. */
+    template<typename T>
+    void hashValue(uint64_t& hash, const T& value) noexcept
+    {
+        const auto bytes = reinterpret_cast<const unsigned char *>(&value);
+
+        for (size_t i = 0; i < sizeof(T); ++i)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+ObjResourceLoader::ObjResourceLoader()
+{
+    setMaxWorkerCount(std::thread::hardware_concurrency());
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjResourceLoader::setMaxWorkerCount(size_t count) noexcept
+{
+    m_maxWorkerCount = std::max<size_t>(count, 1);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -47,35 +170,239 @@ std::unique_ptr<ModelData> ObjResourceLoader::load(
     const std::string& resourcePath,
     ResourcesManager& resources)
 {
-    // TODO: Improve this code because it was written quickly to get minimal obj support working.
-    //       In particular it does not use async I/O.
+    // Use the cooked copy of the model if it was made from the current version of the obj file.
+    file_stamp_t sourceStamp;
+    const auto cookedPath = resourcePath + CookedModelFile::FileExtension;
+    const bool useCookedModel = m_cookedModelCache && resources.tryGetFileStamp(resourcePath, sourceStamp);
+
+    if (useCookedModel)
+    {
+        auto model = tryLoadCooked(cookedPath, sourceStamp, optionsHash(), resources, m_maxWorkerCount);
+
+        if (model != nullptr)
+        {
+            return model;
+        }
+    }
+
+    std::vector<std::string> materialLibraries;
+    std::unique_ptr<ModelData> model;
+
+    const auto missingNormals = (m_normalGeneration ? &m_normalGenerationOptions : nullptr);
+
+    if (m_streaming)
+    {
+        model = loadStreamed(resourcePath, resources, &materialLibraries, missingNormals, m_maxWorkerCount);
+    }
+    else
+    {
+        // TODO: Improve this code because it was written quickly to get minimal obj support working.
+        //       In particular it does not use async I/O.
+        ObjModelParser parser;
+
+        // Parse directly from the mapped file. The parser copies everything it keeps, so the mapping can be released
+        // as soon as parsing is finished.
+        auto file = resources.mapFile(resourcePath);
+        auto objData = parser.parse(file->text(), resourcePath);
+        file.reset();
+
+        auto materials = loadMaterials(*(objData.get()), resources, m_maxWorkerCount);
+
+        model = convert(*objData, materials, m_vertexDeduplication, m_maxWorkerCount, missingNormals);
+        materialLibraries = std::move(objData->materialLibraries);
+    }
+
+    if (m_tangentGeneration && hasNormalMappedGroup(*model))
+    {
+        model->generateTangents(m_maxWorkerCount);
+    }
+
+    if (m_meshOptimization)
+    {
+        model->optimizeMesh();
+    }
+
+    // Meshlets are built after the optimizer, which would scatter them, and order their own triangles for the vertex
+    // cache. They are built before splitting so the vertices can still be reordered to match.
+    if (m_meshletGeneration)
+    {
+        model->buildMeshlets(meshlet_options_t(), m_maxWorkerCount);
+    }
+
+    if (m_splitLargeMeshes)
+    {
+        model->narrowIndices(true);
+    }
+
+    if (m_vertexQuantization)
+    {
+        model->quantizeVertices();
+    }
+
+    // Save a cooked copy of the model for next time. The cooked model is only an optimization, so failing to write it
+    // (for example when the content directory is read only, or the old cooked model is still mapped on Windows) is not
+    // an error.
+    if (useCookedModel)
+    {
+        std::vector<file_stamp_t> materialLibraryStamps(materialLibraries.size());
+
+        for (size_t i = 0; i < materialLibraries.size(); ++i)
+        {
+            resources.tryGetFileStamp(materialLibraries[i], materialLibraryStamps[i]);
+        }
+
+        const auto hash = optionsHash();
+
+        try
+        {
+            resources.writeFile(cookedPath, [&](std::ostream& stream) {
+                CookedModelFile::write(stream, *model, materialLibraries, materialLibraryStamps, sourceStamp, hash);
+            });
+        }
+        catch (const DaybreakEngineException&)
+        {
+        }
+    }
+
+    return model;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<ModelData> ObjResourceLoader::tryLoadCooked(
+    const std::string& cookedPath,
+    const file_stamp_t& sourceStamp,
+    uint64_t optionsHash,
+    ResourcesManager& resources,
+    size_t maxWorkerCount)
+{
+    file_stamp_t cookedStamp;
+
+    if (!resources.tryGetFileStamp(cookedPath, cookedStamp))
+    {
+        return nullptr;
+    }
+
+    // A cooked model that cannot be read (for example it was written by an older version) is treated the same as a
+    // missing one, and is replaced when the obj file is loaded.
+    try
+    {
+        CookedModelFile cookedModel(resources.mapFile(cookedPath));
+
+        if (cookedModel.sourceStamp() != sourceStamp || cookedModel.optionsHash() != optionsHash)
+        {
+            return nullptr;
+        }
+
+        // The materials decide which groups need tangents, so a changed material library can change the model too.
+        const auto& materialLibraries = cookedModel.materialLibraries();
+
+        for (size_t i = 0; i < materialLibraries.size(); ++i)
+        {
+            file_stamp_t libraryStamp;
+
+            if (!resources.tryGetFileStamp(materialLibraries[i], libraryStamp) ||
+                libraryStamp != cookedModel.materialLibraryStamps()[i])
+            {
+                return nullptr;
+            }
+        }
+
+        const auto materialNames = cookedModel.materialNames();
+        auto materials = loadMaterials(materialLibraries, resources, &materialNames, maxWorkerCount);
+        return cookedModel.createModel(materials);
+    }
+    catch (const ContentReadException&)
+    {
+        return nullptr;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+uint64_t ObjResourceLoader::optionsHash() const noexcept
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    hashValue(hash, m_streaming);
+    hashValue(hash, m_vertexDeduplication);
+    hashValue(hash, m_meshOptimization);
+    hashValue(hash, m_splitLargeMeshes);
+    hashValue(hash, m_meshletGeneration);
+    hashValue(hash, m_vertexQuantization);
+    hashValue(hash, m_normalGeneration);
+    hashValue(hash, m_normalGenerationOptions.flat);
+    hashValue(hash, m_normalGenerationOptions.creaseAngle);
+    hashValue(hash, m_tangentGeneration);
+
+    return hash;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<ModelData> ObjResourceLoader::loadStreamed(
+    const std::string& resourcePath,
+    ResourcesManager& resources,
+    std::vector<std::string> * materialLibraries,
+    const normal_generation_options_t * missingNormals,
+    size_t maxWorkerCount)
+{
     ObjModelParser parser;
+    MeshBuilder builder;
 
-    auto fileText = resources.loadTextFile(resourcePath);
-    auto objData = parser.parse(fileText, resourcePath);
+    {
+        auto stream = resources.openFile(resourcePath);
+        parser.parseStream(*stream, builder, resourcePath);
+    }
 
-    auto materials = loadMaterials(*(objData.get()), resources);
+    const auto materialNames = builder.materialNames();
+    auto materials = loadMaterials(builder.materialLibraries(), resources, &materialNames, maxWorkerCount);
 
-    return std::move(convert(std::move(objData), materials));
+    if (materialLibraries != nullptr)
+    {
+        *materialLibraries = builder.materialLibraries();
+    }
+
+    return builder.build(materials, missingNormals, maxWorkerCount);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 ObjResourceLoader::material_lut_t ObjResourceLoader::loadMaterials(
     const obj_model_t& objModel,
-    ResourcesManager& resources)
+    ResourcesManager& resources,
+    size_t maxWorkerCount)
 {
+    std::unordered_set<std::string> materialNames;
+
+    for (const auto& group : objModel.groups)
+    {
+        materialNames.insert(group.material);
+    }
+
+    return loadMaterials(objModel.materialLibraries, resources, &materialNames, maxWorkerCount);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+ObjResourceLoader::material_lut_t ObjResourceLoader::loadMaterials(
+    const std::vector<std::string>& materialLibraries,
+    ResourcesManager& resources,
+    const std::unordered_set<std::string> * materialNames,
+    size_t maxWorkerCount)
+{
+    // Load and parse every library on its own thread, then add the materials in library order so the result does not
+    // depend on which library finishes first.
+    std::vector<std::vector<std::unique_ptr<MaterialData>>> libraries(materialLibraries.size());
+
+    parallelFor(materialLibraries.size(), maxWorkerCount, [&](size_t i)
+    {
+        libraries[i] = loadMtl(materialLibraries[i], resources, materialNames);
+    });
+
     material_lut_t lut;
 
-    // Load all the referenced material libraries in the obj file.
-    for (const auto& materialLibrary : objModel.materialLibraries)
+    for (auto& materials : libraries)
     {
-        // TODO: Only add materials that are actually referenced by the model.
         // TODO: Warn about duplicate material names.
-        auto materials = loadMtl(materialLibrary, resources);
-
-        for (size_t i = 0; i < materials.size(); ++i)
+        for (auto& material : materials)
         {
-            lut.emplace(materials[i]->name(), std::move(materials[i]));
+            lut.emplace(material->name(), std::move(material));
         }
     }
 
@@ -85,102 +412,97 @@ ObjResourceLoader::material_lut_t ObjResourceLoader::loadMaterials(
 //---------------------------------------------------------------------------------------------------------------------
 std::vector<std::unique_ptr<MaterialData>> ObjResourceLoader::loadMtl(
     const std::string& filepath,
-    ResourcesManager& resources)
+    ResourcesManager& resources,
+    const std::unordered_set<std::string> * materialNames)
 {
     MtlMaterialParser parser;
 
-    auto fileText = resources.loadTextFile(filepath);
-    return parser.parse(fileText, filepath);
+    auto file = resources.mapFile(filepath);
+    return parser.parse(file->text(), filepath, materialNames);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 std::unique_ptr<ModelData> ObjResourceLoader::convert(
-    std::unique_ptr<obj_model_t> objModel,
-    const material_lut_t& materials)
+    const obj_model_t& objModel,
+    const material_lut_t& materials,
+    ObjVertexDeduplication deduplication,
+    size_t maxWorkerCount,
+    const normal_generation_options_t * missingNormals)
 {
-    // Get a count of the total number of faces in the model across all groups.
-    size_t faceCount = 0;  
+    // Split the faces of every group into batches that are deduplicated independently. Batches never span groups, and
+    // large groups are split so a model made of one huge group is still converted in parallel.
+    std::vector<convert_batch_t> batches;
+    size_t faceCount = 0;
 
-    for (const auto& group : objModel->groups)
+    for (const auto& group : objModel.groups)
     {
-        faceCount += group.faces.size();
-    }
+        for (size_t firstFace = 0; firstFace < group.faces.size(); firstFace += MaxFacesPerConvertBatch)
+        {
+            convert_batch_t batch;
 
-    // Allocate space for vertex buffer (use the standard position/texture/normal layout).
-    // TODO: Trim space after combined vertex count.
-    auto vertexCount = faceCount * 3;
-    std::unique_ptr<vertex_ptn_t[]> vertices(new vertex_ptn_t[vertexCount]);
+            batch.group = &group;
+            batch.firstFace = firstFace;
+            batch.faceCount = std::min(MaxFacesPerConvertBatch, group.faces.size() - firstFace);
+            batch.firstIndex = (faceCount + firstFace) * 3;
 
-    // Allocate space for the index buffer.
-    auto indexCount = faceCount * 3;
-    
-    std::unique_ptr<uint32_t[]> indices(new uint32_t[indexCount]);
+            batches.push_back(std::move(batch));
+        }
 
-    // Generate vertices for each face group in the obj model.
-    using index_t = uint32_t;
-    
-    std::unordered_map<obj_face_vertex_t, index_t, obj_face_vertex_hasher_t> vertexCache;
-    std::vector<ModelData::Group> groups;
+        faceCount += group.faces.size();
+    }
 
-    index_t nextVertexIndex = 0;
-    size_t nextIndex = 0;
+    parallelFor(batches.size(), maxWorkerCount, [&](size_t i) { deduplicateBatch(batches[i], deduplication); });
 
-    for (const auto& group : objModel->groups)
+    // Now that the number of unique vertices is known, place each batch's vertices after the vertices of all the
+    // batches before it.
+    size_t vertexCount = 0;
+
+    for (auto& batch : batches)
     {
-        // Record the first index in this group.
-        auto firstIndex = nextIndex;
+        batch.firstVertex = vertexCount;
+        vertexCount += batch.uniqueVertices.size();
+    }
 
-        // Generate vertices for each face in the obj model group.
-        for (const auto& face : group.faces)
-        {
-            for (int j = 0; j < 3; ++j)
-            {
-                // If the face vertex does not exist in the cache generate it.
-                auto objVertex = face.vertex(j);
-                auto itr = vertexCache.find(objVertex);
+    // Allocate exactly enough space for the vertex buffer (use the standard position/texture/normal layout).
+    std::unique_ptr<vertex_ptn_t[]> vertices(new vertex_ptn_t[vertexCount]);
 
-                if (itr == vertexCache.end())
-                {
-                    // Generate an entry in the vertex buffer for this face vertex.
-                    auto position = objModel->positions[static_cast<size_t>(face.position[j]) - 1];
-                    vertices[nextVertexIndex].setPosition(position.x, position.y, position.z);
+    // Allocate space for 32 bit indices, which are narrowed once every vertex has been placed.
+    auto indexCount = faceCount * 3;
 
-                    if (objModel->hasUV)
-                    {
-                        auto uv = objModel->uv[static_cast<size_t>(face.uv[j]) - 1];
-                        vertices[nextVertexIndex].setUV(uv.x, uv.y);
-                    }
-                    else
-                    {
-                        vertices[nextVertexIndex].setUV(0.0f, 0.0f);
-                    }
+    std::unique_ptr<uint32_t[]> indices(new uint32_t[indexCount]);
 
-                    if (objModel->hasNormals)
-                    {
-                        auto normal = objModel->normals[static_cast<size_t>(face.normal[j]) - 1];
-                        vertices[nextVertexIndex].setNormal(normal.x, normal.y, normal.z);
-                    }
-                    else
-                    {
-                        vertices[nextVertexIndex].setNormal(0.0f, 0.0f, 0.0f);
-                    }
+    // Generate the vertices for each batch and rebase its indices to where its vertices were placed.
+    parallelFor(batches.size(), maxWorkerCount, [&](size_t i)
+    {
+        const auto& batch = batches[i];
 
-                    // Record the index of the face vertex.
-                    vertexCache[objVertex] = nextVertexIndex++;
-                }
+        for (size_t v = 0; v < batch.uniqueVertices.size(); ++v)
+        {
+            writeVertex(
+                objModel.positions,
+                objModel.uv,
+                objModel.normals,
+                batch.uniqueVertices[v],
+                vertices[batch.firstVertex + v]);
+        }
 
-                // Look up the cached vertice's index in the vertex buffer.
-                auto vertexIndex = vertexCache[objVertex];
+        const auto base = static_cast<uint32_t>(batch.firstVertex);
 
-                indices[nextIndex] = vertexIndex;
-                nextIndex++;
-            }
+        for (size_t j = 0; j < batch.indices.size(); ++j)
+        {
+            indices[batch.firstIndex + j] = base + batch.indices[j];
         }
+    });
+
+    // Create a group definition in the model data for each obj group.
+    std::vector<ModelData::Group> groups;
+    size_t firstIndex = 0;
 
-        // Create a group definition in the model data for this obj group.
+    for (const auto& group : objModel.groups)
+    {
         // TODO: Add material sharing.
         // TODO: Warn if material is missing (or error but not exception).
-        auto groupIndexCount = nextIndex - firstIndex;
+        auto groupIndexCount = group.faces.size() * 3;
         auto materialItr = materials.find(group.material);
 
         groups.emplace_back(ModelData::Group(
@@ -188,22 +510,170 @@ std::unique_ptr<ModelData> ObjResourceLoader::convert(
             (materialItr == materials.end() ? nullptr : materialItr->second),
             firstIndex,
             groupIndexCount));
+
+        firstIndex += groupIndexCount;
+    }
+
+    // Create the Daybreak mesh along with index and vertex buffers.
+    auto mesh = std::make_unique<MeshData>(
+        createCompactIndexBuffer(indices.get(), indexCount),
+        std::make_unique<VertexBufferData>(
+            vertexCount,
+            std::move(vertices),
+            vertex_ptn_t::inputLayout));
+
+    // Generate normals for models that do not have them. Triangles are in the same order as the faces of each group.
+    if (missingNormals != nullptr && !objModel.hasNormals && indexCount > 0)
+    {
+        std::vector<uint32_t> smoothingGroups;
+
+        if (objModel.hasSmoothingGroups)
+        {
+            smoothingGroups.reserve(faceCount);
+
+            for (const auto& group : objModel.groups)
+            {
+                for (const auto& face : group.faces)
+                {
+                    smoothingGroups.push_back(face.smoothingGroup);
+                }
+            }
+        }
+
+        mesh = generateNormals(
+            *mesh,
+            *missingNormals,
+            (objModel.hasSmoothingGroups ? &smoothingGroups : nullptr),
+            maxWorkerCount);
     }
 
-    // Create the Daybreak model along with index and vertex buffers.
-    auto modelData = std::make_unique<ModelData>(
-        std::make_unique<MeshData>(
-            std::make_unique<IndexBufferData>(
-                indexCount,
-                std::move(indices)),
-            std::make_unique<VertexBufferData>(
-                vertexCount,
-                std::move(vertices),
-                vertex_ptn_t::inputLayout)));
+    // Create the Daybreak model.
+    auto modelData = std::make_unique<ModelData>(std::move(mesh));
 
     // Add groups to the Daybreak model.
     modelData->addGroup(std::move(groups));
 
     // All done!
-    return std::move(modelData);
+    return modelData;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjResourceLoader::MeshBuilder::visitPosition(const glm::vec3& position)
+{
+    m_positions.push_back(position);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjResourceLoader::MeshBuilder::visitUV(const glm::vec2& uv)
+{
+    m_uv.push_back(uv);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjResourceLoader::MeshBuilder::visitNormal(const glm::vec3& normal)
+{
+    m_normals.push_back(normal);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjResourceLoader::MeshBuilder::visitGroup(const std::string& name, const std::string& material)
+{
+    m_groups.push_back({ name, material, m_indices.size() });
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjResourceLoader::MeshBuilder::visitFace(const obj_face_t& face)
+{
+    m_smoothingGroups.push_back(face.smoothingGroup);
+    m_hasMissingNormals = m_hasMissingNormals || face.normal[0] == 0;
+
+    for (int j = 0; j < 3; ++j)
+    {
+        // Generate a vertex for this face vertex if it has not been seen before, otherwise reuse the existing one.
+        auto objVertex = face.vertex(j);
+        auto result = m_vertexCache.findOrInsert(objVertex, static_cast<uint32_t>(m_vertices.size()));
+
+        if (result.second)
+        {
+            m_vertices.emplace_back();
+            writeVertex(m_positions, m_uv, m_normals, objVertex, m_vertices.back());
+        }
+
+        m_indices.push_back(result.first);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjResourceLoader::MeshBuilder::visitSmoothingGroup(uint32_t)
+{
+    m_hasSmoothingGroups = true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ObjResourceLoader::MeshBuilder::visitMaterialLibrary(const std::string& path)
+{
+    m_materialLibraries.push_back(path);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unordered_set<std::string> ObjResourceLoader::MeshBuilder::materialNames() const
+{
+    std::unordered_set<std::string> names;
+
+    for (const auto& group : m_groups)
+    {
+        names.insert(group.material);
+    }
+
+    return names;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<ModelData> ObjResourceLoader::MeshBuilder::build(
+    const material_lut_t& materials,
+    const normal_generation_options_t * missingNormals,
+    size_t maxWorkerCount)
+{
+    // Each group runs until the start of the next group.
+    std::vector<ModelData::Group> groups;
+    groups.reserve(m_groups.size());
+
+    for (size_t i = 0; i < m_groups.size(); ++i)
+    {
+        auto firstIndex = m_groups[i].firstIndex;
+        auto lastIndex = (i + 1 < m_groups.size() ? m_groups[i + 1].firstIndex : m_indices.size());
+        auto materialItr = materials.find(m_groups[i].material);
+
+        groups.emplace_back(ModelData::Group(
+            m_groups[i].name,
+            (materialItr == materials.end() ? nullptr : materialItr->second),
+            firstIndex,
+            lastIndex - firstIndex));
+    }
+
+    // Move the vertices and indices into the mesh rather than copying them, since the builder is finished with them.
+    // This keeps peak memory at one copy of the mesh, which is the point of building it from a stream.
+    auto vertices = std::make_shared<std::vector<vertex_ptn_t>>(std::move(m_vertices));
+    auto indexBuffer = createCompactIndexBuffer(std::move(m_indices));
+
+    auto mesh = std::make_unique<MeshData>(
+        std::move(indexBuffer),
+        std::make_unique<VertexBufferData>(
+            vertices->size() * sizeof(vertex_ptn_t),
+            vertices->data(),
+            vertices,
+            vertex_ptn_t::inputLayout));
+
+    if (missingNormals != nullptr && m_hasMissingNormals)
+    {
+        mesh = generateNormals(
+            *mesh,
+            *missingNormals,
+            (m_hasSmoothingGroups ? &m_smoothingGroups : nullptr),
+            maxWorkerCount);
+    }
+
+    auto modelData = std::make_unique<ModelData>(std::move(mesh));
+    modelData->addGroup(std::move(groups));
+    return modelData;
 }
@@ -1,37 +1,270 @@
 #pragma once
 #include "Content/IResourceLoader.h"
+#include "Content/IFileSystem.h"
 #include "Content\Models\ModelData.h"
+#include "Content/ObjModel/IObjModelVisitor.h"
+#include "Content/ObjModel/ObjModelParser.h"
+#include "Content/ObjModel/ObjFaceVertexTable.h"
+#include "Graphics/Mesh/NormalGenerator.h"
+#include "Graphics/Mesh/VertexFormat.h"
 
 #include <memory>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <glm/glm.hpp>
 
 namespace Daybreak
 {
     struct obj_model_t;
 
+    /** How obj face vertices that share the same indices are merged into one vertex when converting a model. */
+    enum class ObjVertexDeduplication
+    {
+        HashTable,                  // Look up each face vertex in a flat hash table. Best for most models.
+        Sort                        // Sort all face vertices and merge runs. Scales better for very large models.
+    };
+
     class ObjResourceLoader : public IResourceLoader<ModelData>
     {
     public:
         using material_lut_t =  std::unordered_map<std::string, std::shared_ptr<MaterialData>>;
 
+        /**
+         * Builds a Daybreak model incrementally from obj data passed to it by ObjModelParser::parseStream. Only the
+         * obj vertex data (needed to resolve face indices) and the output mesh are kept in memory.
+         */
+        class MeshBuilder : public IObjModelVisitor
+        {
+        public:
+            virtual void visitPosition(const glm::vec3& position) override;
+            virtual void visitUV(const glm::vec2& uv) override;
+            virtual void visitNormal(const glm::vec3& normal) override;
+            virtual void visitGroup(const std::string& name, const std::string& material) override;
+            virtual void visitFace(const obj_face_t& face) override;
+            virtual void visitSmoothingGroup(uint32_t smoothingGroup) override;
+            virtual void visitMaterialLibrary(const std::string& path) override;
+
+            /** Get the material libraries referenced by the obj data visited so far. */
+            const std::vector<std::string>& materialLibraries() const noexcept { return m_materialLibraries; }
+
+            /** Get the names of the materials used by the groups visited so far. */
+            std::unordered_set<std::string> materialNames() const;
+
+            /**
+             * Create a model from the obj data visited so far. When the faces do not have normals and missingNormals
+             * is given, normals are generated on up to maxWorkerCount threads using the faces' smoothing groups. The
+             * vertices and indices are moved into the model, so the builder cannot be used after calling this.
+             */
+            std::unique_ptr<ModelData> build(
+                const material_lut_t& materials,
+                const normal_generation_options_t * missingNormals = nullptr,
+                size_t maxWorkerCount = 1);
+
+        private:
+            struct group_t
+            {
+                std::string name;
+                std::string material;
+                size_t firstIndex;
+            };
+
+        private:
+            std::vector<glm::vec3> m_positions;
+            std::vector<glm::vec2> m_uv;
+            std::vector<glm::vec3> m_normals;
+            std::vector<std::string> m_materialLibraries;
+            std::vector<group_t> m_groups;
+            std::vector<vertex_ptn_t> m_vertices;
+            std::vector<uint32_t> m_indices;
+            std::vector<uint32_t> m_smoothingGroups;
+            ObjFaceVertexTable m_vertexCache;
+            bool m_hasMissingNormals = false;
+            bool m_hasSmoothingGroups = false;
+        };
+
     public:
+        /** Constructor. */
+        ObjResourceLoader();
+
         virtual std::unique_ptr<ModelData> load(
             const std::string& resourcePath,
             ResourcesManager& resources) override;
 
-        /** Convert a obj model into a Daybreak model. */
+        /**
+         * Load an obj model by streaming it from disk a block at a time into a MeshBuilder, rather than reading the
+         * whole file and building an obj model first. This bounds memory use by the size of the output mesh at the
+         * cost of parsing on a single thread.
+         */
+        static std::unique_ptr<ModelData> loadStreamed(
+            const std::string& resourcePath,
+            ResourcesManager& resources,
+            std::vector<std::string> * materialLibraries = nullptr,    ///< Optional, receives the material libraries.
+            const normal_generation_options_t * missingNormals = nullptr,  ///< Optional, generates missing normals.
+            size_t maxWorkerCount = 1);
+
+        /**
+         * Load the cooked copy of a model if it exists, was made from a source file with the given stamp using load
+         * options with the given hash, and its material libraries have not changed since. Returns null if the cooked
+         * model is missing, out of date or unreadable.
+         */
+        static std::unique_ptr<ModelData> tryLoadCooked(
+            const std::string& cookedPath,
+            const file_stamp_t& sourceStamp,
+            uint64_t optionsHash,
+            ResourcesManager& resources,
+            size_t maxWorkerCount = 1);
+
+        /**
+         * Get a hash of every load option that changes the model load creates, so cooked models made with different
+         * options are not used.
+         */
+        uint64_t optionsHash() const noexcept;
+
+        /**
+         * Get if load uses a cooked binary copy of the model saved next to the obj file, and saves a new one when the
+         * cooked copy is missing or out of date.
+         */
+        bool cookedModelCache() const noexcept { return m_cookedModelCache; }
+
+        /** Set if load uses and saves a cooked binary copy of the model next to the obj file. */
+        void setCookedModelCache(bool useCache) noexcept { m_cookedModelCache = useCache; }
+
+        /**
+         * Get if load reorders the triangles and vertices of each group for the post-transform vertex cache, overdraw
+         * and vertex fetch. Cooked models are saved after optimizing so the cost is only paid once.
+         */
+        bool meshOptimization() const noexcept { return m_meshOptimization; }
+
+        /** Set if load optimizes the model mesh for drawing. */
+        void setMeshOptimization(bool shouldOptimize) noexcept { m_meshOptimization = shouldOptimize; }
+
+        /**
+         * Get if load splits models with too many vertices for 16 bit indices into groups that each use 16 bit indices
+         * relative to a base vertex.
+         */
+        bool splitLargeMeshes() const noexcept { return m_splitLargeMeshes; }
+
+        /** Set if load splits models with too many vertices for 16 bit indices. */
+        void setSplitLargeMeshes(bool shouldSplit) noexcept { m_splitLargeMeshes = shouldSplit; }
+
+        /**
+         * Get if load splits every group into meshlets of neighbouring triangles, each with bounds for frustum and
+         * back face culling. Cooked models keep the meshlets.
+         */
+        bool meshletGeneration() const noexcept { return m_meshletGeneration; }
+
+        /** Set if load splits every group into meshlets. */
+        void setMeshletGeneration(bool shouldGenerate) noexcept { m_meshletGeneration = shouldGenerate; }
+
+        /**
+         * Get if load stores vertices in the compact formats given by vertex_quantization_options_t. Renderers must
+         * support the quantized input layout and apply the model's position dequantization.
+         */
+        bool vertexQuantization() const noexcept { return m_vertexQuantization; }
+
+        /** Set if load stores vertices in compact quantized formats. */
+        void setVertexQuantization(bool shouldQuantize) noexcept { m_vertexQuantization = shouldQuantize; }
+
+        /**
+         * Get if load generates smooth normals for obj models without any, using the model's smoothing groups (s)
+         * when it has them. Otherwise the normals are left as zero.
+         */
+        bool normalGeneration() const noexcept { return m_normalGeneration; }
+
+        /** Set if load generates normals for obj models without any. */
+        void setNormalGeneration(bool shouldGenerate) noexcept { m_normalGeneration = shouldGenerate; }
+
+        /** Get the options used when load generates missing normals. */
+        const normal_generation_options_t& normalGenerationOptions() const noexcept
+        {
+            return m_normalGenerationOptions;
+        }
+
+        /** Set the options used when load generates missing normals. */
+        void setNormalGenerationOptions(const normal_generation_options_t& options) noexcept
+        {
+            m_normalGenerationOptions = options;
+        }
+
+        /**
+         * Get if load generates tangents for models with a normal mapped material, which appends a tangent attribute
+         * to the vertex layout (see vertex_ptnt_t).
+         */
+        bool tangentGeneration() const noexcept { return m_tangentGeneration; }
+
+        /** Set if load generates tangents for models with a normal mapped material. */
+        void setTangentGeneration(bool shouldGenerate) noexcept { m_tangentGeneration = shouldGenerate; }
+
+        /** Get if load streams the obj file instead of parsing it all at once. */
+        bool streaming() const noexcept { return m_streaming; }
+
+        /** Set if load streams the obj file instead of parsing it all at once. */
+        void setStreaming(bool shouldStream) noexcept { m_streaming = shouldStream; }
+
+        /** Get how load merges face vertices that share the same indices. */
+        ObjVertexDeduplication vertexDeduplication() const noexcept { return m_vertexDeduplication; }
+
+        /** Set how load merges face vertices that share the same indices. */
+        void setVertexDeduplication(ObjVertexDeduplication deduplication) noexcept
+        {
+            m_vertexDeduplication = deduplication;
+        }
+
+        /** Get the maximum number of worker threads used when converting obj models. */
+        size_t maxWorkerCount() const noexcept { return m_maxWorkerCount; }
+
+        /** Set the maximum number of worker threads used when converting obj models. One disables threading. */
+        void setMaxWorkerCount(size_t count) noexcept;
+
+        /**
+         * Convert a obj model into a Daybreak model. Faces are split into batches (each group, with large groups split
+         * further) that are deduplicated on up to maxWorkerCount threads and then merged into one vertex and index
+         * buffer that are sized exactly. Indices use the narrowest type that can address every vertex. Vertices are
+         * only shared within a batch, and the output does not depend on the worker count. When the faces do not have
+         * normals and missingNormals is given, normals are generated using the faces' smoothing groups.
+         */
         static std::unique_ptr<ModelData> convert(
-            std::unique_ptr<obj_model_t> objModel,      // TODO: Pass by const ref.
-            const material_lut_t& materials);
+            const obj_model_t& objModel,
+            const material_lut_t& materials,
+            ObjVertexDeduplication deduplication = ObjVertexDeduplication::HashTable,
+            size_t maxWorkerCount = 1,
+            const normal_generation_options_t * missingNormals = nullptr);
 
-        /** Get all referenced materials in an obj model. */
+        /** Get all referenced materials in an obj model, loading its libraries on up to maxWorkerCount threads. */
         static material_lut_t loadMaterials(
             const obj_model_t& objModel,            ///< OBJ model to load materials for.
-            ResourcesManager& resources);           ///< Reference to active resource manager.
+            ResourcesManager& resources,            ///< Reference to active resource manager.
+            size_t maxWorkerCount = 1);             ///< Largest number of libraries loaded at the same time.
+
+        /**
+         * Get the materials defined in a list of material libraries, which are loaded on up to maxWorkerCount threads.
+         * When materialNames is given only the materials it names are created. A material defined by more than one
+         * library comes from the first library in the list.
+         */
+        static material_lut_t loadMaterials(
+            const std::vector<std::string>& materialLibraries,  ///< Paths of mtl files to load.
+            ResourcesManager& resources,                        ///< Reference to active resource manager.
+            const std::unordered_set<std::string> * materialNames = nullptr,    ///< Optional, materials to keep.
+            size_t maxWorkerCount = 1);                         ///< Largest number of libraries loaded at a time.
 
-        /** Load an MTL material library from disk. */
+        /** Load an MTL material library from disk, optionally only creating the materials named in materialNames. */
         static std::vector<std::unique_ptr<MaterialData>> loadMtl(
             const std::string& filepath,
-            ResourcesManager& resources);
+            ResourcesManager& resources,
+            const std::unordered_set<std::string> * materialNames = nullptr);
+
+    private:
+        bool m_streaming = false;
+        bool m_cookedModelCache = false;
+        bool m_meshOptimization = false;
+        bool m_splitLargeMeshes = false;
+        bool m_meshletGeneration = false;
+        bool m_vertexQuantization = false;
+        bool m_normalGeneration = false;
+        bool m_tangentGeneration = false;
+        size_t m_maxWorkerCount = 1;
+        normal_generation_options_t m_normalGenerationOptions;
+        ObjVertexDeduplication m_vertexDeduplication = ObjVertexDeduplication::HashTable;
     };
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "stdafx.h"
+#include "PolygonTriangulator.h"
+
+#include <cmath>
+
+using namespace Daybreak;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    /** Twice the signed area of triangle abc. Positive when abc is counter clockwise. */
+    float signedArea(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c) noexcept
+    {
+        return (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+    }
+
+    /** Check if p is inside or on the edge of counter clockwise triangle abc. */
+    bool isInsideTriangle(const glm::vec2& p, const glm::vec2& a, const glm::vec2& b, const glm::vec2& c) noexcept
+    {
+        return signedArea(a, b, p) >= 0.0f && signedArea(b, c, p) >= 0.0f && signedArea(c, a, p) >= 0.0f;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void PolygonTriangulator::earClip(const glm::vec3 * positions, size_t count, std::vector<uint32_t>& triangles)
+{
+    triangles.clear();
+
+    if (count < 3)
+    {
+        return;
+    }
+
+    // Find the polygon normal with Newell's method, which is robust for concave and slightly non planar polygons.
+    glm::vec3 normal(0.0f);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto& a = positions[i];
+        const auto& b = positions[(i + 1) % count];
+
+        normal.x += (a.y - b.y) * (a.z + b.z);
+        normal.y += (a.z - b.z) * (a.x + b.x);
+        normal.z += (a.x - b.x) * (a.y + b.y);
+    }
+
+    // Project onto the plane of the two axes that are most perpendicular to the normal. Swap the axes when the normal
+    // points down the dropped axis so the projected polygon is always counter clockwise.
+    const auto ax = std::abs(normal.x);
+    const auto ay = std::abs(normal.y);
+    const auto az = std::abs(normal.z);
+
+    int u = 0;
+    int v = 1;
+    float direction = normal.z;
+
+    if (ax >= ay && ax >= az)
+    {
+        u = 1;
+        v = 2;
+        direction = normal.x;
+    }
+    else if (ay >= az)
+    {
+        u = 2;
+        v = 0;
+        direction = normal.y;
+    }
+
+    if (direction < 0.0f)
+    {
+        std::swap(u, v);
+    }
+
+    m_projected.resize(count);
+    m_remaining.resize(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_projected[i] = glm::vec2(positions[i][u], positions[i][v]);
+        m_remaining[i] = static_cast<uint32_t>(i);
+    }
+
+    // Repeatedly cut off an ear until a single triangle is left. If no ear can be found (degenerate or self
+    // intersecting input) cut off the current corner anyway so the result always has count - 2 triangles.
+    triangles.reserve((count - 2) * 3);
+    size_t i = 0;
+    size_t attempts = 0;
+
+    while (m_remaining.size() > 3)
+    {
+        const auto size = m_remaining.size();
+        i %= size;
+
+        if (isEar(i) || attempts >= size)
+        {
+            triangles.push_back(m_remaining[(i + size - 1) % size]);
+            triangles.push_back(m_remaining[i]);
+            triangles.push_back(m_remaining[(i + 1) % size]);
+
+            m_remaining.erase(m_remaining.begin() + static_cast<ptrdiff_t>(i));
+            attempts = 0;
+        }
+        else
+        {
+            ++i;
+            ++attempts;
+        }
+    }
+
+    triangles.push_back(m_remaining[0]);
+    triangles.push_back(m_remaining[1]);
+    triangles.push_back(m_remaining[2]);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool PolygonTriangulator::isEar(size_t i) const noexcept
+{
+    const auto size = m_remaining.size();
+    const auto previous = m_remaining[(i + size - 1) % size];
+    const auto current = m_remaining[i];
+    const auto next = m_remaining[(i + 1) % size];
+
+    const auto& a = m_projected[previous];
+    const auto& b = m_projected[current];
+    const auto& c = m_projected[next];
+
+    // Reflex (or flat) corners can not be ears.
+    if (signedArea(a, b, c) <= 0.0f)
+    {
+        return false;
+    }
+
+    // No other corner may lie inside the ear.
+    for (auto corner : m_remaining)
+    {
+        if (corner == previous || corner == current || corner == next)
+        {
+            continue;
+        }
+
+        const auto& p = m_projected[corner];
+
+        // Corners at the same position as an ear corner (from duplicate vertices) do not block the ear.
+        if (p == a || p == b || p == c)
+        {
+            continue;
+        }
+
+        if (isInsideTriangle(p, a, b, c))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+namespace Daybreak
+{
+    /**
+     * Splits simple (non self intersecting) polygons into triangles by ear clipping, which unlike a fan also handles
+     * concave polygons. Scratch memory is kept between calls so triangulating many polygons does not allocate once
+     * the buffers have grown to fit the largest polygon.
+     */
+    class PolygonTriangulator
+    {
+    public:
+        /**
+         * Triangulate a polygon with the given corner positions. Replaces the contents of triangles with count - 2
+         * triangles, each written as three indices into the corner array with the same winding as the polygon.
+         */
+        void earClip(const glm::vec3 * positions, size_t count, std::vector<uint32_t>& triangles);
+
+    private:
+        /** Check if the corner at remaining index i is a convex vertex that no other remaining corner lies inside. */
+        bool isEar(size_t i) const noexcept;
+
+    private:
+        std::vector<glm::vec2> m_projected;
+        std::vector<uint32_t> m_remaining;
+    };
+}
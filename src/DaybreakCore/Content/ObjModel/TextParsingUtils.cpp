@@ -1,5 +1,6 @@
 #include "stdafx.h"
 #include "TextParsingUtils.h"
+#include "Utility/TextScanning.h"
 
 #include <charconv>
 #include <stdexcept>
@@ -23,10 +24,17 @@ float Daybreak::readExpectedFloat(Daybreak::TextUtils::StringSplitter& arguments
 float Daybreak::parseFloat(const std::string_view& token)
 {
     float value = 0.0f;
-    auto result = std::from_chars(
-        token.data(),
-        token.data() + token.size(),
-        value);
+
+    // Most numbers in model files are short decimals that can be converted exactly without the general algorithm.
+    const auto first = token.data();
+    const auto last = token.data() + token.size();
+
+    if (TextUtils::tryParseSimpleFloat(first, last, value) != nullptr)
+    {
+        return value;
+    }
+
+    auto result = std::from_chars(first, last, value);
 
     if (result.ec == std::errc::invalid_argument || result.ec == std::errc::result_out_of_range)
     {
@@ -53,6 +61,12 @@ int Daybreak::readExpectedInt(Daybreak::TextUtils::StringSplitter& arguments)
 int Daybreak::parseInt(const std::string_view& token)
 {
     int value = 0;
+
+    if (TextUtils::tryParseSimpleInt(token.data(), token.data() + token.size(), value) != nullptr)
+    {
+        return value;
+    }
+
     auto result = std::from_chars(
         token.data(),
         token.data() + token.size(),
@@ -66,6 +80,26 @@ int Daybreak::parseInt(const std::string_view& token)
     return value;
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+size_t Daybreak::splitFaceElement(const std::string_view& token, std::string_view (&parts)[3]) noexcept
+{
+    const auto first = token.data();
+    const auto last = token.data() + token.size();
+
+    auto p = first;
+    size_t count = 0;
+
+    while (p < last && count < 3)
+    {
+        auto separator = TextUtils::findFirstOfScalar(p, last, '/', '/');
+        parts[count++] = std::string_view(p, static_cast<size_t>(separator - p));
+
+        p = separator + 1;
+    }
+
+    return count;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 std::string Daybreak::readExpectedString(Daybreak::TextUtils::StringSplitter& arguments)
 {
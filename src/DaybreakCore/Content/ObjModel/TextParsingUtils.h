@@ -16,6 +16,12 @@ namespace Daybreak
     /** Parse the provided token as an int. Throw an exception if not possible. */
     int parseInt(const std::string_view& token);
 
+    /**
+     * Split an obj face element token (p, p/t, p//n or p/t/n) on '/' into at most three parts without skipping empty
+     * parts. Returns the number of parts written to parts.
+     */
+    size_t splitFaceElement(const std::string_view& token, std::string_view (&parts)[3]) noexcept;
+
     /** Consume and return the next token from argument as a string. Throw an exception if not possible. */
     std::string readExpectedString(Daybreak::TextUtils::StringSplitter& arguments);
 }
\ No newline at end of file
@@ -0,0 +1,335 @@
+#include "stdafx.h"
+#include "ResourceReloader.h"
+#include "Content/IFileSystem.h"
+#include "Content/ResourcesManager.h"
+#include "Content\Models\ModelData.h"
+#include "Content\Images\Image.h"
+#include "Common/Error.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace Daybreak;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace Daybreak
+{
+    /** File system that records every file it reads and writes, and passes the calls on to another file system. */
+    class ResourceReloader::RecordingFileSystem : public IFileSystem
+    {
+    public:
+        RecordingFileSystem(ResourceReloader& reloader, std::shared_ptr<IFileSystem> fileSystem)
+            : m_reloader(reloader),
+              m_fileSystem(fileSystem)
+        {
+        }
+
+        virtual std::future<std::string> loadFileAsText(const std::string& path) override
+        {
+            m_reloader.recordFile(path, false);
+            return m_fileSystem->loadFileAsText(path);
+        }
+
+        virtual std::future<std::shared_ptr<const MappedFile>> mapFile(const std::string& path) override
+        {
+            m_reloader.recordFile(path, false);
+            return m_fileSystem->mapFile(path);
+        }
+
+        virtual std::unique_ptr<std::istream> openFile(const std::string& path) override
+        {
+            m_reloader.recordFile(path, false);
+            return m_fileSystem->openFile(path);
+        }
+
+        virtual void writeFile(
+            const std::string& path,
+            const std::function<void(std::ostream&)>& writeContents) override
+        {
+            m_reloader.recordFile(path, true);
+            m_fileSystem->writeFile(path, writeContents);
+        }
+
+        virtual bool tryGetFileStamp(const std::string& path, file_stamp_t& stamp) override
+        {
+            m_reloader.recordFile(path, false);
+            return m_fileSystem->tryGetFileStamp(path, stamp);
+        }
+
+        virtual void watchFile(const std::string& path) override
+        {
+            m_fileSystem->watchFile(path);
+        }
+
+        virtual std::vector<std::string> takeChangedFiles() override
+        {
+            return m_fileSystem->takeChangedFiles();
+        }
+
+    private:
+        ResourceReloader& m_reloader;
+        std::shared_ptr<IFileSystem> m_fileSystem;
+    };
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+ResourceReloader::ResourceReloader(
+    std::shared_ptr<IDeviceContext> deviceContext,
+    std::shared_ptr<IFileSystem> fileSystem)
+    : m_fileSystem(fileSystem)
+{
+    CHECK_NOT_NULL(m_fileSystem);
+
+    m_resources = std::make_unique<ResourcesManager>(
+        deviceContext,
+        std::make_shared<RecordingFileSystem>(*this, fileSystem));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+ResourceReloader::~ResourceReloader()
+{
+    // Running reloads record files into this object, so they must finish before it is destroyed.
+    for (auto& entry : m_trackedResources)
+    {
+        if (entry->reload.valid())
+        {
+            entry->reload.wait();
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<ReloadableResource<ModelData>> ResourceReloader::loadModel(const std::string& path)
+{
+    // Reading the model and its images happens in the background, and only the textures are created in update().
+    struct model_files_t
+    {
+        std::unique_ptr<ModelData> model;
+        ResourcesManager::image_lut_t images;
+    };
+
+    return load<ModelData>(
+        [path](ResourcesManager& resources) {
+            model_files_t files;
+            files.model = resources.readModel(path);
+            files.images = resources.readModelImages(*files.model);
+
+            return files;
+        },
+        [](model_files_t&& files, ResourcesManager& resources) {
+            resources.createModelTextures(*files.model, files.images);
+            return std::move(files.model);
+        });
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+size_t ResourceReloader::update()
+{
+    // Forget resources that are no longer used, once they are not reloading.
+    m_trackedResources.erase(
+        std::remove_if(
+            m_trackedResources.begin(),
+            m_trackedResources.end(),
+            [](const std::shared_ptr<tracked_resource_t>& entry) {
+                return !entry->reload.valid() && !entry->isAlive();
+            }),
+        m_trackedResources.end());
+
+    // Start reloading every resource that depends on a changed file. Resources that are already reloading may have
+    // read the file before it changed, so they are reloaded again when they finish.
+    auto changedFiles = m_fileSystem->takeChangedFiles();
+
+    {
+        std::lock_guard<std::mutex> lock(m_recordingMutex);
+
+        changedFiles.erase(
+            std::remove_if(
+                changedFiles.begin(),
+                changedFiles.end(),
+                [this](const std::string& path) { return m_writtenFiles.count(path) > 0; }),
+            changedFiles.end());
+    }
+
+    for (auto& entry : m_trackedResources)
+    {
+        const auto isChanged = std::any_of(
+            changedFiles.begin(),
+            changedFiles.end(),
+            [&entry](const std::string& path) { return entry->dependencies.count(path) > 0; });
+
+        if (!isChanged)
+        {
+            continue;
+        }
+
+        if (entry->reload.valid())
+        {
+            entry->isOutOfDate = true;
+        }
+        else
+        {
+            startReload(entry);
+        }
+    }
+
+    // Replace the resources whose reloads finished.
+    size_t replacedCount = 0;
+
+    for (auto& entry : m_trackedResources)
+    {
+        if (!entry->reload.valid() || entry->reload.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            continue;
+        }
+
+        auto recording = std::move(entry->reloadRecording);
+
+        try
+        {
+            auto data = entry->reload.get();
+
+            beginRecording(*recording);
+
+            try
+            {
+                entry->create(data, *m_resources);
+            }
+            catch (...)
+            {
+                endRecording(*recording);
+                throw;
+            }
+
+            endRecording(*recording);
+
+            // The new version of the resource may use different files than the old one did.
+            entry->dependencies.clear();
+            setDependencies(*entry, *recording);
+            entry->setResult("");
+
+            replacedCount++;
+        }
+        catch (const std::exception& e)
+        {
+            // Keep the old resource, and keep watching the files it used along with any new files the failed reload
+            // read, so fixing the problem reloads it again.
+            setDependencies(*entry, *recording);
+            entry->setResult(e.what());
+        }
+
+        if (entry->isOutOfDate)
+        {
+            entry->isOutOfDate = false;
+            startReload(entry);
+        }
+    }
+
+    return replacedCount;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ResourceReloader::loadTracked(const std::shared_ptr<tracked_resource_t>& entry)
+{
+    recording_t recording;
+    beginRecording(recording);
+
+    try
+    {
+        entry->create(entry->read(*m_resources), *m_resources);
+    }
+    catch (...)
+    {
+        endRecording(recording);
+        throw;
+    }
+
+    endRecording(recording);
+    setDependencies(*entry, recording);
+
+    m_trackedResources.push_back(entry);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ResourceReloader::startReload(const std::shared_ptr<tracked_resource_t>& entry)
+{
+    CHECK(!entry->reload.valid());
+
+    entry->reloadRecording = std::make_unique<recording_t>();
+
+    entry->reload = std::async(
+        std::launch::async,
+        [this, entry, recording = entry->reloadRecording.get()]() {
+            beginRecording(*recording);
+
+            try
+            {
+                auto data = entry->read(*m_resources);
+                endRecording(*recording);
+
+                return data;
+            }
+            catch (...)
+            {
+                endRecording(*recording);
+                throw;
+            }
+        });
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ResourceReloader::setDependencies(tracked_resource_t& entry, const recording_t& recording)
+{
+    std::vector<std::string> newFiles;
+
+    {
+        std::lock_guard<std::mutex> lock(m_recordingMutex);
+
+        for (const auto& path : recording.readFiles)
+        {
+            // Files written while loading are outputs like caches, and are rewritten when their sources change.
+            if (m_writtenFiles.count(path) == 0 && entry.dependencies.insert(path).second)
+            {
+                newFiles.push_back(path);
+            }
+        }
+    }
+
+    for (const auto& path : newFiles)
+    {
+        // Files in directories that do not exist cannot be watched, and a resource that needs them failed to load.
+        try
+        {
+            m_fileSystem->watchFile(path);
+        }
+        catch (const ContentReadException&)
+        {
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ResourceReloader::beginRecording(recording_t& recording)
+{
+    recording.previousContext = WorkContext::exchange(&recording);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ResourceReloader::endRecording(recording_t& recording)
+{
+    WorkContext::exchange(recording.previousContext);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ResourceReloader::recordFile(const std::string& path, bool isWrite)
+{
+    std::lock_guard<std::mutex> lock(m_recordingMutex);
+
+    if (isWrite)
+    {
+        m_writtenFiles.insert(path);
+    }
+    else if (auto recording = dynamic_cast<recording_t *>(WorkContext::current()))
+    {
+        recording->readFiles.insert(path);
+    }
+}
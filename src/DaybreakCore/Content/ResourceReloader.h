@@ -0,0 +1,175 @@
+#pragma once
+#include "Utility/ParallelFor.h"
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Daybreak
+{
+    class IDeviceContext;
+    class IFileSystem;
+    class ModelData;
+    class ResourcesManager;
+    class ResourceReloader;
+
+    /**
+     * Resource that ResourceReloader replaces with a newer version when a file it was loaded from changes. Get the
+     * resource from the holder every frame rather than keeping it, so a reloaded resource is used from the next frame.
+     */
+    template<typename TResource>
+    class ReloadableResource
+    {
+    public:
+        /** Get the current version of the resource. */
+        const std::shared_ptr<TResource>& get() const noexcept { return m_resource; }
+
+        /** Get the number of times the resource was reloaded. */
+        unsigned int reloadCount() const noexcept { return m_reloadCount; }
+
+        /** Get the error of the last reload, or an empty string if it succeeded. A failed reload keeps the resource. */
+        const std::string& reloadError() const noexcept { return m_reloadError; }
+
+    private:
+        friend class ResourceReloader;
+
+        std::shared_ptr<TResource> m_resource;
+        unsigned int m_reloadCount = 0;
+        std::string m_reloadError;
+    };
+
+    /**
+     * Loads resources and reloads them while the program runs when the files they were loaded from change.
+     *
+     * Every file a resource reads through resources() while it loads is recorded as a dependency of the resource and
+     * watched with IFileSystem::watchFile. Calling update() between frames finds the resources whose files changed and
+     * reloads only those. A resource is loaded in two steps: reading, which must only touch the disk and the CPU and
+     * runs on a background thread, and creating, which can use the device context and runs in update() on the thread
+     * that calls it. Reloaded resources replace the old ones in update(), so nothing changes in the middle of a frame.
+     *
+     * Files written while loading (like cooked model caches) are not dependencies. Each load records the files read
+     * on its own thread and on the parallelFor workers it starts, so loads that overlap in time keep separate
+     * dependencies.
+     */
+    class ResourceReloader
+    {
+    public:
+        /** Constructor. */
+        ResourceReloader(
+            std::shared_ptr<IDeviceContext> deviceContext,          ///< Device context for creating resources.
+            std::shared_ptr<IFileSystem> fileSystem);               ///< File system to load and watch files with.
+
+        /** Destructor. Waits for reloads that are still running. */
+        ~ResourceReloader();
+
+        ResourceReloader(const ResourceReloader&) = delete;
+        ResourceReloader& operator =(const ResourceReloader&) = delete;
+
+        /** Get the resources manager whose file reads are recorded as dependencies. */
+        ResourcesManager& resources() noexcept { return *m_resources; }
+
+        /**
+         * Load a resource that is reloaded when its files change. read(resources) returns the data read from disk
+         * and is called on a background thread when the resource is reloaded. create(std::move(data), resources)
+         * turns the data into the resource and returns it as a std::unique_ptr<TResource>. The first load calls both
+         * on the calling thread, and exceptions thrown by the first load are not caught.
+         */
+        template<typename TResource, typename TRead, typename TCreate>
+        std::shared_ptr<ReloadableResource<TResource>> load(TRead read, TCreate create)
+        {
+            using data_t = decltype(read(std::declval<ResourcesManager&>()));
+
+            auto holder = std::make_shared<ReloadableResource<TResource>>();
+            std::weak_ptr<ReloadableResource<TResource>> weakHolder = holder;
+
+            auto entry = std::make_shared<tracked_resource_t>();
+
+            entry->isAlive = [weakHolder]() { return !weakHolder.expired(); };
+
+            entry->read = [read](ResourcesManager& resources) {
+                return std::shared_ptr<void>(std::make_shared<data_t>(read(resources)));
+            };
+
+            entry->create = [create, weakHolder](std::shared_ptr<void> data, ResourcesManager& resources) {
+                std::shared_ptr<TResource> resource =
+                    create(std::move(*static_cast<data_t *>(data.get())), resources);
+
+                if (auto h = weakHolder.lock())
+                {
+                    h->m_resource = std::move(resource);
+                }
+            };
+
+            entry->setResult = [weakHolder](const std::string& error) {
+                if (auto h = weakHolder.lock())
+                {
+                    h->m_reloadCount += (error.empty() ? 1 : 0);
+                    h->m_reloadError = error;
+                }
+            };
+
+            loadTracked(entry);
+            return holder;
+        }
+
+        /** Load a model and the textures of its materials, which are reloaded when any of their files change. */
+        std::shared_ptr<ReloadableResource<ModelData>> loadModel(const std::string& path);
+
+        /**
+         * Start reloading the resources whose files changed since the last update, and replace the resources whose
+         * reloads finished. Call this between frames, on the thread that loaded the resources. Returns the number
+         * of resources that were replaced.
+         */
+        size_t update();
+
+    private:
+        /** Files read while a resource was loading, which is the work context of the threads loading it. */
+        struct recording_t : public WorkContext
+        {
+            std::unordered_set<std::string> readFiles;
+            WorkContext * previousContext = nullptr;    ///< Context of the thread before recording started.
+        };
+
+        /** Type erased resource that is tracked for reloading. */
+        struct tracked_resource_t
+        {
+            std::function<bool()> isAlive;
+            std::function<std::shared_ptr<void>(ResourcesManager&)> read;
+            std::function<void(std::shared_ptr<void>, ResourcesManager&)> create;
+            std::function<void(const std::string&)> setResult;
+            std::unordered_set<std::string> dependencies;
+            std::future<std::shared_ptr<void>> reload;      ///< Data read by the running reload, if there is one.
+            std::unique_ptr<recording_t> reloadRecording;   ///< Files used by the running reload.
+            bool isOutOfDate = false;                       ///< A file changed while the resource was reloading.
+        };
+
+        class RecordingFileSystem;
+
+    private:
+        void loadTracked(const std::shared_ptr<tracked_resource_t>& entry);
+        void startReload(const std::shared_ptr<tracked_resource_t>& entry);
+        void setDependencies(tracked_resource_t& entry, const recording_t& recording);
+
+        /** Start recording the files read on the calling thread and the workers it starts. */
+        void beginRecording(recording_t& recording);
+
+        /** Stop recording files into a recording on the calling thread. */
+        void endRecording(recording_t& recording);
+
+        /** Add a file read through the resources manager to the recording of the load that read it. */
+        void recordFile(const std::string& path, bool isWrite);
+
+    private:
+        std::shared_ptr<IFileSystem> m_fileSystem;
+        std::unique_ptr<ResourcesManager> m_resources;
+        std::vector<std::shared_ptr<tracked_resource_t>> m_trackedResources;
+
+        std::mutex m_recordingMutex;
+        std::unordered_set<std::string> m_writtenFiles;     ///< Every file written through the resources manager.
+    };
+}
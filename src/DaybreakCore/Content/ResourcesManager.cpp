@@ -4,20 +4,72 @@
 #include "Common/Error.h"
 
 #include "Content/ObjModel/ObjResourceLoader.h"
+#include "Content/GltfModel/GltfResourceLoader.h"
 #include "Content\Models\ModelData.h"
 #include "Content\Materials\MaterialData.h"
 #include "Content\Images\ImageResourceLoader.h"
+#include "Content\Images\CompressedTextureResourceLoader.h"
 #include "Content\Images\Image.h"
+#include "Content\Images\BlockCompression.h"
+#include "Content\MappedFile.h"
+#include "Utility/ParallelFor.h"
 
 #include "Renderer\DeviceContext.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
 #include <future>
+#include <iterator>
+#include <thread>
+#include <unordered_set>
 
 using namespace Daybreak;
 
 // TODO: Rewrite the futures system with async i/o and threads or something. I'm not sure, all I know is this is
 //       horrible and barely better than synchronous loading.
 
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    /** Material parameters that hold a texture loaded from an image file. */
+    const MaterialParameterType MaterialTextureParameters[] = {
+        MaterialParameterType::DiffuseMap,
+        MaterialParameterType::SpecularMap,
+        MaterialParameterType::DisplacementMap,
+        MaterialParameterType::NormalMap
+    };
+
+    /** Check if a path ends with a file extension, ignoring case. */
+    bool hasFileExtension(const std::string& path, const std::string& extension)
+    {
+        return path.size() >= extension.size() &&
+            std::equal(extension.rbegin(), extension.rend(), path.rbegin(), [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            });
+    }
+
+    /** Normalise a texture path so different spellings of the same path share a cached texture. */
+    std::string normaliseTexturePath(const std::string& path)
+    {
+        return std::filesystem::path(path).lexically_normal().generic_string();
+    }
+
+    /** Hash the contents of a file with 64 bit FNV-1a. */
+    uint64_t hashFileContents(const unsigned char * bytes, size_t size)
+    {
+        uint64_t hash = 14695981039346656037ull;
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+
+        return hash;
+    }
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 ResourcesManager::ResourcesManager(
     std::shared_ptr<IDeviceContext> deviceContext,
@@ -32,14 +84,48 @@ ResourcesManager::ResourcesManager(
 //---------------------------------------------------------------------------------------------------------------------
 std::unique_ptr<ModelData> ResourcesManager::loadModel(const std::string& path)
 {
-    // Read the model from disk and convert it to the Daybreak model format.
-    // TODO: Use appropriate loader for the file format.
-    ObjResourceLoader l;
-    auto model = l.load(path, *this);
+    auto model = readModel(path);
+    createModelTextures(*model, readModelImages(*model));
+
+    return model;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<ModelData> ResourcesManager::readModel(const std::string& path)
+{
+    // Read the model from disk and convert it to the Daybreak model format with the loader for its file extension.
+    if (hasFileExtension(path, GltfResourceLoader::FileExtension))
+    {
+        GltfResourceLoader l;
+        return l.load(path, *this);
+    }
+    else
+    {
+        ObjResourceLoader l;
+        l.setCookedModelCache(m_modelLoadOptions.cookedModelCache);
+        l.setMeshOptimization(m_modelLoadOptions.meshOptimization);
+        l.setSplitLargeMeshes(m_modelLoadOptions.splitLargeMeshes);
+        l.setMeshletGeneration(m_modelLoadOptions.meshletGeneration);
+        l.setVertexQuantization(m_modelLoadOptions.vertexQuantization);
+        l.setNormalGeneration(m_modelLoadOptions.normalGeneration);
+        l.setTangentGeneration(m_modelLoadOptions.tangentGeneration);
+        l.setStreaming(m_modelLoadOptions.streaming);
+
+        return l.load(path, *this);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+ResourcesManager::image_lut_t ResourcesManager::readModelImages(const ModelData& model)
+{
+    // Find the path of every texture that is not loaded yet, and the texture parameters each path is used with.
+    std::vector<std::string> paths;
+    std::unordered_map<std::string, std::vector<TextureParameters>> pathParams;
+    std::unordered_set<std::string> linearPaths;
+    std::unordered_set<std::string> unflippedPaths;
+    std::unordered_map<std::string, embedded_image_t> embeddedImages;
 
-    // Load all textures associated with materials in the model.
-    // TODO: Use a stack vector and wait in parallel.
-    for (auto& group : model->groups())
+    for (auto& group : model.groups())
     {
         // Skip groups that don't have a material.
         if (!group.hasMaterial())
@@ -47,63 +133,581 @@ std::unique_ptr<ModelData> ResourcesManager::loadModel(const std::string& path)
             continue;
         }
 
-        // TODO: Is there a better way to do this?
-        auto& material = group.materialRef();
-                
-        loadMaterialTextureParameterIfMissing(material, MaterialParameterType::DiffuseMap);
-        loadMaterialTextureParameterIfMissing(material, MaterialParameterType::SpecularMap);
-        loadMaterialTextureParameterIfMissing(material, MaterialParameterType::DisplacementMap);
-        loadMaterialTextureParameterIfMissing(material, MaterialParameterType::NormalMap);
-        loadMaterialTextureParameterIfMissing(material, MaterialParameterType::DiffuseMap);
+        const auto& material = group.materialRef();
+
+        for (auto paramType : MaterialTextureParameters)
+        {
+            if (!material.isParameterDefined(paramType))
+            {
+                continue;
+            }
+
+            auto param = material.getTextureParameter(paramType);
+
+            if (param.texture == nullptr)
+            {
+                auto& params = pathParams[param.filepath];
+
+                if (params.empty())
+                {
+                    paths.push_back(param.filepath);
+                }
+
+                if (param.embeddedImage.bytes != nullptr)
+                {
+                    embeddedImages[param.filepath] = param.embeddedImage;
+                }
+
+                if (std::find(params.begin(), params.end(), param.textureParams) == params.end())
+                {
+                    params.push_back(param.textureParams);
+                }
+
+                if (!param.flipVertically)
+                {
+                    unflippedPaths.insert(param.filepath);
+                }
+
+                // Normal and displacement maps hold data rather than colors, so they are not sRGB encoded.
+                if (paramType == MaterialParameterType::NormalMap ||
+                    paramType == MaterialParameterType::DisplacementMap)
+                {
+                    linearPaths.insert(param.filepath);
+                }
+            }
+        }
+    }
+
+    // Encoded bytes of an image, which are either stored inside the file that holds it or are the whole image file.
+    auto imageBytes = [&](const std::string& path) {
+        auto embedded = embeddedImages.find(path);
+
+        if (embedded != embeddedImages.end())
+        {
+            return embedded->second;
+        }
+
+        auto file = mapFile(path);
+
+        embedded_image_t image;
+        image.containerPath = path;
+        image.bytes = file->data();
+        image.offset = 0;
+        image.size = file->size();
+        image.bytesOwner = file;
+
+        return image;
+    };
+
+    // Keep the cached textures that are still up to date, and only read the files that are missing a texture. A file
+    // that does not exist has an empty stamp and fails when it is read. Images stored inside another file use the
+    // stamp of that file.
+    image_lut_t images;
+    std::vector<std::string> uncachedPaths;
+
+    for (const auto& path : paths)
+    {
+        auto& entry = images[path];
+        const auto& params = pathParams[path];
+        const auto normalisedPath = normaliseTexturePath(path);
+        entry.isFlipped = (unflippedPaths.count(path) == 0);
+
+        auto embedded = embeddedImages.find(path);
+        tryGetFileStamp(embedded == embeddedImages.end() ? path : embedded->second.containerPath, entry.stamp);
+
+        std::lock_guard<std::mutex> lock(m_textureCacheMutex);
+
+        for (const auto& textureParams : params)
+        {
+            if (auto texture = findCachedTexture({ normalisedPath, textureParams, entry.isFlipped }, entry.stamp))
+            {
+                entry.cachedTextures.emplace_back(textureParams, std::move(texture));
+            }
+        }
+
+        if (entry.cachedTextures.size() < params.size())
+        {
+            uncachedPaths.push_back(path);
+        }
+    }
+
+    // Hash the files that are not cached by path so files with the same contents are only decoded once. Hashes can
+    // collide, so images with the same hash are only shared after their bytes are compared.
+    std::vector<std::string> decodePaths;
+    std::unordered_map<std::string, std::string> duplicatePaths;
+
+    if (m_textureContentDeduplication)
+    {
+        std::vector<embedded_image_t> contents(uncachedPaths.size());
+        std::vector<uint64_t> hashes(uncachedPaths.size());
+
+        parallelFor(uncachedPaths.size(), std::thread::hardware_concurrency(), [&](size_t i) {
+            contents[i] = imageBytes(uncachedPaths[i]);
+            hashes[i] = hashFileContents(contents[i].bytes, contents[i].size);
+        });
+
+        std::unordered_map<uint64_t, std::vector<size_t>> decodedWithHash;
+
+        for (size_t i = 0; i < uncachedPaths.size(); ++i)
+        {
+            const auto& path = uncachedPaths[i];
+            const auto& params = pathParams[path];
+            auto& entry = images[path];
+
+            entry.contentHash = hashes[i];
+            entry.contentRange = { contents[i].containerPath, contents[i].offset, contents[i].size, entry.stamp };
+
+            // Textures made from contents with the same hash, which are used once their bytes are compared.
+            struct candidate_t
+            {
+                TextureParameters params;
+                std::shared_ptr<ITexture2d> texture;
+                image_range_t source;
+            };
+
+            std::vector<candidate_t> candidates;
+
+            {
+                std::lock_guard<std::mutex> lock(m_textureCacheMutex);
+
+                for (const auto& textureParams : params)
+                {
+                    auto cachedTexture = findCachedTexture({ entry.contentHash, textureParams, entry.isFlipped });
+                    const auto isHeld = std::any_of(
+                        entry.cachedTextures.begin(),
+                        entry.cachedTextures.end(),
+                        [&textureParams](const auto& cached) { return cached.first == textureParams; });
+
+                    if (cachedTexture.first != nullptr && !isHeld)
+                    {
+                        candidates.push_back({ textureParams, std::move(cachedTexture.first), cachedTexture.second });
+                    }
+                }
+            }
+
+            // Compare the bytes without holding the lock, since it reads the file the texture was made from.
+            for (auto& candidate : candidates)
+            {
+                if (hasSameContents(candidate.source, entry.contentRange))
+                {
+                    entry.cachedTextures.emplace_back(candidate.params, std::move(candidate.texture));
+                }
+            }
+
+            if (entry.cachedTextures.size() == params.size())
+            {
+                continue;
+            }
+
+            auto& sameHash = decodedWithHash[entry.contentHash];
+            auto original = std::find_if(sameHash.begin(), sameHash.end(), [&](size_t j) {
+                return images[uncachedPaths[j]].isFlipped == entry.isFlipped &&
+                    contents[j].size == contents[i].size &&
+                    std::memcmp(contents[j].bytes, contents[i].bytes, contents[i].size) == 0;
+            });
+
+            if (original == sameHash.end())
+            {
+                sameHash.push_back(i);
+                decodePaths.push_back(path);
+            }
+            else
+            {
+                duplicatePaths[path] = uncachedPaths[*original];
+            }
+        }
+    }
+    else
+    {
+        decodePaths = std::move(uncachedPaths);
+    }
+
+    // Read and decode all of the remaining images at the same time.
+    std::vector<std::unique_ptr<Image>> loadedImages(decodePaths.size());
+
+    parallelFor(decodePaths.size(), std::thread::hardware_concurrency(), [&](size_t i) {
+        const auto& path = decodePaths[i];
+        const auto flipVertically = (unflippedPaths.count(path) == 0);
+        auto embedded = embeddedImages.find(path);
+
+        if (embedded == embeddedImages.end())
+        {
+            loadedImages[i] = loadImage(path, flipVertically);
+        }
+        else
+        {
+            loadedImages[i] = BytePerChannelImage::LoadFromMemory(
+                path,
+                embedded->second.bytes,
+                embedded->second.size,
+                flipVertically);
+        }
+    });
+
+    // Generate the mipmaps of the images and compress them before they reach the render thread. The threads are split
+    // between the images, and each image filters and compresses its rows with its share, so that a model with a single
+    // large texture still uses every thread.
+    const auto threadCount = static_cast<size_t>(std::thread::hardware_concurrency());
+    const auto imageCount = static_cast<size_t>(std::count_if(
+        loadedImages.begin(),
+        loadedImages.end(),
+        [](const auto& image) { return !image->IsBlockCompressed(); }));
+    const auto workersPerImage = std::max<size_t>(1, threadCount / std::max<size_t>(1, imageCount));
+
+    parallelFor(loadedImages.size(), threadCount, [&](size_t i) {
+        // Block compressed textures were loaded with every mipmap they have, and are already compressed.
+        if (loadedImages[i]->IsBlockCompressed())
+        {
+            return;
+        }
+
+        mip_map_settings_t settings;
+        settings.filter = m_mipMapFilter;
+        settings.isSrgb = (linearPaths.count(decodePaths[i]) == 0);
+        settings.maxWorkerCount = workersPerImage;
+
+        loadedImages[i]->GenerateMipMaps(settings);
+
+        if (m_textureCompression)
+        {
+            const auto format = blockCompressionForChannels(static_cast<size_t>(loadedImages[i]->Format()));
+            loadedImages[i] = BlockCompressedImage::Compress(*loadedImages[i], format, workersPerImage);
+        }
+    });
+
+    for (size_t i = 0; i < decodePaths.size(); ++i)
+    {
+        images[decodePaths[i]].image = std::move(loadedImages[i]);
+    }
+
+    for (const auto& duplicate : duplicatePaths)
+    {
+        images[duplicate.first].image = images[duplicate.second].image;
     }
 
-    // Return the loaded model.
-    return std::move(model); 
+    return images;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-bool ResourcesManager::loadMaterialTextureParameterIfMissing(
-    MaterialData& material,
-    MaterialParameterType paramType)
+void ResourcesManager::createModelTextures(ModelData& model, const image_lut_t& images)
 {
-    if (material.isParameterDefined(paramType))
+    // A texture that is waiting to be created, and the material parameter it will be stored in.
+    struct pending_texture_t
+    {
+        MaterialData * material;
+        MaterialParameterType paramType;
+        material_texture_t param;
+        const texture_image_t * source;
+        size_t uploadIndex;
+    };
+
+    // A texture parameter with no texture cached under its path, and the texture cached for the same contents.
+    struct uncached_texture_t
     {
-        auto param = material.getTextureParameter(paramType);
+        MaterialData * material;
+        MaterialParameterType paramType;
+        material_texture_t param;
+        const texture_image_t * source;
+        std::shared_ptr<ITexture2d> candidate;
+        image_range_t candidateSource;
+    };
+
+    std::vector<uncached_texture_t> uncachedTextures;
+
+    {
+        std::lock_guard<std::mutex> lock(m_textureCacheMutex);
+
+        for (auto& group : model.groups())
+        {
+            // Skip groups that don't have a material.
+            if (!group.hasMaterial())
+            {
+                continue;
+            }
+
+            auto& material = group.materialRef();
+
+            for (auto paramType : MaterialTextureParameters)
+            {
+                if (!material.isParameterDefined(paramType))
+                {
+                    continue;
+                }
+
+                // Create the texture from the image read from disk if it is not (yet) present.
+                auto param = material.getTextureParameter(paramType);
+                auto image = images.find(param.filepath);
+
+                if (param.texture != nullptr || image == images.end())
+                {
+                    continue;
+                }
+
+                // Use a cached texture if there is one, whether it was found when the images were read or was created
+                // by another model since then.
+                const auto& source = image->second;
+
+                for (const auto& cached : source.cachedTextures)
+                {
+                    if (cached.first == param.textureParams)
+                    {
+                        param.texture = cached.second;
+                    }
+                }
+
+                if (param.texture == nullptr)
+                {
+                    param.texture = findCachedTexture(
+                        { normaliseTexturePath(param.filepath), param.textureParams, source.isFlipped },
+                        source.stamp);
+                }
+
+                if (param.texture != nullptr)
+                {
+                    material.setParameter(paramType, param);
+                    continue;
+                }
+
+                // A texture made from contents with the same hash can be used once the bytes are compared.
+                std::pair<std::shared_ptr<ITexture2d>, image_range_t> candidate;
+
+                if (source.contentHash != 0)
+                {
+                    candidate = findCachedTexture({ source.contentHash, param.textureParams, source.isFlipped });
+                }
+
+                uncachedTextures.push_back({
+                    &material,
+                    paramType,
+                    std::move(param),
+                    &source,
+                    std::move(candidate.first),
+                    std::move(candidate.second) });
+            }
+        }
+    }
 
-        // Load the texture from disk if it is not (yet) present).
-        if (param.texture == nullptr)
+    // Compare the bytes without holding the lock, since it reads the file the texture was made from.
+    for (auto& uncached : uncachedTextures)
+    {
+        if (uncached.candidate != nullptr && hasSameContents(uncached.candidateSource, uncached.source->contentRange))
         {
-            // TODO: Warn if the texture could not be loaded.
-            auto image = loadImage(param.filepath);
+            uncached.param.texture = std::move(uncached.candidate);
+        }
+    }
 
-            // TODO: Support loading texture in format specified by material.
-            // TODO: Support loading textures in non vendor specific API.
-            param.texture = m_deviceContext->createTexture2d(
-                *(image.get()),
-                param.textureParams);
+    std::vector<pending_texture_t> pendingTextures;
+    std::vector<texture2d_upload_t> uploads;
+    std::unordered_map<texture_key_t<const Image *>, size_t, texture_key_hash_t> uploadIndices;
 
-            // Remove the parameter if the texture could not be loaded otherwise store the texture in the material.
-            if (param.texture == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(m_textureCacheMutex);
+
+        for (auto& uncached : uncachedTextures)
+        {
+            auto& param = uncached.param;
+            const auto& source = *uncached.source;
+            const path_texture_key_t pathKey{
+                normaliseTexturePath(param.filepath),
+                param.textureParams,
+                source.isFlipped };
+
+            if (param.texture != nullptr)
             {
-                material.removeParameter(paramType);
+                // Cache the texture under this path too, so the file does not need to be hashed next time.
+                m_textureCache[pathKey] = { param.texture, source.stamp };
             }
             else
             {
-                material.setParameter(paramType, param);
+                // Another model may have created the texture while the lock was released.
+                param.texture = findCachedTexture(pathKey, source.stamp);
+            }
+
+            if (param.texture != nullptr)
+            {
+                uncached.material->setParameter(uncached.paramType, param);
+                continue;
+            }
+
+            // Otherwise create the texture, once for every image and set of texture parameters.
+            CHECK_NOT_NULL(source.image);
+
+            auto upload = uploadIndices.emplace(
+                texture_key_t<const Image *>{ source.image.get(), param.textureParams },
+                uploads.size());
+
+            if (upload.second)
+            {
+                uploads.push_back({ source.image.get(), param.textureParams });
             }
+
+            pendingTextures.push_back(
+                { uncached.material, uncached.paramType, std::move(param), &source, upload.first->second });
+        }
+    }
+
+    if (uploads.empty())
+    {
+        return;
+    }
+
+    // Create every texture in one batch so the device context can upload them together.
+    // TODO: Warn if a texture could not be loaded.
+    // TODO: Support loading texture in format specified by material.
+    auto createdTextures = m_deviceContext->createTextures2d(uploads);
+    CHECK(createdTextures.size() == uploads.size());
+
+    std::vector<std::shared_ptr<ITexture2d>> textures(
+        std::make_move_iterator(createdTextures.begin()),
+        std::make_move_iterator(createdTextures.end()));
+
+    std::lock_guard<std::mutex> lock(m_textureCacheMutex);
+
+    for (auto& pending : pendingTextures)
+    {
+        const auto& texture = textures[pending.uploadIndex];
+
+        // Remove the parameter if the texture could not be loaded otherwise store the texture in the material.
+        if (texture == nullptr)
+        {
+            pending.material->removeParameter(pending.paramType);
+            continue;
         }
 
+        pending.param.texture = texture;
+        pending.material->setParameter(pending.paramType, pending.param);
+
+        const auto& params = pending.param.textureParams;
+        const auto& source = *pending.source;
+        m_textureCache[{ normaliseTexturePath(pending.param.filepath), params, source.isFlipped }] =
+            { texture, source.stamp };
+
+        if (source.contentHash != 0)
+        {
+            m_contentTextureCache[{ source.contentHash, params, source.isFlipped }] = { texture, source.contentRange };
+        }
+    }
+
+    pruneTextureCache();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+size_t ResourcesManager::cachedTextureCount()
+{
+    std::lock_guard<std::mutex> lock(m_textureCacheMutex);
+    pruneTextureCache();
+
+    return m_textureCache.size();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<ITexture2d> ResourcesManager::findCachedTexture(
+    const path_texture_key_t& key,
+    const file_stamp_t& stamp)
+{
+    auto cached = m_textureCache.find(key);
+
+    if (cached == m_textureCache.end() || cached->second.stamp != stamp)
+    {
+        return nullptr;
+    }
+
+    return cached->second.texture.lock();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::pair<std::shared_ptr<ITexture2d>, ResourcesManager::image_range_t> ResourcesManager::findCachedTexture(
+    const content_texture_key_t& key)
+{
+    auto cached = m_contentTextureCache.find(key);
+
+    if (cached == m_contentTextureCache.end())
+    {
+        return {};
+    }
+
+    return { cached->second.texture.lock(), cached->second.source };
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool ResourcesManager::hasSameContents(const image_range_t& a, const image_range_t& b)
+{
+    if (a.size != b.size)
+    {
+        return false;
+    }
+
+    if (a.path == b.path && a.offset == b.offset && a.stamp == b.stamp)
+    {
         return true;
     }
 
-    return false;
+    // Both files must still be the ones that were read, otherwise the texture made from them may be out of date.
+    file_stamp_t stampA, stampB;
+
+    if (!tryGetFileStamp(a.path, stampA) || stampA != a.stamp || !tryGetFileStamp(b.path, stampB) || stampB != b.stamp)
+    {
+        return false;
+    }
+
+    auto fileA = mapFile(a.path);
+    auto fileB = mapFile(b.path);
+
+    if (a.offset + a.size > fileA->size() || b.offset + b.size > fileB->size())
+    {
+        return false;
+    }
+
+    return std::memcmp(fileA->data() + a.offset, fileB->data() + b.offset, a.size) == 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ResourcesManager::pruneTextureCache()
+{
+    for (auto itr = m_textureCache.begin(); itr != m_textureCache.end();)
+    {
+        itr = (itr->second.texture.expired() ? m_textureCache.erase(itr) : std::next(itr));
+    }
+
+    for (auto itr = m_contentTextureCache.begin(); itr != m_contentTextureCache.end();)
+    {
+        itr = (itr->second.texture.expired() ? m_contentTextureCache.erase(itr) : std::next(itr));
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<Image> ResourcesManager::loadImage(const std::string& path, bool flipVertically)
+{
+    // Textures that were compressed ahead of time are loaded with their mipmaps rather than decoded.
+    if (hasFileExtension(path, CompressedTextureResourceLoader::DdsFileExtension) ||
+        hasFileExtension(path, CompressedTextureResourceLoader::Ktx2FileExtension))
+    {
+        CompressedTextureResourceLoader l;
+        l.setFlipVertically(flipVertically);
+
+        return l.load(path, *this);
+    }
+    else
+    {
+        ImageResourceLoader l;
+        l.setFlipVertically(flipVertically);
+
+        return l.load(path, *this);
+    }
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-std::unique_ptr<Image> ResourcesManager::loadImage(const std::string& path)
+std::vector<std::unique_ptr<Image>> ResourcesManager::loadImages(
+    const std::vector<std::string>& paths,
+    size_t maxWorkerCount)
 {
-    ImageResourceLoader l;
-    return l.load(path, *this);
+    std::vector<std::unique_ptr<Image>> images(paths.size());
+
+    parallelFor(paths.size(), maxWorkerCount, [&](size_t i) {
+        images[i] = loadImage(paths[i]);
+    });
+
+    return images;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -111,3 +715,27 @@ std::string ResourcesManager::loadTextFile(const std::string& path)
 {
     return m_fileSystem->loadFileAsText(path).get();
 }
+
+//---------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<const MappedFile> ResourcesManager::mapFile(const std::string& path)
+{
+    return m_fileSystem->mapFile(path).get();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<std::istream> ResourcesManager::openFile(const std::string& path)
+{
+    return m_fileSystem->openFile(path);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ResourcesManager::writeFile(const std::string& path, const std::function<void(std::ostream&)>& writeContents)
+{
+    m_fileSystem->writeFile(path, writeContents);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool ResourcesManager::tryGetFileStamp(const std::string& path, file_stamp_t& stamp)
+{
+    return m_fileSystem->tryGetFileStamp(path, stamp);
+}
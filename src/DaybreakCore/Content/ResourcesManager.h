@@ -1,7 +1,18 @@
 #pragma once
+#include "Content/IFileSystem.h"
+#include "Content/Images/MipMapGenerator.h"
+#include "Renderer/Texture.h"
+
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <future>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace Daybreak
 {
@@ -10,34 +21,219 @@ namespace Daybreak
     class ModelData;
     class MaterialData;
     class Image;
+    class MappedFile;
 
     enum class MaterialParameterType : int;
     
-    /** Manages the loading, unloading and lifetime of game resources. */
+    /**
+     * Manages the loading, unloading and lifetime of game resources.
+     *
+     * Material textures are cached by their normalised path and texture parameters, so every material that uses the
+     * same file shares one texture, even across models. The cache does not keep textures alive: a texture is freed
+     * once nothing uses it. A cached texture is only reused while its file has the same size and write time as when it
+     * was read. With content deduplication enabled, files with identical contents under different names also share a
+     * texture.
+     */
     class ResourcesManager
     {
+    public:
+        /** Part of a file that holds an encoded image, which is the whole file unless the image is embedded in it. */
+        struct image_range_t
+        {
+            std::string path;
+            size_t offset = 0;
+            size_t size = 0;
+            file_stamp_t stamp;                     ///< Size and write time of the file when it was read.
+        };
+
+        /** Image of a material texture read from disk by readModelImages. */
+        struct texture_image_t
+        {
+            std::shared_ptr<const Image> image;     ///< Decoded image, or null if every texture using it is cached.
+            file_stamp_t stamp;                     ///< Size and write time of the file when it was read.
+            uint64_t contentHash = 0;               ///< Hash of the file contents, or zero if it was not hashed.
+            image_range_t contentRange;             ///< Where the hashed contents are stored.
+            bool isFlipped = true;                  ///< Set if the image was flipped so its first row is the bottom.
+
+            /** Cached textures made from the file, kept alive until the model's textures are created. */
+            std::vector<std::pair<TextureParameters, std::shared_ptr<ITexture2d>>> cachedTextures;
+        };
+
+        /** Images read from disk, keyed by the texture path used by the materials. */
+        using image_lut_t = std::unordered_map<std::string, texture_image_t>;
+
+        /** Optional processing applied to obj models read by readModel. Everything is off by default. */
+        struct model_load_options_t
+        {
+            bool cookedModelCache = false;      ///< Use and save a cooked copy of the model next to the obj file.
+            bool meshOptimization = false;      ///< Reorder triangles and vertices for the vertex cache and fetch.
+            bool splitLargeMeshes = false;      ///< Split meshes too large for 16 bit indices.
+            bool meshletGeneration = false;     ///< Split every group into meshlets with culling bounds.
+            bool vertexQuantization = false;    ///< Store vertices in compact formats the renderer dequantizes.
+            bool normalGeneration = false;      ///< Generate normals for models without any.
+            bool tangentGeneration = false;     ///< Generate tangents for models with a normal mapped material.
+            bool streaming = false;             ///< Stream obj files in chunks instead of reading them all at once.
+        };
+
     public:
         /** Initialize resources manager. */
         ResourcesManager(
             std::shared_ptr<IDeviceContext> deviceContext,          ///< Current device context for creating resources.
             std::shared_ptr<IFileSystem> fileSystem);               ///< Current file system device.
 
-        /** Load a 3d model. */
+        /** Load a 3d model and create the textures used by its materials. */
         std::unique_ptr<ModelData> loadModel(const std::string& path);
 
-        /** Load an image. */
-        std::unique_ptr<Image> loadImage(const std::string& path);
+        /** Read a 3d model without creating its textures. Unlike loadModel this does not use the device context. */
+        std::unique_ptr<ModelData> readModel(const std::string& path);
+
+        /**
+         * Read the images of every material texture in a model that does not have a texture yet. The images are read,
+         * decoded and given mipmaps in parallel, and each image is read once even when many materials use it. Color
+         * maps are filtered as sRGB, while normal and displacement maps are filtered as linear data.
+         */
+        image_lut_t readModelImages(const ModelData& model);
+
+        /**
+         * Create the textures of a model's materials from images read with readModelImages. Every texture is created
+         * in one batch with the device context, so call this on the render thread.
+         */
+        void createModelTextures(ModelData& model, const image_lut_t& images);
+
+        /**
+         * Set if files with identical contents share a texture even when their paths differ. This hashes every texture
+         * file that is not already cached by path before it is decoded. Off by default.
+         */
+        void setTextureContentDeduplication(bool isEnabled) noexcept { m_textureContentDeduplication = isEnabled; }
+
+        /**
+         * Set if material textures are block compressed after their mipmaps are generated. Images are compressed
+         * into the format that keeps all of their channels, so normal maps use BC1 rather than BC5 to keep the
+         * normal's z channel. Off by default.
+         */
+        void setTextureCompression(bool isEnabled) noexcept { m_textureCompression = isEnabled; }
+
+        /** Get the processing applied to obj models read by readModel. */
+        const model_load_options_t& modelLoadOptions() const noexcept { return m_modelLoadOptions; }
+
+        /**
+         * Set the processing applied to obj models read by readModel. The cooked model cache writes a file next to
+         * every model it loads, so only enable it where the content directory is writable.
+         */
+        void setModelLoadOptions(const model_load_options_t& options) noexcept { m_modelLoadOptions = options; }
+
+        /** Set the filter used to generate the mipmaps of material textures. Kaiser by default. */
+        void setMipMapFilter(MipMapFilter filter) noexcept { m_mipMapFilter = filter; }
+
+        /** Get the number of textures in the cache that are still in use. */
+        size_t cachedTextureCount();
+
+        /**
+         * Load an image. Images are flipped so the first row is the bottom row by default, which is the order OpenGL
+         * expects for texture coordinates with (0, 0) at the bottom left.
+         */
+        std::unique_ptr<Image> loadImage(const std::string& path, bool flipVertically = true);
+
+        /**
+         * Load many images, decoding up to maxWorkerCount of them at the same time. The images are returned in the
+         * order of their paths, and the first error is thrown once every worker is done.
+         */
+        std::vector<std::unique_ptr<Image>> loadImages(const std::vector<std::string>& paths, size_t maxWorkerCount);
 
         /** Load a text file. */
         std::string loadTextFile(const std::string& path);
 
+        /** Map a file into memory for reading without copying it. */
+        std::shared_ptr<const MappedFile> mapFile(const std::string& path);
+
+        /** Open a file as a binary stream for reading it a piece at a time. */
+        std::unique_ptr<std::istream> openFile(const std::string& path);
+
+        /**
+         * Create (or replace) a file with the contents written by writeContents, which replaces the old file only once
+         * it is complete. Throws ContentWriteException if the file cannot be written.
+         */
+        void writeFile(const std::string& path, const std::function<void(std::ostream&)>& writeContents);
+
+        /** Get the size and last write time of a file. Returns false if the file does not exist. */
+        bool tryGetFileStamp(const std::string& path, file_stamp_t& stamp);
+
+    private:
+        /** Texture in the texture cache, which is up to date while its file matches the stamp. */
+        struct cached_texture_t
+        {
+            std::weak_ptr<ITexture2d> texture;
+            file_stamp_t stamp;
+        };
+
+        /** Texture made from file contents, which is only shared with images that have exactly the same bytes. */
+        struct cached_content_texture_t
+        {
+            std::weak_ptr<ITexture2d> texture;
+            image_range_t source;                   ///< Contents the texture was made from.
+        };
+
+        /**
+         * Key of a texture in the texture cache. The source is a normalised path or a content hash. The same file is
+         * a different texture when it is flipped for one model format and not for another.
+         */
+        template<typename TSource>
+        struct texture_key_t
+        {
+            TSource source;
+            TextureParameters params;
+            bool isFlipped = true;
+
+            bool operator ==(const texture_key_t& rhs) const
+            {
+                return source == rhs.source && params == rhs.params && isFlipped == rhs.isFlipped;
+            }
+        };
+
+        /** Hashes texture cache keys. */
+        struct texture_key_hash_t
+        {
+            template<typename TSource>
+            size_t operator()(const texture_key_t<TSource>& key) const
+            {
+                return combine_hash(0, key.source, key.params, key.isFlipped);
+            }
+        };
+
+        using path_texture_key_t = texture_key_t<std::string>;
+        using content_texture_key_t = texture_key_t<uint64_t>;
+
     private:
-        bool loadMaterialTextureParameterIfMissing(
-            MaterialData& material,
-            MaterialParameterType paramType);
+        /** Get a cached texture if it is still in use and up to date. Call with the texture cache locked. */
+        std::shared_ptr<ITexture2d> findCachedTexture(
+            const path_texture_key_t& key,
+            const file_stamp_t& stamp);
+
+        /**
+         * Get a texture made from file contents with the same hash if it is still in use, along with the contents it
+         * was made from. Call with the texture cache locked, and check the contents match before using the texture.
+         */
+        std::pair<std::shared_ptr<ITexture2d>, image_range_t> findCachedTexture(const content_texture_key_t& key);
+
+        /**
+         * Check if two images have exactly the same bytes. Images whose files changed since they were read never
+         * match.
+         */
+        bool hasSameContents(const image_range_t& a, const image_range_t& b);
+
+        /** Forget cached textures that are no longer used. Call with the texture cache locked. */
+        void pruneTextureCache();
 
     private:
         std::shared_ptr<IDeviceContext> m_deviceContext;
         std::shared_ptr<IFileSystem> m_fileSystem;
+
+        std::mutex m_textureCacheMutex;
+        std::unordered_map<path_texture_key_t, cached_texture_t, texture_key_hash_t> m_textureCache;
+        std::unordered_map<content_texture_key_t, cached_content_texture_t, texture_key_hash_t> m_contentTextureCache;
+        bool m_textureContentDeduplication = false;
+        MipMapFilter m_mipMapFilter = MipMapFilter::Kaiser;
+        bool m_textureCompression = false;
+        model_load_options_t m_modelLoadOptions;
     };
 }
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "BasicGeometryGenerator.h"
 #include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
 #include "Graphics/Mesh/VertexBufferData.h"
 #include "Graphics/Mesh/VertexFormat.h"
 #include "Graphics/Mesh/MeshData.h"
@@ -59,7 +60,7 @@ std::unique_ptr<MeshData> BasicGeometryGenerator::MakeCube()
         { -0.5f,  0.5f, -0.5f,   0.0f, 1.0f,   0.0f,  1.0f,  0.0f }
     };
 
-    const index_element_ui32 CubeIndices[CubeIndicesCount] =
+    const uint32_t CubeIndices[CubeIndicesCount] =
     {
         0,  1,  2,  3,  4,  5,
         6,  7,  8,  9, 10, 11,
@@ -73,11 +74,8 @@ std::unique_ptr<MeshData> BasicGeometryGenerator::MakeCube()
     std::unique_ptr<vertex_ptn_t[]> vertices(new vertex_ptn_t[CubeVerticesCount]);
     std::copy(std::begin(CubeVertices), std::end(CubeVertices), vertices.get());
 
-    std::unique_ptr<unsigned int[]> indices(new unsigned int[CubeIndicesCount]);
-    std::copy(std::begin(CubeIndices), std::end(CubeIndices), indices.get());
-
     return std::make_unique<MeshData>(
-        std::make_unique<IndexBufferData>(CubeIndicesCount, std::move(indices)),
+        createCompactIndexBuffer(CubeIndices, CubeIndicesCount),
         std::make_unique<VertexBufferData>(CubeVerticesCount, std::move(vertices), vertex_ptn_t::inputLayout)
     );
 }
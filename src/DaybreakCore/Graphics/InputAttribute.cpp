@@ -12,14 +12,21 @@ InputAttribute::InputAttribute(
     _In_ SemanticName name,
     _In_ unsigned int index,
     _In_ StorageType type,
-    _In_ unsigned int count)
-    : m_name(name), m_index(index), m_type(type), m_count(count)
+    _In_ unsigned int count,
+    _In_ bool normalized)
+    : m_name(name), m_index(index), m_type(type), m_count(count), m_normalized(normalized)
 {
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 size_t InputAttribute::sizeInBytes() const
 {
+    // Packed types store every component in one value.
+    if (m_type == StorageType::PackedInt2101010)
+    {
+        return typeSizeInBytes(m_type);
+    }
+
     return typeSizeInBytes(m_type) * m_count;
 }
 
@@ -43,6 +50,8 @@ size_t InputAttribute::typeSizeInBytes(StorageType type)
         return 4;
     case InputAttribute::StorageType::Double:
         return 8;
+    case InputAttribute::StorageType::PackedInt2101010:
+        return 4;
     default:
         THROW_ENUM_SWITCH_NOT_HANDLED(InputAttribute::StorageType, type);
     }
@@ -55,5 +64,6 @@ bool Daybreak::operator ==(const InputAttribute& lhs, const InputAttribute& rhs)
         lhs.semanticName() == rhs.semanticName() &&
         lhs.semanticIndex() == rhs.semanticIndex() &&
         lhs.type() == rhs.type() &&
-        lhs.count() == rhs.count();
+        lhs.count() == rhs.count() &&
+        lhs.normalized() == rhs.normalized();
 }
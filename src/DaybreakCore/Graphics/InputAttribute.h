@@ -12,7 +12,8 @@ namespace Daybreak
             None,
             Position,
             Texture,
-            Normal
+            Normal,
+            Tangent     ///< Tangent direction in xyz and the bitangent sign (1 or -1) in w.
         };
 
         // Underlying storage type for an attribute.
@@ -26,7 +27,8 @@ namespace Daybreak
             UnsignedInt,
             HalfFloat,
             Float,
-            Double
+            Double,
+            PackedInt2101010    ///< Four signed values of 10, 10, 10 and 2 bits packed into 32 bits. Count must be 4.
         };
 
     public:
@@ -38,7 +40,8 @@ namespace Daybreak
             _In_ SemanticName name,
             _In_ unsigned int index,
             _In_ StorageType type,
-            _In_ unsigned int count);
+            _In_ unsigned int count,
+            _In_ bool normalized = false);
 
     public:
         /// Get attribute intended use.
@@ -65,6 +68,12 @@ namespace Daybreak
         /// Set the storage count for this attribute.
         void setCount(_In_ unsigned int count) { m_count = count; }
 
+        /// Get if integer values are mapped to [0, 1] (unsigned) or [-1, 1] (signed) when read by a shader.
+        bool normalized() const noexcept { return m_normalized; }
+
+        /// Set if integer values are mapped to [0, 1] (unsigned) or [-1, 1] (signed) when read by a shader.
+        void setNormalized(_In_ bool normalized) noexcept { m_normalized = normalized; }
+
         /// Get attribute size in bytes.
         size_t sizeInBytes() const;
 
@@ -77,6 +86,7 @@ namespace Daybreak
         unsigned int m_index;
         StorageType m_type;
         unsigned int m_count;
+        bool m_normalized = false;
     };
 
     /// Input attribute equality operator.
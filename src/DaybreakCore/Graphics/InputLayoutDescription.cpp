@@ -33,6 +33,7 @@ void InputLayoutDescription::addAttribute(_In_ const InputAttribute& attribute)
 {
     // TODO: Validation!
     CHECK_NOT_ZERO(attribute.count());
+    CHECK(attribute.type() != InputAttribute::StorageType::PackedInt2101010 || attribute.count() == 4);
 
     m_attributes.push_back(attribute);
 }
@@ -42,9 +43,10 @@ void InputLayoutDescription::addAttribute(
     _In_ InputAttribute::SemanticName name,
     _In_ unsigned int index,
     _In_ InputAttribute::StorageType type,
-    _In_ unsigned int count)
+    _In_ unsigned int count,
+    _In_ bool normalized)
 {
-    addAttribute({ name, index, type, count });
+    addAttribute({ name, index, type, count, normalized });
 }
 
 //---------------------------------------------------------------------------------------------------------------------
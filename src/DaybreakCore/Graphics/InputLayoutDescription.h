@@ -26,7 +26,8 @@ namespace Daybreak
             _In_ InputAttribute::SemanticName name,
             _In_ unsigned int index,
             _In_ InputAttribute::StorageType type,
-            _In_ unsigned int count);
+            _In_ unsigned int count,
+            _In_ bool normalized = false);
 
         // Get number of attributes.
         size_t attributeCount() const noexcept;
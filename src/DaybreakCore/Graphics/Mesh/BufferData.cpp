@@ -25,9 +25,19 @@ BufferData::~BufferData() = default;
 
 //---------------------------------------------------------------------------------------------------------------------
 void BufferData::setUnownedDataPtr(_In_ size_t byteCount, _In_ void * bytes) noexcept
+{
+    setUnownedDataPtr(byteCount, bytes, nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BufferData::setUnownedDataPtr(
+    _In_ size_t byteCount,
+    _In_ void * bytes,
+    _In_ std::shared_ptr<const void> owner) noexcept
 {
     m_bytes = std::unique_ptr<uint8_t[], void(*)(uint8_t*)>(reinterpret_cast<uint8_t*>(bytes), noDelete);
     m_byteCount = byteCount;
+    m_bytesOwner = std::move(owner);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -34,6 +34,13 @@ namespace Daybreak
         /// Set a pointer to a byte buffer and the size (in bytes) of the buffer.
         void setUnownedDataPtr(_In_ size_t byteCount, _In_ void * bytes) noexcept;
 
+        /// Set a pointer to a byte buffer that belongs to owner, and the size (in bytes) of the buffer. The owner is
+        /// kept alive for as long as this buffer points to its bytes.
+        void setUnownedDataPtr(
+            _In_ size_t byteCount,
+            _In_ void * bytes,
+            _In_ std::shared_ptr<const void> owner) noexcept;
+
     private:
         static void defaultDelete(uint8_t * data) noexcept;
         static void noDelete(uint8_t * data) noexcept;
@@ -44,5 +51,8 @@ namespace Daybreak
 
         // Number of bytes in buffer.
         size_t m_byteCount = 0;
+
+        // Keeps the owner of unowned bytes alive.
+        std::shared_ptr<const void> m_bytesOwner;
     };
 }
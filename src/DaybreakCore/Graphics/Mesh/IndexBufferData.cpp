@@ -12,11 +12,7 @@ IndexBufferData::IndexBufferData(
     : BufferData(byteCount, std::move(bytes)),
       m_elementType(elementType)
 {
-    CHECK_NOT_ZERO(byteCount);
-    CHECK_NOT_NULL(m_bytes);
-
-    EXPECT(byteCount % indexElementSizeInBytes(elementType) == 0, "Buffer size must be multiple of index size");
-    m_indexCount = byteCount / indexElementSizeInBytes(elementType);
+    initializeIndexCount();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -41,5 +37,28 @@ IndexBufferData::IndexBufferData(
 {
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+IndexBufferData::IndexBufferData(
+    _In_ size_t byteCount,
+    _In_ const void * bytes,
+    _In_ std::shared_ptr<const void> bytesOwner,
+    _In_ IndexElementType elementType)
+    : BufferData(),
+      m_elementType(elementType)
+{
+    setUnownedDataPtr(byteCount, const_cast<void *>(bytes), std::move(bytesOwner));
+    initializeIndexCount();
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 IndexBufferData::~IndexBufferData() = default;
+
+//---------------------------------------------------------------------------------------------------------------------
+void IndexBufferData::initializeIndexCount()
+{
+    CHECK_NOT_ZERO(m_byteCount);
+    CHECK_NOT_NULL(m_bytes);
+
+    EXPECT(m_byteCount % indexElementSizeInBytes(m_elementType) == 0, "Buffer size must be multiple of index size");
+    m_indexCount = m_byteCount / indexElementSizeInBytes(m_elementType);
+}
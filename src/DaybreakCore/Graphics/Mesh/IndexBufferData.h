@@ -27,6 +27,14 @@ namespace Daybreak
             _In_ size_t indexCount,
             _In_ std::unique_ptr<uint32_t[]> indices);
 
+        /// Constructor for index bytes that belong to another object (for example a mapped file). The bytes are not
+        /// copied, and the owner is kept alive for as long as the buffer exists.
+        IndexBufferData(
+            _In_ size_t byteCount,
+            _In_ const void * bytes,
+            _In_ std::shared_ptr<const void> bytesOwner,
+            _In_ IndexElementType elementType);
+
         /// Destructor.
         virtual ~IndexBufferData();
 
@@ -36,6 +44,10 @@ namespace Daybreak
         /// Get the number of indices in the buffer.
         size_t indexCount() const noexcept { return m_indexCount; }
 
+    private:
+        /// Check the buffer is a whole number of indices and calculate the index count.
+        void initializeIndexCount();
+
     protected:
         /// Index element type definition.
         IndexElementType m_elementType;
@@ -0,0 +1,229 @@
+#include "stdafx.h"
+#include "IndexCompaction.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Common/Error.h"
+
+#include <algorithm>
+
+using namespace Daybreak;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    /// Copy 32 bit indices into a buffer of a narrower type.
+    template<typename T>
+    std::unique_ptr<uint8_t[]> narrowIndices(const uint32_t * indices, size_t indexCount)
+    {
+        std::unique_ptr<uint8_t[]> bytes(new uint8_t[indexCount * sizeof(T)]);
+        auto output = reinterpret_cast<T *>(bytes.get());
+
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            output[i] = static_cast<T>(indices[i]);
+        }
+
+        return bytes;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Split consecutive runs of indices into sub-ranges whose indices each span at most maxVertexSpan vertices, by
+    /// growing the current sub-range one run at a time and starting a new one when a run would make the span too
+    /// large. runAt returns the offset and count of a run. Returns false if a single run spans too many vertices.
+    template<typename RunAt>
+    bool splitIndexRuns(
+        const uint32_t * indices,
+        size_t runCount,
+        std::vector<index_sub_range_t>& subRanges,
+        size_t maxVertexSpan,
+        RunAt runAt)
+    {
+        index_sub_range_t current;
+        uint32_t minIndex = 0;
+        uint32_t maxIndex = 0;
+
+        for (size_t r = 0; r < runCount; ++r)
+        {
+            const auto run = runAt(r);
+
+            if (run.second == 0)
+            {
+                continue;
+            }
+
+            const auto extent = std::minmax_element(indices + run.first, indices + run.first + run.second);
+            const auto runMin = *extent.first;
+            const auto runMax = *extent.second;
+
+            if (static_cast<size_t>(runMax - runMin) >= maxVertexSpan)
+            {
+                return false;
+            }
+
+            const auto newMin = std::min(minIndex, runMin);
+            const auto newMax = std::max(maxIndex, runMax);
+
+            if (current.indexCount == 0 || static_cast<size_t>(newMax - newMin) >= maxVertexSpan)
+            {
+                if (current.indexCount > 0)
+                {
+                    current.baseVertex = minIndex;
+                    subRanges.push_back(current);
+                }
+
+                current.indexOffset = run.first;
+                current.indexCount = 0;
+                minIndex = runMin;
+                maxIndex = runMax;
+            }
+            else
+            {
+                minIndex = newMin;
+                maxIndex = newMax;
+            }
+
+            current.indexCount += run.second;
+        }
+
+        if (current.indexCount > 0)
+        {
+            current.baseVertex = minIndex;
+            subRanges.push_back(current);
+        }
+
+        return true;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+IndexElementType Daybreak::narrowestIndexElementType(uint32_t maxIndex) noexcept
+{
+    if (maxIndex <= UINT8_MAX)
+    {
+        return IndexElementType::UnsignedByte;
+    }
+    else if (maxIndex <= UINT16_MAX)
+    {
+        return IndexElementType::UnsignedShort;
+    }
+    else
+    {
+        return IndexElementType::UnsignedInt;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<IndexBufferData> Daybreak::createCompactIndexBuffer(const uint32_t * indices, size_t indexCount)
+{
+    CHECK_NOT_NULL(indices);
+    CHECK_NOT_ZERO(indexCount);
+
+    const auto maxIndex = *std::max_element(indices, indices + indexCount);
+    const auto elementType = narrowestIndexElementType(maxIndex);
+
+    switch (elementType)
+    {
+    case IndexElementType::UnsignedByte:
+        return std::make_unique<IndexBufferData>(
+            indexCount,
+            narrowIndices<uint8_t>(indices, indexCount),
+            IndexElementType::UnsignedByte);
+
+    case IndexElementType::UnsignedShort:
+        return std::make_unique<IndexBufferData>(
+            indexCount * sizeof(uint16_t),
+            narrowIndices<uint16_t>(indices, indexCount),
+            IndexElementType::UnsignedShort);
+
+    case IndexElementType::UnsignedInt:
+        {
+            std::unique_ptr<uint32_t[]> copy(new uint32_t[indexCount]);
+            std::copy(indices, indices + indexCount, copy.get());
+
+            return std::make_unique<IndexBufferData>(indexCount, std::move(copy));
+        }
+
+    default:
+        THROW_ENUM_SWITCH_NOT_HANDLED(IndexElementType, elementType);
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<IndexBufferData> Daybreak::createCompactIndexBuffer(std::vector<uint32_t>&& indices)
+{
+    CHECK_NOT_ZERO(indices.size());
+
+    const auto maxIndex = *std::max_element(indices.begin(), indices.end());
+
+    if (narrowestIndexElementType(maxIndex) != IndexElementType::UnsignedInt)
+    {
+        auto buffer = createCompactIndexBuffer(indices.data(), indices.size());
+        std::vector<uint32_t>().swap(indices);
+
+        return buffer;
+    }
+
+    auto owner = std::make_shared<std::vector<uint32_t>>(std::move(indices));
+
+    return std::make_unique<IndexBufferData>(
+        owner->size() * sizeof(uint32_t),
+        owner->data(),
+        owner,
+        IndexElementType::UnsignedInt);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<uint32_t> Daybreak::readIndices(const MeshData& mesh)
+{
+    std::vector<uint32_t> indices(mesh.indexCount());
+    const auto bytes = mesh.rawIndexBufferData();
+
+    switch (mesh.indexElementType())
+    {
+    case IndexElementType::UnsignedByte:
+        std::copy_n(static_cast<const uint8_t *>(bytes), indices.size(), indices.begin());
+        break;
+    case IndexElementType::UnsignedShort:
+        std::copy_n(static_cast<const uint16_t *>(bytes), indices.size(), indices.begin());
+        break;
+    case IndexElementType::UnsignedInt:
+        std::copy_n(static_cast<const uint32_t *>(bytes), indices.size(), indices.begin());
+        break;
+    default:
+        THROW_ENUM_SWITCH_NOT_HANDLED(IndexElementType, mesh.indexElementType());
+    }
+
+    return indices;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool Daybreak::trySplitIndexRange(
+    const uint32_t * indices,
+    size_t indexOffset,
+    size_t indexCount,
+    std::vector<index_sub_range_t>& subRanges,
+    size_t maxVertexSpan)
+{
+    CHECK(indexCount % 3 == 0);
+
+    return splitIndexRuns(indices, indexCount / 3, subRanges, maxVertexSpan, [&](size_t t) {
+        return std::make_pair(indexOffset + t * 3, size_t(3));
+    });
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool Daybreak::trySplitIndexRuns(
+    const uint32_t * indices,
+    const std::vector<std::pair<size_t, size_t>>& runs,
+    std::vector<index_sub_range_t>& subRanges,
+    size_t maxVertexSpan)
+{
+    for (size_t i = 1; i < runs.size(); ++i)
+    {
+        CHECK(runs[i - 1].first + runs[i - 1].second == runs[i].first);
+    }
+
+    return splitIndexRuns(indices, runs.size(), subRanges, maxVertexSpan, [&](size_t r) {
+        return runs[r];
+    });
+}
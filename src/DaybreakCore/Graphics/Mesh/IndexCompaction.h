@@ -0,0 +1,56 @@
+#pragma once
+#include "Graphics/Mesh/IndexBufferElement.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Daybreak
+{
+    class IndexBufferData;
+    class MeshData;
+
+    /// Number of vertices that can be addressed by 16 bit indices.
+    const size_t MaxUnsignedShortVertexCount = 65536;
+
+    /// Part of an index buffer whose indices are relative to a base vertex.
+    struct index_sub_range_t
+    {
+        size_t indexOffset = 0;             ///< Offset of the first index in the range.
+        size_t indexCount = 0;              ///< Number of indices in the range.
+        uint32_t baseVertex = 0;            ///< Value added to every index in the range before fetching a vertex.
+    };
+
+    /// Get the narrowest index element type that can hold every index from zero to maxIndex.
+    IndexElementType narrowestIndexElementType(uint32_t maxIndex) noexcept;
+
+    /// Create an index buffer holding a copy of indices that uses the narrowest element type able to hold them.
+    std::unique_ptr<IndexBufferData> createCompactIndexBuffer(const uint32_t * indices, size_t indexCount);
+
+    /// Create an index buffer from indices that are no longer needed, using the narrowest element type able to hold
+    /// them. Indices that need 32 bits are moved into the buffer rather than copied.
+    std::unique_ptr<IndexBufferData> createCompactIndexBuffer(std::vector<uint32_t>&& indices);
+
+    /// Get a copy of the indices of a mesh widened to 32 bits.
+    std::vector<uint32_t> readIndices(const MeshData& mesh);
+
+    /// Split a range of a triangle list into sub-ranges of whole triangles whose indices each span at most
+    /// maxVertexSpan vertices, so every sub-range can be drawn with narrow indices relative to its smallest vertex.
+    /// Returns false if a single triangle spans too many vertices.
+    bool trySplitIndexRange(
+        const uint32_t * indices,
+        size_t indexOffset,
+        size_t indexCount,
+        std::vector<index_sub_range_t>& subRanges,
+        size_t maxVertexSpan = MaxUnsignedShortVertexCount);
+
+    /// Split consecutive runs of a triangle list (offset and count), such as meshlets, into sub-ranges like
+    /// trySplitIndexRange, but only between runs so every run stays whole. Returns false if a single run spans too
+    /// many vertices.
+    bool trySplitIndexRuns(
+        const uint32_t * indices,
+        const std::vector<std::pair<size_t, size_t>>& runs,
+        std::vector<index_sub_range_t>& subRanges,
+        size_t maxVertexSpan = MaxUnsignedShortVertexCount);
+}
@@ -47,6 +47,13 @@ IndexElementType MeshData::indexElementType() const noexcept
     return m_indexBuffer->elementType();
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+void MeshData::setIndexBuffer(_In_ std::unique_ptr<IndexBufferData> indexBuffer)
+{
+    CHECK_NOT_NULL(indexBuffer);
+    m_indexBuffer = std::move(indexBuffer);
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 const void * MeshData::rawVertexBufferData() const noexcept
 {
@@ -70,3 +77,16 @@ const InputLayoutDescription& MeshData::vertexElementTypeRef() const noexcept
 {
     return m_vertexBuffer->inputLayoutRef();
 }
+
+//---------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<const InputLayoutDescription> MeshData::vertexInputLayout() const noexcept
+{
+    return m_vertexBuffer->inputLayout();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void MeshData::setVertexBuffer(_In_ std::unique_ptr<VertexBufferData> vertexBuffer)
+{
+    CHECK_NOT_NULL(vertexBuffer);
+    m_vertexBuffer = std::move(vertexBuffer);
+}
@@ -27,6 +27,8 @@ namespace Daybreak
 
         IndexElementType indexElementType() const noexcept;
 
+        void setIndexBuffer(_In_ std::unique_ptr<IndexBufferData> indexBuffer);
+
     public:
 
         const void * rawVertexBufferData() const noexcept;
@@ -37,6 +39,10 @@ namespace Daybreak
 
         const InputLayoutDescription& vertexElementTypeRef() const noexcept;       // TODO: Rename inputLayoutRef
 
+        std::shared_ptr<const InputLayoutDescription> vertexInputLayout() const noexcept;
+
+        void setVertexBuffer(_In_ std::unique_ptr<VertexBufferData> vertexBuffer);
+
     protected:
         std::unique_ptr<IndexBufferData> m_indexBuffer;
         std::unique_ptr<VertexBufferData> m_vertexBuffer;
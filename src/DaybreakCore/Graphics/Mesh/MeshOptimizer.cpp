@@ -0,0 +1,546 @@
+#include "stdafx.h"
+#include "MeshOptimizer.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/InputLayoutDescription.h"
+#include "Common/Error.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+using namespace Daybreak;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    /// FIFO post-transform vertex cache simulation. Each vertex records the time it was added to the cache, and the
+    /// clock advances on every miss, so a vertex is in the cache while fewer than cacheSize vertices were added after
+    /// it.
+    class VertexCacheSimulator
+    {
+    public:
+        VertexCacheSimulator(size_t vertexCount, size_t cacheSize)
+            : m_cacheTime(vertexCount, 0),
+              m_cacheSize(cacheSize),
+              m_time(cacheSize + 1)
+        {
+        }
+
+        /// Get if a vertex is in the cache.
+        bool isCached(uint32_t v) const noexcept { return m_time - m_cacheTime[v] <= m_cacheSize; }
+
+        /// Get how many vertices were added to the cache since a vertex was added.
+        size_t age(uint32_t v) const noexcept { return m_time - m_cacheTime[v]; }
+
+        /// Use a vertex, adding it to the cache if it is not already present. Returns true on a cache miss.
+        bool use(uint32_t v) noexcept
+        {
+            if (isCached(v))
+            {
+                return false;
+            }
+
+            m_cacheTime[v] = m_time++;
+            return true;
+        }
+
+        /// Use the three vertices of a triangle and return the number of cache misses.
+        size_t useTriangle(const uint32_t * triangle) noexcept
+        {
+            return (use(triangle[0]) ? 1 : 0) + (use(triangle[1]) ? 1 : 0) + (use(triangle[2]) ? 1 : 0);
+        }
+
+        /// Remove every vertex from the cache.
+        void flush() noexcept { m_time += m_cacheSize + 1; }
+
+    private:
+        std::vector<size_t> m_cacheTime;
+        size_t m_cacheSize;
+        size_t m_time;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Read a vertex position.
+    glm::vec3 readPosition(const void * positions, size_t vertexStride, uint32_t v) noexcept
+    {
+        glm::vec3 position;
+        std::memcpy(&position, static_cast<const uint8_t *>(positions) + v * vertexStride, sizeof(position));
+
+        return position;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Number the vertices used by a range of indices from zero in the order they are first used, rewriting the
+    /// indices in place. Returns the original id of every local vertex.
+    std::vector<uint32_t> remapToLocalIds(uint32_t * indices, size_t indexCount, size_t vertexCount)
+    {
+        std::unordered_map<uint32_t, uint32_t> localIds;
+        std::vector<uint32_t> originalIds;
+
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            const auto result = localIds.emplace(indices[i], static_cast<uint32_t>(originalIds.size()));
+
+            if (result.second)
+            {
+                CHECK(indices[i] < vertexCount);
+                originalIds.push_back(indices[i]);
+            }
+
+            indices[i] = result.first->second;
+        }
+
+        return originalIds;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool Daybreak::tryFindPositionOffset(const InputLayoutDescription& layout, size_t& offset)
+{
+    for (size_t i = 0; i < layout.attributeCount(); ++i)
+    {
+        auto attribute = layout.getAttributeByIndex(i);
+
+        if (attribute.semanticName() == InputAttribute::SemanticName::Position &&
+            attribute.type() == InputAttribute::StorageType::Float &&
+            attribute.count() >= 3)
+        {
+            offset = layout.attributeOffsetByIndex(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+vertex_cache_statistics_t Daybreak::analyzeVertexCache(
+    const uint32_t * indices,
+    size_t indexCount,
+    size_t vertexCount,
+    size_t cacheSize)
+{
+    vertex_cache_statistics_t statistics;
+    VertexCacheSimulator cache(vertexCount, cacheSize);
+    std::vector<char> referenced(vertexCount, 0);
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const auto v = indices[i];
+
+        if (cache.use(v))
+        {
+            statistics.transformedCount++;
+        }
+
+        if (!referenced[v])
+        {
+            referenced[v] = 1;
+            statistics.vertexCount++;
+        }
+    }
+
+    statistics.triangleCount = indexCount / 3;
+    return statistics;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+vertex_cache_statistics_t Daybreak::analyzeVertexCache(const MeshData& mesh, size_t cacheSize)
+{
+    auto indices = readIndices(mesh);
+    return analyzeVertexCache(indices.data(), indices.size(), mesh.vertexCount(), cacheSize);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void Daybreak::optimizeVertexCache(
+    uint32_t * indices,
+    size_t indexCount,
+    size_t vertexCount,
+    size_t cacheSize)
+{
+    const auto triangleCount = indexCount / 3;
+
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Build a list of the triangles that use each vertex, and count the triangles each vertex still has to draw.
+    std::vector<uint32_t> liveCount(vertexCount, 0);
+    std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        liveCount[indices[i]]++;
+    }
+
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        firstTriangle[v + 1] = firstTriangle[v] + liveCount[v];
+    }
+
+    {
+        std::vector<uint32_t> nextTriangle(firstTriangle.begin(), firstTriangle.end() - 1);
+
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+        {
+            adjacency[nextTriangle[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    // Fan out from one vertex at a time, emitting all of its remaining triangles. The next vertex to fan from is a
+    // vertex of the triangles just emitted that will still be in the cache after its own triangles are emitted, or a
+    // recently used vertex with triangles left when there is no such vertex.
+    std::vector<uint32_t> output;
+    std::vector<char> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnds;
+    std::vector<uint32_t> candidates;
+    VertexCacheSimulator cache(vertexCount, cacheSize);
+    size_t cursor = 0;
+
+    output.reserve(triangleCount * 3);
+    deadEnds.reserve(triangleCount * 3);
+
+    const auto NoVertex = std::numeric_limits<uint32_t>::max();
+    uint32_t fanningVertex = indices[0];
+
+    while (fanningVertex != NoVertex)
+    {
+        candidates.clear();
+
+        for (auto i = firstTriangle[fanningVertex]; i < firstTriangle[fanningVertex + 1]; ++i)
+        {
+            const auto t = adjacency[i];
+
+            if (emitted[t])
+            {
+                continue;
+            }
+
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const auto v = indices[t * 3 + k];
+
+                output.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+
+                liveCount[v]--;
+                cache.use(v);
+            }
+
+            emitted[t] = 1;
+        }
+
+        // Prefer the candidate that has been in the cache longest, as long as it stays in the cache while its own
+        // triangles are emitted.
+        fanningVertex = NoVertex;
+        size_t bestPriority = 0;
+
+        for (auto v : candidates)
+        {
+            if (liveCount[v] == 0)
+            {
+                continue;
+            }
+
+            size_t priority = 0;
+
+            if (cache.age(v) + 2 * liveCount[v] <= cacheSize)
+            {
+                priority = cache.age(v);
+            }
+
+            if (fanningVertex == NoVertex || priority > bestPriority)
+            {
+                fanningVertex = v;
+                bestPriority = priority;
+            }
+        }
+
+        // At a dead end pick the most recently used vertex with triangles left, then any vertex with triangles left.
+        while (fanningVertex == NoVertex && !deadEnds.empty())
+        {
+            const auto v = deadEnds.back();
+            deadEnds.pop_back();
+
+            if (liveCount[v] > 0)
+            {
+                fanningVertex = v;
+            }
+        }
+
+        while (fanningVertex == NoVertex && cursor < vertexCount)
+        {
+            if (liveCount[cursor] > 0)
+            {
+                fanningVertex = static_cast<uint32_t>(cursor);
+            }
+
+            cursor++;
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void Daybreak::optimizeOverdraw(
+    uint32_t * indices,
+    size_t indexCount,
+    const void * positions,
+    size_t vertexCount,
+    size_t vertexStride,
+    float threshold,
+    size_t cacheSize)
+{
+    const auto triangleCount = indexCount / 3;
+
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // A new hard cluster starts wherever all three vertices of a triangle miss the cache. Splitting there costs
+    // nothing because the cache was effectively flushed.
+    std::vector<size_t> hardClusters;
+    VertexCacheSimulator cache(vertexCount, cacheSize);
+
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        if (cache.useTriangle(indices + t * 3) == 3)
+        {
+            hardClusters.push_back(t);
+        }
+    }
+
+    hardClusters.push_back(triangleCount);
+
+    // Split each hard cluster further once the ACMR of the cluster so far is close to the ACMR of the whole hard
+    // cluster. These splits make the cache a little worse, by at most threshold, in exchange for smaller clusters.
+    std::vector<size_t> clusters;
+
+    for (size_t h = 0; h + 1 < hardClusters.size(); ++h)
+    {
+        const auto start = hardClusters[h];
+        const auto end = hardClusters[h + 1];
+
+        size_t hardMisses = 0;
+        cache.flush();
+
+        for (auto t = start; t < end; ++t)
+        {
+            hardMisses += cache.useTriangle(indices + t * 3);
+        }
+
+        const auto hardAcmr = static_cast<float>(hardMisses) / (end - start);
+
+        size_t clusterStart = start;
+        size_t clusterMisses = 0;
+        cache.flush();
+        clusters.push_back(start);
+
+        for (auto t = start; t < end; ++t)
+        {
+            clusterMisses += cache.useTriangle(indices + t * 3);
+
+            if (t + 1 < end && clusterMisses <= threshold * hardAcmr * (t + 1 - clusterStart))
+            {
+                clusterStart = t + 1;
+                clusterMisses = 0;
+                cache.flush();
+                clusters.push_back(clusterStart);
+            }
+        }
+    }
+
+    clusters.push_back(triangleCount);
+
+    // Find the area weighted center and normal of every cluster, and the center of the mesh.
+    const auto clusterCount = clusters.size() - 1;
+    std::vector<glm::vec3> clusterCenters(clusterCount);
+    std::vector<glm::vec3> clusterNormals(clusterCount);
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0.0f;
+
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        glm::vec3 center(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+
+        for (auto t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            const auto a = readPosition(positions, vertexStride, indices[t * 3 + 0]);
+            const auto b = readPosition(positions, vertexStride, indices[t * 3 + 1]);
+            const auto d = readPosition(positions, vertexStride, indices[t * 3 + 2]);
+
+            const auto cross = glm::cross(b - a, d - a);
+            const auto triangleArea = glm::length(cross);
+
+            center += (a + b + d) * (triangleArea / 3.0f);
+            normal += cross;
+            area += triangleArea;
+        }
+
+        meshCenter += center;
+        meshArea += area;
+
+        clusterCenters[c] = (area > 0.0f ? center / area : center);
+        clusterNormals[c] = (glm::length(normal) > 0.0f ? glm::normalize(normal) : normal);
+    }
+
+    if (meshArea > 0.0f)
+    {
+        meshCenter /= meshArea;
+    }
+
+    // Draw clusters that face furthest out from the center first, as they are the most likely to occlude the others.
+    std::vector<float> sortKeys(clusterCount);
+    std::vector<size_t> order(clusterCount);
+
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        sortKeys[c] = glm::dot(clusterCenters[c] - meshCenter, clusterNormals[c]);
+        order[c] = c;
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+
+    for (auto c : order)
+    {
+        output.insert(output.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+size_t Daybreak::optimizeVertexFetch(
+    void * destination,
+    const void * vertices,
+    size_t vertexCount,
+    size_t vertexSize,
+    uint32_t * indices,
+    size_t indexCount)
+{
+    const auto Unassigned = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(vertexCount, Unassigned);
+    uint32_t nextVertex = 0;
+
+    auto output = static_cast<uint8_t *>(destination);
+    auto input = static_cast<const uint8_t *>(vertices);
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const auto v = indices[i];
+
+        if (remap[v] == Unassigned)
+        {
+            std::memcpy(output + nextVertex * vertexSize, input + v * vertexSize, vertexSize);
+            remap[v] = nextVertex++;
+        }
+
+        indices[i] = remap[v];
+    }
+
+    return nextVertex;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<MeshData> Daybreak::optimizeMesh(
+    const MeshData& mesh,
+    const std::vector<std::pair<size_t, size_t>>& indexRanges,
+    const mesh_optimization_options_t& options)
+{
+    auto indices = readIndices(mesh);
+
+    const auto vertexCount = mesh.vertexCount();
+    const auto vertexSize = mesh.vertexElementSizeInBytes();
+    const auto vertices = static_cast<const uint8_t *>(mesh.rawVertexBufferData());
+
+    size_t positionOffset = 0;
+    const bool hasPositions = tryFindPositionOffset(mesh.vertexElementTypeRef(), positionOffset);
+
+    // Reorder the triangles of each range on their own. The vertices of a range are numbered from zero while it is
+    // optimized, so the work arrays are only as large as the range rather than the whole vertex buffer.
+    const bool reordersTriangles = options.vertexCache || (options.overdraw && hasPositions);
+    std::vector<glm::vec3> localPositions;
+
+    for (const auto& range : indexRanges)
+    {
+        CHECK(range.first <= indices.size() && range.second <= indices.size() - range.first);
+
+        if (!reordersTriangles)
+        {
+            continue;
+        }
+
+        auto rangeIndices = indices.data() + range.first;
+        const auto originalIds = remapToLocalIds(rangeIndices, range.second, vertexCount);
+
+        if (options.vertexCache)
+        {
+            optimizeVertexCache(rangeIndices, range.second, originalIds.size(), options.cacheSize);
+        }
+
+        if (options.overdraw && hasPositions)
+        {
+            localPositions.resize(originalIds.size());
+
+            for (size_t v = 0; v < originalIds.size(); ++v)
+            {
+                localPositions[v] = readPosition(vertices + positionOffset, vertexSize, originalIds[v]);
+            }
+
+            optimizeOverdraw(
+                rangeIndices,
+                range.second,
+                localPositions.data(),
+                localPositions.size(),
+                sizeof(glm::vec3),
+                options.overdrawThreshold,
+                options.cacheSize);
+        }
+
+        for (size_t i = 0; i < range.second; ++i)
+        {
+            rangeIndices[i] = originalIds[rangeIndices[i]];
+        }
+    }
+
+    // Reorder the vertices to match the new triangle order.
+    std::unique_ptr<uint8_t[]> optimizedVertices(new uint8_t[vertexCount * vertexSize]);
+    auto optimizedVertexCount = vertexCount;
+
+    if (options.vertexFetch)
+    {
+        optimizedVertexCount = optimizeVertexFetch(
+            optimizedVertices.get(),
+            vertices,
+            vertexCount,
+            vertexSize,
+            indices.data(),
+            indices.size());
+    }
+    else
+    {
+        std::memcpy(optimizedVertices.get(), vertices, vertexCount * vertexSize);
+    }
+
+    return std::make_unique<MeshData>(
+        createCompactIndexBuffer(indices.data(), indices.size()),
+        std::make_unique<VertexBufferData>(
+            optimizedVertexCount * vertexSize,
+            std::move(optimizedVertices),
+            mesh.vertexInputLayout()));
+}
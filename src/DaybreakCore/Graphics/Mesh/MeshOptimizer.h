@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Daybreak
+{
+    class InputLayoutDescription;
+    class MeshData;
+
+    /// Default number of entries in the simulated post-transform vertex cache.
+    const size_t DefaultVertexCacheSize = 16;
+
+    /// Result of simulating a FIFO post-transform vertex cache over an index buffer.
+    struct vertex_cache_statistics_t
+    {
+        size_t triangleCount = 0;           ///< Number of triangles drawn.
+        size_t vertexCount = 0;             ///< Number of unique vertices referenced by the triangles.
+        size_t transformedCount = 0;        ///< Number of vertex shader invocations (cache misses).
+
+        /// Average cache miss ratio, the number of vertices transformed per triangle. Lower is better, 0.5 is ideal.
+        float acmr() const noexcept
+        {
+            return triangleCount == 0 ? 0.0f : static_cast<float>(transformedCount) / triangleCount;
+        }
+
+        /// Average transform to vertex ratio, the number of times each vertex is transformed. 1 is ideal.
+        float atvr() const noexcept
+        {
+            return vertexCount == 0 ? 0.0f : static_cast<float>(transformedCount) / vertexCount;
+        }
+    };
+
+    /// Options for optimizeMesh.
+    struct mesh_optimization_options_t
+    {
+        bool vertexCache = true;                    ///< Reorder triangles for the post-transform vertex cache.
+        bool overdraw = true;                       ///< Reorder clusters of triangles to reduce overdraw.
+        bool vertexFetch = true;                    ///< Reorder vertices in the order they are first used.
+        size_t cacheSize = DefaultVertexCacheSize;  ///< Vertex cache size to optimize for.
+        float overdrawThreshold = 1.05f;            ///< How much ACMR may get worse to make smaller clusters.
+    };
+
+    /// Find the offset of a float position attribute with at least three components in a vertex, or return false if
+    /// there is none.
+    bool tryFindPositionOffset(const InputLayoutDescription& layout, size_t& offset);
+
+    /// Simulate a FIFO vertex cache over a triangle list.
+    vertex_cache_statistics_t analyzeVertexCache(
+        const uint32_t * indices,
+        size_t indexCount,
+        size_t vertexCount,
+        size_t cacheSize = DefaultVertexCacheSize);
+
+    /// Simulate a FIFO vertex cache over the index buffer of a mesh.
+    vertex_cache_statistics_t analyzeVertexCache(const MeshData& mesh, size_t cacheSize = DefaultVertexCacheSize);
+
+    /// Reorder the triangles in a triangle list so recently transformed vertices are reused while they are still in
+    /// the post-transform cache. This is the Tipsify algorithm (Sander, Nehab and Barczak 2007), which runs in linear
+    /// time.
+    void optimizeVertexCache(
+        uint32_t * indices,
+        size_t indexCount,
+        size_t vertexCount,
+        size_t cacheSize = DefaultVertexCacheSize);
+
+    /// Reorder clusters of triangles in a vertex cache optimized triangle list so triangles that are likely to occlude
+    /// others are drawn first. Clusters are split where the cache is flushed anyway, and also where the ACMR of the
+    /// cluster so far is no more than threshold times the ACMR of the whole run, then sorted by how far they face out
+    /// from the center of the mesh. Positions are read as three floats at the start of every vertexStride bytes.
+    void optimizeOverdraw(
+        uint32_t * indices,
+        size_t indexCount,
+        const void * positions,
+        size_t vertexCount,
+        size_t vertexStride,
+        float threshold = 1.05f,
+        size_t cacheSize = DefaultVertexCacheSize);
+
+    /// Reorder vertices into the order they are first referenced by the triangle list, and remap the indices to
+    /// match. Vertices that are not referenced are dropped. Writes the reordered vertices to destination, which must
+    /// not overlap vertices, and returns the number of vertices written.
+    size_t optimizeVertexFetch(
+        void * destination,
+        const void * vertices,
+        size_t vertexCount,
+        size_t vertexSize,
+        uint32_t * indices,
+        size_t indexCount);
+
+    /// Create an optimized copy of a triangle list mesh. Triangles are only reordered within each index range (offset
+    /// and count) so ranges that are drawn separately, like model groups, stay intact. The optimized mesh uses the
+    /// narrowest index type that can address its vertices.
+    std::unique_ptr<MeshData> optimizeMesh(
+        const MeshData& mesh,
+        const std::vector<std::pair<size_t, size_t>>& indexRanges,
+        const mesh_optimization_options_t& options = mesh_optimization_options_t());
+}
@@ -0,0 +1,750 @@
+#include "stdafx.h"
+#include "MeshSimplifier.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/MeshOptimizer.h"
+#include "Common/Error.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+using namespace Daybreak;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    /// Marks a vertex without an open edge, or a vertex that is not referenced by the triangle list.
+    const uint32_t NoVertex = UINT32_MAX;
+
+    /// Marks a vertex with more than one open edge in the same direction.
+    const uint32_t ManyVertices = UINT32_MAX - 1;
+
+    /// Weight of the quadrics that keep borders and seams in place, relative to the quadrics of the triangles.
+    const double EdgeWeight = 10.0;
+
+    /// Marks a position that is used by more than one index range.
+    const size_t SharedPosition = SIZE_MAX;
+
+    /// How the vertices at a position may be collapsed.
+    enum class VertexKind : uint8_t
+    {
+        Manifold,   ///< Inside the surface, can be collapsed onto any neighbour.
+        Border,     ///< On an open border, can only be collapsed along the border.
+        Seam,       ///< On an attribute seam, can only be collapsed along the seam.
+        Locked      ///< Can not be collapsed.
+    };
+
+    /// Bit pattern of a vertex position.
+    using position_key_t = std::array<uint32_t, 3>;
+
+    /// Hash of the bit pattern of a vertex position.
+    struct position_key_hash_t
+    {
+        size_t operator()(const position_key_t& key) const noexcept
+        {
+            return (key[0] * 73856093u) ^ (key[1] * 19349663u) ^ (key[2] * 83492791u);
+        }
+    };
+
+    /// Symmetric 4x4 matrix that sums the weighted squared distances from a point to a set of planes.
+    struct quadric_t
+    {
+        double a2 = 0.0, b2 = 0.0, c2 = 0.0, d2 = 0.0;
+        double ab = 0.0, ac = 0.0, ad = 0.0, bc = 0.0, bd = 0.0, cd = 0.0;
+        double weight = 0.0;
+
+        /// Add the plane dot(normal, p) + d = 0, where normal has unit length.
+        void addPlane(const glm::dvec3& normal, double d, double w) noexcept
+        {
+            a2 += normal.x * normal.x * w;
+            b2 += normal.y * normal.y * w;
+            c2 += normal.z * normal.z * w;
+            d2 += d * d * w;
+            ab += normal.x * normal.y * w;
+            ac += normal.x * normal.z * w;
+            ad += normal.x * d * w;
+            bc += normal.y * normal.z * w;
+            bd += normal.y * d * w;
+            cd += normal.z * d * w;
+            weight += w;
+        }
+
+        quadric_t& operator +=(const quadric_t& other) noexcept
+        {
+            a2 += other.a2;
+            b2 += other.b2;
+            c2 += other.c2;
+            d2 += other.d2;
+            ab += other.ab;
+            ac += other.ac;
+            ad += other.ad;
+            bc += other.bc;
+            bd += other.bd;
+            cd += other.cd;
+            weight += other.weight;
+
+            return *this;
+        }
+
+        /// Get the weighted average of the squared distances from a point to the planes.
+        double error(const glm::dvec3& p) const noexcept
+        {
+            const auto r =
+                a2 * p.x * p.x + b2 * p.y * p.y + c2 * p.z * p.z + d2 +
+                2.0 * (ab * p.x * p.y + ac * p.x * p.z + bc * p.y * p.z) +
+                2.0 * (ad * p.x + bd * p.y + cd * p.z);
+
+            return weight > 0.0 ? std::abs(r) / weight : 0.0;
+        }
+    };
+
+    /// An edge collapse that moves every vertex at one position onto a neighbouring position.
+    struct collapse_t
+    {
+        uint32_t from;
+        uint32_t to;
+        double error;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// List of items per slot stored in one array, built from a triangle list in two passes.
+    class SlotLists
+    {
+    public:
+        /// Get the first item in a slot's list.
+        const uint32_t * begin(uint32_t slot) const noexcept { return m_items.data() + m_offsets[slot]; }
+
+        /// Get one past the last item in a slot's list.
+        const uint32_t * end(uint32_t slot) const noexcept { return m_items.data() + m_offsets[slot + 1]; }
+
+        /// Check if a slot's list contains an item.
+        bool contains(uint32_t slot, uint32_t item) const noexcept
+        {
+            return std::find(begin(slot), end(slot), item) != end(slot);
+        }
+
+        /// Reset the lists and reserve room for the given number of slots.
+        void reset(size_t slotCount)
+        {
+            m_offsets.assign(slotCount + 1, 0);
+        }
+
+        /// Count one more item in a slot, before calling allocate.
+        void count(uint32_t slot) noexcept { ++m_offsets[slot + 1]; }
+
+        /// Allocate room for the counted items.
+        void allocate()
+        {
+            std::partial_sum(m_offsets.begin(), m_offsets.end(), m_offsets.begin());
+            m_items.resize(m_offsets.back());
+            m_next.assign(m_offsets.begin(), m_offsets.end() - 1);
+        }
+
+        /// Add an item to a slot, after calling allocate.
+        void add(uint32_t slot, uint32_t item) noexcept { m_items[m_next[slot]++] = item; }
+
+    private:
+        std::vector<size_t> m_offsets;
+        std::vector<size_t> m_next;
+        std::vector<uint32_t> m_items;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Read a vertex position.
+    glm::vec3 readPosition(const void * positions, size_t vertexStride, uint32_t v) noexcept
+    {
+        glm::vec3 position;
+        std::memcpy(&position, static_cast<const uint8_t *>(positions) + v * vertexStride, sizeof(position));
+
+        return position;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Read the bit pattern of a vertex position.
+    position_key_t readPositionKey(const void * positions, size_t vertexStride, uint32_t v) noexcept
+    {
+        position_key_t key;
+        std::memcpy(key.data(), static_cast<const uint8_t *>(positions) + v * vertexStride, sizeof(key));
+
+        return key;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Check if a vertex of one kind may be collapsed onto a vertex of another kind.
+    bool canCollapse(VertexKind from, VertexKind to) noexcept
+    {
+        return
+            from == VertexKind::Manifold ||
+            (from == to && (from == VertexKind::Border || from == VertexKind::Seam));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Build the outgoing edges of every vertex in a triangle list.
+    void buildEdges(const uint32_t * indices, size_t indexCount, size_t vertexCount, SlotLists& edges)
+    {
+        edges.reset(vertexCount);
+
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            edges.count(indices[i]);
+        }
+
+        edges.allocate();
+
+        for (size_t i = 0; i < indexCount; i += 3)
+        {
+            edges.add(indices[i], indices[i + 1]);
+            edges.add(indices[i + 1], indices[i + 2]);
+            edges.add(indices[i + 2], indices[i]);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Build the triangles (as the offset of their first index) that use every position in a triangle list.
+    void buildTriangles(
+        const uint32_t * indices,
+        size_t indexCount,
+        const std::vector<uint32_t>& positionOf,
+        size_t positionCount,
+        SlotLists& triangles)
+    {
+        triangles.reset(positionCount);
+
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            triangles.count(positionOf[indices[i]]);
+        }
+
+        triangles.allocate();
+
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            triangles.add(positionOf[indices[i]], static_cast<uint32_t>(i - i % 3));
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Check if moving a position would turn any triangle that uses it over, ignoring triangles that also use the
+    /// position it moves to because they are removed by the collapse.
+    bool collapseFlipsTriangle(
+        const uint32_t * indices,
+        const SlotLists& triangles,
+        const std::vector<uint32_t>& positionOf,
+        const void * positions,
+        size_t vertexStride,
+        uint32_t fromPosition,
+        uint32_t toPosition,
+        const glm::vec3& newPosition)
+    {
+        for (auto t = triangles.begin(fromPosition); t != triangles.end(fromPosition); ++t)
+        {
+            const auto triangle = indices + *t;
+            glm::vec3 before[3];
+            glm::vec3 after[3];
+            bool removed = false;
+
+            for (int k = 0; k < 3; ++k)
+            {
+                const auto p = positionOf[triangle[k]];
+                removed = removed || (p == toPosition);
+                before[k] = readPosition(positions, vertexStride, triangle[k]);
+                after[k] = (p == fromPosition ? newPosition : before[k]);
+            }
+
+            if (removed)
+            {
+                continue;
+            }
+
+            const auto normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            const auto normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            const auto lengthBefore = glm::length(normalBefore);
+
+            // Reject collapses that turn a triangle by more than about 75 degrees.
+            if (lengthBefore > 0.0f &&
+                glm::dot(normalBefore, normalAfter) <= 0.25f * lengthBefore * glm::length(normalAfter))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+size_t Daybreak::simplifyIndices(
+    uint32_t * destination,
+    const uint32_t * indices,
+    size_t indexCount,
+    const void * positions,
+    size_t vertexCount,
+    size_t vertexStride,
+    size_t targetIndexCount,
+    float maxError,
+    const std::vector<bool> * lockedVertices,
+    float * resultError)
+{
+    CHECK_NOT_NULL(destination);
+    CHECK_NOT_NULL(indices);
+    CHECK_NOT_NULL(positions);
+    CHECK(indexCount % 3 == 0);
+    CHECK(lockedVertices == nullptr || lockedVertices->size() == vertexCount);
+
+    // Number the vertices used by the triangles from zero, so the work arrays below are only as large as the
+    // triangle list rather than the whole vertex buffer, and pack their positions and locks to match.
+    std::unordered_map<uint32_t, uint32_t> localIds;
+    std::vector<uint32_t> localIndices(indexCount);
+    std::vector<uint32_t> originalIds;
+    std::vector<glm::vec3> localPositions;
+    std::vector<bool> localLocked;
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const auto result = localIds.emplace(indices[i], static_cast<uint32_t>(originalIds.size()));
+
+        if (result.second)
+        {
+            CHECK(indices[i] < vertexCount);
+
+            originalIds.push_back(indices[i]);
+            localPositions.push_back(readPosition(positions, vertexStride, indices[i]));
+            localLocked.push_back(lockedVertices != nullptr && (*lockedVertices)[indices[i]]);
+        }
+
+        localIndices[i] = result.first->second;
+    }
+
+    const auto localVertexCount = originalIds.size();
+    const auto localStride = sizeof(glm::vec3);
+
+    // Give every position used by the triangles a number, and link the vertices that share a position into a cycle.
+    // Vertices that share a position were not merged because their other attributes differ.
+    std::vector<uint32_t> positionOf(localVertexCount, NoVertex);
+    std::vector<uint32_t> wedge(localVertexCount, NoVertex);
+    std::vector<uint32_t> positionVertex;
+    std::unordered_map<position_key_t, uint32_t, position_key_hash_t> positionLookup;
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const auto v = localIndices[i];
+
+        if (positionOf[v] != NoVertex)
+        {
+            continue;
+        }
+
+        const auto result = positionLookup.emplace(
+            readPositionKey(localPositions.data(), localStride, v),
+            static_cast<uint32_t>(positionVertex.size()));
+
+        positionOf[v] = result.first->second;
+
+        if (result.second)
+        {
+            positionVertex.push_back(v);
+            wedge[v] = v;
+        }
+        else
+        {
+            const auto first = positionVertex[positionOf[v]];
+            wedge[v] = wedge[first];
+            wedge[first] = v;
+        }
+    }
+
+    const auto positionCount = positionVertex.size();
+
+    // Find the open edges of every vertex, which are edges without a matching edge in the opposite direction.
+    SlotLists edges;
+    buildEdges(localIndices.data(), indexCount, localVertexCount, edges);
+
+    std::vector<uint32_t> openIn(localVertexCount, NoVertex);
+    std::vector<uint32_t> openOut(localVertexCount, NoVertex);
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const auto a = localIndices[i];
+        const auto b = localIndices[i - i % 3 + (i + 1) % 3];
+
+        if (!edges.contains(b, a))
+        {
+            openOut[a] = (openOut[a] == NoVertex ? b : ManyVertices);
+            openIn[b] = (openIn[b] == NoVertex ? a : ManyVertices);
+        }
+    }
+
+    // Classify every position. Borders need exactly one open edge in and out, and seams need exactly two vertices
+    // whose open edges run along the same positions in opposite directions.
+    auto isSingle = [](uint32_t v) { return v != NoVertex && v != ManyVertices; };
+    std::vector<VertexKind> kind(positionCount, VertexKind::Locked);
+
+    for (uint32_t p = 0; p < positionCount; ++p)
+    {
+        const auto v = positionVertex[p];
+        const auto w = wedge[v];
+        bool locked = false;
+
+        for (auto u = v; lockedVertices != nullptr && !locked; u = wedge[u])
+        {
+            locked = localLocked[u];
+
+            if (wedge[u] == v)
+            {
+                break;
+            }
+        }
+
+        if (locked)
+        {
+            kind[p] = VertexKind::Locked;
+        }
+        else if (w == v)
+        {
+            if (openIn[v] == NoVertex && openOut[v] == NoVertex)
+            {
+                kind[p] = VertexKind::Manifold;
+            }
+            else if (isSingle(openIn[v]) && isSingle(openOut[v]))
+            {
+                kind[p] = VertexKind::Border;
+            }
+        }
+        else if (wedge[w] == v &&
+            isSingle(openIn[v]) && isSingle(openOut[v]) && isSingle(openIn[w]) && isSingle(openOut[w]) &&
+            positionOf[openOut[v]] == positionOf[openIn[w]] &&
+            positionOf[openIn[v]] == positionOf[openOut[w]])
+        {
+            kind[p] = VertexKind::Seam;
+        }
+    }
+
+    // Sum the planes of the triangles around every position, weighted by triangle area. Open edges also add a plane
+    // through the edge at a right angle to the triangle, so borders and seams keep their shape.
+    std::vector<quadric_t> quadrics(positionCount);
+
+    for (size_t i = 0; i < indexCount; i += 3)
+    {
+        const glm::dvec3 p[3] =
+        {
+            localPositions[localIndices[i]],
+            localPositions[localIndices[i + 1]],
+            localPositions[localIndices[i + 2]]
+        };
+
+        auto normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+        const auto length = glm::length(normal);
+
+        if (length == 0.0)
+        {
+            continue;
+        }
+
+        normal /= length;
+
+        for (int k = 0; k < 3; ++k)
+        {
+            quadrics[positionOf[localIndices[i + k]]].addPlane(normal, -glm::dot(normal, p[0]), length * 0.5);
+        }
+
+        for (int k = 0; k < 3; ++k)
+        {
+            const auto a = localIndices[i + k];
+            const auto b = localIndices[i + (k + 1) % 3];
+
+            if (edges.contains(b, a))
+            {
+                continue;
+            }
+
+            const auto edge = p[(k + 1) % 3] - p[k];
+            const auto edgeLength = glm::length(edge);
+
+            if (edgeLength > 0.0)
+            {
+                const auto edgeNormal = glm::normalize(glm::cross(edge, normal));
+                const auto d = -glm::dot(edgeNormal, p[k]);
+                const auto weight = edgeLength * edgeLength * EdgeWeight;
+
+                quadrics[positionOf[a]].addPlane(edgeNormal, d, weight);
+                quadrics[positionOf[b]].addPlane(edgeNormal, d, weight);
+            }
+        }
+    }
+
+    // Collapse edges in passes. Each pass collapses the cheapest edges first, and locks the positions around every
+    // collapse so the collapses in a pass do not change the same triangles.
+    std::copy(localIndices.begin(), localIndices.end(), destination);
+
+    const auto maxErrorSquared = static_cast<double>(maxError) * static_cast<double>(maxError);
+    auto resultCount = indexCount;
+    double worstError = 0.0;
+
+    SlotLists triangles;
+    std::vector<collapse_t> collapses;
+    std::vector<uint8_t> collapseLocked(positionCount);
+    std::vector<uint32_t> collapseRemap(localVertexCount);
+
+    while (resultCount > targetIndexCount)
+    {
+        buildEdges(destination, resultCount, localVertexCount, edges);
+        buildTriangles(destination, resultCount, positionOf, positionCount, triangles);
+
+        collapses.clear();
+
+        for (size_t i = 0; i < resultCount; ++i)
+        {
+            const auto a = destination[i];
+            const auto b = destination[i - i % 3 + (i + 1) % 3];
+            const auto pa = positionOf[a];
+            const auto pb = positionOf[b];
+
+            // Interior edges are found once from each side, so only consider them from one side.
+            const bool open = !edges.contains(b, a);
+
+            if (!open && a > b)
+            {
+                continue;
+            }
+
+            // Borders and seams are only collapsed along open edges.
+            const bool collapseA = canCollapse(kind[pa], kind[pb]) && (kind[pa] == VertexKind::Manifold || open);
+            const bool collapseB = canCollapse(kind[pb], kind[pa]) && (kind[pb] == VertexKind::Manifold || open);
+
+            if (!collapseA && !collapseB)
+            {
+                continue;
+            }
+
+            auto combined = quadrics[pa];
+            combined += quadrics[pb];
+
+            const auto errorA = collapseA ? combined.error(localPositions[b]) : 0.0;
+            const auto errorB = collapseB ? combined.error(localPositions[a]) : 0.0;
+
+            if (collapseA && (!collapseB || errorA <= errorB))
+            {
+                collapses.push_back({ a, b, errorA });
+            }
+            else
+            {
+                collapses.push_back({ b, a, errorB });
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const collapse_t& x, const collapse_t& y) {
+            return x.error != y.error ? x.error < y.error : (x.from != y.from ? x.from < y.from : x.to < y.to);
+        });
+
+        std::fill(collapseLocked.begin(), collapseLocked.end(), 0);
+        std::iota(collapseRemap.begin(), collapseRemap.end(), 0);
+
+        const auto triangleGoal = (resultCount - targetIndexCount + 2) / 3;
+        size_t removedTriangles = 0;
+        size_t collapseCount = 0;
+
+        for (const auto& collapse : collapses)
+        {
+            if (collapse.error > maxErrorSquared || removedTriangles >= triangleGoal)
+            {
+                break;
+            }
+
+            const auto from = positionOf[collapse.from];
+            const auto to = positionOf[collapse.to];
+
+            if (collapseLocked[from] != 0 || collapseLocked[to] != 0 ||
+                collapseFlipsTriangle(
+                    destination,
+                    triangles,
+                    positionOf,
+                    localPositions.data(),
+                    localStride,
+                    from,
+                    to,
+                    localPositions[collapse.to]))
+            {
+                continue;
+            }
+
+            for (auto t = triangles.begin(from); t != triangles.end(from); ++t)
+            {
+                bool removed = false;
+
+                for (int k = 0; k < 3; ++k)
+                {
+                    const auto p = positionOf[destination[*t + k]];
+                    collapseLocked[p] = 1;
+                    removed = removed || (p == to);
+                }
+
+                removedTriangles += (removed ? 1 : 0);
+            }
+
+            collapseRemap[collapse.from] = collapse.to;
+
+            if (kind[from] == VertexKind::Seam)
+            {
+                collapseRemap[wedge[collapse.from]] = wedge[collapse.to];
+            }
+
+            quadrics[to] += quadrics[from];
+            worstError = std::max(worstError, collapse.error);
+            ++collapseCount;
+        }
+
+        if (collapseCount == 0)
+        {
+            break;
+        }
+
+        // Apply the collapses and drop the triangles that lost an edge.
+        size_t writeCount = 0;
+
+        for (size_t i = 0; i < resultCount; i += 3)
+        {
+            const auto a = collapseRemap[destination[i]];
+            const auto b = collapseRemap[destination[i + 1]];
+            const auto c = collapseRemap[destination[i + 2]];
+
+            if (positionOf[a] != positionOf[b] && positionOf[b] != positionOf[c] && positionOf[a] != positionOf[c])
+            {
+                destination[writeCount++] = a;
+                destination[writeCount++] = b;
+                destination[writeCount++] = c;
+            }
+        }
+
+        resultCount = writeCount;
+    }
+
+    for (size_t i = 0; i < resultCount; ++i)
+    {
+        destination[i] = originalIds[destination[i]];
+    }
+
+    if (resultError != nullptr)
+    {
+        *resultError = static_cast<float>(std::sqrt(worstError));
+    }
+
+    return resultCount;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<lod_level_t> Daybreak::generateLodChain(
+    const MeshData& mesh,
+    const std::vector<std::pair<size_t, size_t>>& indexRanges,
+    std::vector<uint32_t>& indices,
+    const lod_chain_options_t& options)
+{
+    CHECK(options.reductionRatio > 0.0f && options.reductionRatio < 1.0f);
+
+    size_t positionOffset = 0;
+
+    if (!tryFindPositionOffset(mesh.vertexElementTypeRef(), positionOffset))
+    {
+        throw DaybreakDataException("Simplifying a mesh requires a three float position attribute");
+    }
+
+    const auto vertexCount = mesh.vertexCount();
+    const auto vertexStride = mesh.vertexElementSizeInBytes();
+    const auto positions = static_cast<const uint8_t *>(mesh.rawVertexBufferData()) + positionOffset;
+
+    // Lock the vertices at positions that are used by more than one range, so every range keeps the boundary it
+    // shares with the others.
+    std::unordered_map<position_key_t, size_t, position_key_hash_t> positionOwner;
+    std::vector<bool> lockedVertices(vertexCount, false);
+    size_t previousIndexCount = 0;
+
+    for (size_t r = 0; r < indexRanges.size(); ++r)
+    {
+        const auto& range = indexRanges[r];
+        CHECK(range.first <= indices.size() && range.second <= indices.size() - range.first);
+
+        for (auto i = range.first; i < range.first + range.second; ++i)
+        {
+            CHECK(indices[i] < vertexCount);
+
+            auto owner = positionOwner.emplace(readPositionKey(positions, vertexStride, indices[i]), r).first;
+            owner->second = (owner->second == r ? r : SharedPosition);
+        }
+
+        previousIndexCount += range.second;
+    }
+
+    for (const auto& range : indexRanges)
+    {
+        for (auto i = range.first; i < range.first + range.second; ++i)
+        {
+            const auto v = indices[i];
+            lockedVertices[v] = (positionOwner[readPositionKey(positions, vertexStride, v)] == SharedPosition);
+        }
+    }
+
+    // Simplify each level from the one before it. The error of a level relative to the full detail surface is
+    // estimated as the sum of the errors of every level up to it.
+    std::vector<lod_level_t> levels;
+    std::vector<uint32_t> simplified;
+    auto previousRanges = indexRanges;
+    float previousError = 0.0f;
+
+    for (size_t level = 0; level < options.maxLevelCount; ++level)
+    {
+        const auto targetTriangleCount = static_cast<size_t>(previousIndexCount / 3 * options.reductionRatio);
+
+        if (targetTriangleCount < options.minTriangleCount || previousError >= options.maxError)
+        {
+            break;
+        }
+
+        lod_level_t next;
+        simplified.clear();
+        float levelError = 0.0f;
+
+        for (const auto& range : previousRanges)
+        {
+            const auto rangeStart = simplified.size();
+            float rangeError = 0.0f;
+
+            simplified.resize(rangeStart + range.second);
+
+            const auto written = simplifyIndices(
+                simplified.data() + rangeStart,
+                indices.data() + range.first,
+                range.second,
+                positions,
+                vertexCount,
+                vertexStride,
+                static_cast<size_t>(range.second / 3 * options.reductionRatio) * 3,
+                options.maxError - previousError,
+                &lockedVertices,
+                &rangeError);
+
+            simplified.resize(rangeStart + written);
+            next.indexRanges.emplace_back(indices.size() + rangeStart, written);
+            levelError = std::max(levelError, rangeError);
+        }
+
+        // Stop when the mesh can no longer be simplified much, for example because most of its vertices are locked.
+        if (simplified.size() * 20 > previousIndexCount * 19)
+        {
+            break;
+        }
+
+        next.error = previousError + levelError;
+        indices.insert(indices.end(), simplified.begin(), simplified.end());
+
+        previousRanges = next.indexRanges;
+        previousIndexCount = simplified.size();
+        previousError = next.error;
+
+        levels.push_back(std::move(next));
+    }
+
+    return levels;
+}
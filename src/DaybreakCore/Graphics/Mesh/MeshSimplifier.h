@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace Daybreak
+{
+    class MeshData;
+
+    /// Options for generateLodChain.
+    struct lod_chain_options_t
+    {
+        size_t maxLevelCount = 4;       ///< Maximum number of simplified levels to generate.
+        float reductionRatio = 0.5f;    ///< Fraction of the previous level's triangles that each level aims for.
+        size_t minTriangleCount = 32;   ///< Stop before a level would have fewer triangles than this.
+
+        /// Stop once a level would be further than this from the full detail surface, in model units.
+        float maxError = std::numeric_limits<float>::max();
+    };
+
+    /// One simplified level of a set of index ranges.
+    struct lod_level_t
+    {
+        /// Index offset and count of each simplified range, in the same order as the ranges that were simplified.
+        std::vector<std::pair<size_t, size_t>> indexRanges;
+
+        /// Estimate of how far, in model units, the level's surface is from the full detail surface.
+        float error = 0.0f;
+    };
+
+    /// Simplify a triangle list by collapsing edges in order of their quadric error (Garland and Heckbert 1997) until
+    /// it has no more than targetIndexCount indices, or the next collapse would move the surface further than
+    /// maxError. Vertices are never moved or created, so the result indexes the same vertex buffer.
+    ///
+    /// Vertices that share a position but not an index are treated as an attribute seam, and open borders and seams
+    /// only collapse along themselves. Vertices that are set in lockedVertices (which is optional) never move.
+    /// Positions are read as three floats at the start of every vertexStride bytes. Writes at most indexCount indices
+    /// to destination, returns the number written and optionally gets the error of the simplified surface.
+    size_t simplifyIndices(
+        uint32_t * destination,
+        const uint32_t * indices,
+        size_t indexCount,
+        const void * positions,
+        size_t vertexCount,
+        size_t vertexStride,
+        size_t targetIndexCount,
+        float maxError = std::numeric_limits<float>::max(),
+        const std::vector<bool> * lockedVertices = nullptr,
+        float * resultError = nullptr);
+
+    /// Generate progressively simplified levels of the triangles in each index range (offset and count) of a mesh.
+    /// Every level simplifies the one before it, and the simplified indices are appended to indices, which holds the
+    /// indices of the mesh. Each range is simplified on its own and vertices whose position is shared between ranges
+    /// are locked, so ranges drawn separately (like model groups) do not crack apart.
+    std::vector<lod_level_t> generateLodChain(
+        const MeshData& mesh,
+        const std::vector<std::pair<size_t, size_t>>& indexRanges,
+        std::vector<uint32_t>& indices,
+        const lod_chain_options_t& options = lod_chain_options_t());
+}
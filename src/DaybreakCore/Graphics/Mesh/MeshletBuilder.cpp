@@ -0,0 +1,449 @@
+#include "stdafx.h"
+#include "MeshletBuilder.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/MeshOptimizer.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Utility/ParallelFor.h"
+#include "Common/Error.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+using namespace Daybreak;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    /// Meshlets whose normals spread further than this from the cone axis (as a cosine) are never back facing.
+    const float MinConeSpread = 0.1f;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Read a vertex position.
+    glm::vec3 readPosition(const void * positions, size_t vertexStride, size_t v) noexcept
+    {
+        glm::vec3 position;
+        std::memcpy(&position, static_cast<const uint8_t *>(positions) + v * vertexStride, sizeof(position));
+
+        return position;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Find a bounding sphere for a set of points. The sphere starts on the two points that are furthest apart along
+    /// a rough guess of the widest direction, and grows to include every point outside of it (Ritter 1990).
+    void computeBoundingSphere(const std::vector<glm::vec3>& points, glm::vec3& center, float& radius)
+    {
+        auto furthestFrom = [&](const glm::vec3& p) {
+            return *std::max_element(points.begin(), points.end(), [&](const glm::vec3& a, const glm::vec3& b) {
+                return glm::dot(a - p, a - p) < glm::dot(b - p, b - p);
+            });
+        };
+
+        const auto a = furthestFrom(points.front());
+        const auto b = furthestFrom(a);
+
+        center = (a + b) * 0.5f;
+        radius = glm::length(b - a) * 0.5f;
+
+        for (const auto& p : points)
+        {
+            const auto distance = glm::length(p - center);
+
+            if (distance > radius)
+            {
+                const auto newRadius = (radius + distance) * 0.5f;
+                center += (p - center) * ((newRadius - radius) / distance);
+                radius = newRadius;
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Find the bounding sphere and normal cone of a meshlet.
+    void computeMeshletBounds(
+        meshlet_t& meshlet,
+        const uint32_t * triangles,
+        size_t triangleCount,
+        const std::vector<glm::vec3>& localPositions,
+        const std::vector<uint32_t>& meshletVertices)
+    {
+        std::vector<glm::vec3> points;
+        points.reserve(meshletVertices.size());
+
+        for (auto v : meshletVertices)
+        {
+            points.push_back(localPositions[v]);
+        }
+
+        computeBoundingSphere(points, meshlet.center, meshlet.radius);
+
+        // The cone axis is the average triangle normal, and the cutoff is the sine of the angle to the normal that is
+        // furthest from it.
+        std::vector<glm::vec3> normals;
+        glm::vec3 normalSum(0.0f);
+
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            const auto& p0 = localPositions[triangles[t * 3]];
+            const auto& p1 = localPositions[triangles[t * 3 + 1]];
+            const auto& p2 = localPositions[triangles[t * 3 + 2]];
+
+            const auto normal = glm::cross(p1 - p0, p2 - p0);
+            const auto length = glm::length(normal);
+
+            if (length > 0.0f)
+            {
+                normals.push_back(normal / length);
+                normalSum += normals.back();
+            }
+        }
+
+        const auto axisLength = glm::length(normalSum);
+
+        meshlet.coneAxis = glm::vec3(0.0f);
+        meshlet.coneCutoff = 1.0f;
+
+        if (axisLength == 0.0f)
+        {
+            return;
+        }
+
+        meshlet.coneAxis = normalSum / axisLength;
+        auto minDot = 1.0f;
+
+        for (const auto& normal : normals)
+        {
+            minDot = std::min(minDot, glm::dot(normal, meshlet.coneAxis));
+        }
+
+        if (minDot > MinConeSpread)
+        {
+            meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<meshlet_t> Daybreak::buildMeshlets(
+    uint32_t * indices,
+    const meshlet_range_t& range,
+    const void * positions,
+    size_t vertexCount,
+    size_t vertexStride,
+    const meshlet_options_t& options)
+{
+    CHECK_NOT_NULL(indices);
+    CHECK_NOT_NULL(positions);
+    CHECK(range.indexCount % 3 == 0);
+    CHECK(options.maxVertices >= 3 && options.maxTriangles > 0);
+
+    const auto rangeIndices = indices + range.indexOffset;
+    const auto triangleCount = range.indexCount / 3;
+
+    // Number the vertices used by the range from zero, so the work arrays only need to be as large as the range.
+    std::unordered_map<uint32_t, uint32_t> localIds;
+    std::vector<uint32_t> triangles(range.indexCount);
+    std::vector<uint32_t> localIndices;
+    std::vector<glm::vec3> localPositions;
+
+    for (size_t i = 0; i < range.indexCount; ++i)
+    {
+        const auto result = localIds.emplace(rangeIndices[i], static_cast<uint32_t>(localPositions.size()));
+
+        if (result.second)
+        {
+            const auto vertex = rangeIndices[i] + range.baseVertex;
+            CHECK(vertex < vertexCount);
+
+            localIndices.push_back(rangeIndices[i]);
+            localPositions.push_back(readPosition(positions, vertexStride, vertex));
+        }
+
+        triangles[i] = result.first->second;
+    }
+
+    const auto localVertexCount = localPositions.size();
+
+    // Find the triangles that use each vertex.
+    std::vector<size_t> adjacencyOffsets(localVertexCount + 1, 0);
+    std::vector<uint32_t> adjacency(range.indexCount);
+
+    for (auto v : triangles)
+    {
+        ++adjacencyOffsets[v + 1];
+    }
+
+    std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+    std::vector<size_t> nextAdjacency(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+    for (size_t i = 0; i < range.indexCount; ++i)
+    {
+        adjacency[nextAdjacency[triangles[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<glm::vec3> centroids(triangleCount);
+
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        centroids[t] = (
+            localPositions[triangles[t * 3]] +
+            localPositions[triangles[t * 3 + 1]] +
+            localPositions[triangles[t * 3 + 2]]) / 3.0f;
+    }
+
+    // Grow meshlets one triangle at a time. Candidates are the unused triangles that share a vertex with the meshlet,
+    // and the best candidate adds the fewest new vertices, then is closest to the center of the meshlet so far.
+    const uint32_t NotInMeshlet = std::numeric_limits<uint32_t>::max();
+
+    std::vector<uint8_t> used(triangleCount, 0);
+    std::vector<uint32_t> vertexMeshlet(localVertexCount, NotInMeshlet);
+    std::vector<uint32_t> meshletIds(localVertexCount, 0);
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint32_t> meshletTriangles;
+    std::vector<uint32_t> meshletIndices;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> reordered;
+    std::vector<meshlet_t> meshlets;
+    size_t nextSeed = 0;
+
+    reordered.reserve(range.indexCount);
+
+    while (nextSeed < triangleCount)
+    {
+        const auto meshletId = static_cast<uint32_t>(meshlets.size());
+        glm::vec3 vertexSum(0.0f);
+
+        meshletVertices.clear();
+        meshletTriangles.clear();
+        candidates.clear();
+
+        auto newVertexCount = [&](uint32_t t) {
+            return
+                (vertexMeshlet[triangles[t * 3]] != meshletId ? 1u : 0u) +
+                (vertexMeshlet[triangles[t * 3 + 1]] != meshletId ? 1u : 0u) +
+                (vertexMeshlet[triangles[t * 3 + 2]] != meshletId ? 1u : 0u);
+        };
+
+        auto addTriangle = [&](uint32_t t) {
+            used[t] = 1;
+            meshletTriangles.push_back(t);
+
+            for (int k = 0; k < 3; ++k)
+            {
+                const auto v = triangles[t * 3 + k];
+
+                if (vertexMeshlet[v] != meshletId)
+                {
+                    vertexMeshlet[v] = meshletId;
+                    meshletIds[v] = static_cast<uint32_t>(meshletVertices.size());
+                    meshletVertices.push_back(v);
+                    vertexSum += localPositions[v];
+
+                    for (auto a = adjacencyOffsets[v]; a < adjacencyOffsets[v + 1]; ++a)
+                    {
+                        if (used[adjacency[a]] == 0)
+                        {
+                            candidates.push_back(adjacency[a]);
+                        }
+                    }
+                }
+            }
+        };
+
+        addTriangle(static_cast<uint32_t>(nextSeed));
+
+        while (meshletTriangles.size() < options.maxTriangles)
+        {
+            const auto center = vertexSum / static_cast<float>(meshletVertices.size());
+            auto best = NotInMeshlet;
+            auto bestNewVertices = 4u;
+            auto bestDistance = std::numeric_limits<float>::max();
+            size_t keptCount = 0;
+
+            for (auto t : candidates)
+            {
+                if (used[t] != 0)
+                {
+                    continue;
+                }
+
+                candidates[keptCount++] = t;
+
+                const auto newVertices = newVertexCount(t);
+
+                if (meshletVertices.size() + newVertices > options.maxVertices)
+                {
+                    continue;
+                }
+
+                const auto distance = glm::dot(centroids[t] - center, centroids[t] - center);
+
+                if (newVertices < bestNewVertices ||
+                    (newVertices == bestNewVertices && (distance < bestDistance ||
+                        (distance == bestDistance && t < best))))
+                {
+                    best = t;
+                    bestNewVertices = newVertices;
+                    bestDistance = distance;
+                }
+            }
+
+            candidates.resize(keptCount);
+
+            if (best == NotInMeshlet)
+            {
+                break;
+            }
+
+            addTriangle(best);
+        }
+
+        // Order the meshlet's triangles for the vertex cache, numbering its vertices from zero so the optimizer only
+        // needs room for the meshlet, and write them after the triangles of the meshlets before it.
+        meshletIndices.clear();
+
+        for (auto t : meshletTriangles)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                meshletIndices.push_back(meshletIds[triangles[t * 3 + k]]);
+            }
+        }
+
+        if (options.vertexCache)
+        {
+            optimizeVertexCache(
+                meshletIndices.data(),
+                meshletIndices.size(),
+                meshletVertices.size(),
+                options.cacheSize);
+        }
+
+        meshlet_t meshlet;
+        meshlet.indexOffset = range.indexOffset + reordered.size();
+        meshlet.indexCount = meshletTriangles.size() * 3;
+        meshlet.vertexCount = meshletVertices.size();
+
+        std::vector<uint32_t> localTriangles;
+        localTriangles.reserve(meshlet.indexCount);
+
+        for (auto i : meshletIndices)
+        {
+            const auto v = meshletVertices[i];
+
+            reordered.push_back(localIndices[v]);
+            localTriangles.push_back(v);
+        }
+
+        computeMeshletBounds(meshlet, localTriangles.data(), meshletTriangles.size(), localPositions, meshletVertices);
+
+        meshlets.push_back(meshlet);
+
+        while (nextSeed < triangleCount && used[nextSeed] != 0)
+        {
+            ++nextSeed;
+        }
+    }
+
+    std::copy(reordered.begin(), reordered.end(), rangeIndices);
+    return meshlets;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::vector<std::vector<meshlet_t>> Daybreak::buildMeshlets(
+    MeshData& mesh,
+    const std::vector<meshlet_range_t>& ranges,
+    const meshlet_options_t& options,
+    size_t maxWorkerCount)
+{
+    size_t positionOffset = 0;
+
+    if (!tryFindPositionOffset(mesh.vertexElementTypeRef(), positionOffset))
+    {
+        throw DaybreakDataException("Building meshlets requires a three float position attribute");
+    }
+
+    auto indices = readIndices(mesh);
+
+    // Ranges are reordered on different threads, so they must not overlap.
+    std::vector<std::pair<size_t, size_t>> sortedRanges;
+
+    for (const auto& range : ranges)
+    {
+        CHECK(range.indexOffset <= indices.size() && range.indexCount <= indices.size() - range.indexOffset);
+        sortedRanges.emplace_back(range.indexOffset, range.indexCount);
+    }
+
+    std::sort(sortedRanges.begin(), sortedRanges.end());
+
+    for (size_t i = 1; i < sortedRanges.size(); ++i)
+    {
+        CHECK(sortedRanges[i - 1].first + sortedRanges[i - 1].second <= sortedRanges[i].first);
+    }
+
+    const auto positions = static_cast<const uint8_t *>(mesh.rawVertexBufferData()) + positionOffset;
+    std::vector<std::vector<meshlet_t>> meshlets(ranges.size());
+
+    parallelFor(ranges.size(), maxWorkerCount, [&](size_t i)
+    {
+        meshlets[i] = buildMeshlets(
+            indices.data(),
+            ranges[i],
+            positions,
+            mesh.vertexCount(),
+            mesh.vertexElementSizeInBytes(),
+            options);
+    });
+
+    if (indices.empty())
+    {
+        return meshlets;
+    }
+
+    // Reorder the vertices to match the new triangle order. Indices relative to a base vertex would no longer fit the
+    // vertices they were split for, so meshes that have them keep their vertex order.
+    const auto hasBaseVertex = std::any_of(ranges.begin(), ranges.end(), [](const meshlet_range_t& range) {
+        return range.baseVertex != 0;
+    });
+
+    if (options.vertexFetch && !hasBaseVertex)
+    {
+        const auto vertexSize = mesh.vertexElementSizeInBytes();
+        std::unique_ptr<uint8_t[]> vertices(new uint8_t[mesh.vertexCount() * vertexSize]);
+
+        const auto vertexCount = optimizeVertexFetch(
+            vertices.get(),
+            mesh.rawVertexBufferData(),
+            mesh.vertexCount(),
+            vertexSize,
+            indices.data(),
+            indices.size());
+
+        mesh.setVertexBuffer(std::make_unique<VertexBufferData>(
+            vertexCount * vertexSize,
+            std::move(vertices),
+            mesh.vertexInputLayout()));
+    }
+
+    mesh.setIndexBuffer(createCompactIndexBuffer(indices.data(), indices.size()));
+    return meshlets;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool Daybreak::isMeshletBackFacing(const meshlet_t& meshlet, const glm::vec3& cameraPosition) noexcept
+{
+    if (meshlet.coneCutoff >= 1.0f)
+    {
+        return false;
+    }
+
+    // Every point of the meshlet is inside its bounding sphere, so the meshlet is back facing when the view direction
+    // to any point in the sphere is more than 90 degrees from every normal in the cone.
+    const auto toCenter = meshlet.center - cameraPosition;
+    return glm::dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius;
+}
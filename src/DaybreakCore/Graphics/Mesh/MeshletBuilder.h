@@ -0,0 +1,78 @@
+#pragma once
+#include "Graphics/Mesh/MeshOptimizer.h"
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Daybreak
+{
+    class MeshData;
+
+    /// Default maximum number of unique vertices in a meshlet.
+    const size_t DefaultMeshletMaxVertices = 64;
+
+    /// Default maximum number of triangles in a meshlet.
+    const size_t DefaultMeshletMaxTriangles = 124;
+
+    /// Options for buildMeshlets.
+    struct meshlet_options_t
+    {
+        size_t maxVertices = DefaultMeshletMaxVertices;     ///< Maximum number of unique vertices in a meshlet.
+        size_t maxTriangles = DefaultMeshletMaxTriangles;   ///< Maximum number of triangles in a meshlet.
+        bool vertexCache = true;                            ///< Reorder each meshlet's triangles for the vertex cache.
+        bool vertexFetch = true;                            ///< Reorder vertices in the order they are first used.
+        size_t cacheSize = DefaultVertexCacheSize;          ///< Vertex cache size to optimize for.
+    };
+
+    /// A small cluster of neighbouring triangles that is stored as a contiguous run of indices, with the bounds used
+    /// to cull it.
+    struct meshlet_t
+    {
+        size_t indexOffset = 0;                     ///< Offset of the meshlet's first index in the index buffer.
+        size_t indexCount = 0;                      ///< Number of indices in the meshlet.
+        size_t vertexCount = 0;                     ///< Number of unique vertices used by the meshlet.
+        glm::vec3 center = glm::vec3(0.0f);         ///< Center of the meshlet's bounding sphere.
+        float radius = 0.0f;                        ///< Radius of the meshlet's bounding sphere.
+        glm::vec3 coneAxis = glm::vec3(0.0f);       ///< Average direction of the meshlet's triangle normals.
+
+        /// Sine of the largest angle between the cone axis and a triangle normal, or one when the normals spread too
+        /// far for the meshlet to ever be back facing.
+        float coneCutoff = 1.0f;
+    };
+
+    /// A range of a mesh's index buffer to split into meshlets.
+    struct meshlet_range_t
+    {
+        size_t indexOffset = 0;     ///< Offset of the range's first index.
+        size_t indexCount = 0;      ///< Number of indices in the range.
+        size_t baseVertex = 0;      ///< Value added to every index in the range before fetching a vertex.
+    };
+
+    /// Split the triangles in an index range into meshlets. Meshlets are grown greedily from a seed triangle by
+    /// adding the neighbouring triangle that needs the fewest new vertices and is closest to the meshlet's center.
+    /// The triangles in the range are reordered so every meshlet is a contiguous run of indices, and the triangles of
+    /// each meshlet are then ordered for the vertex cache. Positions are read as three floats at the start of every
+    /// vertexStride bytes.
+    std::vector<meshlet_t> buildMeshlets(
+        uint32_t * indices,
+        const meshlet_range_t& range,
+        const void * positions,
+        size_t vertexCount,
+        size_t vertexStride,
+        const meshlet_options_t& options = meshlet_options_t());
+
+    /// Split every index range of a mesh into meshlets using up to maxWorkerCount threads, and replace the mesh's
+    /// index buffer with one where every meshlet is a contiguous run of indices. When every range has a zero base
+    /// vertex the vertices are then reordered to match the new triangle order, like optimizeMesh does. Returns the
+    /// meshlets of each range.
+    std::vector<std::vector<meshlet_t>> buildMeshlets(
+        MeshData& mesh,
+        const std::vector<meshlet_range_t>& ranges,
+        const meshlet_options_t& options = meshlet_options_t(),
+        size_t maxWorkerCount = 1);
+
+    /// Check if every triangle of a meshlet faces away from a camera at the given position, using the meshlet's
+    /// normal cone and bounding sphere.
+    bool isMeshletBackFacing(const meshlet_t& meshlet, const glm::vec3& cameraPosition) noexcept;
+}
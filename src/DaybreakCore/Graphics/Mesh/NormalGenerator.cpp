@@ -0,0 +1,497 @@
+#include "stdafx.h"
+#include "NormalGenerator.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/InputLayoutDescription.h"
+#include "Utility/ParallelFor.h"
+#include "Common/Error.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <glm/glm.hpp>
+
+using namespace Daybreak;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    /// Number of triangles (or positions) handed to a worker at a time.
+    const size_t ItemsPerBlock = 16 * 1024;
+
+    /// Corners of the same vertex whose normals are closer than this, as the cosine of the angle between them, share
+    /// one output vertex.
+    const float SameNormalCosine = 0.99999f;
+
+    /// Marks an empty slot in the position hash table.
+    const uint32_t NoVertex = UINT32_MAX;
+
+    /// Bit pattern of a vertex position.
+    using position_key_t = std::array<uint32_t, 3>;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Get the number of blocks needed to cover count items.
+    size_t blockCount(size_t count) noexcept
+    {
+        return (count + ItemsPerBlock - 1) / ItemsPerBlock;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Read a vertex position.
+    glm::vec3 readPosition(const uint8_t * positions, size_t vertexStride, uint32_t v) noexcept
+    {
+        glm::vec3 position;
+        std::memcpy(&position, positions + v * vertexStride, sizeof(position));
+
+        return position;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Read the bit pattern of a vertex position, with negative zero written as zero so the two are welded together.
+    position_key_t readPositionKey(const uint8_t * positions, size_t vertexStride, uint32_t v) noexcept
+    {
+        auto position = readPosition(positions, vertexStride, v);
+        position_key_t key;
+
+        for (glm::length_t k = 0; k < 3; ++k)
+        {
+            const float value = (position[k] == 0.0f ? 0.0f : position[k]);
+            std::memcpy(&key[static_cast<size_t>(k)], &value, sizeof(value));
+        }
+
+        return key;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Hash the bit pattern of a position. The bits are mixed well because the low bits of round numbers are zero.
+    uint32_t hashPositionKey(const position_key_t& key) noexcept
+    {
+        auto h = key[0];
+        h = h * 31u + key[1];
+        h = h * 31u + key[2];
+
+        h ^= h >> 16;
+        h *= 0x85EBCA6Bu;
+        h ^= h >> 13;
+        h *= 0xC2B2AE35u;
+        h ^= h >> 16;
+
+        return h;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Give every vertex the id of its position, so vertices that share a position but not an index are smoothed
+    /// together. Returns the number of unique positions.
+    size_t weldPositions(
+        const uint8_t * positions,
+        size_t vertexStride,
+        size_t vertexCount,
+        std::vector<uint32_t>& positionOf)
+    {
+        std::vector<position_key_t> keys(vertexCount);
+
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            keys[v] = readPositionKey(positions, vertexStride, static_cast<uint32_t>(v));
+        }
+
+        // Open addressing table holding the first vertex with each position. It is never more than half full.
+        size_t capacity = 1;
+
+        while (capacity < vertexCount * 2)
+        {
+            capacity *= 2;
+        }
+
+        std::vector<uint32_t> table(capacity, NoVertex);
+        size_t positionCount = 0;
+
+        positionOf.resize(vertexCount);
+
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            auto slot = hashPositionKey(keys[v]) & (capacity - 1);
+
+            while (table[slot] != NoVertex && keys[table[slot]] != keys[v])
+            {
+                slot = (slot + 1) & (capacity - 1);
+            }
+
+            if (table[slot] == NoVertex)
+            {
+                table[slot] = static_cast<uint32_t>(v);
+                positionOf[v] = static_cast<uint32_t>(positionCount++);
+            }
+            else
+            {
+                positionOf[v] = positionOf[table[slot]];
+            }
+        }
+
+        return positionCount;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<MeshData> Daybreak::generateNormals(
+    const MeshData& mesh,
+    const normal_generation_options_t& options,
+    const std::vector<uint32_t> * smoothingGroups,
+    size_t maxWorkerCount)
+{
+    const auto& layout = mesh.vertexElementTypeRef();
+    const auto vertexCount = mesh.vertexCount();
+    const auto vertexStride = mesh.vertexElementSizeInBytes();
+
+    // Find the position and normal attributes.
+    bool hasPosition = false;
+    bool hasNormal = false;
+    size_t positionOffset = 0;
+
+    for (size_t i = 0; i < layout.attributeCount(); ++i)
+    {
+        const auto attribute = layout.getAttributeByIndex(i);
+        const bool isFloat3 =
+            attribute.semanticIndex() == 0 &&
+            attribute.type() == InputAttribute::StorageType::Float &&
+            attribute.count() == 3;
+
+        if (isFloat3 && attribute.semanticName() == InputAttribute::SemanticName::Position)
+        {
+            positionOffset = layout.attributeOffsetByIndex(i);
+            hasPosition = true;
+        }
+        else if (isFloat3 && attribute.semanticName() == InputAttribute::SemanticName::Normal)
+        {
+            hasNormal = true;
+        }
+    }
+
+    if (!hasPosition || !hasNormal)
+    {
+        throw DaybreakDataException("Generating normals requires three float position and normal attributes");
+    }
+
+    const auto indices = readIndices(mesh);
+    const auto indexCount = indices.size();
+    const auto triangleCount = indexCount / 3;
+
+    CHECK(indexCount % 3 == 0);
+    CHECK(smoothingGroups == nullptr || smoothingGroups->size() == triangleCount);
+
+    const auto source = static_cast<const uint8_t *>(mesh.rawVertexBufferData());
+    const auto positions = source + positionOffset;
+
+    // Weld vertices by position and list the triangle corners at every position.
+    std::vector<uint32_t> positionOf;
+    const auto positionCount = weldPositions(positions, vertexStride, vertexCount, positionOf);
+
+    std::vector<uint32_t> cornerOffsets(positionCount + 1, 0);
+    std::vector<uint32_t> corners(indexCount);
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        cornerOffsets[positionOf[indices[i]] + 1]++;
+    }
+
+    for (size_t p = 0; p < positionCount; ++p)
+    {
+        cornerOffsets[p + 1] += cornerOffsets[p];
+    }
+
+    {
+        auto nextCorner = cornerOffsets;
+
+        for (size_t i = 0; i < indexCount; ++i)
+        {
+            corners[nextCorner[positionOf[indices[i]]]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // Find the unit normal of every triangle, and weight each corner by the triangle's area and the corner's angle.
+    std::vector<glm::vec3> faceNormals(triangleCount);
+    std::vector<float> cornerWeights(indexCount);
+
+    parallelFor(blockCount(triangleCount), maxWorkerCount, [&](size_t block)
+    {
+        const auto lastTriangle = std::min(triangleCount, (block + 1) * ItemsPerBlock);
+
+        for (auto t = block * ItemsPerBlock; t < lastTriangle; ++t)
+        {
+            const glm::vec3 p[3] = {
+                readPosition(positions, vertexStride, indices[t * 3]),
+                readPosition(positions, vertexStride, indices[t * 3 + 1]),
+                readPosition(positions, vertexStride, indices[t * 3 + 2])
+            };
+
+            const auto cross = glm::cross(p[1] - p[0], p[2] - p[0]);
+            const auto length = glm::length(cross);
+
+            faceNormals[t] = (length > 0.0f ? cross / length : glm::vec3(0.0f));
+
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const auto a = p[(k + 1) % 3] - p[k];
+                const auto b = p[(k + 2) % 3] - p[k];
+                const auto lengths = glm::length(a) * glm::length(b);
+                const auto cosine = (lengths > 0.0f ? glm::clamp(glm::dot(a, b) / lengths, -1.0f, 1.0f) : 1.0f);
+                const auto angle = std::acos(cosine);
+
+                cornerWeights[t * 3 + k] = length * 0.5f * angle;
+            }
+        }
+    });
+
+    // Give every corner the weighted average of the normals of the triangles it can be smoothed with. The corners at
+    // a position are sorted by smoothing group and face normal, and corners of a group whose triangles face exactly
+    // the same way are summed into one entry, because they are always smoothed together. Only the distinct normals
+    // of a group are compared, and not even those when every normal is within half the crease angle of the group's
+    // average, which puts every pair within the crease angle of each other.
+    const auto creaseAngle = glm::radians(glm::clamp(options.creaseAngle, 0.0f, 180.0f));
+    const auto creaseCosine = std::cos(creaseAngle);
+    const auto halfCreaseCosine = std::cos(creaseAngle * 0.5f);
+    std::vector<glm::vec3> cornerNormals(indexCount);
+
+    // Triangles in smoothing group zero are only smoothed with themselves.
+    auto smoothingGroupOf = [&](size_t t) {
+        return (smoothingGroups != nullptr ? (*smoothingGroups)[t] : 1u);
+    };
+
+    auto isLess = [](const glm::vec3& a, const glm::vec3& b) {
+        return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+    };
+
+    parallelFor(blockCount(positionCount), maxWorkerCount, [&](size_t block)
+    {
+        const auto lastPosition = std::min(positionCount, (block + 1) * ItemsPerBlock);
+        std::vector<uint32_t> sortedCorners;
+        std::vector<uint32_t> entryOf;
+        std::vector<glm::vec3> entrySums;
+        std::vector<glm::vec3> entryNormals;
+        std::vector<glm::vec3> smoothedSums;
+
+        for (auto p = block * ItemsPerBlock; p < lastPosition; ++p)
+        {
+            sortedCorners.assign(corners.begin() + cornerOffsets[p], corners.begin() + cornerOffsets[p + 1]);
+
+            std::sort(sortedCorners.begin(), sortedCorners.end(), [&](uint32_t a, uint32_t b) {
+                const auto groupA = smoothingGroupOf(a / 3);
+                const auto groupB = smoothingGroupOf(b / 3);
+                const auto& normalA = faceNormals[a / 3];
+                const auto& normalB = faceNormals[b / 3];
+
+                if (groupA != groupB)
+                {
+                    return groupA < groupB;
+                }
+
+                return isLess(normalA, normalB) || (!isLess(normalB, normalA) && a < b);
+            });
+
+            // Sum the weighted normals of the corners that share a smoothing group and face normal.
+            entryOf.resize(sortedCorners.size());
+            entrySums.clear();
+            entryNormals.clear();
+
+            for (size_t i = 0; i < sortedCorners.size(); ++i)
+            {
+                const auto corner = sortedCorners[i];
+                const auto t = corner / 3;
+                const auto previousT = (i > 0 ? sortedCorners[i - 1] / 3 : 0);
+
+                const auto isNewEntry =
+                    i == 0 ||
+                    smoothingGroupOf(t) == 0 ||
+                    smoothingGroupOf(t) != smoothingGroupOf(previousT) ||
+                    faceNormals[t] != faceNormals[previousT];
+
+                if (isNewEntry)
+                {
+                    entrySums.push_back(glm::vec3(0.0f));
+                    entryNormals.push_back(faceNormals[t]);
+                }
+
+                entrySums.back() += faceNormals[t] * cornerWeights[corner];
+                entryOf[i] = static_cast<uint32_t>(entrySums.size() - 1);
+            }
+
+            // Smooth the entries of each smoothing group together.
+            smoothedSums = entrySums;
+            size_t groupStart = 0;
+
+            while (!options.flat && groupStart < sortedCorners.size())
+            {
+                const auto group = smoothingGroupOf(sortedCorners[groupStart] / 3);
+                auto groupEnd = groupStart + 1;
+
+                while (groupEnd < sortedCorners.size() && smoothingGroupOf(sortedCorners[groupEnd] / 3) == group)
+                {
+                    ++groupEnd;
+                }
+
+                const auto firstEntry = entryOf[groupStart];
+                const auto lastEntry = entryOf[groupEnd - 1] + 1;
+                groupStart = groupEnd;
+
+                if (group == 0 || lastEntry - firstEntry == 1)
+                {
+                    continue;
+                }
+
+                glm::vec3 total(0.0f);
+
+                for (auto e = firstEntry; e < lastEntry; ++e)
+                {
+                    total += entrySums[e];
+                }
+
+                const auto totalLength = glm::length(total);
+                auto isWithinHalfCrease = (totalLength > 0.0f);
+
+                for (auto e = firstEntry; e < lastEntry && isWithinHalfCrease; ++e)
+                {
+                    isWithinHalfCrease = (glm::dot(entryNormals[e], total) >= halfCreaseCosine * totalLength);
+                }
+
+                for (auto e = firstEntry; e < lastEntry; ++e)
+                {
+                    if (isWithinHalfCrease)
+                    {
+                        smoothedSums[e] = total;
+                        continue;
+                    }
+
+                    for (auto other = firstEntry; other < lastEntry; ++other)
+                    {
+                        if (other != e && glm::dot(entryNormals[e], entryNormals[other]) >= creaseCosine)
+                        {
+                            smoothedSums[e] += entrySums[other];
+                        }
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < sortedCorners.size(); ++i)
+            {
+                const auto corner = sortedCorners[i];
+                const auto& normal = smoothedSums[entryOf[i]];
+                const auto length = glm::length(normal);
+
+                cornerNormals[corner] = (length > 0.0f ? normal / length : faceNormals[corner / 3]);
+            }
+        }
+    });
+
+    // Corners of one vertex with the same normal share the vertex. The first normal found for a vertex keeps the
+    // original vertex and each other normal gets a copy of it. Every vertex belongs to exactly one position, so
+    // positions can be split on different workers.
+    std::vector<uint32_t> ownerOf(indexCount);              ///< Corner that picks the output vertex of each corner.
+    std::vector<uint32_t> outputVertexOf(indexCount);       ///< Output vertex of each owning corner.
+    std::vector<uint8_t> isVertexUsed(vertexCount, 0);
+    std::vector<std::vector<uint32_t>> blockCopies(blockCount(positionCount));
+
+    parallelFor(blockCopies.size(), maxWorkerCount, [&](size_t block)
+    {
+        const auto lastPosition = std::min(positionCount, (block + 1) * ItemsPerBlock);
+        std::vector<uint32_t> owners;
+
+        for (auto p = block * ItemsPerBlock; p < lastPosition; ++p)
+        {
+            owners.clear();
+
+            for (auto c = cornerOffsets[p]; c < cornerOffsets[p + 1]; ++c)
+            {
+                const auto corner = corners[c];
+                const auto v = indices[corner];
+                auto owner = NoVertex;
+
+                for (auto other : owners)
+                {
+                    const auto& normal = cornerNormals[corner];
+
+                    if (indices[other] == v && glm::dot(cornerNormals[other], normal) >= SameNormalCosine)
+                    {
+                        owner = other;
+                        break;
+                    }
+                }
+
+                if (owner == NoVertex)
+                {
+                    owner = corner;
+                    owners.push_back(corner);
+
+                    if (isVertexUsed[v] == 0)
+                    {
+                        isVertexUsed[v] = 1;
+                        outputVertexOf[corner] = v;
+                    }
+                    else
+                    {
+                        blockCopies[block].push_back(corner);
+                    }
+                }
+
+                ownerOf[corner] = owner;
+            }
+        }
+    });
+
+    // Place the copied vertices after the original ones.
+    auto outputVertexCount = vertexCount;
+
+    for (const auto& copies : blockCopies)
+    {
+        for (auto corner : copies)
+        {
+            outputVertexOf[corner] = static_cast<uint32_t>(outputVertexCount++);
+        }
+    }
+
+    std::unique_ptr<uint8_t[]> bytes(new uint8_t[outputVertexCount * vertexStride]);
+    std::memcpy(bytes.get(), source, vertexCount * vertexStride);
+
+    parallelFor(blockCopies.size(), maxWorkerCount, [&](size_t block)
+    {
+        for (auto corner : blockCopies[block])
+        {
+            std::memcpy(
+                bytes.get() + outputVertexOf[corner] * vertexStride,
+                source + indices[corner] * vertexStride,
+                vertexStride);
+        }
+    });
+
+    auto vertexBuffer = std::make_unique<VertexBufferData>(
+        outputVertexCount * vertexStride,
+        std::move(bytes),
+        mesh.vertexInputLayout());
+
+    // Write the normal of every output vertex once, from the corner that owns it, and point every corner at its
+    // owner's vertex.
+    auto normals = vertexBuffer->attributeBegin<glm::vec3>(InputAttribute::SemanticName::Normal);
+    std::vector<uint32_t> outputIndices(indexCount);
+
+    parallelFor(blockCount(triangleCount), maxWorkerCount, [&](size_t block)
+    {
+        const auto lastIndex = std::min(triangleCount, (block + 1) * ItemsPerBlock) * 3;
+
+        for (auto i = block * ItemsPerBlock * 3; i < lastIndex; ++i)
+        {
+            const auto owner = ownerOf[i];
+            outputIndices[i] = outputVertexOf[owner];
+
+            if (owner == i)
+            {
+                normals[static_cast<ptrdiff_t>(outputVertexOf[owner])] = cornerNormals[i];
+            }
+        }
+    });
+
+    return std::make_unique<MeshData>(
+        createCompactIndexBuffer(outputIndices.data(), outputIndices.size()),
+        std::move(vertexBuffer));
+}
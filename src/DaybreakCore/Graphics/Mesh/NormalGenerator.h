@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Daybreak
+{
+    class MeshData;
+
+    /// Default largest angle, in degrees, between two triangles that are smoothed across their shared vertices.
+    const float DefaultNormalCreaseAngle = 80.0f;
+
+    /// Options for generateNormals.
+    struct normal_generation_options_t
+    {
+        bool flat = false;                              ///< Give every triangle its own face normal.
+
+        /// Triangles that meet at a larger angle than this, in degrees, form a hard edge instead of being smoothed.
+        float creaseAngle = DefaultNormalCreaseAngle;
+    };
+
+    /// Create a copy of a mesh with generated vertex normals. Each triangle corner gets the average of the normals of
+    /// the triangles around its position, weighted by triangle area and by the angle at the corner, so the result
+    /// does not depend on how the surface is tessellated. Vertices that share a position but not an index (attribute
+    /// seams) are smoothed together, and vertices whose corners end up with different normals are split.
+    ///
+    /// Triangles are only smoothed together when they meet at no more than the crease angle, and when smoothingGroups
+    /// (optional, one per triangle) is given, only when they are in the same non zero smoothing group. The mesh needs
+    /// three float position and normal attributes, and the triangles keep their order so index ranges stay valid.
+    std::unique_ptr<MeshData> generateNormals(
+        const MeshData& mesh,
+        const normal_generation_options_t& options = normal_generation_options_t(),
+        const std::vector<uint32_t> * smoothingGroups = nullptr,
+        size_t maxWorkerCount = 1);
+}
@@ -0,0 +1,514 @@
+#include "stdafx.h"
+#include "TangentGenerator.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/Mesh/VertexFormat.h"
+#include "Graphics/InputLayoutDescription.h"
+#include "Utility/ParallelFor.h"
+#include "Common/Error.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <glm/glm.hpp>
+
+using namespace Daybreak;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    /// Number of triangles (or vertices) handed to a worker at a time.
+    const size_t ItemsPerBlock = 16 * 1024;
+
+    /// Orientation of a triangle whose texture coordinates have no area, which joins the other triangles of a vertex.
+    const int8_t AnyOrientation = 0;
+
+    /// Marks a vertex that is not copied.
+    const uint32_t NoVertex = UINT32_MAX;
+
+    /// Flags for the corners that use a vertex.
+    const uint8_t UsedByAnyCorner = 1;
+    const uint8_t UsedByPositiveCorner = 2;
+    const uint8_t UsedByNegativeCorner = 4;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Get the number of blocks needed to cover count items.
+    size_t blockCount(size_t count) noexcept
+    {
+        return (count + ItemsPerBlock - 1) / ItemsPerBlock;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Read a value of a vertex attribute.
+    template<typename T>
+    T readAttribute(const uint8_t * attribute, size_t vertexStride, uint32_t v) noexcept
+    {
+        T value;
+        std::memcpy(&value, attribute + v * vertexStride, sizeof(value));
+
+        return value;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Remove the part of a vector along a unit normal, and normalize what is left if it is not zero.
+    glm::vec3 projectOntoPlane(const glm::vec3& v, const glm::vec3& normal) noexcept
+    {
+        const auto projected = v - normal * glm::dot(normal, v);
+        const auto length = glm::length(projected);
+
+        return (length > 0.0f ? projected / length : projected);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Get a tangent for a vertex whose triangles give no tangent direction, perpendicular to the normal.
+    glm::vec3 perpendicularTangent(const glm::vec3& normal) noexcept
+    {
+        const auto axis = (std::abs(normal.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+        return projectOntoPlane(axis, normal);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Get the flag for corners of an orientation.
+    uint8_t orientationFlag(int8_t orientation) noexcept
+    {
+        return (orientation > 0 ? UsedByPositiveCorner : (orientation < 0 ? UsedByNegativeCorner : uint8_t(0)));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Find the first vertex with the same position, normal and texture coordinate bits as each vertex, which is the
+    /// vertex that stands for all of them.
+    std::vector<uint32_t> weldVertices(
+        const uint8_t * positions,
+        const uint8_t * normals,
+        const uint8_t * textures,
+        size_t vertexStride,
+        size_t vertexCount)
+    {
+        std::vector<std::array<uint32_t, 8>> keys(vertexCount);
+
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            std::memcpy(keys[v].data(), positions + v * vertexStride, 3 * sizeof(float));
+            std::memcpy(keys[v].data() + 3, normals + v * vertexStride, 3 * sizeof(float));
+            std::memcpy(keys[v].data() + 6, textures + v * vertexStride, 2 * sizeof(float));
+        }
+
+        std::vector<uint32_t> order(vertexCount);
+        std::iota(order.begin(), order.end(), 0);
+
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+            return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+        });
+
+        std::vector<uint32_t> weldOf(vertexCount);
+
+        for (size_t i = 0; i < vertexCount; ++i)
+        {
+            const auto isFirst = (i == 0 || keys[order[i]] != keys[order[i - 1]]);
+            weldOf[order[i]] = (isFirst ? order[i] : weldOf[order[i - 1]]);
+        }
+
+        return weldOf;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Check if an attribute is a float vector with the given semantic and size.
+    bool isFloatAttribute(const InputAttribute& attribute, InputAttribute::SemanticName name, unsigned int count)
+    {
+        return
+            attribute.semanticName() == name &&
+            attribute.semanticIndex() == 0 &&
+            attribute.type() == InputAttribute::StorageType::Float &&
+            attribute.count() == count;
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<MeshData> Daybreak::generateTangents(
+    const MeshData& mesh,
+    const std::vector<std::pair<size_t, size_t>>& indexRanges,
+    size_t maxWorkerCount)
+{
+    const auto& layout = mesh.vertexElementTypeRef();
+    const auto vertexCount = mesh.vertexCount();
+    const auto vertexStride = mesh.vertexElementSizeInBytes();
+
+    // Find the attributes tangents are made from, and the tangent attribute if there is one already.
+    const size_t NotFound = SIZE_MAX;
+    size_t positionOffset = NotFound;
+    size_t textureOffset = NotFound;
+    size_t normalOffset = NotFound;
+    bool hasTangent = false;
+
+    for (size_t i = 0; i < layout.attributeCount(); ++i)
+    {
+        const auto attribute = layout.getAttributeByIndex(i);
+
+        if (isFloatAttribute(attribute, InputAttribute::SemanticName::Position, 3))
+        {
+            positionOffset = layout.attributeOffsetByIndex(i);
+        }
+        else if (isFloatAttribute(attribute, InputAttribute::SemanticName::Texture, 2))
+        {
+            textureOffset = layout.attributeOffsetByIndex(i);
+        }
+        else if (isFloatAttribute(attribute, InputAttribute::SemanticName::Normal, 3))
+        {
+            normalOffset = layout.attributeOffsetByIndex(i);
+        }
+        else if (attribute.semanticName() == InputAttribute::SemanticName::Tangent && attribute.semanticIndex() == 0)
+        {
+            if (!isFloatAttribute(attribute, InputAttribute::SemanticName::Tangent, 4))
+            {
+                throw DaybreakDataException("Generated tangents can only be written to a four float attribute");
+            }
+
+            hasTangent = true;
+        }
+    }
+
+    if (positionOffset == NotFound || textureOffset == NotFound || normalOffset == NotFound)
+    {
+        throw DaybreakDataException(
+            "Generating tangents requires three float position and normal and two float texture attributes");
+    }
+
+    auto indices = readIndices(mesh);
+
+    // Corners in different ranges are written by different workers, so the ranges must not overlap. Triangles are
+    // listed in index order so the result does not depend on the order of the ranges.
+    auto sortedRanges = indexRanges;
+    std::sort(sortedRanges.begin(), sortedRanges.end());
+
+    for (size_t i = 0; i < sortedRanges.size(); ++i)
+    {
+        const auto& range = sortedRanges[i];
+
+        CHECK(range.second % 3 == 0);
+        CHECK(range.first <= indices.size() && range.second <= indices.size() - range.first);
+        CHECK(i == 0 || sortedRanges[i - 1].first + sortedRanges[i - 1].second <= range.first);
+    }
+
+    std::vector<uint32_t> triangleStarts;
+
+    for (const auto& range : sortedRanges)
+    {
+        for (auto i = range.first; i < range.first + range.second; i += 3)
+        {
+            CHECK(indices[i] < vertexCount && indices[i + 1] < vertexCount && indices[i + 2] < vertexCount);
+            triangleStarts.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    const auto triangleCount = triangleStarts.size();
+    const auto cornerCount = triangleCount * 3;
+    const auto source = static_cast<const uint8_t *>(mesh.rawVertexBufferData());
+    const auto positions = source + positionOffset;
+    const auto textures = source + textureOffset;
+    const auto normals = source + normalOffset;
+
+    auto readNormal = [&](uint32_t v) {
+        const auto normal = readAttribute<glm::vec3>(normals, vertexStride, v);
+        const auto length = glm::length(normal);
+
+        return (length > 0.0f ? normal / length : normal);
+    };
+
+    // Find the direction the texture's u coordinate increases in on every triangle, and whether the texture mapping
+    // keeps the triangle's winding. Each corner gets that direction projected onto the plane of its vertex normal,
+    // weighted by the angle at the corner in the same plane.
+    std::vector<int8_t> orientations(triangleCount);
+    std::vector<glm::vec3> cornerTangents(cornerCount);
+
+    parallelFor(blockCount(triangleCount), maxWorkerCount, [&](size_t block)
+    {
+        const auto lastTriangle = std::min(triangleCount, (block + 1) * ItemsPerBlock);
+
+        for (auto t = block * ItemsPerBlock; t < lastTriangle; ++t)
+        {
+            const auto start = triangleStarts[t];
+            const uint32_t v[3] = { indices[start], indices[start + 1], indices[start + 2] };
+
+            const glm::vec3 p[3] = {
+                readAttribute<glm::vec3>(positions, vertexStride, v[0]),
+                readAttribute<glm::vec3>(positions, vertexStride, v[1]),
+                readAttribute<glm::vec3>(positions, vertexStride, v[2])
+            };
+
+            const glm::vec2 uv[3] = {
+                readAttribute<glm::vec2>(textures, vertexStride, v[0]),
+                readAttribute<glm::vec2>(textures, vertexStride, v[1]),
+                readAttribute<glm::vec2>(textures, vertexStride, v[2])
+            };
+
+            const auto d1 = p[1] - p[0];
+            const auto d2 = p[2] - p[0];
+            const auto t21 = uv[1] - uv[0];
+            const auto t31 = uv[2] - uv[0];
+            const auto signedArea = t21.x * t31.y - t21.y * t31.x;
+
+            auto tangent = t31.y * d1 - t21.y * d2;
+            const auto length = glm::length(tangent);
+
+            if (signedArea != 0.0f && length > 0.0f)
+            {
+                tangent *= (signedArea > 0.0f ? 1.0f : -1.0f) / length;
+            }
+
+            orientations[t] = (signedArea > 0.0f ? 1 : (signedArea < 0.0f ? -1 : AnyOrientation));
+
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const auto normal = readNormal(v[k]);
+                const auto a = projectOntoPlane(p[(k + 2) % 3] - p[k], normal);
+                const auto b = projectOntoPlane(p[(k + 1) % 3] - p[k], normal);
+                const auto angle = std::acos(glm::clamp(glm::dot(a, b), -1.0f, 1.0f));
+
+                cornerTangents[t * 3 + k] = projectOntoPlane(tangent, normal) * angle;
+            }
+        }
+    });
+
+    // Weld the vertices that have the same position, normal and texture coordinate, so tangents are averaged over
+    // every corner at a point whether or not the mesh was deduplicated. The first vertex of a weld stands for it.
+    const auto weldOf = weldVertices(positions, normals, textures, vertexStride, vertexCount);
+
+    // List the corners of every weld, and note the orientations of the corners that use each vertex.
+    std::vector<uint32_t> cornerOffsets(vertexCount + 1, 0);
+    std::vector<uint32_t> corners(cornerCount);
+    std::vector<uint8_t> vertexUses(vertexCount, 0);
+
+    for (size_t c = 0; c < cornerCount; ++c)
+    {
+        const auto v = indices[triangleStarts[c / 3] + c % 3];
+
+        cornerOffsets[weldOf[v] + 1]++;
+        vertexUses[v] = static_cast<uint8_t>(vertexUses[v] | UsedByAnyCorner | orientationFlag(orientations[c / 3]));
+    }
+
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        cornerOffsets[v + 1] += cornerOffsets[v];
+    }
+
+    {
+        auto nextCorner = cornerOffsets;
+
+        for (size_t c = 0; c < cornerCount; ++c)
+        {
+            corners[nextCorner[weldOf[indices[triangleStarts[c / 3] + c % 3]]]++] = static_cast<uint32_t>(c);
+        }
+    }
+
+    // Sum the corner tangents of every weld separately for each orientation. The orientation of the weld's first
+    // oriented corner is the weld's own and also gets the corners that have no orientation.
+    std::vector<glm::vec3> weldSums(vertexCount);
+    std::vector<glm::vec3> weldCopySums(vertexCount);
+    std::vector<int8_t> weldOrientations(vertexCount, 1);
+
+    parallelFor(blockCount(vertexCount), maxWorkerCount, [&](size_t block)
+    {
+        const auto lastVertex = std::min(vertexCount, (block + 1) * ItemsPerBlock);
+
+        for (auto w = block * ItemsPerBlock; w < lastVertex; ++w)
+        {
+            const auto first = cornerOffsets[w];
+            const auto last = cornerOffsets[w + 1];
+            int8_t orientation = 1;
+
+            for (auto c = first; c < last; ++c)
+            {
+                if (orientations[corners[c] / 3] != AnyOrientation)
+                {
+                    orientation = orientations[corners[c] / 3];
+                    break;
+                }
+            }
+
+            glm::vec3 sum(0.0f);
+            glm::vec3 copySum(0.0f);
+
+            for (auto c = first; c < last; ++c)
+            {
+                const auto cornerOrientation = orientations[corners[c] / 3];
+
+                if (cornerOrientation == AnyOrientation || cornerOrientation == orientation)
+                {
+                    sum += cornerTangents[corners[c]];
+                }
+                else
+                {
+                    copySum += cornerTangents[corners[c]];
+                }
+            }
+
+            weldSums[w] = sum;
+            weldCopySums[w] = copySum;
+            weldOrientations[w] = orientation;
+        }
+    });
+
+    // Every vertex takes its weld's tangent for the orientation of its corners. A vertex used by corners of both
+    // orientations keeps the weld's orientation and gets a copy of the vertex for the other one.
+    std::vector<glm::vec4> tangents(vertexCount);
+    std::vector<glm::vec4> copyTangents(vertexCount);
+    std::vector<int8_t> vertexOrientations(vertexCount, AnyOrientation);
+    std::vector<std::vector<uint32_t>> blockCopies(blockCount(vertexCount));
+
+    parallelFor(blockCopies.size(), maxWorkerCount, [&](size_t block)
+    {
+        const auto lastVertex = std::min(vertexCount, (block + 1) * ItemsPerBlock);
+
+        for (auto v = block * ItemsPerBlock; v < lastVertex; ++v)
+        {
+            const auto w = weldOf[v];
+            const auto normal = readNormal(static_cast<uint32_t>(v));
+            const auto weldOrientation = weldOrientations[w];
+            const auto otherOrientation = static_cast<int8_t>(-weldOrientation);
+            const auto usesWeldOrientation = (vertexUses[v] & orientationFlag(weldOrientation)) != 0;
+            const auto usesOtherOrientation = (vertexUses[v] & orientationFlag(otherOrientation)) != 0;
+
+            auto finish = [&](const glm::vec3& tangent, int8_t sign) {
+                const auto length = glm::length(tangent);
+                const auto direction = (length > 0.0f ? tangent / length : perpendicularTangent(normal));
+
+                return glm::vec4(direction, static_cast<float>(sign));
+            };
+
+            if (usesWeldOrientation || !usesOtherOrientation)
+            {
+                tangents[v] = finish(weldSums[w], weldOrientation);
+                vertexOrientations[v] = weldOrientation;
+            }
+            else
+            {
+                tangents[v] = finish(weldCopySums[w], otherOrientation);
+                vertexOrientations[v] = otherOrientation;
+            }
+
+            if (usesWeldOrientation && usesOtherOrientation)
+            {
+                copyTangents[v] = finish(weldCopySums[w], otherOrientation);
+                blockCopies[block].push_back(static_cast<uint32_t>(v));
+            }
+        }
+    });
+
+    // Place the copied vertices after the original ones.
+    std::vector<uint32_t> copyOf(vertexCount, NoVertex);
+    auto outputVertexCount = vertexCount;
+
+    for (const auto& copies : blockCopies)
+    {
+        for (auto v : copies)
+        {
+            copyOf[v] = static_cast<uint32_t>(outputVertexCount++);
+        }
+    }
+
+    // Append a tangent attribute to the vertex layout if there is not one already. Attributes are laid out one after
+    // the other, so the tangent goes after the existing attributes of each vertex.
+    auto outputLayout = mesh.vertexInputLayout();
+
+    if (!hasTangent)
+    {
+        std::vector<InputAttribute> attributes;
+
+        for (size_t i = 0; i < layout.attributeCount(); ++i)
+        {
+            attributes.push_back(layout.getAttributeByIndex(i));
+        }
+
+        attributes.emplace_back(InputAttribute::SemanticName::Tangent, 0, InputAttribute::StorageType::Float, 4);
+
+        bool isStandardLayout = (attributes.size() == vertex_ptnt_t::inputLayout->attributeCount());
+
+        for (size_t i = 0; isStandardLayout && i < attributes.size(); ++i)
+        {
+            isStandardLayout = (attributes[i] == vertex_ptnt_t::inputLayout->getAttributeByIndex(i));
+        }
+
+        outputLayout = (isStandardLayout ?
+            vertex_ptnt_t::inputLayout :
+            std::make_shared<InputLayoutDescription>(attributes));
+    }
+
+    const auto outputStride = outputLayout->elementSizeInBytes();
+    std::unique_ptr<uint8_t[]> bytes(new uint8_t[outputVertexCount * outputStride]());
+
+    parallelFor(blockCopies.size(), maxWorkerCount, [&](size_t block)
+    {
+        const auto lastVertex = std::min(vertexCount, (block + 1) * ItemsPerBlock);
+
+        for (auto v = block * ItemsPerBlock; v < lastVertex; ++v)
+        {
+            std::memcpy(bytes.get() + v * outputStride, source + v * vertexStride, vertexStride);
+        }
+
+        for (auto v : blockCopies[block])
+        {
+            std::memcpy(bytes.get() + copyOf[v] * outputStride, source + v * vertexStride, vertexStride);
+        }
+    });
+
+    auto vertexBuffer = std::make_unique<VertexBufferData>(
+        outputVertexCount * outputStride,
+        std::move(bytes),
+        outputLayout);
+
+    // Write the tangents. Vertices no triangle uses keep the tangent they had, or get one perpendicular to their
+    // normal when the attribute is new.
+    auto outputTangents = vertexBuffer->attributeBegin<glm::vec4>(InputAttribute::SemanticName::Tangent);
+
+    parallelFor(blockCopies.size(), maxWorkerCount, [&](size_t block)
+    {
+        const auto lastVertex = std::min(vertexCount, (block + 1) * ItemsPerBlock);
+
+        for (auto v = block * ItemsPerBlock; v < lastVertex; ++v)
+        {
+            if (vertexUses[v] != 0)
+            {
+                outputTangents[static_cast<ptrdiff_t>(v)] = tangents[v];
+            }
+            else if (!hasTangent)
+            {
+                const auto normal = readNormal(static_cast<uint32_t>(v));
+                outputTangents[static_cast<ptrdiff_t>(v)] = glm::vec4(perpendicularTangent(normal), 1.0f);
+            }
+        }
+
+        for (auto v : blockCopies[block])
+        {
+            outputTangents[static_cast<ptrdiff_t>(copyOf[v])] = copyTangents[v];
+        }
+    });
+
+    // Point the corners whose orientation differs from their vertex's at the vertex's copy.
+    parallelFor(blockCount(triangleCount), maxWorkerCount, [&](size_t block)
+    {
+        const auto lastTriangle = std::min(triangleCount, (block + 1) * ItemsPerBlock);
+
+        for (auto t = block * ItemsPerBlock; t < lastTriangle; ++t)
+        {
+            const auto orientation = orientations[t];
+
+            for (size_t k = 0; k < 3; ++k)
+            {
+                auto& index = indices[triangleStarts[t] + k];
+
+                if (orientation != AnyOrientation && orientation != vertexOrientations[index])
+                {
+                    index = copyOf[index];
+                }
+            }
+        }
+    });
+
+    return std::make_unique<MeshData>(
+        createCompactIndexBuffer(indices.data(), indices.size()),
+        std::move(vertexBuffer));
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Daybreak
+{
+    class MeshData;
+
+    /// Create a copy of a mesh with generated tangents for normal mapping, computed for the triangles in each index
+    /// range (offset and count) the same way as MikkTSpace. Each corner's tangent points along the direction the first
+    /// texture coordinate increases in, projected onto the plane of the vertex normal and averaged with the other
+    /// corners of the vertex weighted by the angle at the corner. The tangent's w is the bitangent sign: 1 where the
+    /// texture mapping keeps the triangle's winding and -1 where it is mirrored, and vertices used by both mirrored and
+    /// unmirrored triangles are split. Like MikkTSpace, corners are averaged over every vertex with the same position,
+    /// normal and texture coordinate, so the tangents do not depend on whether the vertices were deduplicated.
+    ///
+    /// The mesh needs three float position and normal attributes and a two float texture attribute. A four float
+    /// tangent attribute is filled in if the mesh has one and appended to the vertex layout otherwise. The triangles
+    /// keep their order so index ranges stay valid, and the ranges must not overlap. Triangles are processed in
+    /// blocks on up to maxWorkerCount threads, and the result does not depend on the number of threads.
+    std::unique_ptr<MeshData> generateTangents(
+        const MeshData& mesh,
+        const std::vector<std::pair<size_t, size_t>>& indexRanges,
+        size_t maxWorkerCount = 1);
+}
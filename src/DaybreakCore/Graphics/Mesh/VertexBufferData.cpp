@@ -12,27 +12,46 @@ VertexBufferData::VertexBufferData(
     _In_ std::shared_ptr<const InputLayoutDescription> inputLayout)
     : BufferData(byteCount, std::move(bytes)),
       m_inputLayout(inputLayout)
+{
+    initializeVertexCount();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+VertexBufferData::VertexBufferData(
+    _In_ size_t byteCount,
+    _In_ const void * bytes,
+    _In_ std::shared_ptr<const void> bytesOwner,
+    _In_ std::shared_ptr<const InputLayoutDescription> inputLayout)
+    : BufferData(),
+      m_inputLayout(inputLayout)
+{
+    setUnownedDataPtr(byteCount, const_cast<void *>(bytes), std::move(bytesOwner));
+    initializeVertexCount();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+VertexBufferData::~VertexBufferData() = default;
+
+//---------------------------------------------------------------------------------------------------------------------
+void VertexBufferData::initializeVertexCount()
 {
     CHECK_NOT_NULL(m_bytes);
-    CHECK_NOT_NULL(inputLayout);
+    CHECK_NOT_NULL(m_inputLayout);
 
-    if (byteCount == 0)
+    if (m_byteCount == 0)
     {
         throw DaybreakDataException("Vertex buffer size cannot be zero");
     }
 
-    if (inputLayout->elementSizeInBytes() == 0)
+    if (m_inputLayout->elementSizeInBytes() == 0)
     {
         throw DaybreakDataException("Vertex buffer input layout description cannot be empty");
     }
 
-    if (byteCount % inputLayout->elementSizeInBytes() != 0)
+    if (m_byteCount % m_inputLayout->elementSizeInBytes() != 0)
     {
         throw DaybreakDataException("Vertex buffer size must be multiple of vertex size");
     }
 
-    m_vertexCount = byteCount / inputLayout->elementSizeInBytes();
+    m_vertexCount = m_byteCount / m_inputLayout->elementSizeInBytes();
 }
-
-//---------------------------------------------------------------------------------------------------------------------
-VertexBufferData::~VertexBufferData() = default;
@@ -32,6 +32,14 @@ namespace Daybreak
         {
         }
 
+        // Constructor for vertex bytes that belong to another object (for example a mapped file). The bytes are not
+        // copied, and the owner is kept alive for as long as the buffer exists.
+        VertexBufferData(
+            _In_ size_t byteCount,
+            _In_ const void * bytes,
+            _In_ std::shared_ptr<const void> bytesOwner,
+            _In_ std::shared_ptr<const InputLayoutDescription> inputLayout);
+
         // Destructor.
         virtual ~VertexBufferData();
 
@@ -64,6 +72,10 @@ namespace Daybreak
                 m_inputLayout->elementSizeInBytes());
         }
 
+    private:
+        // Check the buffer matches the input layout and calculate the vertex count.
+        void initializeVertexCount();
+
     protected:
         std::shared_ptr<const InputLayoutDescription> m_inputLayout;
         size_t m_vertexCount = 0;
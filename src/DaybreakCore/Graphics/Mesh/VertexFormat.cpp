@@ -13,3 +13,12 @@ std::shared_ptr<InputLayoutDescription> vertex_ptn_t::inputLayout = std::make_sh
         { InputAttribute::SemanticName::Texture, 0, InputAttribute::StorageType::Float, 2 },
         { InputAttribute::SemanticName::Normal, 0, InputAttribute::StorageType::Float, 3 }
 });
+
+//---------------------------------------------------------------------------------------------------------------------
+std::shared_ptr<InputLayoutDescription> vertex_ptnt_t::inputLayout = std::make_shared<InputLayoutDescription>(
+    std::vector<InputAttribute> {
+        { InputAttribute::SemanticName::Position, 0, InputAttribute::StorageType::Float, 3 },
+        { InputAttribute::SemanticName::Texture, 0, InputAttribute::StorageType::Float, 2 },
+        { InputAttribute::SemanticName::Normal, 0, InputAttribute::StorageType::Float, 3 },
+        { InputAttribute::SemanticName::Tangent, 0, InputAttribute::StorageType::Float, 4 }
+});
@@ -48,4 +48,60 @@ namespace Daybreak
     public:
         static std::shared_ptr<InputLayoutDescription> inputLayout;
     };
+
+    // Lit vertex for normal mapping (position, texture 0, normal, tangent). The tangent's w holds the bitangent sign,
+    // so the bitangent is cross(normal, tangent.xyz) * tangent.w.
+    struct vertex_ptnt_t
+    {
+    public:
+        vertex_ptnt_t()
+            : vertex_ptnt_t(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+        {
+        }
+
+        vertex_ptnt_t(
+            float px, float py, float pz,
+            float u, float v,
+            float nx, float ny, float nz,
+            float tx, float ty, float tz, float tw)
+        {
+            elements[0] = px; elements[1] = py; elements[2] = pz;
+            elements[3] = u; elements[4] = v;
+            elements[5] = nx; elements[6] = ny; elements[7] = nz;
+            elements[8] = tx; elements[9] = ty; elements[10] = tz; elements[11] = tw;
+        }
+
+        void setPosition(float x, float y, float z)
+        {
+            elements[0] = x;
+            elements[1] = y;
+            elements[2] = z;
+        }
+
+        void setUV(float u, float v)
+        {
+            elements[3] = u;
+            elements[4] = v;
+        }
+
+        void setNormal(float x, float y, float z)
+        {
+            elements[5] = x;
+            elements[6] = y;
+            elements[7] = z;
+        }
+
+        void setTangent(float x, float y, float z, float bitangentSign)
+        {
+            elements[8] = x;
+            elements[9] = y;
+            elements[10] = z;
+            elements[11] = bitangentSign;
+        }
+
+        float elements[3 + 2 + 3 + 4];
+
+    public:
+        static std::shared_ptr<InputLayoutDescription> inputLayout;
+    };
 }
\ No newline at end of file
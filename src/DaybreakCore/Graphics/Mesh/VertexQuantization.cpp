@@ -0,0 +1,393 @@
+#include "stdafx.h"
+#include "VertexQuantization.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/InputLayoutDescription.h"
+#include "Common/Error.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <glm/gtc/packing.hpp>
+
+using namespace Daybreak;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    /// What to do with an attribute of the source mesh.
+    enum class AttributeAction
+    {
+        Position,
+        Texture,
+        Normal,
+        Copy
+    };
+
+    /// How one attribute of the source mesh is written to the quantized mesh.
+    struct attribute_plan_t
+    {
+        AttributeAction action;
+        size_t sourceOffset;
+        size_t sourceSize;
+        size_t destinationOffset;
+    };
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Check if an attribute is a vector of floats with the given semantic name and component count.
+    bool isFloatAttribute(const InputAttribute& attribute, InputAttribute::SemanticName name, unsigned int count)
+    {
+        return
+            attribute.semanticName() == name &&
+            attribute.semanticIndex() == 0 &&
+            attribute.type() == InputAttribute::StorageType::Float &&
+            attribute.count() == count;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    template<typename T>
+    T readValue(const uint8_t * source) noexcept
+    {
+        T value;
+        std::memcpy(&value, source, sizeof(T));
+
+        return value;
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    template<typename T>
+    void writeValue(uint8_t * destination, const T& value) noexcept
+    {
+        std::memcpy(destination, &value, sizeof(T));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    uint16_t toUNorm16(float value) noexcept
+    {
+        return static_cast<uint16_t>(std::lround(glm::clamp(value, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    int16_t toSNorm16(float value) noexcept
+    {
+        return static_cast<int16_t>(std::lround(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Pack a vector into the GL_INT_2_10_10_10_REV layout, with x in the lowest bits.
+    uint32_t toSNorm1010102(const glm::vec4& value) noexcept
+    {
+        auto pack = [](float v, float maxValue, uint32_t mask)
+        {
+            const auto value = static_cast<int32_t>(std::lround(glm::clamp(v, -1.0f, 1.0f) * maxValue));
+            return static_cast<uint32_t>(value) & mask;
+        };
+
+        return
+            pack(value.x, 511.0f, 0x3FF) |
+            (pack(value.y, 511.0f, 0x3FF) << 10) |
+            (pack(value.z, 511.0f, 0x3FF) << 20) |
+            (pack(value.w, 1.0f, 0x3) << 30);
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Get the attribute a position is stored in.
+    InputAttribute positionAttribute(PositionEncoding encoding)
+    {
+        switch (encoding)
+        {
+        case PositionEncoding::Float:
+            return { InputAttribute::SemanticName::Position, 0, InputAttribute::StorageType::Float, 3 };
+        case PositionEncoding::HalfFloat:
+            return { InputAttribute::SemanticName::Position, 0, InputAttribute::StorageType::HalfFloat, 4 };
+        case PositionEncoding::UNorm16:
+            return { InputAttribute::SemanticName::Position, 0, InputAttribute::StorageType::UnsignedShort, 4, true };
+        default:
+            THROW_ENUM_SWITCH_NOT_HANDLED(PositionEncoding, encoding);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Get the attribute a normal is stored in.
+    InputAttribute normalAttribute(NormalEncoding encoding)
+    {
+        switch (encoding)
+        {
+        case NormalEncoding::Float:
+            return { InputAttribute::SemanticName::Normal, 0, InputAttribute::StorageType::Float, 3 };
+        case NormalEncoding::SNorm1010102:
+            return { InputAttribute::SemanticName::Normal, 0, InputAttribute::StorageType::PackedInt2101010, 4, true };
+        case NormalEncoding::OctahedralSNorm16:
+            return { InputAttribute::SemanticName::Normal, 0, InputAttribute::StorageType::Short, 2, true };
+        default:
+            THROW_ENUM_SWITCH_NOT_HANDLED(NormalEncoding, encoding);
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    /// Get the attribute a texture coordinate is stored in.
+    InputAttribute textureAttribute(TextureEncoding encoding)
+    {
+        switch (encoding)
+        {
+        case TextureEncoding::Float:
+            return { InputAttribute::SemanticName::Texture, 0, InputAttribute::StorageType::Float, 2 };
+        case TextureEncoding::HalfFloat:
+            return { InputAttribute::SemanticName::Texture, 0, InputAttribute::StorageType::HalfFloat, 2 };
+        case TextureEncoding::UNorm16:
+            return { InputAttribute::SemanticName::Texture, 0, InputAttribute::StorageType::UnsignedShort, 2, true };
+        default:
+            THROW_ENUM_SWITCH_NOT_HANDLED(TextureEncoding, encoding);
+        }
+    }
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+glm::vec2 Daybreak::encodeOctahedralNormal(const glm::vec3& normal) noexcept
+{
+    const auto length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+
+    if (length == 0.0f)
+    {
+        return glm::vec2(0.0f);
+    }
+
+    auto n = glm::vec2(normal.x, normal.y) / length;
+
+    // Fold the lower hemisphere over the diagonals.
+    if (normal.z < 0.0f)
+    {
+        n = glm::vec2(
+            (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+            (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+    }
+
+    return n;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+glm::vec3 Daybreak::decodeOctahedralNormal(const glm::vec2& encoded) noexcept
+{
+    glm::vec3 n(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+
+    if (n.z < 0.0f)
+    {
+        const auto x = n.x;
+        n.x = (1.0f - std::abs(n.y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        n.y = (1.0f - std::abs(x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+    }
+
+    return glm::normalize(n);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+std::unique_ptr<MeshData> Daybreak::quantizeVertices(
+    const MeshData& mesh,
+    const vertex_quantization_options_t& options,
+    position_dequantization_t& dequantization)
+{
+    const auto& sourceLayout = mesh.vertexElementTypeRef();
+    const auto vertexCount = mesh.vertexCount();
+    const auto sourceSize = mesh.vertexElementSizeInBytes();
+    const auto source = static_cast<const uint8_t *>(mesh.rawVertexBufferData());
+
+    // Find the attributes to quantize. Only the first position, texture and normal attributes are quantized.
+    std::vector<attribute_plan_t> plan;
+    std::vector<InputAttribute> attributes;
+    bool hasPosition = false;
+    bool hasTexture = false;
+    bool hasNormal = false;
+    size_t positionOffset = 0;
+    size_t textureOffset = 0;
+
+    for (size_t i = 0; i < sourceLayout.attributeCount(); ++i)
+    {
+        const auto attribute = sourceLayout.getAttributeByIndex(i);
+        const auto offset = sourceLayout.attributeOffsetByIndex(i);
+
+        if (!hasPosition && isFloatAttribute(attribute, InputAttribute::SemanticName::Position, 3))
+        {
+            plan.push_back({ AttributeAction::Position, offset, attribute.sizeInBytes(), 0 });
+            attributes.push_back(positionAttribute(options.position));
+            positionOffset = offset;
+            hasPosition = true;
+        }
+        else if (!hasTexture && isFloatAttribute(attribute, InputAttribute::SemanticName::Texture, 2))
+        {
+            plan.push_back({ AttributeAction::Texture, offset, attribute.sizeInBytes(), 0 });
+            attributes.push_back(textureAttribute(options.texture));
+            textureOffset = offset;
+            hasTexture = true;
+        }
+        else if (!hasNormal && isFloatAttribute(attribute, InputAttribute::SemanticName::Normal, 3))
+        {
+            plan.push_back({ AttributeAction::Normal, offset, attribute.sizeInBytes(), 0 });
+            attributes.push_back(normalAttribute(options.normal));
+            hasNormal = true;
+        }
+        else
+        {
+            plan.push_back({ AttributeAction::Copy, offset, attribute.sizeInBytes(), 0 });
+            attributes.push_back(attribute);
+        }
+    }
+
+    if (!hasPosition)
+    {
+        throw DaybreakDataException("Quantizing vertices requires a three float position attribute");
+    }
+
+    // Find the mesh bounds, and check if texture coordinates fit in the range unsigned normalized values can store.
+    glm::vec3 minPosition(0.0f);
+    glm::vec3 maxPosition(0.0f);
+    bool texturesInUnitRange = true;
+
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        const auto position = readValue<glm::vec3>(source + v * sourceSize + positionOffset);
+
+        minPosition = (v == 0 ? position : glm::min(minPosition, position));
+        maxPosition = (v == 0 ? position : glm::max(maxPosition, position));
+
+        if (hasTexture)
+        {
+            const auto uv = readValue<glm::vec2>(source + v * sourceSize + textureOffset);
+            texturesInUnitRange &= (uv.x >= 0.0f && uv.x <= 1.0f && uv.y >= 0.0f && uv.y <= 1.0f);
+        }
+    }
+
+    const auto textureEncoding = (options.texture == TextureEncoding::UNorm16 && !texturesInUnitRange) ?
+        TextureEncoding::HalfFloat :
+        options.texture;
+
+    for (size_t i = 0; i < plan.size(); ++i)
+    {
+        if (plan[i].action == AttributeAction::Texture)
+        {
+            attributes[i] = textureAttribute(textureEncoding);
+        }
+    }
+
+    // Create the quantized layout.
+    auto layout = std::make_shared<InputLayoutDescription>(attributes);
+    const auto destinationSize = layout->elementSizeInBytes();
+
+    for (size_t i = 0; i < plan.size(); ++i)
+    {
+        plan[i].destinationOffset = layout->attributeOffsetByIndex(i);
+    }
+
+    if (options.position == PositionEncoding::UNorm16)
+    {
+        dequantization.offset = minPosition;
+        dequantization.scale = maxPosition - minPosition;
+    }
+    else
+    {
+        dequantization = position_dequantization_t();
+    }
+
+    // Avoid dividing by zero for flat meshes. Every position is at the offset along a flat axis.
+    const auto extent = maxPosition - minPosition;
+    const auto inverseExtent = glm::vec3(
+        extent.x > 0.0f ? 1.0f / extent.x : 0.0f,
+        extent.y > 0.0f ? 1.0f / extent.y : 0.0f,
+        extent.z > 0.0f ? 1.0f / extent.z : 0.0f);
+
+    // Write the quantized vertices.
+    std::unique_ptr<uint8_t[]> vertices(new uint8_t[vertexCount * destinationSize]);
+
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        const auto input = source + v * sourceSize;
+        const auto output = vertices.get() + v * destinationSize;
+
+        for (const auto& step : plan)
+        {
+            const auto from = input + step.sourceOffset;
+            const auto to = output + step.destinationOffset;
+
+            switch (step.action)
+            {
+            case AttributeAction::Position:
+                {
+                    const auto p = readValue<glm::vec3>(from);
+
+                    if (options.position == PositionEncoding::Float)
+                    {
+                        writeValue(to, p);
+                    }
+                    else if (options.position == PositionEncoding::HalfFloat)
+                    {
+                        writeValue(to, glm::packHalf4x16(glm::vec4(p, 1.0f)));
+                    }
+                    else
+                    {
+                        const auto q = (p - minPosition) * inverseExtent;
+                        const uint16_t values[] = { toUNorm16(q.x), toUNorm16(q.y), toUNorm16(q.z), 65535 };
+                        writeValue(to, values);
+                    }
+                }
+                break;
+
+            case AttributeAction::Texture:
+                {
+                    const auto uv = readValue<glm::vec2>(from);
+
+                    if (textureEncoding == TextureEncoding::Float)
+                    {
+                        writeValue(to, uv);
+                    }
+                    else if (textureEncoding == TextureEncoding::HalfFloat)
+                    {
+                        writeValue(to, glm::packHalf2x16(uv));
+                    }
+                    else
+                    {
+                        const uint16_t values[] = { toUNorm16(uv.x), toUNorm16(uv.y) };
+                        writeValue(to, values);
+                    }
+                }
+                break;
+
+            case AttributeAction::Normal:
+                {
+                    const auto n = readValue<glm::vec3>(from);
+
+                    if (options.normal == NormalEncoding::Float)
+                    {
+                        writeValue(to, n);
+                    }
+                    else if (options.normal == NormalEncoding::SNorm1010102)
+                    {
+                        writeValue(to, toSNorm1010102(glm::vec4(n, 0.0f)));
+                    }
+                    else
+                    {
+                        const auto e = encodeOctahedralNormal(n);
+                        const int16_t values[] = { toSNorm16(e.x), toSNorm16(e.y) };
+                        writeValue(to, values);
+                    }
+                }
+                break;
+
+            case AttributeAction::Copy:
+                std::memcpy(to, from, step.sourceSize);
+                break;
+
+            default:
+                THROW_ENUM_SWITCH_NOT_HANDLED(AttributeAction, step.action);
+            }
+        }
+    }
+
+    // The index buffer is copied as is.
+    const auto indexByteCount = mesh.indexCount() * mesh.indexElementSizeInBytes();
+    std::unique_ptr<uint8_t[]> indices(new uint8_t[indexByteCount]);
+    std::memcpy(indices.get(), mesh.rawIndexBufferData(), indexByteCount);
+
+    return std::make_unique<MeshData>(
+        std::make_unique<IndexBufferData>(indexByteCount, std::move(indices), mesh.indexElementType()),
+        std::make_unique<VertexBufferData>(vertexCount * destinationSize, std::move(vertices), layout));
+}
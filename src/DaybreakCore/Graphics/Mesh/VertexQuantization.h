@@ -0,0 +1,64 @@
+#pragma once
+#include <memory>
+#include <glm/glm.hpp>
+
+namespace Daybreak
+{
+    class InputLayoutDescription;
+    class MeshData;
+
+    /// How vertex positions are stored in a quantized mesh.
+    enum class PositionEncoding
+    {
+        Float,              ///< Three 32 bit floats (12 bytes).
+        HalfFloat,          ///< Four 16 bit floats, w is one (8 bytes).
+        UNorm16             ///< Four normalized 16 bit values relative to the mesh bounds, w is one (8 bytes).
+    };
+
+    /// How vertex normals are stored in a quantized mesh.
+    enum class NormalEncoding
+    {
+        Float,              ///< Three 32 bit floats (12 bytes).
+        SNorm1010102,       ///< Normalized signed 10:10:10:2 packed value, w is zero (4 bytes).
+        OctahedralSNorm16   ///< Octahedral projection as two normalized signed 16 bit values (4 bytes).
+    };
+
+    /// How vertex texture coordinates are stored in a quantized mesh.
+    enum class TextureEncoding
+    {
+        Float,              ///< Two 32 bit floats (8 bytes).
+        HalfFloat,          ///< Two 16 bit floats (4 bytes).
+        UNorm16             ///< Two normalized 16 bit values (4 bytes). Falls back to half floats outside [0, 1].
+    };
+
+    /// Options for quantizeVertices. The defaults store a position, normal and texture vertex in 16 bytes.
+    struct vertex_quantization_options_t
+    {
+        PositionEncoding position = PositionEncoding::UNorm16;
+        NormalEncoding normal = NormalEncoding::SNorm1010102;
+        TextureEncoding texture = TextureEncoding::UNorm16;
+    };
+
+    /// Transform from quantized positions back to model space: position = offset + quantized * scale. Renderers fold
+    /// this into the model matrix.
+    struct position_dequantization_t
+    {
+        glm::vec3 offset = glm::vec3(0.0f);
+        glm::vec3 scale = glm::vec3(1.0f);
+    };
+
+    /// Map a unit vector onto the octahedron and unfold it into [-1, 1] x [-1, 1].
+    glm::vec2 encodeOctahedralNormal(const glm::vec3& normal) noexcept;
+
+    /// Turn an octahedral encoded normal back into a unit vector. Shaders reading OctahedralSNorm16 normals need to
+    /// do the same.
+    glm::vec3 decodeOctahedralNormal(const glm::vec2& encoded) noexcept;
+
+    /// Create a copy of a mesh with smaller vertices. The source mesh must have a three float position attribute,
+    /// and the two float texture and three float normal attributes are quantized when present. Any other attributes
+    /// are copied unchanged. Gets the transform that turns quantized positions back into model space.
+    std::unique_ptr<MeshData> quantizeVertices(
+        const MeshData& mesh,
+        const vertex_quantization_options_t& options,
+        position_dequantization_t& dequantization);
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <vector>
 
 #include "Renderer\Texture.h"
 
@@ -13,6 +14,13 @@ namespace Daybreak
     class IShader;
     class VertexBuffer;
 
+    /** Source image and parameters of a texture created with IDeviceContext::createTextures2d. */
+    struct texture2d_upload_t
+    {
+        const Image * image = nullptr;
+        TextureParameters params;
+    };
+
     /*** Hardware independent API for managing rendering resources. */
     class IDeviceContext
     {
@@ -35,6 +43,24 @@ namespace Daybreak
             const Image& image,                     ///< Source image.
             const TextureParameters& params) = 0;   ///< Texture sampling and generation parameters.
 
+        /**
+         * Create many 2d textures in one batch. Textures are returned in the order of their uploads, and are null if
+         * they could not be created. The default implementation calls createTexture2d for each upload.
+         */
+        virtual std::vector<std::unique_ptr<ITexture2d>> createTextures2d(
+            const std::vector<texture2d_upload_t>& uploads)
+        {
+            std::vector<std::unique_ptr<ITexture2d>> textures;
+            textures.reserve(uploads.size());
+
+            for (const auto& upload : uploads)
+            {
+                textures.push_back(createTexture2d(*upload.image, upload.params));
+            }
+
+            return textures;
+        }
+
         /** Create a new index buffer. */
         virtual std::unique_ptr<IndexBuffer> createIndexBuffer(
             const MeshData& mesh) = 0;              ///< Source index data.
@@ -90,8 +90,12 @@ namespace Daybreak
 
     // Contextual commands.
     public:
+        // Draw count indices of the bound index buffer, starting at the index offset.
         virtual void drawTriangles(unsigned int offset, unsigned int count) = 0;
 
+        // Draw triangles with baseVertex added to every index before fetching vertices.
+        virtual void drawTriangles(unsigned int offset, unsigned int count, int baseVertex) = 0;
+
     // Properties.
     public:
         // Enable or disable depth testing.
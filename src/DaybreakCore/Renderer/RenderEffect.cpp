@@ -22,10 +22,11 @@ void IRendererEffect::finishPass(_In_ IRenderContext& context) const
 void IRendererEffect::startRenderObject(
     _In_ IRenderContext& context,
     _In_ unsigned int offset,
-    _In_ unsigned int count) const
+    _In_ unsigned int count,
+    _In_ int baseVertex) const
 {
     onStartRenderObject(context, offset, count);
-    context.drawTriangles(offset, count);
+    context.drawTriangles(offset, count, baseVertex);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -28,11 +28,12 @@ namespace Daybreak
         // Called by renderer after finishing drawing all objects in a pass.
         void finishPass(_In_ IRenderContext& context) const;
 
-        //
+        // Draw count indices starting at offset, with baseVertex added to every index before fetching vertices.
         void startRenderObject(
             _In_ IRenderContext& context,
             _In_ unsigned int offset,
-            _In_ unsigned int count) const;
+            _In_ unsigned int count,
+            _In_ int baseVertex = 0) const;
 
     // Effect event implementations.
     public:
@@ -1,5 +1,6 @@
 #pragma once
 #include "GpuResource.h"
+#include "app/support/hash.h"
 #include <string>
 
 namespace Daybreak
@@ -26,7 +27,11 @@ namespace Daybreak
         Grayscale,
         GrayscaleWithAlpha,
         RGB,
-        RGBA
+        RGBA,
+        BC1,                // Block compressed RGB, 4 bits per pixel.
+        BC3,                // Block compressed RGBA, 8 bits per pixel.
+        BC4,                // Block compressed single channel, 4 bits per pixel.
+        BC5                 // Block compressed two channels, 8 bits per pixel.
     };
 
     // Defines how a texture should be sampled by the GPU.
@@ -81,6 +86,12 @@ namespace Daybreak
         // Set texture format.
         void setFormat(TextureFormat format) { m_format = format; }
 
+        // Check if two sets of parameters create the same texture.
+        bool operator ==(const TextureParameters& rhs) const noexcept;
+
+        // Check if two sets of parameters create different textures.
+        bool operator !=(const TextureParameters& rhs) const noexcept { return !(*this == rhs); }
+
     private:
         TextureWrapMode m_wrapS = TextureWrapMode::Repeat;
         TextureWrapMode m_wrapT = TextureWrapMode::Repeat;
@@ -101,4 +112,14 @@ namespace Daybreak
         // Get texture name. (Optional, might be empty.)
         virtual std::string name() const = 0;
     };
-}
\ No newline at end of file
+}
+
+DAYBREAK_MAKE_HASHABLE(
+    Daybreak::TextureParameters,
+    t.wrapS(),
+    t.wrapT(),
+    t.wrapU(),
+    t.minFilter(),
+    t.magFilter(),
+    t.mipFilter(),
+    t.format())
\ No newline at end of file
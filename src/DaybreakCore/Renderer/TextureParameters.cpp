@@ -35,3 +35,15 @@ void TextureParameters::setWrapU(TextureWrapMode mode)
 {
     m_wrapU = mode;
 }
+
+//---------------------------------------------------------------------------------------------------------------------
+bool TextureParameters::operator ==(const TextureParameters& rhs) const noexcept
+{
+    return m_wrapS == rhs.m_wrapS &&
+        m_wrapT == rhs.m_wrapT &&
+        m_wrapU == rhs.m_wrapU &&
+        m_minFilter == rhs.m_minFilter &&
+        m_magFilter == rhs.m_magFilter &&
+        m_mipFilter == rhs.m_mipFilter &&
+        m_format == rhs.m_format;
+}
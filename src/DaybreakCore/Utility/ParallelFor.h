@@ -0,0 +1,83 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <vector>
+
+namespace Daybreak
+{
+    /**
+     * Information about the work a thread is doing, like the load it is reading files for. parallelFor passes the
+     * context of the calling thread on to its workers, so work split across threads keeps its context.
+     */
+    class WorkContext
+    {
+    public:
+        virtual ~WorkContext() = default;
+
+        /** Get the context of the work on the current thread, or null if there is none. */
+        static WorkContext * current() noexcept { return s_current; }
+
+        /** Set the context of the work on the current thread and return the context it replaced. */
+        static WorkContext * exchange(WorkContext * context) noexcept
+        {
+            auto previous = s_current;
+            s_current = context;
+
+            return previous;
+        }
+
+    private:
+        static inline thread_local WorkContext * s_current = nullptr;
+    };
+
+    /**
+     * Call func with every index in [0, count) using up to maxWorkerCount threads. Workers take the next unclaimed
+     * index until none are left, and the first error thrown by a worker is rethrown once all workers are done. Workers
+     * run with the WorkContext of the calling thread.
+     */
+    template<typename TFunc>
+    void parallelFor(size_t count, size_t maxWorkerCount, TFunc func)
+    {
+        const auto workerCount = std::min(std::max<size_t>(maxWorkerCount, 1), count);
+
+        if (workerCount <= 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                func(i);
+            }
+
+            return;
+        }
+
+        std::atomic<size_t> nextItem = 0;
+        std::vector<std::future<void>> workers;
+        workers.reserve(workerCount);
+
+        const auto context = WorkContext::current();
+
+        for (size_t w = 0; w < workerCount; ++w)
+        {
+            workers.push_back(std::async(std::launch::async, [&]()
+            {
+                // Worker threads can be reused, so put back whatever context the thread had when the work is done.
+                struct context_scope_t
+                {
+                    WorkContext * previous;
+                    ~context_scope_t() { WorkContext::exchange(previous); }
+                } scope{ WorkContext::exchange(context) };
+
+                for (auto i = nextItem++; i < count; i = nextItem++)
+                {
+                    func(i);
+                }
+            }));
+        }
+
+        for (auto& worker : workers)
+        {
+            worker.get();
+        }
+    }
+}
@@ -0,0 +1,325 @@
+#include "stdafx.h"
+#include "TextScanning.h"
+
+#include <cfloat>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#   define DAYBREAK_TEXT_SCANNING_SSE2
+#   include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+using namespace Daybreak::TextUtils;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace
+{
+    // Powers of ten that are exactly representable as a float (up to 10^10) and a double (up to 10^22).
+    const float FloatPowersOfTen[] =
+    {
+        1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+    };
+
+    const double DoublePowersOfTen[] =
+    {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    const uint64_t MaxExactFloatMantissa = uint64_t(1) << 24;
+    const uint64_t MaxExactDoubleMantissa = uint64_t(1) << 53;
+    const int MaxSignificantDigits = 19;
+
+    //-----------------------------------------------------------------------------------------------------------------
+    bool isDigit(char c) noexcept
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    bool isBlankSpace(char c) noexcept
+    {
+        return c == ' ' || c == '\t';
+    }
+
+#ifdef DAYBREAK_TEXT_SCANNING_SSE2
+    //-----------------------------------------------------------------------------------------------------------------
+    unsigned int countTrailingZeros(unsigned int mask) noexcept
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    unsigned int matchMask(__m128i block, __m128i a, __m128i b) noexcept
+    {
+        return static_cast<unsigned int>(
+            _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, a), _mm_cmpeq_epi8(block, b))));
+    }
+#endif
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const char * Daybreak::TextUtils::findFirstOf(const char * first, const char * last, char a, char b) noexcept
+{
+#ifdef DAYBREAK_TEXT_SCANNING_SSE2
+    const auto va = _mm_set1_epi8(a);
+    const auto vb = _mm_set1_epi8(b);
+
+    while (last - first >= 16)
+    {
+        auto mask = matchMask(_mm_loadu_si128(reinterpret_cast<const __m128i *>(first)), va, vb);
+
+        if (mask != 0)
+        {
+            return first + countTrailingZeros(mask);
+        }
+
+        first += 16;
+    }
+#endif
+
+    return findFirstOfScalar(first, last, a, b);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const char * Daybreak::TextUtils::findFirstOfScalar(const char * first, const char * last, char a, char b) noexcept
+{
+    for (; first != last; ++first)
+    {
+        if (*first == a || *first == b)
+        {
+            return first;
+        }
+    }
+
+    return last;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const char * Daybreak::TextUtils::findBlankSpace(const char * first, const char * last) noexcept
+{
+    return findFirstOf(first, last, ' ', '\t');
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const char * Daybreak::TextUtils::skipBlankSpace(const char * first, const char * last) noexcept
+{
+#ifdef DAYBREAK_TEXT_SCANNING_SSE2
+    const auto space = _mm_set1_epi8(' ');
+    const auto tab = _mm_set1_epi8('\t');
+
+    while (last - first >= 16)
+    {
+        // Invert the blank space mask to find the first character that is not blank space.
+        auto mask = ~matchMask(_mm_loadu_si128(reinterpret_cast<const __m128i *>(first)), space, tab) & 0xFFFF;
+
+        if (mask != 0)
+        {
+            return first + countTrailingZeros(mask);
+        }
+
+        first += 16;
+    }
+#endif
+
+    while (first != last && isBlankSpace(*first))
+    {
+        ++first;
+    }
+
+    return first;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const char * Daybreak::TextUtils::tryParseSimpleFloat(const char * first, const char * last, float& value) noexcept
+{
+    auto p = first;
+    bool isNegative = false;
+
+    if (p != last && *p == '-')
+    {
+        isNegative = true;
+        ++p;
+    }
+
+    // Accumulate all digits (integer and fraction) into one mantissa, and track the decimal exponent.
+    uint64_t mantissa = 0;
+    int significantDigits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+
+    while (p != last && isDigit(*p))
+    {
+        if (mantissa != 0 || *p != '0')
+        {
+            if (++significantDigits > MaxSignificantDigits)
+            {
+                return nullptr;
+            }
+        }
+
+        mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+        hasDigits = true;
+        ++p;
+    }
+
+    if (p != last && *p == '.')
+    {
+        ++p;
+
+        while (p != last && isDigit(*p))
+        {
+            if (mantissa != 0 || *p != '0')
+            {
+                if (++significantDigits > MaxSignificantDigits)
+                {
+                    return nullptr;
+                }
+            }
+
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            exponent--;
+            hasDigits = true;
+            ++p;
+        }
+    }
+
+    if (!hasDigits)
+    {
+        return nullptr;
+    }
+
+    // An exponent is only consumed if it has at least one digit, otherwise the number ends before the 'e'.
+    if (p != last && (*p == 'e' || *p == 'E'))
+    {
+        auto q = p + 1;
+        bool isNegativeExponent = false;
+
+        if (q != last && (*q == '-' || *q == '+'))
+        {
+            isNegativeExponent = (*q == '-');
+            ++q;
+        }
+
+        if (q != last && isDigit(*q))
+        {
+            int explicitExponent = 0;
+
+            while (q != last && isDigit(*q))
+            {
+                if (explicitExponent > 1000)
+                {
+                    return nullptr;
+                }
+
+                explicitExponent = explicitExponent * 10 + (*q - '0');
+                ++q;
+            }
+
+            exponent += (isNegativeExponent ? -explicitExponent : explicitExponent);
+            p = q;
+        }
+    }
+
+    // Convert the mantissa and exponent to a float. A single multiply or divide of exactly representable values is
+    // correctly rounded, so these results match std::from_chars.
+    float result = 0.0f;
+
+    if (mantissa == 0)
+    {
+        result = 0.0f;
+    }
+    else if (mantissa <= MaxExactFloatMantissa && exponent >= -10 && exponent <= 10)
+    {
+        result = static_cast<float>(mantissa);
+        result = (exponent < 0 ? result / FloatPowersOfTen[-exponent] : result * FloatPowersOfTen[exponent]);
+    }
+    else if (mantissa <= MaxExactDoubleMantissa && exponent >= -22 && exponent <= 22)
+    {
+        auto d = static_cast<double>(mantissa);
+        d = (exponent < 0 ? d / DoublePowersOfTen[-exponent] : d * DoublePowersOfTen[exponent]);
+
+        // Rounding the correctly rounded double to float is only wrong when the double lands exactly halfway between
+        // two floats, or when the value is outside the normal float range. Leave those cases to the slow path.
+        if (d < FLT_MIN || d > FLT_MAX)
+        {
+            return nullptr;
+        }
+
+        uint64_t bits = 0;
+        std::memcpy(&bits, &d, sizeof(bits));
+
+        if ((bits & 0x1FFFFFFF) == 0x10000000)
+        {
+            return nullptr;
+        }
+
+        result = static_cast<float>(d);
+    }
+    else
+    {
+        return nullptr;
+    }
+
+    value = (isNegative ? -result : result);
+    return p;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+const char * Daybreak::TextUtils::tryParseSimpleInt(const char * first, const char * last, int& value) noexcept
+{
+    auto p = first;
+    bool isNegative = false;
+
+    if (p != last && *p == '-')
+    {
+        isNegative = true;
+        ++p;
+    }
+
+    if (p == last || !isDigit(*p))
+    {
+        return nullptr;
+    }
+
+    // Accumulate as a negative number so that the smallest int can be represented.
+    const int64_t limit = std::numeric_limits<int>::min();
+    int64_t result = 0;
+
+    while (p != last && isDigit(*p))
+    {
+        result = result * 10 - (*p - '0');
+
+        if (result < limit)
+        {
+            return nullptr;
+        }
+
+        ++p;
+    }
+
+    if (!isNegative)
+    {
+        if (-result > std::numeric_limits<int>::max())
+        {
+            return nullptr;
+        }
+
+        result = -result;
+    }
+
+    value = static_cast<int>(result);
+    return p;
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+
+namespace Daybreak::TextUtils
+{
+    /**
+     * Get a pointer to the first character in [first, last) that is equal to a or b, or last if there is no match.
+     * Searches 16 characters at a time when SSE2 is available.
+     */
+    const char * findFirstOf(const char * first, const char * last, char a, char b) noexcept;
+
+    /** Get a pointer to the first space or tab in [first, last), or last if there is none. */
+    const char * findBlankSpace(const char * first, const char * last) noexcept;
+
+    /** Get a pointer to the first character in [first, last) that is not a space or tab, or last if there is none. */
+    const char * skipBlankSpace(const char * first, const char * last) noexcept;
+
+    /** Scalar reference version of findFirstOf. */
+    const char * findFirstOfScalar(const char * first, const char * last, char a, char b) noexcept;
+
+    /**
+     * Parse a float written as [-]digits[.digits][(e|E)[+|-]digits] directly from a character buffer. Returns a
+     * pointer to the first character after the number, or nullptr if the text is not in this form or the value cannot
+     * be converted quickly with the same result as std::from_chars. Callers should fall back to std::from_chars when
+     * nullptr is returned.
+     */
+    const char * tryParseSimpleFloat(const char * first, const char * last, float& value) noexcept;
+
+    /**
+     * Parse an int written as [-]digits directly from a character buffer. Returns a pointer to the first character
+     * after the number, or nullptr if there are no digits or the value does not fit in an int.
+     */
+    const char * tryParseSimpleInt(const char * first, const char * last, int& value) noexcept;
+}
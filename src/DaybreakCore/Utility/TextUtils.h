@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
+#include <type_traits>
 #include "Common/Error.h"
+#include "Utility/TextScanning.h"
 
 namespace Daybreak::TextUtils
 {
@@ -48,6 +50,45 @@ namespace Daybreak::TextUtils
 
         /** Returns the next line from the text. */
         std::basic_string_view<CharT, Traits> readNextLine()
+        {
+            if constexpr (std::is_same_v<CharT, char>)
+            {
+                return readNextLineFast();
+            }
+            else
+            {
+                return readNextLineScalar();
+            }
+        }
+
+        /** Get the current line or throw an exception if no line is available. */
+        std::basic_string_view<CharT, Traits> currentLine() const
+        {
+            if (m_currentLineStart == std::basic_string_view<CharT, Traits>::npos ||
+                m_currentLineEnd == std::basic_string_view<CharT, Traits>::npos ||
+                m_currentLineEnd > m_text.size() || m_currentLineEnd < m_currentLineStart)
+            {
+                throw DaybreakEngineException("StringLineParser line start or end is invalid", "");
+            }
+
+            return m_text.substr(m_currentLineStart, m_currentLineEnd - m_currentLineStart);
+        }
+
+        /** Check if there is another line to be read from the text. */
+        bool hasNextLine() const noexcept
+        {
+            return m_position < m_text.size();
+        }
+
+        /** Reset the line reader to the beginning of the input text. */
+        void reset() noexcept
+        {
+            m_position = 0;
+        }
+
+    private:
+        /** Read the next line one character at a time. */
+        std::basic_string_view<CharT, Traits> readNextLineScalar()
         {
             const auto start = m_position;
             const auto size = m_text.size();
@@ -108,29 +149,63 @@ namespace Daybreak::TextUtils
             return currentLine();
         }
 
-        /** Get the current line or throw an exception if no line is available. */
-        std::basic_string_view<CharT, Traits> currentLine() const
+        /**
+         * Narrow character version of readNextLine that searches for newline and comment characters many bytes at a
+         * time. Produces the same lines as the character by character loop.
+         */
+        std::basic_string_view<CharT, Traits> readNextLineFast()
         {
-            if (m_currentLineStart == std::basic_string_view<CharT, Traits>::npos ||
-                m_currentLineEnd == std::basic_string_view<CharT, Traits>::npos ||
-                m_currentLineEnd > m_text.size() || m_currentLineEnd < m_currentLineStart)
+            const auto start = m_position;
+            const auto size = m_text.size();
+
+            const char * const text = m_text.data();
+            const char * const last = text + size;
+            const char commentChar = (m_stripComments ? m_commentChar : '\n');
+
+            auto p = text + start;
+            const char * lastCommentChar = nullptr;
+
+            // Search for the next newline, remembering the last comment character seen along the way to match the
+            // behavior of the character by character loop.
+            for (;;)
             {
-                throw DaybreakEngineException("StringLineParser line start or end is invalid", "");
+                p = findFirstOf(p, last, '\n', commentChar);
+
+                if (p == last || *p == '\n')
+                {
+                    break;
+                }
+
+                lastCommentChar = p++;
             }
 
-            return m_text.substr(m_currentLineStart, m_currentLineEnd - m_currentLineStart);
-        }
+            auto end = static_cast<size_t>(p - text);
 
-        /** Check if there is another line to be read from the text. */
-        bool hasNextLine() const noexcept
-        {
-            return m_position < m_text.size();
-        }
+            if (p == last)
+            {
+                m_position = size;
+            }
+            else
+            {
+                // Skip past the newline, and exclude the carriage return of a Windows CRLF newline from the line.
+                m_position = end + 1;
 
-        /** Reset the line reader to the beginning of the input text. */
-        void reset() noexcept
-        {
-            m_position = 0;
+                if (end > start && text[end - 1] == '\r')
+                {
+                    end--;
+                }
+            }
+
+            // If a comment was found in this line then adjust the end of the line to be the start of the comment.
+            if (lastCommentChar != nullptr)
+            {
+                end = static_cast<size_t>(lastCommentChar - text);
+            }
+
+            m_currentLineStart = start;
+            m_currentLineEnd = end;
+
+            return currentLine();
         }
 
     private:
@@ -185,7 +260,7 @@ namespace Daybreak::TextUtils
             while (m_position < textSize)
             {
                 // Find the position of the next unread separator character.
-                auto nextSeparatorPosition = m_text.find_first_of(m_separators, m_position);
+                auto nextSeparatorPosition = findNextSeparator(m_position);
 
                 // If there are no more separator characters then move the position to the end of the input which will
                 // cover all remaining unread characters.
@@ -265,6 +340,33 @@ namespace Daybreak::TextUtils
         /** Set if the splitter will skip empty tokens (tokens that do not contain any text). */
         void setSkipEmptyTokens(bool shouldSkip) noexcept { m_skipEmptyTokens = shouldSkip; }
 
+    private:
+        /** Get the position of the next separator character at or after position, or npos if there is none. */
+        typename std::basic_string_view<CharT, Traits>::size_type findNextSeparator(
+            typename std::basic_string_view<CharT, Traits>::size_type position) const noexcept
+        {
+            // Narrow strings split on one or two characters (the common case when parsing text files) can use the
+            // vectorized search.
+            if constexpr (std::is_same_v<CharT, char>)
+            {
+                if (m_separators.size() == 1 || m_separators.size() == 2)
+                {
+                    const auto first = m_text.data() + position;
+                    const auto last = m_text.data() + m_text.size();
+                    const auto p = findFirstOf(first, last, m_separators.front(), m_separators.back());
+
+                    if (p == last)
+                    {
+                        return std::basic_string_view<CharT, Traits>::npos;
+                    }
+
+                    return static_cast<size_t>(p - m_text.data());
+                }
+            }
+
+            return m_text.find_first_of(m_separators, position);
+        }
+
     private:
         std::basic_string_view<CharT, Traits> m_text;
         std::basic_string_view<CharT, Traits> m_separators;
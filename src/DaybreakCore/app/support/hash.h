@@ -12,18 +12,18 @@
 
 namespace Daybreak
 {
-    /** Calculate a hash value by hashing the given object and combining it with the provided seed. */
-    template <typename T, typename... Rest>
-    std::size_t combine_hash(std::size_t seed, const T& v, Rest... rest)
+    /** Empty. */
+    inline std::size_t combine_hash(std::size_t seed)
     {
-        std::hash<T> hasher;
-        seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
         return seed;
     }
 
-    /** Empty. */
-    std::size_t combine_hash(std::size_t seed)
+    /** Calculate a hash value by hashing each of the given objects in order and combining them with the seed. */
+    template <typename T, typename... Rest>
+    std::size_t combine_hash(std::size_t seed, const T& v, const Rest&... rest)
     {
-        return seed;
+        std::hash<T> hasher;
+        seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return combine_hash(seed, rest...);
     }
 }
@@ -0,0 +1,106 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+namespace Daybreak::Benchmarks
+{
+    /** Run action repeatedly and return the best time in seconds. Best of several runs filters out scheduler noise. */
+    template<typename Action>
+    double measureBestSeconds(Action&& action, int runCount = 5)
+    {
+        double best = 0.0;
+
+        for (int i = 0; i < runCount; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            action();
+            const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (i == 0 || elapsed < best)
+            {
+                best = elapsed;
+            }
+        }
+
+        return best;
+    }
+
+    /** Print the throughput of processing byteCount bytes in the given number of seconds. */
+    inline void reportThroughput(const char * name, size_t byteCount, double seconds)
+    {
+        const auto megabytes = static_cast<double>(byteCount) / (1024.0 * 1024.0);
+        std::printf("%-40s %10.2f MB/s  (%.3f ms)\n", name, megabytes / seconds, seconds * 1000.0);
+    }
+
+    /** Append printf style formatted text to a string, sizing the string to fit the formatted text. */
+    template<typename... Args>
+    void appendFormatted(std::string& text, const char * format, Args... args)
+    {
+        const auto length = std::snprintf(nullptr, 0, format, args...);
+
+        if (length <= 0)
+        {
+            return;
+        }
+
+        const auto offset = text.size();
+        text.resize(offset + static_cast<size_t>(length) + 1);
+
+        std::snprintf(&text[offset], static_cast<size_t>(length) + 1, format, args...);
+        text.resize(offset + static_cast<size_t>(length));
+    }
+
+    /**
+     * Generate obj text for a flat grid of quads with positions, uvs and normals. The quads are split into triangles
+     * (2 * cellsPerSide * cellsPerSide faces) unless writeQuads is true, in which case each quad is one face.
+     */
+    inline std::string generateGridObj(int cellsPerSide, bool writeQuads = false)
+    {
+        std::string text;
+
+        const int verticesPerSide = cellsPerSide + 1;
+        text.reserve(static_cast<size_t>(verticesPerSide) * verticesPerSide * 96);
+
+        text += "# Generated grid\no grid\n";
+
+        for (int y = 0; y < verticesPerSide; ++y)
+        {
+            for (int x = 0; x < verticesPerSide; ++x)
+            {
+                const float u = static_cast<float>(x) / cellsPerSide;
+                const float v = static_cast<float>(y) / cellsPerSide;
+
+                appendFormatted(text, "v %.6f %.6f %.6f\nvt %.6f %.6f\n", u * 10.0f, 0.0f, v * 10.0f, u, v);
+            }
+        }
+
+        text += "vn 0.000000 1.000000 0.000000\n";
+
+        for (int y = 0; y < cellsPerSide; ++y)
+        {
+            for (int x = 0; x < cellsPerSide; ++x)
+            {
+                const int a = y * verticesPerSide + x + 1;
+                const int b = a + 1;
+                const int c = a + verticesPerSide;
+                const int d = c + 1;
+
+                if (writeQuads)
+                {
+                    appendFormatted(text, "f %d/%d/1 %d/%d/1 %d/%d/1 %d/%d/1\n", a, a, c, c, d, d, b, b);
+                }
+                else
+                {
+                    appendFormatted(
+                        text,
+                        "f %d/%d/1 %d/%d/1 %d/%d/1\nf %d/%d/1 %d/%d/1 %d/%d/1\n",
+                        a, a, c, c, b, b,
+                        b, b, c, c, d, d);
+                }
+            }
+        }
+
+        return text;
+    }
+}
@@ -0,0 +1,65 @@
+#include "stdafx.h"
+#include "Content/Models/CookedModelFile.h"
+#include "Content/Models/ModelData.h"
+#include "Content/Materials/MaterialData.h"
+#include "Content/ObjModel/ObjModelParser.h"
+#include "Content/ObjModel/ObjResourceLoader.h"
+#include "Content/MappedFile.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "BenchmarkHelpers.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+using namespace Daybreak::Benchmarks;
+
+TEST_CASE("Benchmark_Cooked_Model_Load", "[.][benchmark][cookedload]")
+{
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto objPath = (directory / "daybreak_cooked_benchmark.obj").string();
+    const auto cookedPath = objPath + CookedModelFile::FileExtension;
+
+    {
+        const auto objText = generateGridObj(708);
+        std::ofstream stream(objPath, std::ios::binary);
+        stream.write(objText.data(), static_cast<std::streamsize>(objText.size()));
+    }
+
+    ObjResourceLoader::material_lut_t materials;
+    size_t objIndexCount = 0;
+    size_t cookedIndexCount = 0;
+
+    auto objSeconds = measureBestSeconds([&] {
+        ObjModelParser parser;
+        auto file = std::make_shared<const MappedFile>(objPath);
+        auto objModel = parser.parse(file->text(), objPath);
+
+        for (const auto& group : objModel->groups)
+        {
+            materials[group.material] = std::make_shared<MaterialData>(group.material, MaterialType::Traditional);
+        }
+
+        auto model = ObjResourceLoader::convert(*objModel, materials);
+        objIndexCount = model->mesh().indexCount();
+
+        std::ofstream stream(cookedPath, std::ios::binary);
+        CookedModelFile::write(stream, *model, {}, {}, {}, 0);
+    }, 3);
+
+    auto cookedSeconds = measureBestSeconds([&] {
+        CookedModelFile cookedModel(std::make_shared<const MappedFile>(cookedPath));
+        cookedIndexCount = cookedModel.createModel(materials)->mesh().indexCount();
+    });
+
+    std::printf("%-40s %10.3f ms\n", "Parse and convert obj", objSeconds * 1000.0);
+    std::printf("%-40s %10.3f ms\n", "Map cooked model", cookedSeconds * 1000.0);
+
+    std::error_code error;
+    std::filesystem::remove(objPath, error);
+    std::filesystem::remove(cookedPath, error);
+
+    REQUIRE(objIndexCount == cookedIndexCount);
+}
@@ -0,0 +1,220 @@
+#include "stdafx.h"
+#include "Content/ObjModel/ObjModelParser.h"
+#include "Content/ObjModel/ObjResourceLoader.h"
+#include "Content/Models/ModelData.h"
+#include "Content/Materials/MaterialData.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/MeshOptimizer.h"
+#include "Graphics/Mesh/MeshSimplifier.h"
+#include "Graphics/Mesh/NormalGenerator.h"
+#include "Graphics/Mesh/TangentGenerator.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "BenchmarkHelpers.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+using namespace Daybreak::Benchmarks;
+
+namespace
+{
+    /** Create a copy of a mesh with 32 bit indices whose triangles are drawn in random order. */
+    std::unique_ptr<MeshData> shuffleTriangles(const MeshData& mesh)
+    {
+        auto indices = readIndices(mesh);
+        std::vector<std::array<uint32_t, 3>> triangles(mesh.indexCount() / 3);
+
+        for (size_t t = 0; t < triangles.size(); ++t)
+        {
+            triangles[t] = { indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2] };
+        }
+
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1234));
+
+        std::unique_ptr<uint32_t[]> shuffled(new uint32_t[triangles.size() * 3]);
+        std::memcpy(shuffled.get(), triangles.data(), triangles.size() * sizeof(triangles[0]));
+
+        const auto vertexBytes = mesh.vertexCount() * mesh.vertexElementSizeInBytes();
+        std::unique_ptr<uint8_t[]> vertices(new uint8_t[vertexBytes]);
+        std::memcpy(vertices.get(), mesh.rawVertexBufferData(), vertexBytes);
+
+        return std::make_unique<MeshData>(
+            std::make_unique<IndexBufferData>(triangles.size() * 3, std::move(shuffled)),
+            std::make_unique<VertexBufferData>(vertexBytes, std::move(vertices), mesh.vertexInputLayout()));
+    }
+
+    /** Print the post-transform cache efficiency of a mesh. */
+    void reportVertexCache(const char * name, const MeshData& mesh)
+    {
+        const auto statistics = analyzeVertexCache(mesh);
+        std::printf("%-40s ACMR %.3f  ATVR %.3f\n", name, statistics.acmr(), statistics.atvr());
+    }
+}
+
+TEST_CASE("Benchmark_Mesh_Optimization", "[.][benchmark][meshopt]")
+{
+    // 256 * 256 cells with two triangles each.
+    ObjModelParser parser;
+    auto objModel = parser.parse(generateGridObj(256));
+
+    ObjResourceLoader::material_lut_t materials;
+
+    for (const auto& group : objModel->groups)
+    {
+        materials[group.material] = std::make_shared<MaterialData>(group.material, MaterialType::Traditional);
+    }
+
+    auto model = ObjResourceLoader::convert(*objModel, materials);
+    auto shuffled = shuffleTriangles(model->mesh());
+    const std::vector<std::pair<size_t, size_t>> ranges = { { 0, shuffled->indexCount() } };
+
+    std::unique_ptr<MeshData> optimized;
+    mesh_optimization_options_t cacheOnly;
+    cacheOnly.overdraw = false;
+    cacheOnly.vertexFetch = false;
+
+    auto cacheSeconds = measureBestSeconds([&] { optimized = optimizeMesh(*shuffled, ranges, cacheOnly); });
+    auto cacheOnlyAcmr = analyzeVertexCache(*optimized).acmr();
+
+    auto allSeconds = measureBestSeconds([&] { optimized = optimizeMesh(*shuffled, ranges); });
+
+    const auto triangleCount = shuffled->indexCount() / 3;
+    std::printf(
+        "%-40s %8.2f ms  %8.2f Mtris/s\n",
+        "optimizeMesh (vertex cache)",
+        cacheSeconds * 1000.0,
+        triangleCount / cacheSeconds / 1.0e6);
+    std::printf(
+        "%-40s %8.2f ms  %8.2f Mtris/s\n",
+        "optimizeMesh (cache, overdraw, fetch)",
+        allSeconds * 1000.0,
+        triangleCount / allSeconds / 1.0e6);
+
+    reportVertexCache("converted obj (row order)", model->mesh());
+    reportVertexCache("shuffled triangles", *shuffled);
+    reportVertexCache("optimized", *optimized);
+
+    REQUIRE(analyzeVertexCache(*optimized).acmr() < analyzeVertexCache(model->mesh()).acmr());
+    REQUIRE(analyzeVertexCache(*optimized).acmr() <= cacheOnlyAcmr * 1.05f + 0.001f);
+}
+
+TEST_CASE("Benchmark_Lod_Chain_Generation", "[.][benchmark][lodchain]")
+{
+    // 256 * 256 cells with two triangles each.
+    ObjModelParser parser;
+    auto objModel = parser.parse(generateGridObj(256));
+
+    ObjResourceLoader::material_lut_t materials;
+
+    for (const auto& group : objModel->groups)
+    {
+        materials[group.material] = std::make_shared<MaterialData>(group.material, MaterialType::Traditional);
+    }
+
+    auto model = ObjResourceLoader::convert(*objModel, materials);
+    const auto baseIndices = readIndices(model->mesh());
+    const std::vector<std::pair<size_t, size_t>> ranges = { { 0, baseIndices.size() } };
+
+    std::vector<uint32_t> indices;
+    std::vector<lod_level_t> levels;
+
+    auto seconds = measureBestSeconds([&] {
+        indices = baseIndices;
+        levels = generateLodChain(model->mesh(), ranges, indices);
+    }, 3);
+
+    const auto triangleCount = baseIndices.size() / 3;
+    std::printf(
+        "%-40s %8.2f ms  %8.2f Mtris/s\n",
+        "generateLodChain",
+        seconds * 1000.0,
+        triangleCount / seconds / 1.0e6);
+
+    for (size_t i = 0; i < levels.size(); ++i)
+    {
+        std::printf(
+            "  level %zu: %8zu triangles, error %.6f\n",
+            i + 1,
+            levels[i].indexRanges[0].second / 3,
+            levels[i].error);
+    }
+
+    REQUIRE(!levels.empty());
+}
+
+TEST_CASE("Benchmark_Normal_Generation", "[.][benchmark][normalgen]")
+{
+    // 1024 * 1024 cells with two triangles each.
+    ObjModelParser parser;
+    auto objModel = parser.parse(generateGridObj(1024));
+
+    ObjResourceLoader::material_lut_t materials;
+
+    for (const auto& group : objModel->groups)
+    {
+        materials[group.material] = std::make_shared<MaterialData>(group.material, MaterialType::Traditional);
+    }
+
+    auto model = ObjResourceLoader::convert(*objModel, materials);
+    const auto triangleCount = model->mesh().indexCount() / 3;
+
+    for (size_t workerCount : { size_t(1), size_t(std::thread::hardware_concurrency()) })
+    {
+        std::unique_ptr<MeshData> mesh;
+
+        auto seconds = measureBestSeconds([&] {
+            mesh = generateNormals(model->mesh(), normal_generation_options_t(), nullptr, workerCount);
+        }, 3);
+
+        std::printf(
+            "generateNormals (%2zu workers)            %8.2f ms  %8.2f Mtris/s\n",
+            workerCount,
+            seconds * 1000.0,
+            triangleCount / seconds / 1.0e6);
+
+        REQUIRE(model->mesh().vertexCount() == mesh->vertexCount());
+    }
+}
+
+TEST_CASE("Benchmark_Tangent_Generation", "[.][benchmark][tangentgen]")
+{
+    // 1024 * 1024 cells with two triangles each.
+    ObjModelParser parser;
+    auto objModel = parser.parse(generateGridObj(1024));
+
+    ObjResourceLoader::material_lut_t materials;
+
+    for (const auto& group : objModel->groups)
+    {
+        materials[group.material] = std::make_shared<MaterialData>(group.material, MaterialType::Traditional);
+    }
+
+    auto model = ObjResourceLoader::convert(*objModel, materials);
+    const auto triangleCount = model->mesh().indexCount() / 3;
+
+    for (size_t workerCount : { size_t(1), size_t(std::thread::hardware_concurrency()) })
+    {
+        std::unique_ptr<MeshData> mesh;
+
+        auto seconds = measureBestSeconds([&] {
+            mesh = generateTangents(model->mesh(), { { 0, model->mesh().indexCount() } }, workerCount);
+        }, 3);
+
+        std::printf(
+            "generateTangents (%2zu workers)           %8.2f ms  %8.2f Mtris/s\n",
+            workerCount,
+            seconds * 1000.0,
+            triangleCount / seconds / 1.0e6);
+
+        REQUIRE(model->mesh().vertexCount() <= mesh->vertexCount());
+    }
+}
@@ -0,0 +1,47 @@
+#include "stdafx.h"
+#include "Content/ObjModel/ObjModelParser.h"
+#include "BenchmarkHelpers.h"
+
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+using namespace Daybreak::Benchmarks;
+
+namespace
+{
+    /** Parse obj text on one thread with the given triangulation and return the number of triangles. */
+    size_t parseTriangleCount(const std::string& objText, ObjTriangulation triangulation)
+    {
+        ObjModelParser parser;
+        parser.setMaxWorkerCount(1);
+        parser.setTriangulation(triangulation);
+
+        return parser.parse(objText)->groups[0].faces.size();
+    }
+}
+
+TEST_CASE("Benchmark_Obj_Quad_Mesh_Triangulation_Throughput", "[.][benchmark][triangulation]")
+{
+    const int CellsPerSide = 400;
+    const auto triangleText = generateGridObj(CellsPerSide);
+    const auto quadText = generateGridObj(CellsPerSide, true);
+
+    size_t triangleCount = 0;
+    size_t fanCount = 0;
+    size_t earClipCount = 0;
+
+    auto triangleSeconds = measureBestSeconds([&] {
+        triangleCount = parseTriangleCount(triangleText, ObjTriangulation::Fan); });
+    auto fanSeconds = measureBestSeconds([&] {
+        fanCount = parseTriangleCount(quadText, ObjTriangulation::Fan); });
+    auto earClipSeconds = measureBestSeconds([&] {
+        earClipCount = parseTriangleCount(quadText, ObjTriangulation::EarClipping); });
+
+    reportThroughput("Triangle mesh", triangleText.size(), triangleSeconds);
+    reportThroughput("Quad mesh (fan)", quadText.size(), fanSeconds);
+    reportThroughput("Quad mesh (ear clipping)", quadText.size(), earClipSeconds);
+
+    REQUIRE(triangleCount == 2 * CellsPerSide * CellsPerSide);
+    REQUIRE(fanCount == triangleCount);
+    REQUIRE(earClipCount == triangleCount);
+}
@@ -0,0 +1,109 @@
+#include "stdafx.h"
+#include "Content/ObjModel/ObjFaceVertexTable.h"
+#include "Content/ObjModel/ObjModelParser.h"
+#include "Content/ObjModel/ObjResourceLoader.h"
+#include "Content/Materials/MaterialData.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "BenchmarkHelpers.h"
+
+#include <cstdio>
+#include <thread>
+#include <unordered_map>
+
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+using namespace Daybreak::Benchmarks;
+
+namespace
+{
+    /** Hasher for the node based baseline. */
+    struct face_vertex_hasher_t
+    {
+        size_t operator()(const obj_face_vertex_t& v) const noexcept
+        {
+            return static_cast<size_t>(hashFaceVertex(v));
+        }
+    };
+
+    /** Deduplicate all face vertices with std::unordered_map and return the number of unique vertices. */
+    size_t deduplicateWithUnorderedMap(const obj_model_t& model)
+    {
+        std::unordered_map<obj_face_vertex_t, uint32_t, face_vertex_hasher_t> cache;
+        std::vector<uint32_t> indices;
+        indices.reserve(model.groups[0].faces.size() * 3);
+
+        for (const auto& face : model.groups[0].faces)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                auto result = cache.emplace(face.vertex(j), static_cast<uint32_t>(cache.size()));
+                indices.push_back(result.first->second);
+            }
+        }
+
+        return cache.size();
+    }
+
+    /** Print the number of faces converted per second. */
+    void reportFaceRate(const char * name, size_t faceCount, double seconds)
+    {
+        std::printf("%-36s %8.2f ms  %8.2f Mfaces/s\n", name, seconds * 1000.0, faceCount / seconds / 1.0e6);
+    }
+}
+
+TEST_CASE("Benchmark_Obj_Vertex_Deduplication", "[.][benchmark][deduplication]")
+{
+    // 708 * 708 cells with two triangles each is just over one million faces.
+    ObjModelParser parser;
+    auto objModel = parser.parse(generateGridObj(708));
+
+    ObjResourceLoader::material_lut_t materials;
+
+    for (const auto& group : objModel->groups)
+    {
+        materials[group.material] = std::make_shared<MaterialData>(group.material, MaterialType::Traditional);
+    }
+
+    const auto faceCount = objModel->groups[0].faces.size();
+    REQUIRE(faceCount >= 1000000);
+
+    size_t baselineCount = 0;
+    size_t hashedCount = 0;
+    size_t sortedCount = 0;
+    size_t parallelCount = 0;
+
+    auto baselineSeconds = measureBestSeconds([&] {
+        baselineCount = deduplicateWithUnorderedMap(*objModel); });
+    auto hashedSeconds = measureBestSeconds([&] {
+        hashedCount = ObjResourceLoader::convert(*objModel, materials, ObjVertexDeduplication::HashTable)
+            ->mesh().indexCount(); });
+    auto sortedSeconds = measureBestSeconds([&] {
+        sortedCount = ObjResourceLoader::convert(*objModel, materials, ObjVertexDeduplication::Sort)
+            ->mesh().indexCount(); });
+    auto parallelSeconds = measureBestSeconds([&] {
+        parallelCount = ObjResourceLoader::convert(
+            *objModel,
+            materials,
+            ObjVertexDeduplication::HashTable,
+            std::thread::hardware_concurrency())->mesh().indexCount(); });
+
+    reportFaceRate("std::unordered_map (dedupe only)", faceCount, baselineSeconds);
+    reportFaceRate("convert (flat hash table)", faceCount, hashedSeconds);
+    reportFaceRate("convert (sort)", faceCount, sortedSeconds);
+    reportFaceRate("convert (flat hash table, all cores)", faceCount, parallelSeconds);
+
+    // Vertices are only duplicated along the seams between batches.
+    auto model = ObjResourceLoader::convert(*objModel, materials);
+    std::printf(
+        "%zu vertices (%.2f MB) for %zu unique face vertices\n",
+        model->mesh().vertexCount(),
+        model->mesh().vertexCount() * model->mesh().vertexElementSizeInBytes() / (1024.0 * 1024.0),
+        baselineCount);
+
+    REQUIRE(709 * 709 == baselineCount);
+    REQUIRE(model->mesh().vertexCount() < baselineCount + baselineCount / 20);
+    REQUIRE(faceCount * 3 == hashedCount);
+    REQUIRE(faceCount * 3 == sortedCount);
+    REQUIRE(faceCount * 3 == parallelCount);
+}
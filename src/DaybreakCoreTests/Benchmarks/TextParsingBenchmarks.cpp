@@ -0,0 +1,198 @@
+#include "stdafx.h"
+#include "Content/ObjModel/ObjModelParser.h"
+#include "Content/ObjModel/TextParsingUtils.h"
+#include "Utility/TextUtils.h"
+#include "BenchmarkHelpers.h"
+
+#include <charconv>
+
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+using namespace Daybreak::Benchmarks;
+using namespace Daybreak::TextUtils;
+
+namespace
+{
+    /** Totals of every number lexed from obj text, used to check both lexers produce the same values. */
+    struct lex_totals_t
+    {
+        double floatSum = 0.0;
+        long long intSum = 0;
+    };
+
+    /** Read the next line one character at a time, as the line reader did before it was vectorized. */
+    std::string_view readLineOneCharAtATime(const std::string_view& text, size_t& position)
+    {
+        const auto start = position;
+        auto end = start;
+        auto commentStart = std::string_view::npos;
+
+        while (position < text.size())
+        {
+            const auto c = text[position++];
+
+            if (c == '#')
+            {
+                commentStart = position - 1;
+            }
+
+            if (c == '\n')
+            {
+                end = position - 1;
+                break;
+            }
+            else if (c == '\r' && position < text.size() && text[position] == '\n')
+            {
+                end = position - 1;
+                position++;
+                break;
+            }
+            else
+            {
+                end = position;
+            }
+        }
+
+        return text.substr(start, (commentStart != std::string_view::npos ? commentStart : end) - start);
+    }
+
+    /** Split text on any of the separators using find_first_of, as the splitter did before it was vectorized. */
+    std::string_view readTokenWithFindFirstOf(const std::string_view& text, const char * separators, size_t& position)
+    {
+        while (position < text.size())
+        {
+            auto next = text.find_first_of(separators, position);
+            next = (next == std::string_view::npos ? text.size() : next);
+
+            auto start = position;
+            position = next + 1;
+
+            if (next != start)
+            {
+                return text.substr(start, next - start);
+            }
+        }
+
+        return std::string_view();
+    }
+
+    /** Lex obj vertex and face lines with the previous scalar line reader, find_first_of and from_chars. */
+    lex_totals_t lexWithPreviousPath(const std::string_view& text)
+    {
+        lex_totals_t totals;
+        size_t linePosition = 0;
+
+        while (linePosition < text.size())
+        {
+            auto line = readLineOneCharAtATime(text, linePosition);
+            size_t position = 0;
+            auto command = readTokenWithFindFirstOf(line, " \t", position);
+
+            if (command == "v" || command == "vt" || command == "vn")
+            {
+                for (auto token = readTokenWithFindFirstOf(line, " \t", position);
+                     !token.empty();
+                     token = readTokenWithFindFirstOf(line, " \t", position))
+                {
+                    float value = 0.0f;
+                    std::from_chars(token.data(), token.data() + token.size(), value);
+                    totals.floatSum += value;
+                }
+            }
+            else if (command == "f")
+            {
+                for (auto token = readTokenWithFindFirstOf(line, " \t", position);
+                     !token.empty();
+                     token = readTokenWithFindFirstOf(line, " \t", position))
+                {
+                    size_t elementPosition = 0;
+
+                    for (auto part = readTokenWithFindFirstOf(token, "/", elementPosition);
+                         !part.empty();
+                         part = readTokenWithFindFirstOf(token, "/", elementPosition))
+                    {
+                        int value = 0;
+                        std::from_chars(part.data(), part.data() + part.size(), value);
+                        totals.intSum += value;
+                    }
+                }
+            }
+        }
+
+        return totals;
+    }
+
+    /** Lex obj vertex and face lines with the line reader, splitter and number parsers used by the obj parser. */
+    lex_totals_t lexWithCurrentPath(const std::string_view& text)
+    {
+        lex_totals_t totals;
+        StringLineReader lineReader(text, '#');
+
+        while (lineReader.hasNextLine())
+        {
+            StringSplitter splitter(lineReader.readNextLine(), " \t", true);
+
+            if (!splitter.hasNextToken())
+            {
+                continue;
+            }
+
+            auto command = splitter.readNextToken();
+
+            if (command == "v" || command == "vt" || command == "vn")
+            {
+                while (splitter.hasNextToken())
+                {
+                    totals.floatSum += parseFloat(splitter.readNextToken());
+                }
+            }
+            else if (command == "f")
+            {
+                while (splitter.hasNextToken())
+                {
+                    std::string_view parts[3];
+                    auto partCount = splitFaceElement(splitter.readNextToken(), parts);
+
+                    for (size_t i = 0; i < partCount; ++i)
+                    {
+                        totals.intSum += (parts[i].empty() ? 0 : parseInt(parts[i]));
+                    }
+                }
+            }
+        }
+
+        return totals;
+    }
+}
+
+TEST_CASE("Benchmark_Obj_Text_Lexing_Throughput", "[.][benchmark][textscanning]")
+{
+    const auto objText = generateGridObj(400);
+
+    lex_totals_t previous;
+    lex_totals_t current;
+
+    auto previousSeconds = measureBestSeconds([&] { previous = lexWithPreviousPath(objText); });
+    auto currentSeconds = measureBestSeconds([&] { current = lexWithCurrentPath(objText); });
+
+    reportThroughput("Obj lexing (scalar + from_chars)", objText.size(), previousSeconds);
+    reportThroughput("Obj lexing (vectorized + fast numbers)", objText.size(), currentSeconds);
+
+    REQUIRE(previous.floatSum == current.floatSum);
+    REQUIRE(previous.intSum == current.intSum);
+}
+
+TEST_CASE("Benchmark_Obj_Model_Parser_Throughput", "[.][benchmark][textscanning]")
+{
+    const auto objText = generateGridObj(400);
+
+    ObjModelParser parser;
+    parser.setMaxWorkerCount(1);
+
+    size_t faceCount = 0;
+    auto seconds = measureBestSeconds([&] { faceCount = parser.parse(objText)->groups[0].faces.size(); });
+
+    reportThroughput("ObjModelParser::parse (single thread)", objText.size(), seconds);
+    REQUIRE(faceCount == 2 * 400 * 400);
+}
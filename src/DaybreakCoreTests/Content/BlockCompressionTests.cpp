@@ -0,0 +1,223 @@
+#include "stdafx.h"
+#include "Content/Images/BlockCompression.h"
+#include "Content/Images/Image.h"
+#include "Common/Error.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /** Decode the RGB of pixel i in a BC1 color block, always using four colors as BC3 does. */
+    std::array<int, 3> decodeColorBlock(const unsigned char * block, size_t i)
+    {
+        const auto color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+        const auto color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+        const auto indices = static_cast<uint32_t>(block[4] | (block[5] << 8) | (block[6] << 16) | (block[7] << 24));
+        const auto index = (indices >> (2 * i)) & 3;
+
+        auto unpack = [](uint16_t c) {
+            const int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+            return std::array<int, 3>{ (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+        };
+
+        const auto c0 = unpack(color0);
+        const auto c1 = unpack(color1);
+        const int weights0[4] = { 3, 0, 2, 1 };
+        std::array<int, 3> color;
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            color[c] = (weights0[index] * c0[c] + (3 - weights0[index]) * c1[c] + 1) / 3;
+        }
+
+        return color;
+    }
+
+    /** Decode pixel i of a BC4 block. */
+    int decodeChannelBlock(const unsigned char * block, size_t i)
+    {
+        uint64_t indices = 0;
+
+        for (size_t b = 0; b < 6; ++b)
+        {
+            indices |= static_cast<uint64_t>(block[2 + b]) << (8 * b);
+        }
+
+        const int value0 = block[0], value1 = block[1];
+        const auto index = static_cast<int>((indices >> (3 * i)) & 7);
+
+        if (index < 2)
+        {
+            return (index == 0 ? value0 : value1);
+        }
+
+        if (value0 > value1)
+        {
+            return ((8 - index) * value0 + (index - 1) * value1 + 3) / 7;
+        }
+
+        return (index == 6 ? 0 : index == 7 ? 255 : ((6 - index) * value0 + (index - 1) * value1 + 2) / 5);
+    }
+}
+
+TEST_CASE("Block_Compression_Sizes", "[content][BlockCompression]")
+{
+    REQUIRE(isBlockCompressed(TextureFormat::BC1));
+    REQUIRE(isBlockCompressed(TextureFormat::BC5));
+    REQUIRE_FALSE(isBlockCompressed(TextureFormat::RGBA));
+
+    REQUIRE(8 == blockCompressedSize(TextureFormat::BC1, 1, 1));
+    REQUIRE(2 * 1 * 8 == blockCompressedSize(TextureFormat::BC4, 5, 3));
+    REQUIRE(4 * 4 * 16 == blockCompressedSize(TextureFormat::BC3, 16, 16));
+    REQUIRE(16 == blockCompressedSize(TextureFormat::BC5, 2, 2));
+
+    REQUIRE(TextureFormat::BC4 == blockCompressionForChannels(1));
+    REQUIRE(TextureFormat::BC5 == blockCompressionForChannels(2));
+    REQUIRE(TextureFormat::BC1 == blockCompressionForChannels(3));
+    REQUIRE(TextureFormat::BC3 == blockCompressionForChannels(4));
+}
+
+TEST_CASE("Block_Compression_Keeps_Colors_Close", "[content][BlockCompression]")
+{
+    // A gradient between two colors fits a single block palette well, even across several blocks and threads.
+    const size_t width = 16, height = 8;
+    std::vector<unsigned char> pixels(width * height * 4);
+
+    for (size_t i = 0; i < width * height; ++i)
+    {
+        const auto t = static_cast<int>((i % width) * 255 / (width - 1));
+
+        pixels[i * 4 + 0] = static_cast<unsigned char>(t);
+        pixels[i * 4 + 1] = static_cast<unsigned char>(255 - t);
+        pixels[i * 4 + 2] = 64;
+        pixels[i * 4 + 3] = static_cast<unsigned char>((i / width) * 32);
+    }
+
+    const auto bc1 = compressBlocks(pixels.data(), width, height, 4, TextureFormat::BC1, 4);
+    const auto bc3 = compressBlocks(pixels.data(), width, height, 4, TextureFormat::BC3, 4);
+
+    REQUIRE(blockCompressedSize(TextureFormat::BC1, width, height) == bc1.size());
+    REQUIRE(blockCompressedSize(TextureFormat::BC3, width, height) == bc3.size());
+
+    for (size_t y = 0; y < height; ++y)
+    {
+        for (size_t x = 0; x < width; ++x)
+        {
+            const auto blockIndex = (y / 4) * (width / 4) + x / 4;
+            const auto pixelIndex = (y % 4) * 4 + x % 4;
+            const auto * pixel = &pixels[(y * width + x) * 4];
+
+            const auto bc1Color = decodeColorBlock(&bc1[blockIndex * 8], pixelIndex);
+            const auto bc3Color = decodeColorBlock(&bc3[blockIndex * 16 + 8], pixelIndex);
+
+            for (size_t c = 0; c < 3; ++c)
+            {
+                REQUIRE(std::abs(bc1Color[c] - pixel[c]) <= 16);
+                REQUIRE(bc1Color[c] == bc3Color[c]);
+            }
+
+            // Alpha spans 96 in each block, so the eight alpha values are 96 / 7 apart.
+            REQUIRE(std::abs(decodeChannelBlock(&bc3[blockIndex * 16], pixelIndex) - pixel[3]) <= 7);
+        }
+    }
+
+    // A block of one color is stored exactly up to the precision of the endpoints.
+    const std::vector<unsigned char> gray(4 * 4, 200);
+    const auto bc1Gray = compressBlocks(gray.data(), 4, 4, 1, TextureFormat::BC1, 1);
+    const auto bc4Gray = compressBlocks(gray.data(), 4, 4, 1, TextureFormat::BC4, 1);
+
+    for (size_t i = 0; i < 16; ++i)
+    {
+        REQUIRE(std::abs(decodeColorBlock(bc1Gray.data(), i)[1] - 200) <= 2);
+        REQUIRE(200 == decodeChannelBlock(bc4Gray.data(), i));
+    }
+}
+
+TEST_CASE("Block_Compressed_Image_Keeps_Mip_Maps", "[content][BlockCompression]")
+{
+    // Two channel PGM images do not exist, so use a grayscale PGM and compress its only channel.
+    std::string pgm = "P5\n6 5\n255\n";
+
+    for (int i = 0; i < 6 * 5; ++i)
+    {
+        pgm.push_back(static_cast<char>(i * 8));
+    }
+
+    auto image = BytePerChannelImage::LoadFromMemory(
+        "image",
+        reinterpret_cast<const unsigned char *>(pgm.data()),
+        pgm.size(),
+        false);
+
+    image->GenerateMipMaps(mip_map_settings_t());
+
+    auto compressed = BlockCompressedImage::Compress(*image, TextureFormat::BC4, 2);
+
+    REQUIRE(compressed->IsBlockCompressed());
+    REQUIRE_FALSE(image->IsBlockCompressed());
+    REQUIRE(TextureFormat::BC4 == compressed->CompressedFormat());
+    REQUIRE(ImagePixelFormat::Grayscale == compressed->Format());
+    REQUIRE(image->MipMapCount() == compressed->MipMapCount());
+    REQUIRE(6 == compressed->Width());
+    REQUIRE(5 == compressed->Height());
+
+    for (unsigned int level = 0; level < compressed->MipMapCount(); ++level)
+    {
+        const auto width = image->MipMapWidth(level);
+        const auto height = image->MipMapHeight(level);
+
+        REQUIRE(blockCompressedSize(TextureFormat::BC4, width, height) == compressed->RawPixelsSize(level));
+    }
+
+    // Pixel 1 of block 1 on the first row is pixel 5 of the image. The block spans values from 32 to 184, so its eight
+    // values are about 22 apart.
+    REQUIRE(std::abs(decodeChannelBlock(compressed->RawPixels(0) + 8, 1) - 40) <= 11);
+
+    REQUIRE_THROWS_AS(compressed->GenerateMipMaps(mip_map_settings_t()), DaybreakEngineException);
+}
+
+TEST_CASE("Block_Compression_Flips_Vertically", "[content][BlockCompression]")
+{
+    // Flipping the blocks flips the decoded pixels, both across rows of blocks and inside a block shorter than four.
+    for (size_t height : { 8, 2 })
+    {
+        const size_t width = 4;
+        std::vector<unsigned char> pixels(width * height * 4);
+
+        for (size_t i = 0; i < pixels.size(); ++i)
+        {
+            pixels[i] = static_cast<unsigned char>((i * 37) % 251);
+        }
+
+        const auto original = compressBlocks(pixels.data(), width, height, 4, TextureFormat::BC3, 1);
+        auto flipped = original;
+        flipBlocksVertically(flipped.data(), width, height, TextureFormat::BC3);
+
+        auto pixelAt = [&](const std::vector<unsigned char>& blocks, size_t x, size_t y) {
+            const auto * block = &blocks[(y / 4) * 16];
+            const auto color = decodeColorBlock(block + 8, (y % 4) * 4 + x);
+
+            return std::array<int, 4>{ color[0], color[1], color[2], decodeChannelBlock(block, (y % 4) * 4 + x) };
+        };
+
+        for (size_t y = 0; y < height; ++y)
+        {
+            for (size_t x = 0; x < width; ++x)
+            {
+                REQUIRE(pixelAt(original, x, height - 1 - y) == pixelAt(flipped, x, y));
+            }
+        }
+    }
+
+    // Rows no longer line up with blocks when the height is not a multiple of four.
+    std::vector<unsigned char> blocks(blockCompressedSize(TextureFormat::BC1, 4, 6));
+    REQUIRE_THROWS_AS(flipBlocksVertically(blocks.data(), 4, 6, TextureFormat::BC1), DaybreakDataException);
+}
@@ -0,0 +1,264 @@
+#include "stdafx.h"
+#include "Content/Images/Image.h"
+#include "Content/Images/BlockCompression.h"
+#include "Content/DefaultFileSystem.h"
+#include "Content/ResourcesManager.h"
+#include "Common/Error.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ContentTestHelpers.h"
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    //-----------------------------------------------------------------------------------------------------------------
+    void appendUint32(std::string& bytes, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            bytes.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    void appendUint64(std::string& bytes, uint64_t value)
+    {
+        appendUint32(bytes, static_cast<uint32_t>(value));
+        appendUint32(bytes, static_cast<uint32_t>(value >> 32));
+    }
+
+    //-----------------------------------------------------------------------------------------------------------------
+    std::string createBlocks(size_t size, unsigned char first)
+    {
+        std::string blocks;
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            blocks.push_back(static_cast<char>(first + i));
+        }
+
+        return blocks;
+    }
+
+    /** Create a DDS file with a FourCC pixel format, and a DX10 header when the FourCC is DX10. */
+    std::string createDds(
+        uint32_t width,
+        uint32_t height,
+        uint32_t mipMapCount,
+        const std::string& fourCc,
+        uint32_t dxgiFormat,
+        uint32_t arraySize,
+        const std::string& blocks)
+    {
+        std::string dds = "DDS ";
+        appendUint32(dds, 124);
+        appendUint32(dds, 0x1007 | 0x20000);        // Caps, height, width, pixel format and mipmap count.
+        appendUint32(dds, height);
+        appendUint32(dds, width);
+        appendUint32(dds, 0);
+        appendUint32(dds, 0);
+        appendUint32(dds, mipMapCount);
+        dds.append(11 * 4, '\0');
+
+        appendUint32(dds, 32);
+        appendUint32(dds, 0x4);                     // FourCC.
+        dds.append(fourCc);
+        dds.append(5 * 4, '\0');
+
+        appendUint32(dds, 0x1000);                  // Texture.
+        dds.append(4 * 4, '\0');
+
+        if (fourCc == "DX10")
+        {
+            appendUint32(dds, dxgiFormat);
+            appendUint32(dds, 3);                   // 2D texture.
+            appendUint32(dds, 0);
+            appendUint32(dds, arraySize);
+            appendUint32(dds, 0);
+        }
+
+        return dds + blocks;
+    }
+
+    /** Create a KTX2 file whose levels hold every layer, with an optional KTXorientation value. */
+    std::string createKtx2(
+        uint32_t vkFormat,
+        uint32_t width,
+        uint32_t height,
+        uint32_t layerCount,
+        const std::vector<std::string>& levels,
+        const std::string& orientation,
+        uint32_t supercompressionScheme = 0)
+    {
+        std::string keyValues;
+
+        if (!orientation.empty())
+        {
+            const std::string entry = std::string("KTXorientation") + '\0' + orientation + '\0';
+            appendUint32(keyValues, static_cast<uint32_t>(entry.size()));
+            keyValues.append(entry);
+            keyValues.append((4 - entry.size() % 4) % 4, '\0');
+        }
+
+        const auto keyValueOffset = 80 + levels.size() * 24;
+        auto levelOffset = keyValueOffset + keyValues.size();
+
+        std::string ktx2 = "\xABKTX 20\xBB\r\n\x1A\n";
+        appendUint32(ktx2, vkFormat);
+        appendUint32(ktx2, 1);
+        appendUint32(ktx2, width);
+        appendUint32(ktx2, height);
+        appendUint32(ktx2, 0);
+        appendUint32(ktx2, layerCount);
+        appendUint32(ktx2, 1);
+        appendUint32(ktx2, static_cast<uint32_t>(levels.size()));
+        appendUint32(ktx2, supercompressionScheme);
+
+        appendUint32(ktx2, 0);
+        appendUint32(ktx2, 0);
+        appendUint32(ktx2, static_cast<uint32_t>(keyValueOffset));
+        appendUint32(ktx2, static_cast<uint32_t>(keyValues.size()));
+        appendUint64(ktx2, 0);
+        appendUint64(ktx2, 0);
+
+        for (const auto& level : levels)
+        {
+            appendUint64(ktx2, levelOffset);
+            appendUint64(ktx2, level.size());
+            appendUint64(ktx2, level.size());
+            levelOffset += level.size();
+        }
+
+        ktx2 += keyValues;
+
+        for (const auto& level : levels)
+        {
+            ktx2 += level;
+        }
+
+        return ktx2;
+    }
+}
+
+TEST_CASE("Compressed_Texture_Loads_Dds_Mip_Maps", "[content][CompressedTexture]")
+{
+    TempDirectory directory("daybreak_dds_textures");
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+
+    // An 8x4 BC1 texture with every mipmap, which is flipped so the first row of pixels is the bottom row.
+    const auto blocks = createBlocks(16 + 8 + 8 + 8, 0);
+    auto image = resources.loadImage(directory.write("texture.dds", createDds(8, 4, 4, "DXT1", 0, 0, blocks)));
+
+    REQUIRE(image->IsBlockCompressed());
+    REQUIRE(ImagePixelFormat::RGB == image->Format());
+    REQUIRE(8 == image->Width());
+    REQUIRE(4 == image->Height());
+    REQUIRE(4 == image->MipMapCount());
+
+    const auto& compressed = static_cast<const BlockCompressedImage&>(*image);
+
+    REQUIRE(TextureFormat::BC1 == compressed.CompressedFormat());
+    REQUIRE(1 == compressed.LayerCount());
+    REQUIRE(16 == compressed.RawPixelsSize(0));
+    REQUIRE(8 == compressed.RawPixelsSize(3));
+
+    // The endpoints stay the same while the rows of indices are reversed, and mipmaps shorter than a block only
+    // reverse the rows they have.
+    const std::vector<unsigned char> firstBlock(compressed.RawPixels(0), compressed.RawPixels(0) + 8);
+    REQUIRE(std::vector<unsigned char>{ 0, 1, 2, 3, 7, 6, 5, 4 } == firstBlock);
+
+    const std::vector<unsigned char> twoRowBlock(compressed.RawPixels(1), compressed.RawPixels(1) + 8);
+    REQUIRE(std::vector<unsigned char>{ 16, 17, 18, 19, 21, 20, 22, 23 } == twoRowBlock);
+    REQUIRE(31 == compressed.RawPixels(2)[7]);
+    REQUIRE(39 == compressed.RawPixels(3)[7]);
+
+    // DX10 headers give the format as a DXGI format.
+    const auto bc5Blocks = createBlocks(3 * 16, 100);
+    image = resources.loadImage(directory.write("bc5.DDS", createDds(4, 4, 3, "DX10", 83, 1, bc5Blocks)));
+
+    const auto& bc5 = static_cast<const BlockCompressedImage&>(*image);
+
+    REQUIRE(TextureFormat::BC5 == bc5.CompressedFormat());
+    REQUIRE(ImagePixelFormat::GrayscaleWithAlpha == bc5.Format());
+    REQUIRE(1 == bc5.LayerCount());
+    REQUIRE(3 == bc5.MipMapCount());
+    REQUIRE(100 == bc5.RawPixels(0)[0]);
+    REQUIRE(116 == bc5.RawPixels(1)[0]);
+
+    // Precompressed textures keep the mipmaps they were stored with.
+    REQUIRE_THROWS_AS(image->GenerateMipMaps(mip_map_settings_t()), DaybreakEngineException);
+}
+
+TEST_CASE("Compressed_Texture_Loads_Ktx2_Levels", "[content][CompressedTexture]")
+{
+    TempDirectory directory("daybreak_ktx2_textures");
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+
+    // A texture stored bottom row first is used exactly as stored.
+    const std::vector<std::string> levels = { createBlocks(32, 0), createBlocks(16, 100) };
+
+    const auto path = directory.write("texture.ktx2", createKtx2(137, 8, 2, 0, levels, "ru"));
+    auto image = resources.loadImage(path);
+
+    const auto& compressed = static_cast<const BlockCompressedImage&>(*image);
+
+    REQUIRE(TextureFormat::BC3 == compressed.CompressedFormat());
+    REQUIRE(ImagePixelFormat::RGBA == compressed.Format());
+    REQUIRE(1 == compressed.LayerCount());
+    REQUIRE(2 == compressed.MipMapCount());
+    REQUIRE(32 == compressed.RawPixelsSize(0));
+    REQUIRE(16 == compressed.RawPixelsSize(1));
+
+    for (size_t i = 0; i < 32; ++i)
+    {
+        REQUIRE(i == compressed.RawPixels(0)[i]);
+    }
+
+    REQUIRE(100 == compressed.RawPixels(1)[0]);
+
+    // The default orientation is top row first, so the texture is flipped. BC4 index rows are 12 bits each.
+    const std::vector<std::string> bc4Levels = { createBlocks(8, 0) };
+    image = resources.loadImage(directory.write("flipped.ktx2", createKtx2(139, 4, 4, 0, bc4Levels, "")));
+
+    const auto * flipped = image->RawPixels(0);
+    REQUIRE(ImagePixelFormat::Grayscale == image->Format());
+    REQUIRE(0 == flipped[0]);
+    REQUIRE(1 == flipped[1]);
+    REQUIRE(std::vector<unsigned char>{ 0x70, 0x50, 0x60, 0x40, 0x20, 0x30 } ==
+        std::vector<unsigned char>(flipped + 2, flipped + 8));
+}
+
+TEST_CASE("Compressed_Texture_Rejects_Unsupported_Files", "[content][CompressedTexture]")
+{
+    TempDirectory directory("daybreak_bad_textures");
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+
+    const std::vector<std::string> levels = { createBlocks(8, 0) };
+    const auto blocks = createBlocks(8, 0);
+
+    // Supercompressed and uncompressed textures need decoding, which this loader never does.
+    auto supercompressed = directory.write("zstd.ktx2", createKtx2(131, 4, 4, 0, levels, "ru", 2));
+    auto uncompressed = directory.write("rgba.ktx2", createKtx2(37, 1, 2, 0, levels, "ru"));
+    auto dxgi = directory.write("rgba.dds", createDds(4, 4, 1, "DX10", 28, 1, blocks));
+
+    // The blocks must fit inside the file, and a texture that is not a DDS or KTX2 file is rejected whatever its name.
+    auto truncated = directory.write("truncated.dds", createDds(8, 8, 1, "DXT5", 0, 0, blocks));
+    auto png = directory.write("texture.ktx2", "\x89PNG\r\n\x1A\n");
+
+    // Odd heights cannot be flipped once they span more than one row of blocks.
+    auto oddHeight = directory.write("odd.dds", createDds(4, 6, 1, "ATI1", 0, 0, createBlocks(16, 0)));
+
+    // Only 2d textures are drawn, so texture arrays are rejected rather than loaded with layers that are never used.
+    auto ddsArray = directory.write("array.dds", createDds(4, 4, 1, "DX10", 83, 2, createBlocks(32, 0)));
+    auto ktx2Array = directory.write("array.ktx2", createKtx2(139, 4, 4, 2, { createBlocks(16, 0) }, "ru"));
+
+    for (const auto& path : { supercompressed, uncompressed, dxgi, truncated, png, oddHeight, ddsArray, ktx2Array })
+    {
+        REQUIRE_THROWS_AS(resources.loadImage(path), ContentReadException);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "Content/Materials/MaterialData.h"
+#include "Content/ObjModel/ObjModelParser.h"
+#include "Content/ObjModel/ObjResourceLoader.h"
+#include "Renderer/DeviceContext.h"
+#include "Renderer/IndexBuffer.h"
+#include "Renderer/InputLayout.h"
+#include "Renderer/Shader.h"
+#include "Renderer/VertexBuffer.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace Daybreak
+{
+    /** Get a material table with a material for every material name used by a group in the obj model. */
+    inline ObjResourceLoader::material_lut_t createMaterials(const obj_model_t& model)
+    {
+        ObjResourceLoader::material_lut_t materials;
+
+        for (const auto& group : model.groups)
+        {
+            if (!group.material.empty())
+            {
+                materials[group.material] = std::make_shared<MaterialData>(group.material, MaterialType::Traditional);
+            }
+        }
+
+        return materials;
+    }
+
+    /** Device context for tests that load models without textures. */
+    class NullDeviceContext : public IDeviceContext
+    {
+    public:
+        virtual std::unique_ptr<ITexture2d> createTexture2d(const Image&, const TextureParameters&) override
+        {
+            return nullptr;
+        }
+
+        virtual std::unique_ptr<IndexBuffer> createIndexBuffer(const MeshData&) override { return nullptr; }
+
+        virtual std::unique_ptr<InputLayout> createInputLayout(const InputLayoutDescription&) override
+        {
+            return nullptr;
+        }
+
+        virtual std::unique_ptr<IShader> compileShader(const std::string&, std::string_view, std::string_view) override
+        {
+            return nullptr;
+        }
+
+        virtual std::unique_ptr<VertexBuffer> createVertexBuffer(const MeshData&) override { return nullptr; }
+    };
+
+    /** Creates a temp directory for a test and deletes it and everything in it when the test is done. */
+    class TempDirectory
+    {
+    public:
+        explicit TempDirectory(const std::string& name)
+            : m_path(std::filesystem::temp_directory_path() / name)
+        {
+            std::filesystem::remove_all(m_path);
+            std::filesystem::create_directories(m_path);
+        }
+
+        ~TempDirectory()
+        {
+            std::error_code error;
+            std::filesystem::remove_all(m_path, error);
+        }
+
+        std::string write(const std::string& name, const std::string& contents) const
+        {
+            auto path = file(name);
+            std::ofstream stream(path, std::ios::binary);
+            stream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+
+            return path;
+        }
+
+        std::string file(const std::string& name) const { return (m_path / name).string(); }
+
+    private:
+        std::filesystem::path m_path;
+    };
+}
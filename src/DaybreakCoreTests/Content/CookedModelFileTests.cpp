@@ -0,0 +1,429 @@
+#include "stdafx.h"
+#include "Content/Models/CookedModelFile.h"
+#include "Content/Models/ModelData.h"
+#include "Content/Materials/MaterialData.h"
+#include "Content/ObjModel/ObjModelParser.h"
+#include "Content/ObjModel/ObjResourceLoader.h"
+#include "Content/ObjModel/MtlMaterialException.h"
+#include "Content/DefaultFileSystem.h"
+#include "Content/MappedFile.h"
+#include "Content/ResourcesManager.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/InputLayoutDescription.h"
+#include "Common/Error.h"
+
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <sstream>
+
+#include "ContentTestHelpers.h"
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    const char * CubeObj =
+        "mtllib daybreak_cooked_test.mtl\n"
+        "v -1 -1 1\nv 1 -1 1\nv 1 1 1\nv -1 1 1\nv -1 -1 -1\nv 1 -1 -1\nv 1 1 -1\nv -1 1 -1\n"
+        "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+        "vn 0 0 1\nvn 0 0 -1\n"
+        "g front\nusemtl red\nf 1/1/1 2/2/1 3/3/1 4/4/1\n"
+        "g back\nusemtl blue\nf 8/1/2 7/2/2 6/3/2 5/4/2\n";
+
+    const char * CubeMtl = "newmtl red\nKd 1 0 0\nnewmtl blue\nKd 0 0 1\n";
+
+    /** Require two models to have the same mesh data and groups. */
+    void requireSameModel(const ModelData& expected, const ModelData& actual)
+    {
+        const auto& e = expected.mesh();
+        const auto& a = actual.mesh();
+
+        REQUIRE(e.indexElementType() == a.indexElementType());
+        REQUIRE(e.indexCount() == a.indexCount());
+        REQUIRE(e.vertexCount() == a.vertexCount());
+        REQUIRE(e.vertexElementSizeInBytes() == a.vertexElementSizeInBytes());
+        const auto& expectedLayout = e.vertexElementTypeRef();
+        const auto& actualLayout = a.vertexElementTypeRef();
+
+        REQUIRE(expectedLayout.attributeCount() == actualLayout.attributeCount());
+
+        for (size_t i = 0; i < expectedLayout.attributeCount(); ++i)
+        {
+            REQUIRE(expectedLayout.getAttributeByIndex(i) == actualLayout.getAttributeByIndex(i));
+        }
+
+        REQUIRE(0 == std::memcmp(
+            e.rawIndexBufferData(),
+            a.rawIndexBufferData(),
+            e.indexCount() * e.indexElementSizeInBytes()));
+        REQUIRE(0 == std::memcmp(
+            e.rawVertexBufferData(),
+            a.rawVertexBufferData(),
+            e.vertexCount() * e.vertexElementSizeInBytes()));
+
+        REQUIRE(expected.groupCount() == actual.groupCount());
+
+        for (size_t i = 0; i < expected.groupCount(); ++i)
+        {
+            REQUIRE(expected.group(i).name() == actual.group(i).name());
+            REQUIRE(expected.group(i).indexOffset() == actual.group(i).indexOffset());
+            REQUIRE(expected.group(i).indexCount() == actual.group(i).indexCount());
+            REQUIRE(expected.group(i).baseVertex() == actual.group(i).baseVertex());
+            REQUIRE(expected.group(i).material()->name() == actual.group(i).material()->name());
+
+            const auto& expectedMeshlets = expected.group(i).meshlets();
+            const auto& actualMeshlets = actual.group(i).meshlets();
+
+            REQUIRE(expectedMeshlets.size() == actualMeshlets.size());
+
+            for (size_t m = 0; m < expectedMeshlets.size(); ++m)
+            {
+                REQUIRE(expectedMeshlets[m].indexOffset == actualMeshlets[m].indexOffset);
+                REQUIRE(expectedMeshlets[m].indexCount == actualMeshlets[m].indexCount);
+                REQUIRE(expectedMeshlets[m].vertexCount == actualMeshlets[m].vertexCount);
+                REQUIRE(expectedMeshlets[m].center == actualMeshlets[m].center);
+                REQUIRE(expectedMeshlets[m].radius == actualMeshlets[m].radius);
+                REQUIRE(expectedMeshlets[m].coneAxis == actualMeshlets[m].coneAxis);
+                REQUIRE(expectedMeshlets[m].coneCutoff == actualMeshlets[m].coneCutoff);
+            }
+        }
+    }
+}
+
+TEST_CASE("Cooked_Model_Round_Trips_Model_Without_Copying_Buffers", "[content][CookedModel]")
+{
+    TempDirectory directory("daybreak_cooked_model_round_trip");
+
+    ObjModelParser parser;
+    auto objModel = parser.parse(CubeObj);
+    auto materials = createMaterials(*objModel);
+    auto model = ObjResourceLoader::convert(*objModel, materials);
+
+    std::ostringstream stream;
+    CookedModelFile::write(stream, *model, { "a.mtl", "b.mtl" }, { { 1, 2 }, { 3, 4 } }, { 1234, 5678 }, 42);
+
+    auto path = directory.write("cube.obj.cooked", stream.str());
+    auto file = std::make_shared<const MappedFile>(path);
+
+    std::unique_ptr<ModelData> cooked;
+
+    {
+        CookedModelFile cookedFile(file);
+
+        REQUIRE(file_stamp_t{ 1234, 5678 } == cookedFile.sourceStamp());
+        REQUIRE(42 == cookedFile.optionsHash());
+        REQUIRE(std::vector<std::string>{ "a.mtl", "b.mtl" } == cookedFile.materialLibraries());
+        REQUIRE(2 == cookedFile.materialLibraryStamps().size());
+        REQUIRE(file_stamp_t{ 3, 4 } == cookedFile.materialLibraryStamps()[1]);
+
+        cooked = cookedFile.createModel(materials);
+    }
+
+    requireSameModel(*model, *cooked);
+    REQUIRE(materials["red"] == cooked->group(0).material());
+    REQUIRE(materials["blue"] == cooked->group(1).material());
+
+    // The buffers point into the mapped file, and keep it mapped after every other reference is released.
+    const auto fileStart = file->data();
+    const auto fileEnd = file->data() + file->size();
+    const auto indices = static_cast<const unsigned char *>(cooked->mesh().rawIndexBufferData());
+    const auto vertices = static_cast<const unsigned char *>(cooked->mesh().rawVertexBufferData());
+
+    REQUIRE((indices >= fileStart && indices < fileEnd));
+    REQUIRE((vertices >= fileStart && vertices < fileEnd));
+    REQUIRE(0 == reinterpret_cast<uintptr_t>(vertices) % 16);
+
+    file.reset();
+    requireSameModel(*model, *cooked);
+}
+
+TEST_CASE("Cooked_Model_Round_Trips_Quantized_Model", "[content][CookedModel]")
+{
+    TempDirectory directory("daybreak_cooked_model_quantized");
+
+    ObjModelParser parser;
+    auto objModel = parser.parse(CubeObj);
+    auto materials = createMaterials(*objModel);
+    auto model = ObjResourceLoader::convert(*objModel, materials);
+    model->quantizeVertices();
+
+    std::ostringstream stream;
+    CookedModelFile::write(stream, *model, {}, {}, {}, 0);
+
+    auto file = std::make_shared<const MappedFile>(directory.write("cube.obj.cooked", stream.str()));
+    auto cooked = CookedModelFile(file).createModel(materials);
+
+    requireSameModel(*model, *cooked);
+    REQUIRE(glm::vec3(-1.0f) == cooked->positionDequantization().offset);
+    REQUIRE(glm::vec3(2.0f) == cooked->positionDequantization().scale);
+}
+
+TEST_CASE("Cooked_Model_Round_Trips_Meshlets", "[content][CookedModel]")
+{
+    TempDirectory directory("daybreak_cooked_model_meshlets");
+
+    ObjModelParser parser;
+    auto objModel = parser.parse(CubeObj);
+    auto materials = createMaterials(*objModel);
+    auto model = ObjResourceLoader::convert(*objModel, materials);
+
+    meshlet_options_t options;
+    options.maxTriangles = 1;
+    model->buildMeshlets(options);
+
+    REQUIRE(model->group(0).meshlets().size() > 1);
+
+    std::ostringstream stream;
+    CookedModelFile::write(stream, *model, {}, {}, {}, 0);
+
+    auto file = std::make_shared<const MappedFile>(directory.write("cube.obj.cooked", stream.str()));
+    auto cooked = CookedModelFile(file).createModel(materials);
+
+    requireSameModel(*model, *cooked);
+}
+
+TEST_CASE("Cooked_Model_Throws_Exception_If_Not_Readable", "[content][CookedModel]")
+{
+    TempDirectory directory("daybreak_cooked_model_unreadable");
+
+    ObjModelParser parser;
+    auto objModel = parser.parse(CubeObj);
+    auto model = ObjResourceLoader::convert(*objModel, createMaterials(*objModel));
+
+    std::ostringstream stream;
+    CookedModelFile::write(stream, *model, {}, {}, {}, 0);
+    const auto cooked = stream.str();
+
+    SECTION("Wrong magic")
+    {
+        auto bytes = cooked;
+        bytes[0] = 'X';
+
+        auto file = std::make_shared<const MappedFile>(directory.write("bad.cooked", bytes));
+        REQUIRE_THROWS_MATCHES(
+            CookedModelFile(file),
+            ContentReadException,
+            ContainsExceptionMessage<ContentReadException>("File is not a cooked model"));
+    }
+
+    SECTION("Different version")
+    {
+        auto bytes = cooked;
+        bytes[4] = static_cast<char>(CookedModelFile::Version + 1);
+
+        auto file = std::make_shared<const MappedFile>(directory.write("old.cooked", bytes));
+        REQUIRE_THROWS_MATCHES(
+            CookedModelFile(file),
+            ContentReadException,
+            ContainsExceptionMessage<ContentReadException>("version is not supported"));
+    }
+
+    SECTION("Truncated")
+    {
+        for (size_t size : { size_t(0), size_t(10), cooked.size() / 2, cooked.size() - 1 })
+        {
+            auto file = std::make_shared<const MappedFile>(directory.write("short.cooked", cooked.substr(0, size)));
+            REQUIRE_THROWS_AS(CookedModelFile(file), ContentReadException);
+        }
+    }
+}
+
+TEST_CASE("Obj_Loader_Writes_And_Reuses_Cooked_Model", "[content][CookedModel]")
+{
+    TempDirectory directory("daybreak_cooked_model_loader");
+    directory.write("daybreak_cooked_test.mtl", CubeMtl);
+
+    // Material libraries are relative to the working directory, so use absolute obj and mtl paths.
+    std::string obj = CubeObj;
+    obj.replace(obj.find("daybreak_cooked_test.mtl"), 24, directory.file("daybreak_cooked_test.mtl"));
+
+    const auto objPath = directory.write("cube.obj", obj);
+    const auto cookedPath = objPath + CookedModelFile::FileExtension;
+
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+
+    ObjResourceLoader loader;
+    loader.setCookedModelCache(true);
+
+    // First load parses the obj file and writes the cooked model.
+    auto parsed = loader.load(objPath, resources);
+    file_stamp_t cookedStamp;
+
+    REQUIRE(resources.tryGetFileStamp(cookedPath, cookedStamp));
+    REQUIRE(0 < cookedStamp.size);
+
+    // Second load uses the cooked model.
+    file_stamp_t sourceStamp;
+    REQUIRE(resources.tryGetFileStamp(objPath, sourceStamp));
+
+    auto cooked = ObjResourceLoader::tryLoadCooked(cookedPath, sourceStamp, loader.optionsHash(), resources);
+    REQUIRE(cooked != nullptr);
+    requireSameModel(*parsed, *cooked);
+    requireSameModel(*parsed, *loader.load(objPath, resources));
+
+    // Loading with different options does not use a cooked model made with other options.
+    ObjResourceLoader optimizingLoader;
+    optimizingLoader.setMeshOptimization(true);
+
+    const auto optimizedHash = optimizingLoader.optionsHash();
+
+    REQUIRE(loader.optionsHash() != optimizedHash);
+    REQUIRE(nullptr == ObjResourceLoader::tryLoadCooked(cookedPath, sourceStamp, optimizedHash, resources));
+
+    // Changing a material library makes the cooked model out of date, since the materials decide which groups need
+    // tangents.
+    directory.write("daybreak_cooked_test.mtl", std::string(CubeMtl) + "\n");
+    REQUIRE(nullptr == ObjResourceLoader::tryLoadCooked(cookedPath, sourceStamp, loader.optionsHash(), resources));
+
+    loader.load(objPath, resources);
+    REQUIRE(ObjResourceLoader::tryLoadCooked(cookedPath, sourceStamp, loader.optionsHash(), resources) != nullptr);
+
+    // So does changing the obj file.
+    directory.write("cube.obj", obj + "g extra\nusemtl red\nf 1/1/1 3/3/1 5/1/2\n");
+    REQUIRE(resources.tryGetFileStamp(objPath, sourceStamp));
+    REQUIRE(nullptr == ObjResourceLoader::tryLoadCooked(cookedPath, sourceStamp, loader.optionsHash(), resources));
+
+    auto changed = loader.load(objPath, resources);
+    REQUIRE(3 == changed->groupCount());
+    REQUIRE(ObjResourceLoader::tryLoadCooked(cookedPath, sourceStamp, loader.optionsHash(), resources) != nullptr);
+}
+
+TEST_CASE("Resources_Manager_Only_Cooks_Models_When_Enabled", "[content][CookedModel]")
+{
+    TempDirectory directory("daybreak_cooked_model_options");
+    directory.write("daybreak_cooked_test.mtl", CubeMtl);
+
+    std::string obj = CubeObj;
+    obj.replace(obj.find("daybreak_cooked_test.mtl"), 24, directory.file("daybreak_cooked_test.mtl"));
+
+    const auto objPath = directory.write("cube.obj", obj);
+    const auto cookedPath = objPath + CookedModelFile::FileExtension;
+
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+    file_stamp_t cookedStamp;
+
+    // Models are read as they are stored unless processing is enabled.
+    auto model = resources.readModel(objPath);
+
+    REQUIRE(2 == model->groupCount());
+    REQUIRE(model->group(0).meshlets().empty());
+    REQUIRE_FALSE(resources.tryGetFileStamp(cookedPath, cookedStamp));
+
+    ResourcesManager::model_load_options_t options;
+    options.cookedModelCache = true;
+    options.meshletGeneration = true;
+    resources.setModelLoadOptions(options);
+
+    model = resources.readModel(objPath);
+
+    REQUIRE_FALSE(model->group(0).meshlets().empty());
+    REQUIRE(resources.tryGetFileStamp(cookedPath, cookedStamp));
+
+    // The cooked model is only reused by a loader with the same options, so it shows which options were passed on.
+    file_stamp_t sourceStamp;
+    REQUIRE(resources.tryGetFileStamp(objPath, sourceStamp));
+
+    ObjResourceLoader loader;
+    loader.setMeshletGeneration(true);
+    loader.setStreaming(true);
+
+    REQUIRE(nullptr == ObjResourceLoader::tryLoadCooked(cookedPath, sourceStamp, loader.optionsHash(), resources));
+
+    options.streaming = true;
+    resources.setModelLoadOptions(options);
+    model = resources.readModel(objPath);
+
+    REQUIRE(2 == model->groupCount());
+    REQUIRE(ObjResourceLoader::tryLoadCooked(cookedPath, sourceStamp, loader.optionsHash(), resources) != nullptr);
+
+    // Quantized models are cooked separately, and keep the transform that restores their positions.
+    loader.setVertexQuantization(true);
+    REQUIRE(nullptr == ObjResourceLoader::tryLoadCooked(cookedPath, sourceStamp, loader.optionsHash(), resources));
+
+    options.vertexQuantization = true;
+    resources.setModelLoadOptions(options);
+    model = resources.readModel(objPath);
+
+    REQUIRE(glm::vec3(1.0f) != model->positionDequantization().scale);
+
+    auto cooked = ObjResourceLoader::tryLoadCooked(cookedPath, sourceStamp, loader.optionsHash(), resources);
+    REQUIRE(cooked != nullptr);
+    REQUIRE(model->positionDequantization().scale == cooked->positionDequantization().scale);
+}
+
+TEST_CASE("Obj_Loader_Only_Loads_Referenced_Materials", "[content][CookedModel]")
+{
+    TempDirectory directory("daybreak_referenced_materials");
+
+    std::vector<std::string> libraries = {
+        directory.write("first.mtl", "newmtl unused\nKd 1 1 1\nnewmtl red\nKd 1 0 0\n"),
+        directory.write("second.mtl", "newmtl red\nKd 0 1 0\nnewmtl blue\nKd 0 0 1\nnewmtl other\nd 5\n"),
+        directory.write("third.mtl", "newmtl other\nKd 0 0 0\n")
+    };
+
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+
+    // The libraries are loaded on different threads, but red still comes from the first library that defines it.
+    for (size_t workerCount : { size_t(1), size_t(3) })
+    {
+        obj_model_t objModel;
+        objModel.materialLibraries = libraries;
+        objModel.groups.resize(2);
+        objModel.groups[0].material = "red";
+        objModel.groups[1].material = "blue";
+
+        auto materials = ObjResourceLoader::loadMaterials(objModel, resources, workerCount);
+
+        REQUIRE(2 == materials.size());
+        REQUIRE(glm::vec3(1, 0, 0) == materials["red"]->getVector3Parameter(MaterialParameterType::DiffuseColor));
+        REQUIRE(glm::vec3(0, 0, 1) == materials["blue"]->getVector3Parameter(MaterialParameterType::DiffuseColor));
+    }
+
+    // Without names every material is kept, and the invalid material in the second library is an error.
+    REQUIRE(3 == ObjResourceLoader::loadMaterials({ libraries[0], libraries[2] }, resources, nullptr, 2).size());
+    REQUIRE_THROWS_AS(ObjResourceLoader::loadMaterials(libraries, resources, nullptr, 2), MtlMaterialException);
+}
+
+TEST_CASE("Default_File_System_Gets_File_Stamp", "[content][CookedModel]")
+{
+    TempDirectory directory("daybreak_file_stamp");
+    auto path = directory.write("stamp.txt", "12345");
+
+    DefaultFileSystem fileSystem("");
+    file_stamp_t stamp;
+
+    REQUIRE(fileSystem.tryGetFileStamp(path, stamp));
+    REQUIRE(5 == stamp.size);
+    REQUIRE(!fileSystem.tryGetFileStamp(directory.file("missing.txt"), stamp));
+}
+
+TEST_CASE("Default_File_System_Replaces_Whole_Files", "[content][CookedModel]")
+{
+    TempDirectory directory("daybreak_write_file");
+    auto path = directory.file("written.txt");
+
+    DefaultFileSystem fileSystem("");
+    fileSystem.writeFile(path, [](std::ostream& stream) { stream << "first"; });
+    fileSystem.writeFile(path, [](std::ostream& stream) { stream << "second"; });
+
+    REQUIRE("second" == fileSystem.loadFileAsText(path).get());
+
+    // A write that fails part way leaves the old file, and no temporary file, behind.
+    auto failedWrite = [](std::ostream& stream) {
+        stream << "third";
+        throw DaybreakDataException("Failed to write");
+    };
+
+    REQUIRE_THROWS_AS(fileSystem.writeFile(path, failedWrite), DaybreakDataException);
+    REQUIRE("second" == fileSystem.loadFileAsText(path).get());
+    REQUIRE(1 == std::distance(
+        std::filesystem::directory_iterator(directory.file("")),
+        std::filesystem::directory_iterator()));
+
+    // Files that cannot be created are write errors rather than read errors.
+    REQUIRE_THROWS_AS(
+        fileSystem.writeFile(directory.file("missing/written.txt"), [](std::ostream&) {}),
+        ContentWriteException);
+}
@@ -0,0 +1,408 @@
+#include "stdafx.h"
+#include "Content/GltfModel/GltfResourceLoader.h"
+#include "Content/Models/ModelData.h"
+#include "Content/Materials/MaterialData.h"
+#include "Content/Images/Image.h"
+#include "Content/DefaultFileSystem.h"
+#include "Content/MappedFile.h"
+#include "Content/ResourcesManager.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/VertexFormat.h"
+#include "Graphics/InputLayoutDescription.h"
+#include "Common/Error.h"
+
+#include <cstring>
+#include <vector>
+
+#include "ContentTestHelpers.h"
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /** File system that keeps every file it maps, so tests can check where loaded data points. */
+    class RecordingFileSystem : public DefaultFileSystem
+    {
+    public:
+        RecordingFileSystem() : DefaultFileSystem("") {}
+
+        virtual std::future<std::shared_ptr<const MappedFile>> mapFile(const std::string& path) override
+        {
+            auto file = DefaultFileSystem::mapFile(path).get();
+            mappedFiles.push_back(file);
+
+            std::promise<std::shared_ptr<const MappedFile>> result;
+            result.set_value(file);
+            return result.get_future();
+        }
+
+        std::vector<std::shared_ptr<const MappedFile>> mappedFiles;
+    };
+
+    /** Append values to a byte string. */
+    template<typename T>
+    void append(std::string& bytes, std::initializer_list<T> values)
+    {
+        for (const auto& value : values)
+        {
+            bytes.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+    }
+
+    /** Replace the first occurrence of a string in a JSON document. */
+    std::string replace(std::string text, const std::string& from, const std::string& to)
+    {
+        text.replace(text.find(from), from.size(), to);
+        return text;
+    }
+
+    /** Create a glb file from a JSON document and binary chunk, padding both to four bytes. */
+    std::string createGlb(std::string json, std::string binary)
+    {
+        json.resize((json.size() + 3) & ~size_t(3), ' ');
+        binary.resize((binary.size() + 3) & ~size_t(3), '\0');
+
+        std::string glb = "glTF";
+        const auto length = static_cast<uint32_t>(12 + 8 + json.size() + (binary.empty() ? 0 : 8 + binary.size()));
+
+        append<uint32_t>(glb, { 2, length, static_cast<uint32_t>(json.size()), 0x4E4F534A });
+        glb += json;
+
+        if (!binary.empty())
+        {
+            append<uint32_t>(glb, { static_cast<uint32_t>(binary.size()), 0x004E4942 });
+            glb += binary;
+        }
+
+        return glb;
+    }
+
+    /** Vertices of a unit quad in the xy plane, with position, texture and normal attributes. */
+    std::string quadVertices()
+    {
+        std::string bytes;
+        append<float>(bytes, { 0, 0, 0, 0, 0, 0, 0, 1 });
+        append<float>(bytes, { 1, 0, 0, 1, 0, 0, 0, 1 });
+        append<float>(bytes, { 1, 1, 0, 1, 1, 0, 0, 1 });
+        append<float>(bytes, { 0, 1, 0, 0, 1, 0, 0, 1 });
+
+        return bytes;
+    }
+
+    /** Binary PGM image of a single gray pixel. */
+    const std::string GrayPixelPgm("P5\n1 1\n255\n\x80", 12);
+
+    /**
+     * Buffer views and accessors of a quad made of two primitives that share an index buffer view and an interleaved
+     * vertex buffer view. The second primitive's vertices start at the quad's second vertex. The normal map is an
+     * image stored in a third buffer view after the vertices.
+     */
+    const char * InterleavedQuadJson = R"({
+        "asset": { "version": "2.0" },
+        "buffers": [ { "byteLength": 152 } ],
+        "bufferViews": [
+            { "buffer": 0, "byteLength": 12 },
+            { "buffer": 0, "byteOffset": 12, "byteLength": 128, "byteStride": 32 },
+            { "buffer": 0, "byteOffset": 140, "byteLength": 12 }
+        ],
+        "accessors": [
+            { "bufferView": 0, "componentType": 5123, "count": 3, "type": "SCALAR" },
+            { "bufferView": 0, "byteOffset": 6, "componentType": 5123, "count": 3, "type": "SCALAR" },
+            { "bufferView": 1, "componentType": 5126, "count": 3, "type": "VEC3" },
+            { "bufferView": 1, "byteOffset": 12, "componentType": 5126, "count": 3, "type": "VEC2" },
+            { "bufferView": 1, "byteOffset": 20, "componentType": 5126, "count": 3, "type": "VEC3" },
+            { "bufferView": 1, "byteOffset": 32, "componentType": 5126, "count": 3, "type": "VEC3" },
+            { "bufferView": 1, "byteOffset": 44, "componentType": 5126, "count": 3, "type": "VEC2" },
+            { "bufferView": 1, "byteOffset": 52, "componentType": 5126, "count": 3, "type": "VEC3" }
+        ],
+        "materials": [ {
+            "name": "red",
+            "pbrMetallicRoughness": { "baseColorFactor": [ 1, 0, 0, 0.5 ], "baseColorTexture": { "index": 0 } },
+            "normalTexture": { "index": 1 }
+        } ],
+        "textures": [ { "source": 0 }, { "source": 1 } ],
+        "images": [ { "uri": "red.png" }, { "bufferView": 2, "mimeType": "image/x-portable-graymap" } ],
+        "meshes": [ {
+            "name": "quad",
+            "primitives": [
+                { "attributes": { "POSITION": 2, "TEXCOORD_0": 3, "NORMAL": 4 }, "indices": 0, "material": 0 },
+                { "attributes": { "NORMAL": 7, "POSITION": 5, "TEXCOORD_0": 6 }, "indices": 1 }
+            ]
+        } ]
+    })";
+
+    /** Get the texel OpenGL samples at a texture coordinate, which is in the row of the image stored first for v = 0. */
+    const unsigned char * texelAt(const Image& image, const glm::vec2& uv)
+    {
+        const auto x = std::min(static_cast<size_t>(uv.x * image.Width()), image.Width() - 1);
+        const auto y = std::min(static_cast<size_t>(uv.y * image.Height()), image.Height() - 1);
+        const auto channelCount = static_cast<size_t>(image.Format());
+
+        return image.RawPixels(0) + (y * image.Width() + x) * channelCount;
+    }
+
+    /** Get the position of a vertex in a model whose first attribute is a three float position. */
+    glm::vec3 positionOf(const ModelData& model, size_t index)
+    {
+        const auto& mesh = model.mesh();
+        const auto vertexBytes = static_cast<const uint8_t *>(mesh.rawVertexBufferData());
+        const auto vertex = readIndices(mesh)[index] + model.group(0).baseVertex();
+
+        glm::vec3 position;
+        std::memcpy(&position, vertexBytes + vertex * mesh.vertexElementSizeInBytes(), sizeof(position));
+
+        return position;
+    }
+}
+
+TEST_CASE("Gltf_Loader_Uses_Mapped_Buffers_When_Layout_Matches", "[content][GltfModel]")
+{
+    TempDirectory directory("daybreak_gltf_mapped");
+
+    std::string binary;
+    append<uint16_t>(binary, { 0, 1, 2, 0, 1, 2 });
+    binary += quadVertices() + GrayPixelPgm;
+
+    const auto path = directory.write("quad.glb", createGlb(InterleavedQuadJson, binary));
+    auto fileSystem = std::make_shared<RecordingFileSystem>();
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), fileSystem);
+
+    GltfResourceLoader loader;
+    auto model = loader.load(path, resources);
+
+    // The layout is the one the vertices are stored in, and the buffers point into the mapped file.
+    const auto& mesh = model->mesh();
+    const auto& layout = mesh.vertexElementTypeRef();
+
+    REQUIRE(vertex_ptn_t::inputLayout->attributeCount() == layout.attributeCount());
+
+    for (size_t i = 0; i < layout.attributeCount(); ++i)
+    {
+        REQUIRE(vertex_ptn_t::inputLayout->getAttributeByIndex(i) == layout.getAttributeByIndex(i));
+    }
+
+    REQUIRE(1 == fileSystem->mappedFiles.size());
+
+    const auto& file = *fileSystem->mappedFiles.front();
+    const auto indices = static_cast<const unsigned char *>(mesh.rawIndexBufferData());
+    const auto vertices = static_cast<const unsigned char *>(mesh.rawVertexBufferData());
+
+    REQUIRE((indices >= file.data() && indices < file.data() + file.size()));
+    REQUIRE((vertices >= file.data() && vertices < file.data() + file.size()));
+    REQUIRE(IndexElementType::UnsignedShort == mesh.indexElementType());
+    REQUIRE(6 == mesh.indexCount());
+    REQUIRE(4 == mesh.vertexCount());
+
+    // Each primitive is a group, and the second starts at the second vertex.
+    REQUIRE(2 == model->groupCount());
+    REQUIRE("quad_0" == model->group(0).name());
+    REQUIRE(0 == model->group(0).indexOffset());
+    REQUIRE(3 == model->group(0).indexCount());
+    REQUIRE(0 == model->group(0).baseVertex());
+    REQUIRE("quad_1" == model->group(1).name());
+    REQUIRE(3 == model->group(1).indexOffset());
+    REQUIRE(3 == model->group(1).indexCount());
+    REQUIRE(1 == model->group(1).baseVertex());
+
+    // Images in separate files are referenced by path, while images in a buffer view point into the mapped file.
+    const auto& red = model->group(0).materialRef();
+
+    REQUIRE("red" == red.name());
+    REQUIRE(glm::vec3(1, 0, 0) == red.getVector3Parameter(MaterialParameterType::DiffuseColor));
+    REQUIRE(0.5f == red.getFloatParameter(MaterialParameterType::Opacity));
+    REQUIRE(directory.file("red.png") == red.getTextureParameter(MaterialParameterType::DiffuseMap).filepath);
+    REQUIRE(nullptr == red.getTextureParameter(MaterialParameterType::DiffuseMap).embeddedImage.bytes);
+    REQUIRE("default" == model->group(1).materialRef().name());
+
+    const auto normalMap = red.getTextureParameter(MaterialParameterType::NormalMap);
+
+    REQUIRE(path + "#images/1" == normalMap.filepath);
+    REQUIRE(path == normalMap.embeddedImage.containerPath);
+    REQUIRE(file.data() + file.size() - GrayPixelPgm.size() == normalMap.embeddedImage.bytes);
+    REQUIRE(GrayPixelPgm.size() == normalMap.embeddedImage.size);
+
+    // The model stays valid after the file system releases the mapping.
+    fileSystem->mappedFiles.clear();
+    REQUIRE(glm::vec3(1, 1, 0) == positionOf(*model, 2));
+}
+
+TEST_CASE("Gltf_Loader_Repacks_Separate_Attribute_Buffers", "[content][GltfModel]")
+{
+    TempDirectory directory("daybreak_gltf_repacked");
+
+    // Positions and texture coordinates are in separate buffer views, the first primitive has byte indices and the
+    // second primitive is not indexed.
+    std::string binary;
+    append<float>(binary, { 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0 });
+    append<float>(binary, { 0, 0, 1, 0, 1, 1, 0, 1 });
+    append<uint8_t>(binary, { 0, 1, 2, 0, 2, 3 });
+
+    const char * json = R"({
+        "asset": { "version": "2.0" },
+        "buffers": [ { "byteLength": 86 } ],
+        "bufferViews": [
+            { "buffer": 0, "byteLength": 48 },
+            { "buffer": 0, "byteOffset": 48, "byteLength": 32 },
+            { "buffer": 0, "byteOffset": 80, "byteLength": 6 }
+        ],
+        "accessors": [
+            { "bufferView": 0, "componentType": 5126, "count": 4, "type": "VEC3" },
+            { "bufferView": 1, "componentType": 5126, "count": 4, "type": "VEC2" },
+            { "bufferView": 2, "componentType": 5121, "count": 6, "type": "SCALAR" },
+            { "bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3" },
+            { "bufferView": 1, "componentType": 5126, "count": 3, "type": "VEC2" },
+            { "bufferView": 1, "componentType": 5126, "count": 3, "type": "VEC2" }
+        ],
+        "meshes": [
+            { "primitives": [ { "attributes": { "TEXCOORD_0": 1, "POSITION": 0 }, "indices": 2 } ] },
+            { "name": "triangle", "primitives": [ { "attributes": { "POSITION": 3, "TEXCOORD_0": 4, "COLOR_0": 5 } } ] }
+        ]
+    })";
+
+    const auto path = directory.write("quad.glb", createGlb(json, binary));
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+
+    // The resources manager picks the loader by file extension.
+    auto model = resources.loadModel(path);
+    const auto& mesh = model->mesh();
+    const auto& layout = mesh.vertexElementTypeRef();
+
+    // Attributes Daybreak has no semantic for are dropped.
+    REQUIRE(2 == layout.attributeCount());
+    REQUIRE(InputAttribute::SemanticName::Position == layout.getAttributeByIndex(0).semanticName());
+    REQUIRE(InputAttribute::SemanticName::Texture == layout.getAttributeByIndex(1).semanticName());
+    REQUIRE(20 == mesh.vertexElementSizeInBytes());
+    REQUIRE(7 == mesh.vertexCount());
+    REQUIRE(std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3, 4, 5, 6 } == readIndices(mesh));
+
+    REQUIRE(2 == model->groupCount());
+    REQUIRE("mesh0" == model->group(0).name());
+    REQUIRE("triangle" == model->group(1).name());
+    REQUIRE(6 == model->group(1).indexOffset());
+    REQUIRE(3 == model->group(1).indexCount());
+    REQUIRE(model->group(0).material() == model->group(1).material());
+
+    const auto vertices = static_cast<const float *>(mesh.rawVertexBufferData());
+    REQUIRE(std::vector<float>{ 1, 1, 0, 1, 1 } == std::vector<float>(vertices + 10, vertices + 15));
+    REQUIRE(std::vector<float>{ 1, 0, 0, 1, 0 } == std::vector<float>(vertices + 25, vertices + 30));
+}
+
+TEST_CASE("Gltf_Loader_Throws_Exception_If_Not_Readable", "[content][GltfModel]")
+{
+    TempDirectory directory("daybreak_gltf_errors");
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+    GltfResourceLoader loader;
+
+    std::string binary;
+    append<uint16_t>(binary, { 0, 1, 2, 0, 1, 2 });
+    binary += quadVertices() + GrayPixelPgm;
+
+    auto requireThrows = [&](const std::string& glb) {
+        const auto path = directory.write("bad.glb", glb);
+        REQUIRE_THROWS_AS(loader.load(path, resources), ContentReadException);
+    };
+
+    const auto glb = createGlb(InterleavedQuadJson, binary);
+
+    // Not a glb file, a truncated file and invalid JSON.
+    requireThrows("solid cube\n");
+    requireThrows(glb.substr(0, glb.size() - 4));
+    requireThrows(createGlb("{ \"meshes\": [ }", binary));
+
+    // Missing binary chunk, buffer views and accessors outside their buffers and indices outside the vertices.
+    requireThrows(createGlb(InterleavedQuadJson, ""));
+    requireThrows(createGlb(replace(InterleavedQuadJson, "\"byteLength\": 128", "\"byteLength\": 148"), binary));
+    requireThrows(createGlb(replace(InterleavedQuadJson, "\"byteOffset\": 52", "\"byteOffset\": 120"), binary));
+
+    std::string badIndices;
+    append<uint16_t>(badIndices, { 0, 1, 3, 0, 1, 2 });
+    requireThrows(createGlb(InterleavedQuadJson, badIndices + quadVertices() + GrayPixelPgm));
+
+    // Missing members and primitives that are not triangle lists.
+    requireThrows(createGlb(replace(InterleavedQuadJson, "\"count\": 3, \"type\": \"SCALAR\"", "\"type\": 1"), binary));
+    requireThrows(createGlb(replace(InterleavedQuadJson, "\"indices\": 1", "\"indices\": 1, \"mode\": 1"), binary));
+
+    // Images in data uris, without a source and in buffer views that do not exist.
+    requireThrows(createGlb(replace(InterleavedQuadJson, "\"bufferView\": 2,", "\"uri\": \"data:,AAAA\","), binary));
+    requireThrows(createGlb(replace(InterleavedQuadJson, "\"bufferView\": 2,", ""), binary));
+    requireThrows(createGlb(replace(InterleavedQuadJson, "\"bufferView\": 2,", "\"bufferView\": 3,"), binary));
+}
+
+TEST_CASE("Gltf_Loader_Decodes_Images_In_Buffer_Views", "[content][GltfModel]")
+{
+    TempDirectory directory("daybreak_gltf_images");
+
+    std::string binary;
+    append<uint16_t>(binary, { 0, 1, 2, 0, 1, 2 });
+    binary += quadVertices() + GrayPixelPgm;
+
+    const auto path = directory.write("quad.glb", createGlb(InterleavedQuadJson, binary));
+    directory.write("red.png", std::string("P6\n1 1\n255\n\xFF\0\0", 14));
+
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+    auto model = resources.readModel(path);
+    auto images = resources.readModelImages(*model);
+
+    // The embedded image is decoded from the glb file, and is stamped with the glb file since it has no file of its
+    // own.
+    REQUIRE(2 == images.size());
+
+    const auto& normalMap = images[path + "#images/1"];
+    file_stamp_t stamp;
+
+    REQUIRE(resources.tryGetFileStamp(path, stamp));
+    REQUIRE(stamp == normalMap.stamp);
+    REQUIRE(ImagePixelFormat::Grayscale == normalMap.image->Format());
+    REQUIRE(1 == normalMap.image->Width());
+    REQUIRE(0x80 == normalMap.image->RawPixels(0)[0]);
+
+    REQUIRE(ImagePixelFormat::RGB == images[directory.file("red.png")].image->Format());
+}
+
+TEST_CASE("Gltf_Loader_Samples_Top_Row_Of_Images_At_Texture_Origin", "[content][GltfModel]")
+{
+    TempDirectory directory("daybreak_gltf_image_rows");
+
+    // Both images are one pixel wide and two tall, with a different top and bottom row. The embedded image replaces
+    // the gray pixel in the interleaved quad's buffer.
+    const std::string RowsPgm("P5\n1 2\n255\n\x00\xFF", 13);
+    const auto rowsPpmPath = directory.write("rows.ppm", std::string("P6\n1 2\n255\n\xFF\0\0\0\0\xFF", 17));
+
+    auto json = replace(InterleavedQuadJson, "red.png", "rows.ppm");
+    json = replace(json, "\"byteLength\": 152", "\"byteLength\": 153");
+    json = replace(json, "\"byteOffset\": 140, \"byteLength\": 12", "\"byteOffset\": 140, \"byteLength\": 13");
+
+    std::string binary;
+    append<uint16_t>(binary, { 0, 1, 2, 0, 1, 2 });
+    binary += quadVertices() + RowsPgm;
+
+    const auto path = directory.write("quad.glb", createGlb(json, binary));
+
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+    auto model = resources.readModel(path);
+    auto images = resources.readModelImages(*model);
+
+    // The first vertex has texture coordinate (0, 0), which glTF puts at the top left of the image.
+    const auto& material = model->group(0).materialRef();
+    REQUIRE_FALSE(material.getTextureParameter(MaterialParameterType::DiffuseMap).flipVertically);
+
+    const auto& baseColor = *images[rowsPpmPath].image;
+    const auto red = texelAt(baseColor, { 0.0f, 0.0f });
+    const auto blue = texelAt(baseColor, { 0.0f, 0.99f });
+
+    REQUIRE(0xFF == red[0]);
+    REQUIRE(0x00 == red[2]);
+    REQUIRE(0x00 == blue[0]);
+    REQUIRE(0xFF == blue[2]);
+
+    const auto& normalMap = *images[path + "#images/1"].image;
+    REQUIRE(0x00 == texelAt(normalMap, { 0.0f, 0.0f })[0]);
+    REQUIRE(0xFF == texelAt(normalMap, { 0.0f, 0.99f })[0]);
+
+    // Images loaded for formats with the origin at the bottom left are flipped.
+    auto flipped = resources.loadImage(rowsPpmPath);
+    REQUIRE(0x00 == texelAt(*flipped, { 0.0f, 0.0f })[0]);
+    REQUIRE(0xFF == texelAt(*flipped, { 0.0f, 0.0f })[2]);
+}
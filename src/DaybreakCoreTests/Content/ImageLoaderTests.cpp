@@ -0,0 +1,261 @@
+#include "stdafx.h"
+#include "Content/Images/Image.h"
+#include "Content/DefaultFileSystem.h"
+#include "Content/ResourcesManager.h"
+#include "Content/Models/ModelData.h"
+#include "Content/Materials/MaterialData.h"
+#include "Common/Error.h"
+
+#include <string>
+#include <vector>
+
+#include "ContentTestHelpers.h"
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /** Create a binary PPM image with a width of one pixel, whose rows are given from top to bottom. */
+    std::string createPpm(const std::vector<unsigned char>& rows)
+    {
+        std::string ppm = "P6\n1 " + std::to_string(rows.size()) + "\n255\n";
+
+        for (auto row : rows)
+        {
+            ppm.append(3, static_cast<char>(row));
+        }
+
+        return ppm;
+    }
+
+    /** Texture that only remembers its name. */
+    class NamedTexture : public ITexture2d
+    {
+    public:
+        explicit NamedTexture(const std::string& name) : m_name(name) {}
+        virtual std::string name() const override { return m_name; }
+
+    private:
+        std::string m_name;
+    };
+
+    /** Device context that records the batches of textures it creates. Images named "bad" fail to upload. */
+    class BatchRecordingDeviceContext : public NullDeviceContext
+    {
+    public:
+        virtual std::vector<std::unique_ptr<ITexture2d>> createTextures2d(
+            const std::vector<texture2d_upload_t>& uploads) override
+        {
+            batchSizes.push_back(uploads.size());
+            std::vector<std::unique_ptr<ITexture2d>> textures;
+
+            for (const auto& upload : uploads)
+            {
+                const auto isBad = upload.image->Name().find("bad") != std::string::npos;
+                textures.push_back(isBad ? nullptr : std::make_unique<NamedTexture>(upload.image->Name()));
+            }
+
+            return textures;
+        }
+
+        std::vector<size_t> batchSizes;
+    };
+}
+
+TEST_CASE("Image_Decodes_With_Per_Call_Flip", "[content][Image]")
+{
+    const auto ppm = createPpm({ 10, 20, 30 });
+    const auto bytes = reinterpret_cast<const unsigned char *>(ppm.data());
+
+    auto flipped = BytePerChannelImage::LoadFromMemory("flipped", bytes, ppm.size());
+    auto unflipped = BytePerChannelImage::LoadFromMemory("unflipped", bytes, ppm.size(), false);
+
+    REQUIRE(1 == flipped->Width());
+    REQUIRE(3 == flipped->Height());
+    REQUIRE(ImagePixelFormat::RGB == flipped->Format());
+
+    REQUIRE(30 == flipped->RawPixels()[0]);
+    REQUIRE(10 == flipped->RawPixels()[6]);
+    REQUIRE(10 == unflipped->RawPixels()[0]);
+    REQUIRE(30 == unflipped->RawPixels()[6]);
+
+    // The error message belongs to the image that failed.
+    const std::string garbage = "not an image";
+
+    REQUIRE_THROWS_AS(
+        BytePerChannelImage::LoadFromMemory(
+            "garbage",
+            reinterpret_cast<const unsigned char *>(garbage.data()),
+            garbage.size()),
+        ContentReadException);
+}
+
+TEST_CASE("Resources_Manager_Loads_Images_In_Parallel", "[content][Image]")
+{
+    TempDirectory directory("daybreak_parallel_images");
+    std::vector<std::string> paths;
+
+    for (int i = 0; i < 64; ++i)
+    {
+        const auto value = static_cast<unsigned char>(i);
+        paths.push_back(directory.write("image" + std::to_string(i) + ".ppm", createPpm({ value, 255 })));
+    }
+
+    ResourcesManager resources(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+    auto images = resources.loadImages(paths, 8);
+
+    REQUIRE(paths.size() == images.size());
+
+    for (size_t i = 0; i < images.size(); ++i)
+    {
+        REQUIRE(paths[i] == images[i]->Name());
+        REQUIRE(2 == images[i]->Height());
+        REQUIRE(255 == images[i]->RawPixels()[0]);
+        REQUIRE(i == images[i]->RawPixels()[3]);
+    }
+
+    // A bad image fails the whole batch.
+    paths.push_back(directory.write("bad.ppm", "P6\n"));
+    REQUIRE_THROWS_AS(resources.loadImages(paths, 8), ContentReadException);
+}
+
+TEST_CASE("Resources_Manager_Creates_Model_Textures_In_One_Batch", "[content][Image]")
+{
+    TempDirectory directory("daybreak_model_textures");
+    const auto brickPath = directory.write("brick.ppm", createPpm({ 1 }));
+    const auto bumpPath = directory.write("bump.ppm", createPpm({ 2 }));
+    const auto badPath = directory.write("bad.ppm", createPpm({ 3 }));
+
+    const auto mtlPath = directory.write(
+        "walls.mtl",
+        "newmtl red\nmap_Kd " + brickPath + "\nnorm " + bumpPath + "\n"
+        "newmtl blue\nmap_Kd " + brickPath + "\nmap_Ks " + badPath + "\n");
+
+    const auto objPath = directory.write(
+        "walls.obj",
+        "mtllib " + mtlPath + "\n"
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\nvt 1 0\nvt 1 1\nvn 0 0 1\n"
+        "g front\nusemtl red\nf 1/1/1 2/2/1 3/3/1\n"
+        "g back\nusemtl blue\nf 3/3/1 2/2/1 1/1/1\n");
+
+    auto deviceContext = std::make_shared<BatchRecordingDeviceContext>();
+    ResourcesManager resources(deviceContext, std::make_shared<DefaultFileSystem>(""));
+
+    // Images shared by materials are read once.
+    auto model = resources.readModel(objPath);
+    auto images = resources.readModelImages(*model);
+
+    REQUIRE(3 == images.size());
+    REQUIRE(1 == images.at(brickPath).image->RawPixels()[0]);
+    REQUIRE(2 == images.at(bumpPath).image->RawPixels()[0]);
+
+    // Every texture is created in a single batch, and textures that fail are removed from their material. The
+    // materials that use the same image share a texture.
+    resources.createModelTextures(*model, images);
+
+    REQUIRE(std::vector<size_t>{ 3 } == deviceContext->batchSizes);
+    REQUIRE(2 == model->groupCount());
+
+    const auto& red = model->group(0).materialRef();
+    const auto& blue = model->group(1).materialRef();
+
+    REQUIRE(brickPath == red.getTextureParameter(MaterialParameterType::DiffuseMap).texture->name());
+    REQUIRE(bumpPath == red.getTextureParameter(MaterialParameterType::NormalMap).texture->name());
+    REQUIRE(brickPath == blue.getTextureParameter(MaterialParameterType::DiffuseMap).texture->name());
+    REQUIRE_FALSE(blue.isParameterDefined(MaterialParameterType::SpecularMap));
+}
+
+TEST_CASE("Resources_Manager_Shares_Cached_Textures", "[content][Image]")
+{
+    TempDirectory directory("daybreak_texture_cache");
+    const auto brickPath = directory.write("brick.ppm", createPpm({ 1 }));
+    const auto copyPath = directory.write("copy.ppm", createPpm({ 1 }));
+
+    const auto writeModel = [&](const std::string& name, const std::string& texturePath) {
+        const auto mtlPath = directory.write(
+            name + ".mtl",
+            "newmtl red\nmap_Kd " + texturePath + "\nnewmtl blue\nmap_Kd " + texturePath + "\n");
+
+        return directory.write(
+            name + ".obj",
+            "mtllib " + mtlPath + "\n"
+            "v 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\nvt 1 0\nvt 1 1\nvn 0 0 1\n"
+            "g front\nusemtl red\nf 1/1/1 2/2/1 3/3/1\n"
+            "g back\nusemtl blue\nf 3/3/1 2/2/1 1/1/1\n");
+    };
+
+    const auto wallPath = writeModel("wall", brickPath);
+    const auto otherWallPath = writeModel("other_wall", directory.file("./brick.ppm"));
+    const auto copyWallPath = writeModel("copy_wall", copyPath);
+
+    auto deviceContext = std::make_shared<BatchRecordingDeviceContext>();
+    ResourcesManager resources(deviceContext, std::make_shared<DefaultFileSystem>(""));
+
+    auto diffuseMap = [](const ModelData& model, size_t groupIndex) {
+        return model.group(groupIndex).materialRef().getTextureParameter(MaterialParameterType::DiffuseMap).texture;
+    };
+
+    // Materials that use the same file share one texture.
+    auto wall = resources.loadModel(wallPath);
+
+    REQUIRE(std::vector<size_t>{ 1 } == deviceContext->batchSizes);
+    REQUIRE(diffuseMap(*wall, 0) == diffuseMap(*wall, 1));
+    REQUIRE(1 == resources.cachedTextureCount());
+
+    // So do other models, even when they spell the path differently, and the image is not read again.
+    auto otherWall = resources.readModel(otherWallPath);
+    auto otherImages = resources.readModelImages(*otherWall);
+
+    REQUIRE(nullptr == otherImages.begin()->second.image);
+    resources.createModelTextures(*otherWall, otherImages);
+
+    REQUIRE(std::vector<size_t>{ 1 } == deviceContext->batchSizes);
+    REQUIRE(diffuseMap(*wall, 0) == diffuseMap(*otherWall, 0));
+
+    // Files with the same contents only share a texture when content deduplication is enabled.
+    auto copyWall = resources.loadModel(copyWallPath);
+
+    REQUIRE(2 == deviceContext->batchSizes.size());
+    REQUIRE(diffuseMap(*wall, 0) != diffuseMap(*copyWall, 0));
+
+    resources.setTextureContentDeduplication(true);
+    copyWall.reset();
+
+    const auto secondCopyPath = directory.write("second_copy.ppm", createPpm({ 1 }));
+    const auto secondCopyWallPath = writeModel("second_copy_wall", secondCopyPath);
+
+    copyWall = resources.loadModel(copyWallPath);
+    auto secondCopyWall = resources.loadModel(secondCopyWallPath);
+
+    REQUIRE(3 == deviceContext->batchSizes.size());
+    REQUIRE(diffuseMap(*copyWall, 0) == diffuseMap(*secondCopyWall, 0));
+
+    // The bytes are compared with the file a texture was made from, so nothing is shared once that file changed.
+    directory.write("copy.ppm", createPpm({ 2, 3 }));
+
+    const auto thirdCopyPath = directory.write("third_copy.ppm", createPpm({ 1 }));
+    auto thirdCopyWall = resources.loadModel(writeModel("third_copy_wall", thirdCopyPath));
+
+    REQUIRE(4 == deviceContext->batchSizes.size());
+    REQUIRE(diffuseMap(*copyWall, 0) != diffuseMap(*thirdCopyWall, 0));
+
+    // A file that changed is read again.
+    directory.write("brick.ppm", createPpm({ 4, 5 }));
+    auto changedWall = resources.loadModel(wallPath);
+
+    REQUIRE(5 == deviceContext->batchSizes.size());
+    REQUIRE(diffuseMap(*wall, 0) != diffuseMap(*changedWall, 0));
+
+    // Textures that are no longer used are forgotten.
+    wall.reset();
+    otherWall.reset();
+    copyWall.reset();
+    secondCopyWall.reset();
+    thirdCopyWall.reset();
+
+    REQUIRE(1 == resources.cachedTextureCount());
+
+    changedWall.reset();
+    REQUIRE(0 == resources.cachedTextureCount());
+}
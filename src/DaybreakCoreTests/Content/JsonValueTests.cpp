@@ -0,0 +1,60 @@
+#include "stdafx.h"
+#include "Content/GltfModel/JsonValue.h"
+#include "Common/Error.h"
+
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+
+TEST_CASE("Json_Parses_Values", "[content][Json]")
+{
+    auto json = JsonValue::parse(
+        " { \"name\" : \"caf\\u00e9 \\\"\\ud83d\\ude00\\\"\", \"count\": 42, \"scale\": -1.5e2,"
+        " \"flags\": [true, false, null], \"empty\": {}, \"list\": [] } ");
+
+    REQUIRE(JsonValue::Type::Object == json.type());
+    REQUIRE(6 == json.asObject().size());
+    REQUIRE("name" == json.asObject()[0].first);
+
+    REQUIRE(u8"caf\u00e9 \"\U0001F600\"" == json.at("name").asString());
+    REQUIRE(42 == json.at("count").asSize());
+    REQUIRE(-150.0 == json.at("scale").asNumber());
+
+    const auto& flags = json.at("flags");
+    REQUIRE(3 == flags.asArray().size());
+    REQUIRE(flags.at(size_t(0)).asBool());
+    REQUIRE_FALSE(flags.at(1).asBool());
+    REQUIRE(flags.at(2).isNull());
+
+    REQUIRE(json.at("empty").asObject().empty());
+    REQUIRE(json.at("list").asArray().empty());
+
+    // Optional members.
+    REQUIRE(nullptr == json.find("missing"));
+    REQUIRE(7 == json.sizeOr("missing", 7));
+    REQUIRE(42 == json.sizeOr("count", 7));
+    REQUIRE(2.5 == json.numberOr("missing", 2.5));
+    REQUIRE("default" == json.stringOr("missing", "default"));
+}
+
+TEST_CASE("Json_Throws_Exception_If_Not_Valid", "[content][Json]")
+{
+    REQUIRE_THROWS_AS(JsonValue::parse(""), DaybreakDataException);
+    REQUIRE_THROWS_AS(JsonValue::parse("{\"a\": 1,}"), DaybreakDataException);
+    REQUIRE_THROWS_AS(JsonValue::parse("[1 2]"), DaybreakDataException);
+    REQUIRE_THROWS_AS(JsonValue::parse("01"), DaybreakDataException);
+    REQUIRE_THROWS_AS(JsonValue::parse("\"unterminated"), DaybreakDataException);
+    REQUIRE_THROWS_AS(JsonValue::parse("\"\\ud83d\""), DaybreakDataException);
+    REQUIRE_THROWS_AS(JsonValue::parse("tru"), DaybreakDataException);
+    REQUIRE_THROWS_AS(JsonValue::parse("{} {}"), DaybreakDataException);
+    REQUIRE_THROWS_AS(JsonValue::parse(std::string(1000, '[')), DaybreakDataException);
+
+    // Values of the wrong type, and numbers that are not sizes.
+    auto json = JsonValue::parse("{\"a\": -1, \"b\": 1.5, \"c\": \"text\"}");
+
+    REQUIRE_THROWS_AS(json.at("a").asSize(), DaybreakDataException);
+    REQUIRE_THROWS_AS(json.at("b").asSize(), DaybreakDataException);
+    REQUIRE_THROWS_AS(json.at("c").asNumber(), DaybreakDataException);
+    REQUIRE_THROWS_AS(json.at("d"), DaybreakDataException);
+    REQUIRE_THROWS_AS(json.at(size_t(0)), DaybreakDataException);
+}
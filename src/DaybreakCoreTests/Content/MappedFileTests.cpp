@@ -0,0 +1,76 @@
+#include "stdafx.h"
+#include "Content/MappedFile.h"
+#include "Content/DefaultFileSystem.h"
+#include "Common/Error.h"
+
+#include <filesystem>
+#include <fstream>
+
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /** Writes a file to the temp directory and deletes it when the test is done. */
+    class TempFile
+    {
+    public:
+        TempFile(const std::string& name, const std::string& contents)
+            : m_path((std::filesystem::temp_directory_path() / name).string())
+        {
+            std::ofstream stream(m_path, std::ios::binary);
+            stream.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        }
+
+        ~TempFile()
+        {
+            std::error_code error;
+            std::filesystem::remove(m_path, error);
+        }
+
+        const std::string& path() const noexcept { return m_path; }
+
+    private:
+        std::string m_path;
+    };
+}
+
+TEST_CASE("Mapped_File_Contains_File_Contents", "[content][MappedFile]")
+{
+    TempFile temp("daybreak_mapped_file_test.txt", "v 1 2 3\r\nv 4 5 6\n");
+    MappedFile file(temp.path());
+
+    REQUIRE(17 == file.size());
+    REQUIRE(!file.empty());
+    REQUIRE(std::string_view("v 1 2 3\r\nv 4 5 6\n") == file.text());
+    REQUIRE('v' == file.data()[0]);
+    REQUIRE(temp.path() == file.filePath());
+}
+
+TEST_CASE("Mapped_File_Can_Be_Empty", "[content][MappedFile]")
+{
+    TempFile temp("daybreak_mapped_file_empty_test.txt", "");
+    MappedFile file(temp.path());
+
+    REQUIRE(0 == file.size());
+    REQUIRE(file.empty());
+    REQUIRE(file.text().empty());
+}
+
+TEST_CASE("Mapped_File_Throws_Exception_If_File_Missing", "[content][MappedFile]")
+{
+    auto path = (std::filesystem::temp_directory_path() / "daybreak_file_that_does_not_exist.txt").string();
+    REQUIRE_THROWS_AS(MappedFile(path), ContentReadException);
+}
+
+TEST_CASE("Default_File_System_Maps_File", "[content][MappedFile]")
+{
+    TempFile temp("daybreak_file_system_map_test.txt", "newmtl test\n");
+    DefaultFileSystem fileSystem("");
+
+    auto file = fileSystem.mapFile(temp.path()).get();
+
+    REQUIRE(file != nullptr);
+    REQUIRE(std::string_view("newmtl test\n") == file->text());
+}
@@ -0,0 +1,153 @@
+#include "stdafx.h"
+#include "Content/Images/MipMapGenerator.h"
+#include "Content/Images/Image.h"
+
+#include <string>
+#include <vector>
+
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /** Create a binary grayscale PGM image. */
+    std::string createPgm(size_t width, size_t height, const std::vector<unsigned char>& pixels)
+    {
+        std::string pgm = "P5\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+        pgm.append(pixels.begin(), pixels.end());
+
+        return pgm;
+    }
+}
+
+TEST_CASE("Mip_Map_Generator_Creates_Full_Chain", "[content][MipMaps]")
+{
+    REQUIRE(1 == mipMapCount(1, 1));
+    REQUIRE(3 == mipMapCount(5, 3));
+    REQUIRE(11 == mipMapCount(1024, 16));
+
+    // Every level is half the size of the one above it, down to one pixel, and a constant image stays constant with
+    // every filter.
+    const std::vector<float> pixels(5 * 3 * 2, 0.25f);
+
+    for (auto filter : { MipMapFilter::Box, MipMapFilter::Kaiser, MipMapFilter::Lanczos })
+    {
+        mip_map_settings_t settings;
+        settings.filter = filter;
+        settings.maxWorkerCount = 4;
+
+        auto mipMaps = generateMipMaps(pixels.data(), 5, 3, 2, settings);
+
+        REQUIRE(2 == mipMaps.size());
+        REQUIRE(2 == mipMaps[0].width);
+        REQUIRE(1 == mipMaps[0].height);
+        REQUIRE(1 == mipMaps[1].width);
+        REQUIRE(1 == mipMaps[1].height);
+        REQUIRE(2 * 2 == mipMaps[0].pixels.size());
+
+        for (const auto& mipMap : mipMaps)
+        {
+            for (auto value : mipMap.pixels)
+            {
+                REQUIRE(Approx(0.25f) == value);
+            }
+        }
+    }
+}
+
+TEST_CASE("Mip_Map_Generator_Filters_sRGB_In_Linear_Space", "[content][MipMaps]")
+{
+    REQUIRE(0 == linearToSrgb(srgbToLinear(0)));
+    REQUIRE(255 == linearToSrgb(srgbToLinear(255)));
+
+    for (int i = 0; i < 256; ++i)
+    {
+        REQUIRE(i == linearToSrgb(srgbToLinear(static_cast<unsigned char>(i))));
+    }
+
+    // Averaging black and white gives half the light, which is brighter than half the sRGB value.
+    const std::vector<unsigned char> pixels = { 0, 255 };
+    mip_map_settings_t settings;
+    settings.filter = MipMapFilter::Box;
+
+    REQUIRE(128 == generateMipMaps(pixels.data(), 2, 1, 1, settings)[0].pixels[0]);
+
+    settings.isSrgb = true;
+    REQUIRE(188 == generateMipMaps(pixels.data(), 2, 1, 1, settings)[0].pixels[0]);
+
+    // Alpha is never sRGB encoded.
+    const std::vector<unsigned char> grayAlphaPixels = { 0, 0, 255, 255 };
+    auto grayAlpha = generateMipMaps(grayAlphaPixels.data(), 2, 1, 2, settings)[0].pixels;
+
+    REQUIRE(188 == grayAlpha[0]);
+    REQUIRE(128 == grayAlpha[1]);
+}
+
+TEST_CASE("Mip_Map_Generator_Sharper_Filters_Keep_Detail", "[content][MipMaps]")
+{
+    // A bright line in the middle of a dark image spreads less with a windowed sinc filter than with a box filter,
+    // but every filter keeps the total brightness.
+    std::vector<float> pixels(16, 0.0f);
+    pixels[7] = 1.0f;
+    pixels[8] = 1.0f;
+
+    auto filterLine = [&](MipMapFilter filter) {
+        mip_map_settings_t settings;
+        settings.filter = filter;
+
+        return generateMipMaps(pixels.data(), 16, 1, 1, settings)[0].pixels;
+    };
+
+    const auto box = filterLine(MipMapFilter::Box);
+    const auto kaiser = filterLine(MipMapFilter::Kaiser);
+    const auto lanczos = filterLine(MipMapFilter::Lanczos);
+
+    REQUIRE(8 == box.size());
+    REQUIRE(Approx(0.5f) == box[3]);
+    REQUIRE(Approx(0.5f) == box[4]);
+    REQUIRE(0.0f == box[2]);
+    REQUIRE(kaiser[3] > box[3]);
+    REQUIRE(lanczos[3] > box[3]);
+
+    auto sum = [](const std::vector<float>& values) {
+        float total = 0.0f;
+
+        for (auto value : values)
+        {
+            total += value;
+        }
+
+        return total;
+    };
+
+    REQUIRE(Approx(1.0f).epsilon(0.02) == sum(kaiser));
+    REQUIRE(Approx(1.0f).epsilon(0.02) == sum(lanczos));
+}
+
+TEST_CASE("Image_Stores_Generated_Mip_Maps", "[content][MipMaps]")
+{
+    const std::vector<unsigned char> pixels = { 10, 10, 10, 10, 30, 30, 30, 30 };
+    const auto pgm = createPgm(4, 2, pixels);
+
+    auto image = BytePerChannelImage::LoadFromMemory(
+        "image",
+        reinterpret_cast<const unsigned char *>(pgm.data()),
+        pgm.size(),
+        false);
+
+    REQUIRE(1 == image->MipMapCount());
+
+    mip_map_settings_t settings;
+    settings.filter = MipMapFilter::Box;
+    image->GenerateMipMaps(settings);
+
+    REQUIRE(3 == image->MipMapCount());
+    REQUIRE(2 == image->MipMapWidth(1));
+    REQUIRE(1 == image->MipMapHeight(1));
+    REQUIRE(1 == image->MipMapWidth(2));
+    REQUIRE(20 == image->RawPixels(1)[0]);
+    REQUIRE(20 == image->RawPixels(1)[1]);
+    REQUIRE(20 == image->RawPixels(2)[0]);
+    REQUIRE(10 == image->RawPixels(0)[0]);
+}
@@ -399,6 +399,30 @@ TEST_CASE("disp_Throws_Exception_If_Path_Missing", "[content][MtlMaterialParser]
         ContainsExceptionMessage<std::runtime_error>("Expected next token to be a string but no token was found"));
 }
 
+TEST_CASE("Parse_Only_Creates_Named_Materials", "[content][MtlMaterialParser]")
+{
+    MtlMaterialParser parser;
+
+    // Commands of skipped materials are not parsed, so their errors are not reported.
+    const std::string MtlData =
+        "newmtl unused\n"
+        "d 5\n"
+        "newmtl used\n"
+        "Kd 1.0 0.5 0.0\n"
+        "newmtl also_unused\n"
+        "Kd\n";
+
+    const std::unordered_set<std::string> names = { "used", "missing" };
+    auto materials = parser.parse(MtlData, "", &names);
+
+    REQUIRE(1 == (int)materials.size());
+    REQUIRE("used" == materials[0]->name());
+    REQUIRE(glm::vec3(1.0f, 0.5f, 0.0f) == materials[0]->getVector3Parameter(MaterialParameterType::DiffuseColor));
+
+    // The parser does not keep the names between files.
+    REQUIRE(3 == (int)parser.parse("newmtl a\nnewmtl b\nnewmtl c\n").size());
+}
+
 TEST_CASE("Parse_Two_Simple_Materials", "[content][MtlMaterialParser]")
 {
     MtlMaterialParser parser;
@@ -0,0 +1,127 @@
+#include "stdafx.h"
+#include "Content/ObjModel/ObjFaceVertexTable.h"
+#include "Content/ObjModel/ObjModelParser.h"
+#include "Content/ObjModel/ObjResourceLoader.h"
+#include "Content/Materials/MaterialData.h"
+#include "Graphics/Mesh/MeshData.h"
+
+#include <cstring>
+#include <random>
+
+#include "ContentTestHelpers.h"
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+
+TEST_CASE("Face_Vertex_Table_Finds_Inserted_Vertices", "[content][ObjFaceVertexTable]")
+{
+    ObjFaceVertexTable table;
+
+    REQUIRE(std::make_pair(0u, true) == table.findOrInsert({ 1, 2, 3 }, 0));
+    REQUIRE(std::make_pair(1u, true) == table.findOrInsert({ 1, 2, 4 }, 1));
+    REQUIRE(std::make_pair(2u, true) == table.findOrInsert({ 1, 0, 0 }, 2));
+    REQUIRE(std::make_pair(0u, false) == table.findOrInsert({ 1, 2, 3 }, 3));
+    REQUIRE(std::make_pair(2u, false) == table.findOrInsert({ 1, 0, 0 }, 3));
+
+    REQUIRE(3 == table.size());
+}
+
+TEST_CASE("Face_Vertex_Table_Grows_Past_Expected_Count", "[content][ObjFaceVertexTable]")
+{
+    ObjFaceVertexTable table(4);
+    const auto initialCapacity = table.capacity();
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        REQUIRE(table.findOrInsert({ i + 1, i % 7, i % 3 }, static_cast<uint32_t>(i)).second);
+    }
+
+    REQUIRE(10000 == table.size());
+    REQUIRE(table.capacity() > initialCapacity);
+    REQUIRE(table.size() * 4 <= table.capacity() * 3);
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        REQUIRE(std::make_pair(static_cast<uint32_t>(i), false) == table.findOrInsert({ i + 1, i % 7, i % 3 }, 0));
+    }
+}
+
+TEST_CASE("Face_Vertex_Hash_Uses_All_Indices", "[content][ObjFaceVertexTable]")
+{
+    const auto h = hashFaceVertex({ 1, 2, 3 });
+
+    REQUIRE(h == hashFaceVertex({ 1, 2, 3 }));
+    REQUIRE(h != hashFaceVertex({ 1, 3, 2 }));
+    REQUIRE(h != hashFaceVertex({ 2, 1, 3 }));
+    REQUIRE(h != hashFaceVertex({ 3, 2, 1 }));
+    REQUIRE(h != hashFaceVertex({ 1, 2, 4 }));
+    REQUIRE(h != hashFaceVertex({ 1, 2, 0 }));
+}
+
+TEST_CASE("Sort_Deduplicate_Matches_Face_Vertex_Table", "[content][ObjFaceVertexTable]")
+{
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> index(1, 50);
+
+    std::vector<obj_face_vertex_t> faceVertices;
+
+    for (int i = 0; i < 3000; ++i)
+    {
+        faceVertices.push_back({ index(random), index(random) % 4, index(random) % 2 });
+    }
+
+    ObjFaceVertexTable table;
+    std::vector<uint32_t> expectedIndices;
+    std::vector<obj_face_vertex_t> expectedVertices;
+
+    for (const auto& v : faceVertices)
+    {
+        auto result = table.findOrInsert(v, static_cast<uint32_t>(expectedVertices.size()));
+
+        if (result.second)
+        {
+            expectedVertices.push_back(v);
+        }
+
+        expectedIndices.push_back(result.first);
+    }
+
+    std::vector<uint32_t> indices;
+    std::vector<obj_face_vertex_t> uniqueVertices;
+
+    sortDeduplicateFaceVertices(faceVertices, indices, uniqueVertices);
+
+    REQUIRE(expectedIndices == indices);
+    REQUIRE(expectedVertices == uniqueVertices);
+}
+
+TEST_CASE("Convert_Produces_Same_Mesh_With_Hash_And_Sort_Deduplication", "[content][ObjFaceVertexTable]")
+{
+    ObjModelParser parser;
+    auto objModel = parser.parse(
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvt 1 1\nvn 0 0 1\nvn 0 1 0\n"
+        "g first\nusemtl red\nf 1/1/1 2/1/1 3/2/1 4/2/1\nf 1/1/2 2/1/1 3/2/1\n"
+        "g second\nusemtl blue\nf 3/2/1 2/1/1 1/1/2\nf 4/2/2 3/2/1 2/1/1\n");
+
+    auto materials = createMaterials(*objModel);
+
+    auto hashed = ObjResourceLoader::convert(*objModel, materials, ObjVertexDeduplication::HashTable);
+    auto sorted = ObjResourceLoader::convert(*objModel, materials, ObjVertexDeduplication::Sort);
+
+    const auto& hashedMesh = hashed->mesh();
+    const auto& sortedMesh = sorted->mesh();
+
+    REQUIRE(hashedMesh.indexCount() == sortedMesh.indexCount());
+    REQUIRE(hashedMesh.vertexCount() == sortedMesh.vertexCount());
+    REQUIRE(0 == std::memcmp(
+        hashedMesh.rawIndexBufferData(),
+        sortedMesh.rawIndexBufferData(),
+        hashedMesh.indexCount() * hashedMesh.indexElementSizeInBytes()));
+
+    // Vertices are only shared within a group, so the second group adds its own copies of 3/2/1, 2/1/1 and 1/1/2.
+    REQUIRE(9 == hashedMesh.vertexCount());
+    REQUIRE(0 == std::memcmp(
+        hashedMesh.rawVertexBufferData(),
+        sortedMesh.rawVertexBufferData(),
+        hashedMesh.vertexCount() * hashedMesh.vertexElementSizeInBytes()));
+}
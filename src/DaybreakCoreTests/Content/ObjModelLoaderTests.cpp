@@ -1,11 +1,45 @@
 #include "stdafx.h"
 #include "Content/ObjModel/ObjModelParser.h"
 #include "Content/ObjModel/ObjModelException.h"
+#include "Content/ObjModel/ObjResourceLoader.h"
+#include "Content/ObjModel/IObjModelVisitor.h"
+#include "Content/Materials/MaterialData.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/VertexFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
 
 #include "../TestHelpers.h"
 
 using namespace Daybreak;
 
+namespace
+{
+    /** Rebuilds an obj model from the data passed to a visitor. */
+    class RecordingObjModelVisitor : public IObjModelVisitor
+    {
+    public:
+        virtual void visitPosition(const glm::vec3& position) override { model.positions.push_back(position); }
+        virtual void visitUV(const glm::vec2& uv) override { model.uv.push_back(uv); }
+        virtual void visitNormal(const glm::vec3& normal) override { model.normals.push_back(normal); }
+
+        virtual void visitGroup(const std::string& name, const std::string& material) override
+        {
+            model.groups.push_back(obj_group_t(name));
+            model.groups.back().material = material;
+        }
+
+        virtual void visitFace(const obj_face_t& face) override { model.groups.back().faces.push_back(face); }
+        virtual void visitSmoothingGroup(uint32_t) override { model.hasSmoothingGroups = true; }
+        virtual void visitMaterialLibrary(const std::string& path) override { model.materialLibraries.push_back(path); }
+
+        obj_model_t model;
+    };
+}
+
 TEST_CASE("V_Adds_Vertex_Positions", "[content][ObjMaterialParser]")
 {
     ObjModelParser parser;
@@ -300,7 +334,6 @@ TEST_CASE("F_Throws_Exception_If_Any_Of_Three_Elements_Missing", "[content][ObjM
         "v 12 22 32\n vt 0.4 0.5\n vn 0.7 0.8 0.9\n";
 
     // TODO: These exceptions are not clear, fix that.
-    // TODO: Test when there are more than three elements.
     REQUIRE_THROWS_MATCHES(
         [o] { ObjModelParser p; p.parse(o + "f"); }(),
         ObjModelException,
@@ -426,6 +459,53 @@ TEST_CASE("O_Creates_A_New_Group", "[content][ObjMaterialParser]")
     REQUIRE(std::string("second") == model->groups[2].name);
 }
 
+TEST_CASE("S_Sets_Smoothing_Group_Of_Following_Faces", "[content][ObjMaterialParser]")
+{
+    const std::string ObjData =
+        "v 10 20 30\nv 11 21 31\nv 12 22 32\n"
+        "f 1 2 3\ns 1\nf 3 2 1\ng first\nf 1 2 3\ns off\nf 3 2 1\ns 4\nf 1 2 3\ns 0\nf 3 2 1\n";
+
+    ObjModelParser parser;
+    auto model = parser.parse(ObjData);
+
+    REQUIRE(model->hasSmoothingGroups);
+    REQUIRE(2 == model->groups.size());
+    REQUIRE(2 == model->groups[0].faces.size());
+    REQUIRE(0 == model->groups[0].faces[0].smoothingGroup);
+    REQUIRE(1 == model->groups[0].faces[1].smoothingGroup);
+
+    // Smoothing groups carry over into new groups.
+    REQUIRE(4 == model->groups[1].faces.size());
+    REQUIRE(1 == model->groups[1].faces[0].smoothingGroup);
+    REQUIRE(0 == model->groups[1].faces[1].smoothingGroup);
+    REQUIRE(4 == model->groups[1].faces[2].smoothingGroup);
+    REQUIRE(0 == model->groups[1].faces[3].smoothingGroup);
+
+    // Streaming visits the same smoothing groups, even when the s command is in an earlier block than the faces.
+    std::istringstream stream(ObjData);
+    RecordingObjModelVisitor visitor;
+
+    parser.setStreamBlockSize(4);
+    parser.parseStream(stream, visitor);
+
+    REQUIRE(visitor.model.hasSmoothingGroups);
+    REQUIRE(model->groups[0].faces == visitor.model.groups[0].faces);
+    REQUIRE(model->groups[1].faces == visitor.model.groups[1].faces);
+
+    REQUIRE_FALSE(parser.parse("v 1 2 3\nf 1 1 1\n")->hasSmoothingGroups);
+}
+
+TEST_CASE("S_Throws_Exception_If_Smoothing_Group_Invalid", "[content][ObjMaterialParser]")
+{
+    REQUIRE_THROWS_MATCHES(
+        [] { ObjModelParser p; p.parse("s -1"); }(),
+        ObjModelException,
+        ContainsExceptionMessage<ObjModelException>("Smoothing group must be a positive number or off"));
+
+    REQUIRE_THROWS_AS([] { ObjModelParser p; p.parse("s"); }(), ObjModelException);
+    REQUIRE_THROWS_AS([] { ObjModelParser p; p.parse("v 1 2 3\ns smooth\nf 1 1 1\n"); }(), ObjModelException);
+}
+
 TEST_CASE("MTLLIB_Adds_Material_Library", "[content][ObjMaterialParser]")
 {
     ObjModelParser parser;
@@ -497,3 +577,449 @@ TEST_CASE("USEMTL_Replaces_Material_If_No_Existing_Faces_In_Current_Group", "[co
     REQUIRE(1 == (int)model->groups.size());
     REQUIRE(std::string("mat2") == model->groups[0].material);
 }
+
+TEST_CASE("Parallel_Parse_Matches_Serial_Parse", "[content][ObjMaterialParser]")
+{
+    const char * ObjData =
+        "mtllib first.mtl\n"
+        "v 10 20 30\n vt 0.2 0.4\n vn 0.1 0.2 0.3\n"
+        "v 11 21 31\n vt 0.3 0.5\n vn 0.4 0.5 0.6\n"
+        "# comment line\n"
+        "v 12 22 32\n vt 0.4 0.5\n vn 0.7 0.8 0.9\n"
+        "usemtl foo\nf 1/2/3 2/1/1 3/3/2\n"
+        "g first\nusemtl bar\nf -1/-1/-1 -2/-2/-2 -3/-3/-3\n"
+        "v 13 23 33\n vt 0.5 0.6\n vn 0.2 0.3 0.4\n"
+        "f -1/-1/-1 -2/-2/-2 1/1/1\n"
+        "usemtl foobar\nf 4/4/4 -4/-4/-4 2/2/2\n"
+        "mtllib second.mtl\n"
+        "o object\r\nf 3/3/3 4/4/4 -1/-1/-1\r\n";
+
+    ObjModelParser serialParser;
+    serialParser.setMaxWorkerCount(1);
+
+    ObjModelParser parallelParser;
+    parallelParser.setMaxWorkerCount(4);
+    parallelParser.setMinChunkSize(16);
+
+    auto expected = serialParser.parse(ObjData);
+    auto actual = parallelParser.parse(ObjData);
+
+    REQUIRE(expected->positions == actual->positions);
+    REQUIRE(expected->uv == actual->uv);
+    REQUIRE(expected->normals == actual->normals);
+    REQUIRE(expected->materialLibraries == actual->materialLibraries);
+    REQUIRE(expected->hasUV == actual->hasUV);
+    REQUIRE(expected->hasNormals == actual->hasNormals);
+
+    REQUIRE(expected->groups.size() == actual->groups.size());
+
+    for (size_t i = 0; i < expected->groups.size(); ++i)
+    {
+        REQUIRE(expected->groups[i].name == actual->groups[i].name);
+        REQUIRE(expected->groups[i].material == actual->groups[i].material);
+        REQUIRE(expected->groups[i].faces == actual->groups[i].faces);
+    }
+}
+
+TEST_CASE("Parallel_Parse_Reports_Same_Line_Number_As_Serial_Parse", "[content][ObjMaterialParser]")
+{
+    const char * ObjData =
+        "v 10 20 30\nv 11 21 31\nv 12 22 32\n"
+        "f 1 2 3\nf 3 2 1\n"
+        "v 13 23 33\n"
+        "f 1 2 3\nf 1 2 5\nf 1 2 x\n";
+
+    ObjModelParser parser;
+    parser.setMaxWorkerCount(4);
+    parser.setMinChunkSize(8);
+
+    try
+    {
+        parser.parse(ObjData);
+        FAIL("Expected ObjModelException to be thrown");
+    }
+    catch (const ObjModelException& e)
+    {
+        REQUIRE(8 == e.lineNumber());
+        REQUIRE_THAT(e.what(), Catch::Contains("Index must be smaller than size of data array"));
+    }
+}
+
+TEST_CASE("Stream_Parse_Visits_Same_Data_As_Parse", "[content][ObjMaterialParser]")
+{
+    const std::string ObjData =
+        "mtllib first.mtl\n"
+        "v 10 20 30\n vt 0.2 0.4\n vn 0.1 0.2 0.3\n"
+        "v 11 21 31\n vt 0.3 0.5\n vn 0.4 0.5 0.6\n"
+        "# comment line that is longer than a block\n"
+        "v 12 22 32\r\n vt 0.4 0.5\r\n vn 0.7 0.8 0.9\r\n"
+        "usemtl foo\nf 1/2/3 2/1/1 3/3/2\n"
+        "g first\nusemtl bar\nf -1/-1/-1 -2/-2/-2 -3/-3/-3\n"
+        "v 13 23 33\n vt 0.5 0.6\n vn 0.2 0.3 0.4\n"
+        "f -1/-1/-1 -2/-2/-2 1/1/1\n"
+        "usemtl foobar\nf 4/4/4 -4/-4/-4 2/2/2\n"
+        "mtllib second.mtl\n"
+        "o object\r\nf 3/3/3 4/4/4 -1/-1/-1\r\n"
+        "usemtl unused";
+
+    ObjModelParser parser;
+    auto expected = parser.parse(ObjData);
+
+    // Try block sizes that split lines (and CRLF pairs) at many different places.
+    for (size_t blockSize : { 1, 3, 7, 16, 4096 })
+    {
+        std::istringstream stream(ObjData);
+        RecordingObjModelVisitor visitor;
+
+        parser.setStreamBlockSize(blockSize);
+        parser.parseStream(stream, visitor);
+
+        const auto& actual = visitor.model;
+
+        REQUIRE(expected->positions == actual.positions);
+        REQUIRE(expected->uv == actual.uv);
+        REQUIRE(expected->normals == actual.normals);
+        REQUIRE(expected->materialLibraries == actual.materialLibraries);
+
+        // Groups without faces are not visited.
+        size_t actualGroupIndex = 0;
+
+        for (const auto& group : expected->groups)
+        {
+            if (group.faces.empty())
+            {
+                continue;
+            }
+
+            REQUIRE(actualGroupIndex < actual.groups.size());
+            REQUIRE(group.name == actual.groups[actualGroupIndex].name);
+            REQUIRE(group.material == actual.groups[actualGroupIndex].material);
+            REQUIRE(group.faces == actual.groups[actualGroupIndex].faces);
+
+            actualGroupIndex++;
+        }
+
+        REQUIRE(actualGroupIndex == actual.groups.size());
+    }
+}
+
+TEST_CASE("Stream_Parse_Reports_Same_Line_Number_As_Parse", "[content][ObjMaterialParser]")
+{
+    std::istringstream stream(
+        "v 10 20 30\nv 11 21 31\nv 12 22 32\n"
+        "f 1 2 3\nf 3 2 1\n"
+        "v 13 23 33\n"
+        "f 1 2 3\nf 1 2 5\nf 1 2 x\n");
+
+    ObjModelParser parser;
+    parser.setStreamBlockSize(8);
+
+    RecordingObjModelVisitor visitor;
+
+    try
+    {
+        parser.parseStream(stream, visitor);
+        FAIL("Expected ObjModelException to be thrown");
+    }
+    catch (const ObjModelException& e)
+    {
+        REQUIRE(8 == e.lineNumber());
+        REQUIRE_THAT(e.what(), Catch::Contains("Index must be smaller than size of data array"));
+        REQUIRE_THAT(e.what(), Catch::Contains("while performing command 'f'"));
+    }
+}
+
+TEST_CASE("Mesh_Builder_Creates_Indexed_Mesh_From_Streamed_Obj", "[content][ObjMaterialParser]")
+{
+    std::istringstream stream(
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "vn 0 0 1\n"
+        "g first\nusemtl red\nf 1//1 2//1 3//1\nf 1//1 3//1 4//1\n"
+        "g second\nusemtl blue\nf 3//1 2//1 1//1\n");
+
+    ObjModelParser parser;
+    parser.setStreamBlockSize(5);
+
+    ObjResourceLoader::MeshBuilder builder;
+    parser.parseStream(stream, builder);
+
+    ObjResourceLoader::material_lut_t materials;
+    materials["red"] = std::make_shared<MaterialData>("red", MaterialType::Traditional);
+    materials["blue"] = std::make_shared<MaterialData>("blue", MaterialType::Traditional);
+
+    auto model = builder.build(materials);
+    const auto& mesh = model->mesh();
+
+    REQUIRE(4 == mesh.vertexCount());
+    REQUIRE(9 == mesh.indexCount());
+
+    REQUIRE(IndexElementType::UnsignedByte == mesh.indexElementType());
+
+    const auto indices = readIndices(mesh);
+    const uint32_t expectedIndices[] = { 0, 1, 2, 0, 2, 3, 2, 1, 0 };
+
+    for (size_t i = 0; i < 9; ++i)
+    {
+        REQUIRE(expectedIndices[i] == indices[i]);
+    }
+
+    REQUIRE(2 == model->groupCount());
+    REQUIRE(std::string("first") == model->group(0).name());
+    REQUIRE(0 == model->group(0).indexOffset());
+    REQUIRE(6 == model->group(0).indexCount());
+    REQUIRE(materials["red"] == model->group(0).material());
+    REQUIRE(std::string("second") == model->group(1).name());
+    REQUIRE(6 == model->group(1).indexOffset());
+    REQUIRE(3 == model->group(1).indexCount());
+    REQUIRE(materials["blue"] == model->group(1).material());
+}
+
+TEST_CASE("Convert_Output_Does_Not_Depend_On_Worker_Count", "[content][ObjMaterialParser]")
+{
+    // One large group that is split into several batches, followed by many small groups with different materials.
+    const int Side = 200;
+    std::string text;
+
+    for (int y = 0; y <= Side; ++y)
+    {
+        for (int x = 0; x <= Side; ++x)
+        {
+            text += "v " + std::to_string(x) + " " + std::to_string(y) + " 0\n";
+        }
+    }
+
+    text += "vn 0 0 1\ng big\nusemtl red\n";
+
+    for (int y = 0; y < Side; ++y)
+    {
+        for (int x = 0; x < Side; ++x)
+        {
+            auto a = std::to_string(y * (Side + 1) + x + 1);
+            auto b = std::to_string(y * (Side + 1) + x + 2);
+            auto c = std::to_string((y + 1) * (Side + 1) + x + 1);
+            auto d = std::to_string((y + 1) * (Side + 1) + x + 2);
+
+            text += "f " + a + "//1 " + b + "//1 " + d + "//1 " + c + "//1\n";
+        }
+    }
+
+    for (int g = 0; g < 50; ++g)
+    {
+        text += "g small" + std::to_string(g) + "\nusemtl " + (g % 2 == 0 ? "red" : "blue") + "\n";
+        text += "f " + std::to_string(g + 1) + "//1 " + std::to_string(g + 2) + "//1 " + std::to_string(g + 3) + "//1\n";
+    }
+
+    ObjModelParser parser;
+    auto objModel = parser.parse(text);
+
+    ObjResourceLoader::material_lut_t materials;
+    materials["red"] = std::make_shared<MaterialData>("red", MaterialType::Traditional);
+    materials["blue"] = std::make_shared<MaterialData>("blue", MaterialType::Traditional);
+
+    auto serial = ObjResourceLoader::convert(*objModel, materials, ObjVertexDeduplication::HashTable, 1);
+    auto parallel = ObjResourceLoader::convert(*objModel, materials, ObjVertexDeduplication::HashTable, 4);
+
+    const auto& serialMesh = serial->mesh();
+    const auto& parallelMesh = parallel->mesh();
+
+    REQUIRE(serialMesh.indexCount() == parallelMesh.indexCount());
+    REQUIRE(serialMesh.vertexCount() == parallelMesh.vertexCount());
+
+    const auto serialIndices = readIndices(serialMesh);
+    const auto parallelIndices = readIndices(parallelMesh);
+    const auto vertices = reinterpret_cast<const vertex_ptn_t *>(parallelMesh.rawVertexBufferData());
+
+    REQUIRE(serialMesh.indexElementType() == parallelMesh.indexElementType());
+    REQUIRE(serialIndices == parallelIndices);
+
+    // Every index must refer to a vertex with the position of the obj face vertex it came from.
+    size_t i = 0;
+
+    for (const auto& group : objModel->groups)
+    {
+        for (const auto& face : group.faces)
+        {
+            for (int j = 0; j < 3; ++j, ++i)
+            {
+                const auto& expected = objModel->positions[face.vertex(j).p - 1];
+                const auto& actual = vertices[parallelIndices[i]];
+
+                REQUIRE(expected.x == actual.elements[0]);
+                REQUIRE(expected.y == actual.elements[1]);
+            }
+        }
+    }
+
+    REQUIRE(51 == parallel->groupCount());
+    REQUIRE(0 == parallel->group(0).indexOffset());
+    REQUIRE(Side * Side * 6 == parallel->group(0).indexCount());
+    REQUIRE(Side * Side * 6 + 3 * 7 == parallel->group(8).indexOffset());
+    REQUIRE(materials["blue"] == parallel->group(8).material());
+}
+
+TEST_CASE("Convert_Generates_Missing_Normals_Using_Smoothing_Groups", "[content][ObjMaterialParser]")
+{
+    // Two quads folded along x = 1, first in one smoothing group and then in two.
+    const std::string Positions = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 2 0 1\nv 2 1 1\nusemtl red\n";
+    const std::string Faces = "f 1 2 3 4\n{s}f 2 5 6 3\n";
+
+    ObjResourceLoader::material_lut_t materials;
+    materials["red"] = std::make_shared<MaterialData>("red", MaterialType::Traditional);
+
+    normal_generation_options_t options;
+
+    auto convert = [&](const std::string& secondGroup) {
+        auto text = Positions + "s 1\n" + Faces;
+        text.replace(text.find("{s}"), 3, secondGroup);
+
+        ObjModelParser parser;
+        auto objModel = parser.parse(text);
+
+        return ObjResourceLoader::convert(*objModel, materials, ObjVertexDeduplication::HashTable, 2, &options);
+    };
+
+    auto requireUnitNormals = [](const ModelData& model) {
+        const auto& mesh = model.mesh();
+        const auto vertices = static_cast<const vertex_ptn_t *>(mesh.rawVertexBufferData());
+
+        for (size_t v = 0; v < mesh.vertexCount(); ++v)
+        {
+            const auto& e = vertices[v].elements;
+            REQUIRE(std::abs(glm::length(glm::vec3(e[5], e[6], e[7])) - 1.0f) < 0.0001f);
+        }
+    };
+
+    // The two vertices on the shared edge are split when the quads are in different smoothing groups.
+    auto smooth = convert("");
+    requireUnitNormals(*smooth);
+    REQUIRE(6 == smooth->mesh().vertexCount());
+
+    auto hard = convert("s 2\n");
+    requireUnitNormals(*hard);
+    REQUIRE(8 == hard->mesh().vertexCount());
+
+    // The crease angle also splits the edge, since the quads meet at 45 degrees.
+    options.creaseAngle = 30.0f;
+    REQUIRE(8 == convert("")->mesh().vertexCount());
+
+    // Without options the normals are left as zero.
+    ObjModelParser parser;
+    auto objModel = parser.parse(Positions + Faces.substr(0, Faces.find("{s}")));
+    auto model = ObjResourceLoader::convert(*objModel, materials);
+
+    REQUIRE(0.0f == static_cast<const vertex_ptn_t *>(model->mesh().rawVertexBufferData())[0].elements[7]);
+}
+
+TEST_CASE("F_Splits_Quad_Into_Two_Triangles", "[content][ObjMaterialParser]")
+{
+    ObjModelParser parser;
+    auto model = parser.parse(
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvt 0 0\nvn 0 0 1\n"
+        "f 1/1/1 2/1/1 3/1/1 4/1/1\n");
+
+    REQUIRE(2 == model->groups[0].faces.size());
+    REQUIRE(obj_face_t{ {1, 2, 3}, {1, 1, 1}, {1, 1, 1} } == model->groups[0].faces[0]);
+    REQUIRE(obj_face_t{ {1, 3, 4}, {1, 1, 1}, {1, 1, 1} } == model->groups[0].faces[1]);
+}
+
+TEST_CASE("F_Splits_Polygon_Into_Fan_Of_Triangles", "[content][ObjMaterialParser]")
+{
+    ObjModelParser parser;
+    auto model = parser.parse(
+        "v 0 0 0\nv 1 0 0\nv 2 1 0\nv 1 2 0\nv 0 1 0\n"
+        "f 1 2 3 4 5\nf -1 -2 -3\n");
+
+    REQUIRE(4 == model->groups[0].faces.size());
+    REQUIRE(obj_face_t{ {1, 2, 3}, {0, 0, 0}, {0, 0, 0} } == model->groups[0].faces[0]);
+    REQUIRE(obj_face_t{ {1, 3, 4}, {0, 0, 0}, {0, 0, 0} } == model->groups[0].faces[1]);
+    REQUIRE(obj_face_t{ {1, 4, 5}, {0, 0, 0}, {0, 0, 0} } == model->groups[0].faces[2]);
+    REQUIRE(obj_face_t{ {5, 4, 3}, {0, 0, 0}, {0, 0, 0} } == model->groups[0].faces[3]);
+}
+
+TEST_CASE("F_Throws_Exception_If_Polygon_Element_Layout_Inconsistent", "[content][ObjMaterialParser]")
+{
+    REQUIRE_THROWS_MATCHES(
+        [] { ObjModelParser p; p.parse("v 0 0 0\nvt 0 0\nf 1/1 1/1 1/1 1\n"); }(),
+        ObjModelException,
+        ContainsExceptionMessage<ObjModelException>("Face elements have inconsistent data layout"));
+}
+
+TEST_CASE("F_Ear_Clipping_Triangulates_Concave_Polygon", "[content][ObjMaterialParser]")
+{
+    // Chevron with a reflex corner at 4. A fan from corner 1 produces a flipped triangle for this polygon.
+    ObjModelParser parser;
+    parser.setTriangulation(ObjTriangulation::EarClipping);
+
+    auto model = parser.parse("v 0 0 0\nv 2 1 0\nv 0 2 0\nv 1 1 0\nf 1 2 3 4\n");
+    const auto& faces = model->groups[0].faces;
+
+    REQUIRE(2 == faces.size());
+
+    float totalArea = 0.0f;
+
+    for (const auto& face : faces)
+    {
+        auto a = model->positions[face.position[0] - 1];
+        auto b = model->positions[face.position[1] - 1];
+        auto c = model->positions[face.position[2] - 1];
+        auto area = 0.5f * ((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y));
+
+        REQUIRE(area > 0.0f);
+        totalArea += area;
+    }
+
+    REQUIRE(Approx(1.0f) == totalArea);
+}
+
+TEST_CASE("Ear_Clipping_Matches_Across_Serial_And_Parallel_Parse", "[content][ObjMaterialParser]")
+{
+    const std::string ObjData =
+        "v 0 0 0\nv 2 1 0\nv 0 2 0\nv 1 1 0\n"
+        "f 1 2 3\n"
+        "g second\n"
+        "v 5 5 5\n"
+        "f 1 2 3 4\n"
+        "f -1 -2 -3 -4 -5\n";
+
+    ObjModelParser serialParser;
+    serialParser.setMaxWorkerCount(1);
+    serialParser.setTriangulation(ObjTriangulation::EarClipping);
+
+    ObjModelParser parallelParser;
+    parallelParser.setMaxWorkerCount(4);
+    parallelParser.setMinChunkSize(16);
+    parallelParser.setTriangulation(ObjTriangulation::EarClipping);
+
+    auto expected = serialParser.parse(ObjData);
+    auto actual = parallelParser.parse(ObjData);
+
+    REQUIRE(expected->groups.size() == actual->groups.size());
+
+    for (size_t i = 0; i < expected->groups.size(); ++i)
+    {
+        REQUIRE(expected->groups[i].faces == actual->groups[i].faces);
+    }
+}
+
+TEST_CASE("Stream_Parse_Throws_Exception_With_Ear_Clipping", "[content][ObjMaterialParser]")
+{
+    // Ear clipping needs every earlier position, which streaming does not keep.
+    std::istringstream stream("v 0 0 0\nv 2 1 0\nv 0 2 0\nv 1 1 0\nf 1 2 3 4\n");
+    RecordingObjModelVisitor visitor;
+
+    ObjModelParser parser;
+    parser.setTriangulation(ObjTriangulation::EarClipping);
+
+    REQUIRE_THROWS_MATCHES(
+        parser.parseStream(stream, visitor),
+        DaybreakEngineException,
+        ContainsExceptionMessage<DaybreakEngineException>("cannot be streamed with ear clipping"));
+    REQUIRE(visitor.model.positions.empty());
+
+    // Fan triangulation still streams.
+    parser.setTriangulation(ObjTriangulation::Fan);
+    parser.parseStream(stream, visitor);
+
+    REQUIRE(4 == visitor.model.positions.size());
+    REQUIRE(2 == visitor.model.groups[0].faces.size());
+}
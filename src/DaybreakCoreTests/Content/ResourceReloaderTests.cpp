@@ -0,0 +1,215 @@
+#include "stdafx.h"
+#include "Content/ResourceReloader.h"
+#include "Content/ResourcesManager.h"
+#include "Content/DefaultFileSystem.h"
+#include "Content/Models/ModelData.h"
+#include "Content/Materials/MaterialData.h"
+#include "Common/Error.h"
+#include "Utility/ParallelFor.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "ContentTestHelpers.h"
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /** Call update until a resource has been reloaded a number of times, or give up after a few seconds. */
+    template<typename TResource>
+    void updateUntilReloaded(
+        ResourceReloader& reloader,
+        const ReloadableResource<TResource>& resource,
+        unsigned int reloadCount)
+    {
+        for (int i = 0; i < 500 && resource.reloadCount() < reloadCount; ++i)
+        {
+            reloader.update();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        REQUIRE(reloadCount == resource.reloadCount());
+    }
+
+    /** Load a text file as a reloadable resource. Files that start with "bad" fail to load. */
+    std::shared_ptr<ReloadableResource<std::string>> loadText(ResourceReloader& reloader, const std::string& path)
+    {
+        return reloader.load<std::string>(
+            [path](ResourcesManager& resources) { return resources.loadTextFile(path); },
+            [](std::string&& text, ResourcesManager&) {
+                if (text.compare(0, 3, "bad") == 0)
+                {
+                    throw DaybreakDataException("Bad text");
+                }
+
+                return std::make_unique<std::string>(std::move(text));
+            });
+    }
+}
+
+TEST_CASE("Resource_Reloader_Reloads_Only_Changed_Resources", "[content][ResourceReloader]")
+{
+    TempDirectory directory("daybreak_reloader_text");
+    const auto firstPath = directory.write("first.txt", "first");
+    const auto secondPath = directory.write("second.txt", "second");
+
+    ResourceReloader reloader(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+
+    auto first = loadText(reloader, firstPath);
+    auto second = loadText(reloader, secondPath);
+
+    REQUIRE("first" == *first->get());
+    REQUIRE("second" == *second->get());
+    REQUIRE(0 == reloader.update());
+
+    // The resource only changes in update, after the reload finished.
+    const auto oldFirst = first->get();
+    directory.write("first.txt", "first changed");
+    updateUntilReloaded(reloader, *first, 1);
+
+    REQUIRE("first changed" == *first->get());
+    REQUIRE("first" == *oldFirst);
+    REQUIRE(0 == second->reloadCount());
+    REQUIRE("second" == *second->get());
+
+    // A failed reload keeps the old resource, and fixing the file reloads it.
+    directory.write("second.txt", "bad second");
+
+    for (int i = 0; i < 500 && second->reloadError().empty(); ++i)
+    {
+        reloader.update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    REQUIRE("Bad text" == second->reloadError());
+    REQUIRE("second" == *second->get());
+
+    directory.write("second.txt", "second fixed");
+    updateUntilReloaded(reloader, *second, 1);
+
+    REQUIRE(second->reloadError().empty());
+    REQUIRE("second fixed" == *second->get());
+    REQUIRE(1 == first->reloadCount());
+}
+
+TEST_CASE("Resource_Reloader_Reloads_Model_When_Material_Changes", "[content][ResourceReloader]")
+{
+    TempDirectory directory("daybreak_reloader_model");
+    const auto mtlPath = directory.write("cube.mtl", "newmtl red\nKd 1 0 0\n");
+
+    const auto objPath = directory.write(
+        "cube.obj",
+        "mtllib " + mtlPath + "\n"
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nvt 0 0\nvt 1 0\nvt 1 1\nvn 0 0 1\n"
+        "g front\nusemtl red\nf 1/1/1 2/2/1 3/3/1\n");
+
+    ResourceReloader reloader(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+
+    ResourcesManager::model_load_options_t options;
+    options.cookedModelCache = true;
+    reloader.resources().setModelLoadOptions(options);
+
+    auto model = reloader.loadModel(objPath);
+
+    auto diffuseColor = [&]() {
+        return model->get()->group(0).materialRef().getVector3Parameter(MaterialParameterType::DiffuseColor);
+    };
+
+    REQUIRE(glm::vec3(1, 0, 0) == diffuseColor());
+
+    directory.write("cube.mtl", "newmtl red\nKd 0 1 0\n");
+    updateUntilReloaded(reloader, *model, 1);
+
+    REQUIRE(glm::vec3(0, 1, 0) == diffuseColor());
+
+    // Writing the cooked model cache while loading does not reload the model again.
+    for (int i = 0; i < 10; ++i)
+    {
+        REQUIRE(0 == reloader.update());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    REQUIRE(1 == model->reloadCount());
+}
+
+TEST_CASE("Resource_Reloader_Keeps_Dependencies_Of_Overlapping_Loads_Separate", "[content][ResourceReloader]")
+{
+    TempDirectory directory("daybreak_reloader_overlapping");
+    const auto sharedPath = directory.write("shared.txt", "shared");
+    const auto firstPath = directory.write("first.txt", "first");
+    const auto secondPath = directory.write("second.txt", "second");
+
+    ResourceReloader reloader(std::make_shared<NullDeviceContext>(), std::make_shared<DefaultFileSystem>(""));
+
+    // Once overlapCount is set, reads wait for each other before and after reading their files so the reads of both
+    // loads happen while both are loading.
+    std::atomic<int> overlapCount = 0;
+    std::atomic<int> startedCount = 0;
+    std::atomic<int> finishedCount = 0;
+
+    auto waitForOtherLoad = [&](std::atomic<int>& count) {
+        count++;
+
+        for (int i = 0; i < 2000 && count < overlapCount; ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+
+    // Each load reads the shared file and its own file on parallelFor workers.
+    auto loadPair = [&](const std::string& path) {
+        return reloader.load<std::string>(
+            [&, path](ResourcesManager& resources) {
+                waitForOtherLoad(startedCount);
+
+                const std::string paths[] = { sharedPath, path };
+                std::string texts[2];
+
+                parallelFor(2, 2, [&](size_t i) { texts[i] = resources.loadTextFile(paths[i]); });
+                waitForOtherLoad(finishedCount);
+
+                return texts[0] + " " + texts[1];
+            },
+            [](std::string&& text, ResourcesManager&) { return std::make_unique<std::string>(std::move(text)); });
+    };
+
+    auto first = loadPair(firstPath);
+    auto second = loadPair(secondPath);
+
+    // Changing the shared file reloads both resources at the same time.
+    startedCount = 0;
+    finishedCount = 0;
+    overlapCount = 2;
+    directory.write("shared.txt", "shared changed");
+
+    for (int i = 0; i < 500 && (first->reloadCount() < 1 || second->reloadCount() < 1); ++i)
+    {
+        reloader.update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    REQUIRE(2 == startedCount);
+    REQUIRE("shared changed first" == *first->get());
+    REQUIRE("shared changed second" == *second->get());
+
+    // Neither load recorded the other's file, so changing one only reloads the resource that read it.
+    overlapCount = 0;
+    directory.write("first.txt", "first changed");
+    updateUntilReloaded(reloader, *first, 2);
+
+    directory.write("second.txt", "second changed");
+    updateUntilReloaded(reloader, *second, 2);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        reloader.update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    REQUIRE(2 == first->reloadCount());
+    REQUIRE(2 == second->reloadCount());
+    REQUIRE("shared changed first changed" == *first->get());
+}
@@ -145,3 +145,22 @@ TEST_CASE("Input_Layout_Finds_Attribute_By_Semantic_Name_And_Index", "[graphics]
     REQUIRE(attributes[0] == d.getAttributeByName(InputAttribute::SemanticName::Position, 1));
     REQUIRE(attributes[1] == d.getAttributeByName(InputAttribute::SemanticName::Texture, 0));
 }
+
+TEST_CASE("Input_Layout_Stores_Packed_And_Normalized_Attributes", "[graphics][inputlayout]")
+{
+    InputLayoutDescription d;
+
+    d.addAttribute(InputAttribute::SemanticName::Position, 0, InputAttribute::StorageType::UnsignedShort, 4, true);
+    d.addAttribute(InputAttribute::SemanticName::Normal, 0, InputAttribute::StorageType::PackedInt2101010, 4, true);
+    REQUIRE(12 == (int)d.elementSizeInBytes());
+    REQUIRE(8 == (int)d.attributeOffsetByIndex(1));
+
+    REQUIRE(d.getAttributeByIndex(0).normalized());
+    REQUIRE_FALSE(
+        InputAttribute(InputAttribute::SemanticName::Position, 0, InputAttribute::StorageType::UnsignedShort, 4) ==
+        d.getAttributeByIndex(0));
+
+    REQUIRE_THROWS_AS(
+        d.addAttribute(InputAttribute::SemanticName::None, 0, InputAttribute::StorageType::PackedInt2101010, 3),
+        RuntimeCheckException);
+}
@@ -0,0 +1,245 @@
+#include "stdafx.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/Mesh/VertexFormat.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/InputLayoutDescription.h"
+#include "Content/Models/ModelData.h"
+#include "Content/Materials/MaterialData.h"
+
+#include "../../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /** Create a model with a strip of triangles over vertexCount vertices, split into two groups. */
+    std::unique_ptr<ModelData> createStripModel(uint32_t vertexCount)
+    {
+        std::vector<uint32_t> indices;
+
+        for (uint32_t v = 0; v + 2 < vertexCount; ++v)
+        {
+            indices.insert(indices.end(), { v, v + 1, v + 2 });
+        }
+
+        std::unique_ptr<uint32_t[]> indexCopy(new uint32_t[indices.size()]);
+        std::copy(indices.begin(), indices.end(), indexCopy.get());
+
+        auto model = std::make_unique<ModelData>(std::make_unique<MeshData>(
+            std::make_unique<IndexBufferData>(indices.size(), std::move(indexCopy)),
+            std::make_unique<VertexBufferData>(
+                vertexCount,
+                std::unique_ptr<vertex_ptn_t[]>(new vertex_ptn_t[vertexCount]),
+                vertex_ptn_t::inputLayout)));
+
+        auto material = std::make_shared<MaterialData>("material", MaterialType::Traditional);
+        const auto half = (indices.size() / 6) * 3;
+
+        model->addGroup(ModelData::Group("first", material, 0, half));
+        model->addGroup(ModelData::Group("second", material, half, indices.size() - half));
+
+        return model;
+    }
+}
+
+TEST_CASE("Narrowest_Index_Element_Type_Depends_On_Largest_Index", "[graphics][IndexCompaction]")
+{
+    REQUIRE(IndexElementType::UnsignedByte == narrowestIndexElementType(0));
+    REQUIRE(IndexElementType::UnsignedByte == narrowestIndexElementType(255));
+    REQUIRE(IndexElementType::UnsignedShort == narrowestIndexElementType(256));
+    REQUIRE(IndexElementType::UnsignedShort == narrowestIndexElementType(65535));
+    REQUIRE(IndexElementType::UnsignedInt == narrowestIndexElementType(65536));
+}
+
+TEST_CASE("Compact_Index_Buffer_Uses_Narrowest_Type_And_Keeps_Values", "[graphics][IndexCompaction]")
+{
+    const uint32_t byteIndices[] = { 0, 1, 255 };
+    auto byteBuffer = createCompactIndexBuffer(byteIndices, 3);
+
+    REQUIRE(IndexElementType::UnsignedByte == byteBuffer->elementType());
+    REQUIRE(3 == byteBuffer->indexCount());
+    REQUIRE(255 == static_cast<const uint8_t *>(byteBuffer->bytes())[2]);
+
+    const uint32_t shortIndices[] = { 0, 300, 65535 };
+    auto shortBuffer = createCompactIndexBuffer(shortIndices, 3);
+
+    REQUIRE(IndexElementType::UnsignedShort == shortBuffer->elementType());
+    REQUIRE(3 == shortBuffer->indexCount());
+    REQUIRE(300 == static_cast<const uint16_t *>(shortBuffer->bytes())[1]);
+    REQUIRE(65535 == static_cast<const uint16_t *>(shortBuffer->bytes())[2]);
+
+    const uint32_t intIndices[] = { 70000, 1, 2 };
+    auto intBuffer = createCompactIndexBuffer(intIndices, 3);
+
+    REQUIRE(IndexElementType::UnsignedInt == intBuffer->elementType());
+    REQUIRE(70000 == static_cast<const uint32_t *>(intBuffer->bytes())[0]);
+}
+
+TEST_CASE("Compact_Index_Buffer_Moves_Indices_That_Need_32_Bits", "[graphics][IndexCompaction]")
+{
+    std::vector<uint32_t> intIndices = { 70000, 1, 2 };
+    const auto * intData = intIndices.data();
+    auto intBuffer = createCompactIndexBuffer(std::move(intIndices));
+
+    REQUIRE(IndexElementType::UnsignedInt == intBuffer->elementType());
+    REQUIRE(intData == intBuffer->bytes());
+    REQUIRE(70000 == static_cast<const uint32_t *>(intBuffer->bytes())[0]);
+
+    // Narrower indices are copied, and the wide ones are released straight away.
+    std::vector<uint32_t> shortIndices = { 0, 300, 2 };
+    auto shortBuffer = createCompactIndexBuffer(std::move(shortIndices));
+
+    REQUIRE(IndexElementType::UnsignedShort == shortBuffer->elementType());
+    REQUIRE(300 == static_cast<const uint16_t *>(shortBuffer->bytes())[1]);
+    REQUIRE(0 == shortIndices.capacity());
+}
+
+TEST_CASE("Split_Index_Range_Limits_Vertex_Span_Of_Each_Sub_Range", "[graphics][IndexCompaction]")
+{
+    const uint32_t indices[] = { 0, 1, 2, 5, 6, 7, 12, 13, 14, 3, 4, 5 };
+    std::vector<index_sub_range_t> subRanges;
+
+    REQUIRE(trySplitIndexRange(indices, 0, 12, subRanges, 10));
+    REQUIRE(3 == subRanges.size());
+
+    REQUIRE(0 == subRanges[0].indexOffset);
+    REQUIRE(6 == subRanges[0].indexCount);
+    REQUIRE(0 == subRanges[0].baseVertex);
+
+    REQUIRE(6 == subRanges[1].indexOffset);
+    REQUIRE(3 == subRanges[1].indexCount);
+    REQUIRE(12 == subRanges[1].baseVertex);
+
+    REQUIRE(9 == subRanges[2].indexOffset);
+    REQUIRE(3 == subRanges[2].indexCount);
+    REQUIRE(3 == subRanges[2].baseVertex);
+
+    // A range that already fits is not split.
+    subRanges.clear();
+    REQUIRE(trySplitIndexRange(indices, 0, 12, subRanges));
+    REQUIRE(1 == subRanges.size());
+    REQUIRE(12 == subRanges[0].indexCount);
+
+    // A triangle that spans too many vertices can not be split.
+    const uint32_t wideTriangle[] = { 0, 1, 20 };
+    subRanges.clear();
+    REQUIRE_FALSE(trySplitIndexRange(wideTriangle, 0, 3, subRanges, 10));
+}
+
+TEST_CASE("Split_Index_Runs_Keeps_Every_Run_Whole", "[graphics][IndexCompaction]")
+{
+    const uint32_t indices[] = { 0, 1, 2, 5, 6, 7, 12, 13, 14, 3, 4, 5 };
+    std::vector<index_sub_range_t> subRanges;
+
+    // The second run could share a sub-range with the first triangle, but not while it holds the third triangle too.
+    REQUIRE(trySplitIndexRuns(indices, { { 0, 3 }, { 3, 6 }, { 9, 3 } }, subRanges, 10));
+    REQUIRE(3 == subRanges.size());
+
+    REQUIRE(0 == subRanges[0].indexOffset);
+    REQUIRE(3 == subRanges[0].indexCount);
+    REQUIRE(0 == subRanges[0].baseVertex);
+
+    REQUIRE(3 == subRanges[1].indexOffset);
+    REQUIRE(6 == subRanges[1].indexCount);
+    REQUIRE(5 == subRanges[1].baseVertex);
+
+    REQUIRE(9 == subRanges[2].indexOffset);
+    REQUIRE(3 == subRanges[2].indexCount);
+    REQUIRE(3 == subRanges[2].baseVertex);
+
+    // A run that spans too many vertices can not be split.
+    subRanges.clear();
+    REQUIRE_FALSE(trySplitIndexRuns(indices, { { 0, 12 } }, subRanges, 10));
+}
+
+TEST_CASE("Narrow_Indices_Uses_Narrowest_Type_For_Small_Models", "[graphics][IndexCompaction]")
+{
+    auto model = createStripModel(200);
+    const auto expected = readIndices(model->mesh());
+
+    model->narrowIndices(true);
+
+    REQUIRE(IndexElementType::UnsignedByte == model->mesh().indexElementType());
+    REQUIRE(expected == readIndices(model->mesh()));
+    REQUIRE(2 == model->groupCount());
+    REQUIRE(0 == model->group(1).baseVertex());
+}
+
+TEST_CASE("Narrow_Indices_Splits_Large_Models_Into_Base_Vertex_Groups", "[graphics][IndexCompaction]")
+{
+    const uint32_t VertexCount = 150000;
+    auto model = createStripModel(VertexCount);
+    const auto expected = readIndices(model->mesh());
+
+    SECTION("Without splitting")
+    {
+        model->narrowIndices(false);
+
+        REQUIRE(IndexElementType::UnsignedInt == model->mesh().indexElementType());
+        REQUIRE(2 == model->groupCount());
+    }
+
+    SECTION("With splitting")
+    {
+        model->narrowIndices(true);
+
+        REQUIRE(IndexElementType::UnsignedShort == model->mesh().indexElementType());
+        REQUIRE(expected.size() == model->mesh().indexCount());
+        REQUIRE(model->groupCount() > 2);
+
+        // Every split group draws the same vertices as before, and the groups still cover the index buffer in order.
+        auto indices = readIndices(model->mesh());
+        size_t nextIndex = 0;
+
+        for (const auto& group : model->groups())
+        {
+            REQUIRE(nextIndex == group.indexOffset());
+            REQUIRE((group.name() == "first" || group.name() == "second"));
+
+            for (auto i = group.indexOffset(); i < group.indexOffset() + group.indexCount(); ++i)
+            {
+                REQUIRE(expected[i] == indices[i] + group.baseVertex());
+            }
+
+            nextIndex += group.indexCount();
+        }
+
+        REQUIRE(expected.size() == nextIndex);
+    }
+
+    SECTION("With meshlets")
+    {
+        model->buildMeshlets();
+
+        size_t meshletCount = 0;
+
+        for (const auto& group : model->groups())
+        {
+            meshletCount += group.meshlets().size();
+        }
+
+        model->narrowIndices(true);
+
+        REQUIRE(IndexElementType::UnsignedShort == model->mesh().indexElementType());
+        REQUIRE(model->groupCount() > 2);
+
+        // Groups are split between meshlets, so every part is covered by the meshlets it keeps.
+        size_t splitMeshletCount = 0;
+
+        for (const auto& group : model->groups())
+        {
+            const auto& meshlets = group.meshlets();
+
+            REQUIRE_FALSE(meshlets.empty());
+            REQUIRE(group.indexOffset() == meshlets.front().indexOffset);
+            REQUIRE(group.indexOffset() + group.indexCount() ==
+                meshlets.back().indexOffset + meshlets.back().indexCount);
+
+            splitMeshletCount += meshlets.size();
+        }
+
+        REQUIRE(meshletCount == splitMeshletCount);
+    }
+}
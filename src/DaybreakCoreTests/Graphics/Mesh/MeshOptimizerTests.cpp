@@ -0,0 +1,188 @@
+#include "stdafx.h"
+#include "Graphics/Mesh/MeshOptimizer.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/Mesh/VertexFormat.h"
+#include "Graphics/InputLayoutDescription.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+
+#include "MeshTestHelpers.h"
+#include "../../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /** Generate the triangles of a flat grid of cellsPerSide * cellsPerSide quads, in random order. */
+    std::vector<uint32_t> generateShuffledGrid(uint32_t cellsPerSide)
+    {
+        const auto grid = createGridIndices(cellsPerSide);
+        std::vector<triangle_t> triangles;
+
+        for (size_t i = 0; i < grid.size(); i += 3)
+        {
+            triangles.push_back({ grid[i], grid[i + 1], grid[i + 2] });
+        }
+
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1234));
+
+        std::vector<uint32_t> indices;
+
+        for (const auto& triangle : triangles)
+        {
+            indices.insert(indices.end(), triangle.begin(), triangle.end());
+        }
+
+        return indices;
+    }
+
+    /** Get the sorted triangles in a range of a mesh with vertex indices replaced by vertex positions. */
+    std::vector<std::array<float, 9>> trianglePositions(const MeshData& mesh, size_t indexOffset, size_t indexCount)
+    {
+        auto indices = readIndices(mesh);
+        auto vertices = static_cast<const vertex_ptn_t *>(mesh.rawVertexBufferData());
+        std::vector<std::array<float, 9>> triangles;
+
+        for (auto i = indexOffset; i < indexOffset + indexCount; i += 3)
+        {
+            std::array<float, 9> t;
+
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const auto& v = vertices[indices[i + k]];
+                t[k * 3 + 0] = v.elements[0];
+                t[k * 3 + 1] = v.elements[1];
+                t[k * 3 + 2] = v.elements[2];
+            }
+
+            triangles.push_back(t);
+        }
+
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    /** Create a mesh of a flat grid with positions, uvs and normals that draws the given triangles. */
+    std::unique_ptr<MeshData> createFloorMesh(const std::vector<uint32_t>& indices, uint32_t cellsPerSide)
+    {
+        // Rows run along x and columns along z, so the triangles face +y like the normals.
+        return createGridMesh(cellsPerSide, [](uint32_t column, uint32_t row) {
+            const auto x = static_cast<float>(row);
+            const auto z = static_cast<float>(column);
+
+            return vertex_ptn_t(x, 0.0f, z, x, z, 0.0f, 1.0f, 0.0f);
+        }, indices);
+    }
+}
+
+TEST_CASE("Analyze_Vertex_Cache_Counts_Fifo_Cache_Misses", "[graphics][MeshOptimizer]")
+{
+    // Two triangles sharing an edge transform four vertices.
+    const uint32_t quad[] = { 0, 1, 2, 2, 1, 3 };
+    auto statistics = analyzeVertexCache(quad, 6, 4);
+
+    REQUIRE(2 == statistics.triangleCount);
+    REQUIRE(4 == statistics.vertexCount);
+    REQUIRE(4 == statistics.transformedCount);
+    REQUIRE(2.0f == statistics.acmr());
+    REQUIRE(1.0f == statistics.atvr());
+
+    // With a three entry cache 0, 1 and 2 are evicted by 3, 4 and 5 before they are used again.
+    const uint32_t fan[] = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+    statistics = analyzeVertexCache(fan, 9, 6, 3);
+
+    REQUIRE(3 == statistics.triangleCount);
+    REQUIRE(6 == statistics.vertexCount);
+    REQUIRE(9 == statistics.transformedCount);
+
+    // A six entry cache keeps every vertex.
+    statistics = analyzeVertexCache(fan, 9, 6, 6);
+    REQUIRE(6 == statistics.transformedCount);
+    REQUIRE(2.0f == statistics.acmr());
+}
+
+TEST_CASE("Optimize_Vertex_Cache_Keeps_Triangles_And_Lowers_Acmr", "[graphics][MeshOptimizer]")
+{
+    auto indices = generateShuffledGrid(32);
+    const auto vertexCount = size_t(33 * 33);
+    const auto before = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+    const auto expectedTriangles = sortedTriangles(indices.data(), indices.size());
+
+    optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+    const auto after = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+    REQUIRE(expectedTriangles == sortedTriangles(indices.data(), indices.size()));
+    REQUIRE(before.acmr() > 2.0f);
+    REQUIRE(after.acmr() < 1.0f);
+}
+
+TEST_CASE("Optimize_Overdraw_Keeps_Triangles_And_Cache_Efficiency", "[graphics][MeshOptimizer]")
+{
+    auto indices = generateShuffledGrid(32);
+    auto mesh = createFloorMesh(indices, 32);
+    const auto vertexCount = mesh->vertexCount();
+    const auto expectedTriangles = sortedTriangles(indices.data(), indices.size());
+
+    optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+    const auto cacheOptimized = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+    optimizeOverdraw(
+        indices.data(),
+        indices.size(),
+        mesh->rawVertexBufferData(),
+        vertexCount,
+        sizeof(vertex_ptn_t),
+        1.05f);
+
+    const auto overdrawOptimized = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+
+    REQUIRE(expectedTriangles == sortedTriangles(indices.data(), indices.size()));
+    REQUIRE(overdrawOptimized.acmr() <= cacheOptimized.acmr() * 1.05f + 0.001f);
+}
+
+TEST_CASE("Optimize_Vertex_Fetch_Orders_Vertices_By_First_Use", "[graphics][MeshOptimizer]")
+{
+    const uint32_t vertices[] = { 10, 11, 12, 13, 14 };
+    uint32_t indices[] = { 3, 1, 4, 4, 1, 3 };
+    uint32_t output[5] = {};
+
+    const auto count = optimizeVertexFetch(output, vertices, 5, sizeof(uint32_t), indices, 6);
+
+    // Vertices 0 and 2 are not used and are dropped.
+    REQUIRE(3 == count);
+    REQUIRE(13 == output[0]);
+    REQUIRE(11 == output[1]);
+    REQUIRE(14 == output[2]);
+
+    const uint32_t expectedIndices[] = { 0, 1, 2, 2, 1, 0 };
+    REQUIRE(std::equal(std::begin(expectedIndices), std::end(expectedIndices), std::begin(indices)));
+}
+
+TEST_CASE("Optimize_Mesh_Only_Reorders_Triangles_Within_Ranges", "[graphics][MeshOptimizer]")
+{
+    auto indices = generateShuffledGrid(16);
+    auto mesh = createFloorMesh(indices, 16);
+    const auto half = indices.size() / 2;
+
+    auto optimized = optimizeMesh(*mesh, { { 0, half }, { half, indices.size() - half } });
+
+    REQUIRE(IndexElementType::UnsignedShort == optimized->indexElementType());
+    REQUIRE(mesh->indexCount() == optimized->indexCount());
+    REQUIRE(mesh->vertexCount() == optimized->vertexCount());
+    REQUIRE(&mesh->vertexElementTypeRef() == &optimized->vertexElementTypeRef());
+
+    // Each range draws the same triangles as before.
+    for (auto range : { std::make_pair(size_t(0), half), std::make_pair(half, indices.size() - half) })
+    {
+        REQUIRE(
+            trianglePositions(*mesh, range.first, range.second) ==
+            trianglePositions(*optimized, range.first, range.second));
+    }
+
+    REQUIRE(analyzeVertexCache(*optimized).acmr() < analyzeVertexCache(*mesh).acmr());
+}
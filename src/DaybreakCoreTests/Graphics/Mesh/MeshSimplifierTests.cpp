@@ -0,0 +1,331 @@
+#include "stdafx.h"
+#include "Graphics/Mesh/MeshSimplifier.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/Mesh/VertexFormat.h"
+#include "Content/Models/ModelData.h"
+#include "Content/Materials/MaterialData.h"
+
+#include <cmath>
+#include <set>
+#include <glm/glm.hpp>
+
+#include "MeshTestHelpers.h"
+#include "../../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /**
+     * Create a grid of cellsPerSide * cellsPerSide quads in the xy plane from (0, 0) to (1, 1), with heights from
+     * the height function. When seamColumn is not zero the vertices on that column are duplicated so the columns
+     * left and right of it use different vertices, like a texture seam.
+     */
+    std::unique_ptr<MeshData> createGrid(
+        uint32_t cellsPerSide,
+        uint32_t seamColumn = 0,
+        float (*height)(float, float) = nullptr)
+    {
+        const auto verticesPerSide = cellsPerSide + 1;
+        const auto gridVertexCount = verticesPerSide * verticesPerSide;
+        const auto vertexCount = gridVertexCount + (seamColumn != 0 ? verticesPerSide : 0);
+
+        std::unique_ptr<vertex_ptn_t[]> vertices(new vertex_ptn_t[vertexCount]);
+
+        for (uint32_t y = 0; y < verticesPerSide; ++y)
+        {
+            for (uint32_t x = 0; x < verticesPerSide; ++x)
+            {
+                const auto px = static_cast<float>(x) / cellsPerSide;
+                const auto py = static_cast<float>(y) / cellsPerSide;
+                const auto pz = (height != nullptr ? height(px, py) : 0.0f);
+
+                vertices[y * verticesPerSide + x] = vertex_ptn_t(px, py, pz, px, py, 0.0f, 0.0f, 1.0f);
+
+                if (seamColumn != 0 && x == seamColumn)
+                {
+                    vertices[gridVertexCount + y] = vertex_ptn_t(px, py, pz, 1.0f - px, py, 0.0f, 0.0f, 1.0f);
+                }
+            }
+        }
+
+        std::vector<uint32_t> indices;
+
+        for (uint32_t y = 0; y < cellsPerSide; ++y)
+        {
+            for (uint32_t x = 0; x < cellsPerSide; ++x)
+            {
+                auto vertex = [&](uint32_t vx, uint32_t vy) {
+                    return (seamColumn != 0 && vx == seamColumn && x == seamColumn) ?
+                        gridVertexCount + vy :
+                        vy * verticesPerSide + vx;
+                };
+
+                const auto a = vertex(x, y);
+                const auto b = vertex(x + 1, y);
+                const auto c = vertex(x, y + 1);
+                const auto d = vertex(x + 1, y + 1);
+
+                indices.insert(indices.end(), { a, b, d, a, d, c });
+            }
+        }
+
+        return createMesh(std::move(vertices), vertexCount, indices);
+    }
+
+    /** Get the total area of the triangles in a triangle list projected onto the xy plane. */
+    float projectedArea(const MeshData& mesh, const uint32_t * indices, size_t indexCount)
+    {
+        float area = 0.0f;
+
+        for (size_t i = 0; i < indexCount; i += 3)
+        {
+            const auto a = positionOf(mesh, indices[i]);
+            const auto b = positionOf(mesh, indices[i + 1]);
+            const auto c = positionOf(mesh, indices[i + 2]);
+
+            area += 0.5f * ((b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y));
+        }
+
+        return area;
+    }
+
+    /** Simplify all of a mesh's triangles. */
+    std::vector<uint32_t> simplify(
+        const MeshData& mesh,
+        size_t targetIndexCount,
+        float maxError = std::numeric_limits<float>::max(),
+        const std::vector<bool> * lockedVertices = nullptr,
+        float * resultError = nullptr)
+    {
+        const auto indices = readIndices(mesh);
+        std::vector<uint32_t> simplified(indices.size());
+
+        simplified.resize(simplifyIndices(
+            simplified.data(),
+            indices.data(),
+            indices.size(),
+            mesh.rawVertexBufferData(),
+            mesh.vertexCount(),
+            mesh.vertexElementSizeInBytes(),
+            targetIndexCount,
+            maxError,
+            lockedVertices,
+            resultError));
+
+        return simplified;
+    }
+
+    /** Height of a bumpy surface. */
+    float bumps(float x, float y)
+    {
+        return 0.1f * std::sin(x * 12.0f) * std::cos(y * 9.0f);
+    }
+}
+
+TEST_CASE("Simplify_Flat_Grid_Keeps_Its_Outline", "[graphics][MeshSimplifier]")
+{
+    auto mesh = createGrid(16);
+    float error = -1.0f;
+    auto simplified = simplify(*mesh, 0, 0.0001f, nullptr, &error);
+
+    // A flat grid only needs its corners, because collapses inside the plane or along a straight border are free.
+    REQUIRE(simplified.size() < mesh->indexCount() / 8);
+    REQUIRE(simplified.size() % 3 == 0);
+    REQUIRE(std::abs(projectedArea(*mesh, simplified.data(), simplified.size()) - 1.0f) < 0.0001f);
+    REQUIRE(error < 0.0001f);
+
+    // The corners can not move.
+    std::set<uint32_t> used(simplified.begin(), simplified.end());
+
+    for (uint32_t corner : { 0u, 16u, 17u * 16u, 17u * 17u - 1u })
+    {
+        REQUIRE(used.count(corner) == 1);
+    }
+}
+
+TEST_CASE("Simplify_Stops_At_Target_Index_Count", "[graphics][MeshSimplifier]")
+{
+    auto mesh = createGrid(32, 0, bumps);
+    auto simplified = simplify(*mesh, 600);
+
+    REQUIRE(simplified.size() <= 600);
+    REQUIRE(simplified.size() > 300);
+    REQUIRE(std::abs(projectedArea(*mesh, simplified.data(), simplified.size()) - 1.0f) < 0.0001f);
+}
+
+TEST_CASE("Simplify_Stops_Before_Exceeding_Max_Error", "[graphics][MeshSimplifier]")
+{
+    auto mesh = createGrid(32, 0, bumps);
+
+    float looseError = 0.0f;
+    auto loose = simplify(*mesh, 0, std::numeric_limits<float>::max(), nullptr, &looseError);
+
+    float strictError = 0.0f;
+    auto strict = simplify(*mesh, 0, 0.002f, nullptr, &strictError);
+
+    REQUIRE(strictError <= 0.002f);
+    REQUIRE(looseError > strictError);
+    REQUIRE(strict.size() > loose.size());
+    REQUIRE(strict.size() < mesh->indexCount());
+}
+
+TEST_CASE("Simplify_Keeps_Attribute_Seams", "[graphics][MeshSimplifier]")
+{
+    const uint32_t CellsPerSide = 16;
+    const uint32_t SeamColumn = 6;
+    const uint32_t GridVertexCount = (CellsPerSide + 1) * (CellsPerSide + 1);
+
+    auto mesh = createGrid(CellsPerSide, SeamColumn);
+    auto simplified = simplify(*mesh, 0, 0.0001f);
+
+    REQUIRE(simplified.size() < mesh->indexCount() / 4);
+    REQUIRE(std::abs(projectedArea(*mesh, simplified.data(), simplified.size()) - 1.0f) < 0.0001f);
+
+    // Triangles right of the seam only use the duplicated seam vertices and triangles left of it only use the
+    // original ones, so no triangle stretches texture coordinates across the seam.
+    for (size_t i = 0; i < simplified.size(); i += 3)
+    {
+        bool left = false;
+        bool right = false;
+
+        for (size_t k = 0; k < 3; ++k)
+        {
+            const auto x = positionOf(*mesh, simplified[i + k]).x * CellsPerSide;
+
+            left = left || (x < SeamColumn - 0.5f);
+            right = right || (x > SeamColumn + 0.5f);
+        }
+
+        REQUIRE_FALSE((left && right));
+
+        for (size_t k = 0; k < 3; ++k)
+        {
+            const auto v = simplified[i + k];
+
+            if (std::abs(positionOf(*mesh, v).x * CellsPerSide - SeamColumn) < 0.5f)
+            {
+                REQUIRE((v >= GridVertexCount) == right);
+            }
+        }
+    }
+}
+
+TEST_CASE("Simplify_Never_Moves_Locked_Vertices", "[graphics][MeshSimplifier]")
+{
+    auto mesh = createGrid(16);
+    std::vector<bool> locked(mesh->vertexCount(), false);
+
+    for (uint32_t v = 17 * 8; v < 17 * 9; ++v)
+    {
+        locked[v] = true;
+    }
+
+    auto simplified = simplify(*mesh, 0, std::numeric_limits<float>::max(), &locked);
+    std::set<uint32_t> used(simplified.begin(), simplified.end());
+
+    for (uint32_t v = 17 * 8; v < 17 * 9; ++v)
+    {
+        REQUIRE(used.count(v) == 1);
+    }
+
+    REQUIRE(simplified.size() < mesh->indexCount() / 4);
+}
+
+TEST_CASE("Generate_Lod_Chain_Appends_Levels_With_Increasing_Error", "[graphics][MeshSimplifier]")
+{
+    auto mesh = createGrid(64, 0, bumps);
+    auto indices = readIndices(*mesh);
+    const auto baseIndexCount = indices.size();
+
+    lod_chain_options_t options;
+    options.maxLevelCount = 3;
+
+    auto levels = generateLodChain(*mesh, { { 0, baseIndexCount } }, indices, options);
+
+    REQUIRE(3 == levels.size());
+
+    auto previousOffset = size_t(0);
+    auto previousCount = baseIndexCount;
+    auto previousError = 0.0f;
+
+    for (const auto& level : levels)
+    {
+        REQUIRE(1 == level.indexRanges.size());
+
+        const auto offset = level.indexRanges[0].first;
+        const auto count = level.indexRanges[0].second;
+
+        REQUIRE(offset == previousOffset + previousCount);
+        REQUIRE(count <= previousCount / 2);
+        REQUIRE(count > 0);
+        REQUIRE(level.error > previousError);
+
+        previousOffset = offset;
+        previousCount = count;
+        previousError = level.error;
+    }
+
+    REQUIRE(indices.size() == previousOffset + previousCount);
+}
+
+TEST_CASE("Model_Levels_Of_Detail_Keep_Group_Boundaries", "[graphics][MeshSimplifier]")
+{
+    // Split the grid into two groups along a row, which both groups use.
+    auto model = std::make_unique<ModelData>(createGrid(32));
+    const auto half = model->mesh().indexCount() / 2;
+    auto material = std::make_shared<MaterialData>("material", MaterialType::Traditional);
+
+    model->addGroup(ModelData::Group("bottom", material, 0, half));
+    model->addGroup(ModelData::Group("top", material, half, model->mesh().indexCount() - half));
+
+    const auto baseIndexCount = model->mesh().indexCount();
+    model->generateLevelsOfDetail();
+
+    REQUIRE(model->levelOfDetailCount() > 1);
+
+    const auto indices = readIndices(model->mesh());
+
+    for (size_t l = 0; l < model->levelOfDetailCount(); ++l)
+    {
+        const auto& level = model->levelOfDetail(l);
+        REQUIRE(2 == level.groups().size());
+
+        for (size_t g = 0; g < 2; ++g)
+        {
+            const auto& group = level.groups()[g];
+
+            REQUIRE(group.name() == model->group(g).name());
+            REQUIRE(group.indexOffset() >= baseIndexCount);
+
+            // Every group still covers its half of the grid, and keeps every vertex on the shared row.
+            const auto area = projectedArea(model->mesh(), indices.data() + group.indexOffset(), group.indexCount());
+            REQUIRE(std::abs(area - 0.5f) < 0.0001f);
+
+            std::set<uint32_t> used(
+                indices.begin() + group.indexOffset(),
+                indices.begin() + group.indexOffset() + group.indexCount());
+
+            for (uint32_t v = 33 * 16; v < 33 * 17; ++v)
+            {
+                REQUIRE(used.count(v) == 1);
+            }
+        }
+    }
+
+    // Levels are picked by the largest error allowed.
+    REQUIRE(0 == model->selectLevelOfDetail(-1.0f));
+    REQUIRE(model->levelOfDetailCount() == model->selectLevelOfDetail(1.0f));
+
+    // Generating the levels again replaces them.
+    const auto indexCount = model->mesh().indexCount();
+    const auto levelCount = model->levelOfDetailCount();
+
+    model->generateLevelsOfDetail();
+
+    REQUIRE(indexCount == model->mesh().indexCount());
+    REQUIRE(levelCount == model->levelOfDetailCount());
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/Mesh/VertexFormat.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace Daybreak
+{
+    /** Vertex indices of a triangle. */
+    using triangle_t = std::array<uint32_t, 3>;
+
+    /** Create a mesh from vertices and a triangle list. */
+    inline std::unique_ptr<MeshData> createMesh(
+        std::unique_ptr<vertex_ptn_t[]> vertices,
+        size_t vertexCount,
+        const std::vector<uint32_t>& indices)
+    {
+        std::unique_ptr<uint32_t[]> indexCopy(new uint32_t[indices.size()]);
+        std::copy(indices.begin(), indices.end(), indexCopy.get());
+
+        return std::make_unique<MeshData>(
+            std::make_unique<IndexBufferData>(indices.size(), std::move(indexCopy)),
+            std::make_unique<VertexBufferData>(vertexCount, std::move(vertices), vertex_ptn_t::inputLayout));
+    }
+
+    /**
+     * Get the triangles of a grid of cellsPerSide * cellsPerSide quads, one row after another. The vertex in column x
+     * and row y of the grid is y * (cellsPerSide + 1) + x, and each quad is wound counter clockwise when x points
+     * right and y points up.
+     */
+    inline std::vector<uint32_t> createGridIndices(uint32_t cellsPerSide)
+    {
+        const auto verticesPerSide = cellsPerSide + 1;
+        std::vector<uint32_t> indices;
+
+        for (uint32_t y = 0; y < cellsPerSide; ++y)
+        {
+            for (uint32_t x = 0; x < cellsPerSide; ++x)
+            {
+                const auto a = y * verticesPerSide + x;
+                const auto b = a + 1;
+                const auto c = a + verticesPerSide;
+                const auto d = c + 1;
+
+                indices.insert(indices.end(), { a, b, d, a, d, c });
+            }
+        }
+
+        return indices;
+    }
+
+    /**
+     * Create a mesh with a vertex for every corner of a grid of cellsPerSide * cellsPerSide quads, made by
+     * vertexOf(x, y) from its column and row, that draws the given triangles.
+     */
+    template<typename VertexOf>
+    std::unique_ptr<MeshData> createGridMesh(
+        uint32_t cellsPerSide,
+        VertexOf vertexOf,
+        const std::vector<uint32_t>& indices)
+    {
+        const auto verticesPerSide = cellsPerSide + 1;
+        const auto vertexCount = verticesPerSide * verticesPerSide;
+        std::unique_ptr<vertex_ptn_t[]> vertices(new vertex_ptn_t[vertexCount]);
+
+        for (uint32_t y = 0; y < verticesPerSide; ++y)
+        {
+            for (uint32_t x = 0; x < verticesPerSide; ++x)
+            {
+                vertices[y * verticesPerSide + x] = vertexOf(x, y);
+            }
+        }
+
+        return createMesh(std::move(vertices), vertexCount, indices);
+    }
+
+    /** Create a mesh of a grid of cellsPerSide * cellsPerSide quads with the triangles from createGridIndices. */
+    template<typename VertexOf>
+    std::unique_ptr<MeshData> createGridMesh(uint32_t cellsPerSide, VertexOf vertexOf)
+    {
+        return createGridMesh(cellsPerSide, vertexOf, createGridIndices(cellsPerSide));
+    }
+
+    /** Get the position of a vertex in a mesh whose vertices start with three float positions. */
+    inline glm::vec3 positionOf(const MeshData& mesh, uint32_t v)
+    {
+        const auto vertices = static_cast<const uint8_t *>(mesh.rawVertexBufferData());
+        glm::vec3 position;
+
+        std::memcpy(&position, vertices + v * mesh.vertexElementSizeInBytes(), sizeof(position));
+        return position;
+    }
+
+    /** Get the triangles of a triangle list sorted, with each triangle rotated so its smallest index comes first. */
+    inline std::vector<triangle_t> sortedTriangles(const uint32_t * indices, size_t indexCount)
+    {
+        std::vector<triangle_t> triangles;
+
+        for (size_t i = 0; i < indexCount; i += 3)
+        {
+            triangle_t t = { indices[i], indices[i + 1], indices[i + 2] };
+            std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+            triangles.push_back(t);
+        }
+
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+}
@@ -0,0 +1,228 @@
+#include "stdafx.h"
+#include "Graphics/Mesh/MeshletBuilder.h"
+#include "Graphics/Mesh/MeshOptimizer.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/Mesh/VertexFormat.h"
+#include "Content/Models/ModelData.h"
+#include "Content/Materials/MaterialData.h"
+
+#include <algorithm>
+#include <array>
+#include <set>
+
+#include "MeshTestHelpers.h"
+#include "../../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /** Create a flat grid of cellsPerSide * cellsPerSide quads in the xy plane that faces +z. */
+    std::unique_ptr<MeshData> createGrid(uint32_t cellsPerSide)
+    {
+        return createGridMesh(cellsPerSide, [](uint32_t x, uint32_t y) {
+            return vertex_ptn_t(static_cast<float>(x), static_cast<float>(y), 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
+        });
+    }
+}
+
+TEST_CASE("Build_Meshlets_Covers_Every_Triangle_Within_Limits", "[graphics][MeshletBuilder]")
+{
+    auto mesh = createGrid(32);
+    const auto original = readIndices(*mesh);
+    auto indices = original;
+
+    const auto meshlets = buildMeshlets(
+        indices.data(),
+        { 0, indices.size(), 0 },
+        mesh->rawVertexBufferData(),
+        mesh->vertexCount(),
+        mesh->vertexElementSizeInBytes());
+
+    // 2048 triangles need at least 17 meshlets of 124 triangles, and a grid packs well.
+    REQUIRE(meshlets.size() >= 17);
+    REQUIRE(meshlets.size() <= 40);
+    REQUIRE(sortedTriangles(original.data(), original.size()) == sortedTriangles(indices.data(), indices.size()));
+
+    size_t nextIndex = 0;
+
+    for (const auto& meshlet : meshlets)
+    {
+        REQUIRE(nextIndex == meshlet.indexOffset);
+        REQUIRE(meshlet.indexCount % 3 == 0);
+        REQUIRE(meshlet.indexCount / 3 <= DefaultMeshletMaxTriangles);
+
+        std::set<uint32_t> vertices(
+            indices.begin() + meshlet.indexOffset,
+            indices.begin() + meshlet.indexOffset + meshlet.indexCount);
+
+        REQUIRE(vertices.size() == meshlet.vertexCount);
+        REQUIRE(vertices.size() <= DefaultMeshletMaxVertices);
+
+        for (auto v : vertices)
+        {
+            REQUIRE(glm::length(positionOf(*mesh, v) - meshlet.center) <= meshlet.radius * 1.0001f);
+        }
+
+        // Every triangle of a flat grid faces the same way.
+        REQUIRE(glm::length(meshlet.coneAxis - glm::vec3(0.0f, 0.0f, 1.0f)) < 0.0001f);
+        REQUIRE(meshlet.coneCutoff < 0.001f);
+
+        nextIndex += meshlet.indexCount;
+    }
+
+    REQUIRE(indices.size() == nextIndex);
+}
+
+TEST_CASE("Build_Meshlets_Respects_Vertex_Limit", "[graphics][MeshletBuilder]")
+{
+    auto mesh = createGrid(16);
+    auto indices = readIndices(*mesh);
+
+    meshlet_options_t options;
+    options.maxVertices = 16;
+
+    const auto meshlets = buildMeshlets(
+        indices.data(),
+        { 0, indices.size(), 0 },
+        mesh->rawVertexBufferData(),
+        mesh->vertexCount(),
+        mesh->vertexElementSizeInBytes(),
+        options);
+
+    for (const auto& meshlet : meshlets)
+    {
+        REQUIRE(meshlet.vertexCount <= 16);
+        REQUIRE(meshlet.indexCount > 0);
+    }
+}
+
+TEST_CASE("Meshlet_Back_Facing_Test_Uses_Normal_Cone", "[graphics][MeshletBuilder]")
+{
+    auto mesh = createGrid(8);
+    auto indices = readIndices(*mesh);
+
+    const auto meshlets = buildMeshlets(
+        indices.data(),
+        { 0, indices.size(), 0 },
+        mesh->rawVertexBufferData(),
+        mesh->vertexCount(),
+        mesh->vertexElementSizeInBytes());
+
+    for (const auto& meshlet : meshlets)
+    {
+        REQUIRE(isMeshletBackFacing(meshlet, glm::vec3(4.0f, 4.0f, -20.0f)));
+        REQUIRE_FALSE(isMeshletBackFacing(meshlet, glm::vec3(4.0f, 4.0f, 20.0f)));
+
+        // The camera is behind the plane but the meshlet's sphere reaches past the grazing angle.
+        REQUIRE_FALSE(isMeshletBackFacing(meshlet, glm::vec3(40.0f, 4.0f, -0.1f)));
+    }
+
+    // A meshlet whose normals point in opposite directions is never back facing.
+    meshlet_t folded;
+    folded.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    folded.coneCutoff = 1.0f;
+
+    REQUIRE_FALSE(isMeshletBackFacing(folded, glm::vec3(0.0f, 0.0f, -20.0f)));
+}
+
+TEST_CASE("Model_Meshlets_Are_Built_Per_Group_In_Parallel", "[graphics][MeshletBuilder]")
+{
+    auto material = std::make_shared<MaterialData>("material", MaterialType::Traditional);
+
+    auto createModel = [&]() {
+        auto model = std::make_unique<ModelData>(createGrid(32));
+        const auto third = (model->mesh().indexCount() / 9) * 3;
+
+        model->addGroup(ModelData::Group("first", material, 0, third));
+        model->addGroup(ModelData::Group("second", material, third, third));
+        model->addGroup(ModelData::Group("third", material, third * 2, model->mesh().indexCount() - third * 2));
+
+        return model;
+    };
+
+    auto serial = createModel();
+    auto parallel = createModel();
+    const auto original = readIndices(serial->mesh());
+
+    // Keep the vertex order so the triangles can be compared with the original ones.
+    meshlet_options_t options;
+    options.vertexFetch = false;
+
+    serial->buildMeshlets(options);
+    parallel->buildMeshlets(options, 4);
+
+    const auto serialIndices = readIndices(serial->mesh());
+    REQUIRE(serialIndices == readIndices(parallel->mesh()));
+
+    for (size_t g = 0; g < serial->groupCount(); ++g)
+    {
+        const auto& group = serial->group(g);
+        const auto& meshlets = group.meshlets();
+
+        REQUIRE_FALSE(meshlets.empty());
+        REQUIRE(meshlets.size() == parallel->group(g).meshlets().size());
+
+        // Triangles stay in their group.
+        REQUIRE(
+            sortedTriangles(original.data() + group.indexOffset(), group.indexCount()) ==
+            sortedTriangles(serialIndices.data() + group.indexOffset(), group.indexCount()));
+
+        REQUIRE(group.indexOffset() == meshlets.front().indexOffset);
+        REQUIRE(group.indexOffset() + group.indexCount() == meshlets.back().indexOffset + meshlets.back().indexCount);
+    }
+
+    // Reordering the triangles again makes the meshlets invalid, so they are removed.
+    serial->optimizeMesh();
+    REQUIRE(serial->group(0).meshlets().empty());
+}
+
+TEST_CASE("Model_Meshlets_Are_Ordered_For_Vertex_Cache_And_Fetch", "[graphics][MeshletBuilder]")
+{
+    auto material = std::make_shared<MaterialData>("material", MaterialType::Traditional);
+
+    auto createModel = [&]() {
+        auto model = std::make_unique<ModelData>(createGrid(32));
+        model->addGroup(ModelData::Group("grid", material, 0, model->mesh().indexCount()));
+        model->optimizeMesh();
+
+        return model;
+    };
+
+    auto ordered = createModel();
+    auto unordered = createModel();
+
+    meshlet_options_t options;
+    options.vertexCache = false;
+
+    ordered->buildMeshlets();
+    unordered->buildMeshlets(options);
+
+    // Each meshlet's triangles are reordered for the vertex cache after the meshlets are chosen.
+    REQUIRE(ordered->group(0).meshlets().size() == unordered->group(0).meshlets().size());
+    REQUIRE(analyzeVertexCache(ordered->mesh()).acmr() < analyzeVertexCache(unordered->mesh()).acmr());
+    REQUIRE(analyzeVertexCache(ordered->mesh()).acmr() < 0.8f);
+
+    // The vertices are stored in the order the meshlets first use them, and keep their positions.
+    const auto indices = readIndices(ordered->mesh());
+    uint32_t nextVertex = 0;
+
+    for (auto v : indices)
+    {
+        REQUIRE(v <= nextVertex);
+        nextVertex = std::max(nextVertex, v + 1);
+    }
+
+    REQUIRE(ordered->mesh().vertexCount() == nextVertex);
+
+    for (const auto& meshlet : ordered->group(0).meshlets())
+    {
+        for (auto i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; ++i)
+        {
+            REQUIRE(glm::length(positionOf(ordered->mesh(), indices[i]) - meshlet.center) <= meshlet.radius * 1.0001f);
+        }
+    }
+}
@@ -0,0 +1,251 @@
+#include "stdafx.h"
+#include "Graphics/Mesh/NormalGenerator.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/Mesh/VertexFormat.h"
+
+#include <cmath>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "MeshTestHelpers.h"
+#include "../../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /** Create a mesh from positions and a triangle list, with zero normals. */
+    std::unique_ptr<MeshData> createMesh(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices)
+    {
+        std::unique_ptr<vertex_ptn_t[]> vertices(new vertex_ptn_t[positions.size()]);
+
+        for (size_t v = 0; v < positions.size(); ++v)
+        {
+            vertices[v].setPosition(positions[v].x, positions[v].y, positions[v].z);
+        }
+
+        return Daybreak::createMesh(std::move(vertices), positions.size(), indices);
+    }
+
+    /** Create a unit cube centered on the origin with one vertex per corner and outward facing triangles. */
+    std::unique_ptr<MeshData> createCube()
+    {
+        std::vector<glm::vec3> positions;
+
+        for (int i = 0; i < 8; ++i)
+        {
+            positions.push_back(glm::vec3(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f));
+        }
+
+        return createMesh(positions, {
+            0, 2, 3, 0, 3, 1,       // -z
+            4, 5, 7, 4, 7, 6,       // +z
+            0, 1, 5, 0, 5, 4,       // -y
+            2, 6, 7, 2, 7, 3,       // +y
+            0, 4, 6, 0, 6, 2,       // -x
+            1, 3, 7, 1, 7, 5 });    // +x
+    }
+
+    /** Get the normal of a vertex. */
+    glm::vec3 normalOf(const MeshData& mesh, uint32_t v)
+    {
+        const auto& e = static_cast<const vertex_ptn_t *>(mesh.rawVertexBufferData())[v].elements;
+        return glm::vec3(e[5], e[6], e[7]);
+    }
+
+    /** Check two vectors are nearly equal. */
+    bool isNear(const glm::vec3& a, const glm::vec3& b)
+    {
+        return glm::length(a - b) < 0.0001f;
+    }
+}
+
+TEST_CASE("Generate_Normals_Smooths_Across_Shared_Vertices", "[graphics][NormalGenerator]")
+{
+    auto cube = createCube();
+
+    normal_generation_options_t options;
+    options.creaseAngle = 180.0f;
+
+    auto mesh = generateNormals(*cube, options);
+    REQUIRE(8 == mesh->vertexCount());
+    REQUIRE(readIndices(*cube) == readIndices(*mesh));
+
+    // Angle weighting makes the normal point exactly out of the corner, even though each face is split differently.
+    for (uint32_t v = 0; v < 8; ++v)
+    {
+        REQUIRE(isNear(glm::normalize(positionOf(*mesh, v)), normalOf(*mesh, v)));
+    }
+}
+
+TEST_CASE("Generate_Normals_Splits_Vertices_On_Hard_Edges", "[graphics][NormalGenerator]")
+{
+    auto cube = createCube();
+    const auto original = readIndices(*cube);
+
+    auto requireFaceNormals = [&](const MeshData& mesh) {
+        REQUIRE(24 == mesh.vertexCount());
+
+        const auto indices = readIndices(mesh);
+
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            const auto a = positionOf(mesh, indices[i]);
+            const auto b = positionOf(mesh, indices[i + 1]);
+            const auto c = positionOf(mesh, indices[i + 2]);
+            const auto faceNormal = glm::normalize(glm::cross(b - a, c - a));
+
+            for (size_t k = 0; k < 3; ++k)
+            {
+                REQUIRE(positionOf(*cube, original[i + k]) == positionOf(mesh, indices[i + k]));
+                REQUIRE(isNear(faceNormal, normalOf(mesh, indices[i + k])));
+            }
+        }
+    };
+
+    // The faces of a cube meet at 90 degrees, more than the default crease angle.
+    requireFaceNormals(*generateNormals(*cube));
+
+    // Flat normals and smoothing group zero give the same result.
+    normal_generation_options_t options;
+    options.flat = true;
+    requireFaceNormals(*generateNormals(*cube, options));
+
+    std::vector<uint32_t> smoothingGroups(12, 0);
+    options.flat = false;
+    options.creaseAngle = 180.0f;
+    requireFaceNormals(*generateNormals(*cube, options, &smoothingGroups));
+
+    // One smoothing group per face.
+    for (uint32_t t = 0; t < 12; ++t)
+    {
+        smoothingGroups[t] = 1 + t / 2;
+    }
+
+    requireFaceNormals(*generateNormals(*cube, options, &smoothingGroups));
+}
+
+TEST_CASE("Generate_Normals_Smooths_Across_Attribute_Seams", "[graphics][NormalGenerator]")
+{
+    // Two triangles folded along the y axis that share the positions but not the vertices of the fold.
+    auto mesh = createMesh(
+        { { 0, 0, 0 }, { 0, 1, 0 }, { -1, 0, 0 }, { 0, 0, 0 }, { 0, 1, 0 }, { 1, 0, 1 } },
+        { 0, 1, 2, 3, 5, 4 });
+
+    auto result = generateNormals(*mesh);
+    REQUIRE(6 == result->vertexCount());
+
+    const auto expected = glm::normalize(glm::vec3(-1.0f, 0.0f, 1.0f) + glm::normalize(glm::vec3(0.0f, 0.0f, 1.0f)));
+
+    REQUIRE(isNear(normalOf(*result, 0), normalOf(*result, 3)));
+    REQUIRE(isNear(normalOf(*result, 1), normalOf(*result, 4)));
+    REQUIRE(std::abs(glm::dot(normalOf(*result, 0), glm::vec3(0.0f, 1.0f, 0.0f))) < 0.0001f);
+    REQUIRE(glm::dot(normalOf(*result, 0), expected) > 0.99f);
+}
+
+TEST_CASE("Generate_Normals_Smooths_High_Valence_Positions", "[graphics][NormalGenerator]")
+{
+    // A fan of many triangles around one position, which is either flat or folded along the y axis like a roof.
+    const uint32_t RimCount = 1024;
+
+    auto createFan = [&](bool isFolded) {
+        std::vector<glm::vec3> positions = { glm::vec3(0.0f) };
+        std::vector<uint32_t> indices;
+
+        for (uint32_t i = 0; i < RimCount; ++i)
+        {
+            const auto angle = glm::radians(360.0f) * (static_cast<float>(i) + 0.5f) / static_cast<float>(RimCount);
+            const auto x = std::cos(angle);
+
+            positions.push_back(glm::vec3(x, std::sin(angle), isFolded ? std::abs(x) : 0.0f));
+            indices.insert(indices.end(), { 0, 1 + i, 1 + (i + 1) % RimCount });
+        }
+
+        return createMesh(positions, indices);
+    };
+
+    // Every triangle of the flat fan shares the center vertex.
+    auto flat = generateNormals(*createFan(false));
+    const auto flatIndices = readIndices(*flat);
+
+    REQUIRE(RimCount + 1 == flat->vertexCount());
+    REQUIRE(isNear(glm::vec3(0.0f, 0.0f, 1.0f), normalOf(*flat, 0)));
+
+    for (size_t i = 0; i < flatIndices.size(); i += 3)
+    {
+        REQUIRE(0 == flatIndices[i]);
+    }
+
+    // The sides of the folded fan meet at 90 degrees, so each side is only smoothed with itself.
+    auto folded = generateNormals(*createFan(true));
+    const auto foldedIndices = readIndices(*folded);
+    const auto left = glm::normalize(glm::vec3(1.0f, 0.0f, 1.0f));
+    const auto right = glm::normalize(glm::vec3(-1.0f, 0.0f, 1.0f));
+
+    REQUIRE(folded->vertexCount() > RimCount + 1);
+
+    for (size_t i = 0; i < foldedIndices.size(); i += 3)
+    {
+        const auto b = positionOf(*folded, foldedIndices[i + 1]);
+        const auto c = positionOf(*folded, foldedIndices[i + 2]);
+        const auto center = normalOf(*folded, foldedIndices[i]);
+
+        if (b.x < 0.0f && c.x < 0.0f)
+        {
+            REQUIRE(glm::dot(center, left) > 0.999f);
+        }
+        else if (b.x > 0.0f && c.x > 0.0f)
+        {
+            REQUIRE(glm::dot(center, right) > 0.999f);
+        }
+    }
+}
+
+TEST_CASE("Generate_Normals_Does_Not_Depend_On_Worker_Count", "[graphics][NormalGenerator]")
+{
+    // A bumpy grid with enough triangles to be split across workers.
+    const uint32_t Side = 160;
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+
+    for (uint32_t y = 0; y <= Side; ++y)
+    {
+        for (uint32_t x = 0; x <= Side; ++x)
+        {
+            const auto height = ((x * 7 + y * 13) % 5 == 0 ? 1.0f : 0.0f);
+            positions.push_back(glm::vec3(static_cast<float>(x), static_cast<float>(y), height));
+        }
+    }
+
+    for (uint32_t y = 0; y < Side; ++y)
+    {
+        for (uint32_t x = 0; x < Side; ++x)
+        {
+            const auto a = y * (Side + 1) + x;
+            const auto c = a + Side + 1;
+
+            indices.insert(indices.end(), { a, a + 1, c + 1, a, c + 1, c });
+        }
+    }
+
+    auto mesh = createMesh(positions, indices);
+
+    normal_generation_options_t options;
+    options.creaseAngle = 30.0f;
+
+    auto serial = generateNormals(*mesh, options, nullptr, 1);
+    auto parallel = generateNormals(*mesh, options, nullptr, 4);
+
+    REQUIRE(serial->vertexCount() > mesh->vertexCount());
+    REQUIRE(serial->vertexCount() == parallel->vertexCount());
+    REQUIRE(readIndices(*serial) == readIndices(*parallel));
+
+    for (uint32_t v = 0; v < serial->vertexCount(); ++v)
+    {
+        REQUIRE(normalOf(*serial, v) == normalOf(*parallel, v));
+        REQUIRE(std::abs(glm::length(normalOf(*serial, v)) - 1.0f) < 0.0001f);
+    }
+}
@@ -0,0 +1,219 @@
+#include "stdafx.h"
+#include "Graphics/Mesh/TangentGenerator.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/Mesh/IndexCompaction.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/Mesh/VertexFormat.h"
+#include "Graphics/InputLayoutDescription.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "MeshTestHelpers.h"
+#include "../../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    /**
+     * Create a grid of cellsPerSide * cellsPerSide quads in the xy plane that faces +z, with texture coordinates from
+     * uvOf(x, y).
+     */
+    template<typename UV>
+    std::unique_ptr<MeshData> createGrid(uint32_t cellsPerSide, UV uvOf)
+    {
+        return createGridMesh(cellsPerSide, [&](uint32_t x, uint32_t y) {
+            const glm::vec2 uv = uvOf(x, y);
+            return vertex_ptn_t(static_cast<float>(x), static_cast<float>(y), 0.0f, uv.x, uv.y, 0.0f, 0.0f, 1.0f);
+        });
+    }
+
+    /** Get the tangent and bitangent sign of a vertex. */
+    glm::vec4 tangentOf(const MeshData& mesh, uint32_t v)
+    {
+        const auto& e = static_cast<const vertex_ptnt_t *>(mesh.rawVertexBufferData())[v].elements;
+        return glm::vec4(e[8], e[9], e[10], e[11]);
+    }
+
+    /** Check two vectors are nearly equal. */
+    bool isNear(const glm::vec4& a, const glm::vec4& b)
+    {
+        return glm::length(a - b) < 0.0001f;
+    }
+}
+
+TEST_CASE("Generate_Tangents_Follows_Texture_U_Direction", "[graphics][TangentGenerator]")
+{
+    auto mesh = createGrid(2, [](uint32_t x, uint32_t y) {
+        return glm::vec2(static_cast<float>(x) * 0.5f, static_cast<float>(y) * 0.5f);
+    });
+
+    auto result = generateTangents(*mesh, { { 0, mesh->indexCount() } });
+
+    REQUIRE(vertex_ptnt_t::inputLayout == result->vertexInputLayout());
+    REQUIRE(mesh->vertexCount() == result->vertexCount());
+    REQUIRE(readIndices(*mesh) == readIndices(*result));
+
+    for (uint32_t v = 0; v < result->vertexCount(); ++v)
+    {
+        REQUIRE(isNear(glm::vec4(1.0f, 0.0f, 0.0f, 1.0f), tangentOf(*result, v)));
+    }
+
+    // Texture coordinates that run along y make the tangent follow y.
+    auto rotated = createGrid(2, [](uint32_t x, uint32_t y) {
+        return glm::vec2(static_cast<float>(y), -static_cast<float>(x));
+    });
+
+    result = generateTangents(*rotated, { { 0, rotated->indexCount() } });
+
+    for (uint32_t v = 0; v < result->vertexCount(); ++v)
+    {
+        REQUIRE(isNear(glm::vec4(0.0f, 1.0f, 0.0f, 1.0f), tangentOf(*result, v)));
+    }
+}
+
+TEST_CASE("Generate_Tangents_Splits_Vertices_On_Mirrored_Texture_Seams", "[graphics][TangentGenerator]")
+{
+    // The texture is mirrored along the middle column of vertices.
+    auto mesh = createGrid(2, [](uint32_t x, uint32_t y) {
+        return glm::vec2(x == 1 ? 1.0f : 0.0f, static_cast<float>(y) * 0.5f);
+    });
+
+    auto result = generateTangents(*mesh, { { 0, mesh->indexCount() } });
+    REQUIRE(mesh->vertexCount() + 3 == result->vertexCount());
+
+    const auto original = readIndices(*mesh);
+    const auto indices = readIndices(*result);
+
+    // The first column of quads keeps the shared vertices and the second column uses copies of them.
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        const auto v = indices[i];
+        const auto tangent = tangentOf(*result, v);
+        const auto triangle = i - i % 3;
+        const auto isMirrored = std::max({
+            positionOf(*mesh, original[triangle]).x,
+            positionOf(*mesh, original[triangle + 1]).x,
+            positionOf(*mesh, original[triangle + 2]).x }) > 1.5f;
+
+        REQUIRE(positionOf(*result, original[i]) == positionOf(*result, v));
+        REQUIRE((original[i] == v) == (!isMirrored || positionOf(*result, v).x != 1.0f));
+        REQUIRE(isNear(isMirrored ? glm::vec4(-1.0f, 0.0f, 0.0f, -1.0f) : glm::vec4(1.0f, 0.0f, 0.0f, 1.0f), tangent));
+
+        // The bitangent, cross(normal, tangent) * sign, follows the texture's v direction on both sides.
+        const auto bitangent = glm::cross(glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(tangent)) * tangent.w;
+        REQUIRE(glm::length(bitangent - glm::vec3(0.0f, 1.0f, 0.0f)) < 0.0001f);
+    }
+}
+
+TEST_CASE("Generate_Tangents_Does_Not_Depend_On_Worker_Count", "[graphics][TangentGenerator]")
+{
+    // A grid with enough triangles to be split across workers, whose texture is mirrored every few columns.
+    auto mesh = createGrid(130, [](uint32_t x, uint32_t y) {
+        return glm::vec2(static_cast<float>(x % 8 < 4 ? x % 8 : 8 - x % 8), static_cast<float>(y * y) * 0.01f);
+    });
+
+    const auto third = (mesh->indexCount() / 9) * 3;
+    const std::vector<std::pair<size_t, size_t>> ranges = {
+        { third * 2, mesh->indexCount() - third * 2 }, { 0, third }, { third, third }
+    };
+
+    auto serial = generateTangents(*mesh, ranges, 1);
+    auto parallel = generateTangents(*mesh, ranges, 4);
+
+    REQUIRE(serial->vertexCount() > mesh->vertexCount());
+    REQUIRE(serial->vertexCount() == parallel->vertexCount());
+    REQUIRE(readIndices(*serial) == readIndices(*parallel));
+    REQUIRE(0 == std::memcmp(
+        serial->rawVertexBufferData(),
+        parallel->rawVertexBufferData(),
+        serial->vertexCount() * serial->vertexElementSizeInBytes()));
+
+    for (uint32_t v = 0; v < serial->vertexCount(); ++v)
+    {
+        const auto tangent = tangentOf(*serial, v);
+
+        REQUIRE(std::abs(glm::length(glm::vec3(tangent)) - 1.0f) < 0.0001f);
+        REQUIRE(std::abs(tangent.z) < 0.0001f);
+        REQUIRE(std::abs(tangent.w) == 1.0f);
+    }
+}
+
+TEST_CASE("Generate_Tangents_Welds_Duplicate_Vertices", "[graphics][TangentGenerator]")
+{
+    // A curved and mirrored texture mapping, so the corners at a vertex have different tangents.
+    auto mesh = createGrid(8, [](uint32_t x, uint32_t y) {
+        const auto u = static_cast<float>(x % 4 < 2 ? x % 4 : 4 - x % 4);
+        return glm::vec2(u, static_cast<float>(y) + static_cast<float>(x * x) * 0.1f);
+    });
+
+    // Give every corner its own copy of its vertex.
+    const auto indices = readIndices(*mesh);
+    const auto vertices = static_cast<const vertex_ptn_t *>(mesh->rawVertexBufferData());
+
+    std::unique_ptr<vertex_ptn_t[]> cornerVertices(new vertex_ptn_t[indices.size()]);
+    std::unique_ptr<uint32_t[]> cornerIndices(new uint32_t[indices.size()]);
+
+    for (uint32_t i = 0; i < indices.size(); ++i)
+    {
+        cornerVertices[i] = vertices[indices[i]];
+        cornerIndices[i] = i;
+    }
+
+    auto unwelded = std::make_unique<MeshData>(
+        std::make_unique<IndexBufferData>(indices.size(), std::move(cornerIndices)),
+        std::make_unique<VertexBufferData>(indices.size(), std::move(cornerVertices), vertex_ptn_t::inputLayout));
+
+    auto expected = generateTangents(*mesh, { { 0, mesh->indexCount() } });
+    auto result = generateTangents(*unwelded, { { 0, unwelded->indexCount() } });
+
+    // Every corner gets the same tangent as the corner of the shared vertex.
+    const auto expectedIndices = readIndices(*expected);
+    const auto resultIndices = readIndices(*result);
+
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+        REQUIRE(isNear(tangentOf(*expected, expectedIndices[i]), tangentOf(*result, resultIndices[i])));
+    }
+}
+
+TEST_CASE("Generate_Tangents_Uses_Existing_Tangent_Attribute", "[graphics][TangentGenerator]")
+{
+    auto mesh = createGrid(1, [](uint32_t x, uint32_t y) {
+        return glm::vec2(static_cast<float>(x), static_cast<float>(y));
+    });
+
+    auto withTangents = generateTangents(*mesh, { { 0, mesh->indexCount() } });
+
+    // Only the first triangle is given, so the vertex only the second triangle uses keeps its tangent.
+    auto result = generateTangents(*withTangents, { { 0, 3 } });
+
+    REQUIRE(withTangents->vertexInputLayout() == result->vertexInputLayout());
+    REQUIRE(withTangents->vertexCount() == result->vertexCount());
+    REQUIRE(0 == std::memcmp(
+        withTangents->rawVertexBufferData(),
+        result->rawVertexBufferData(),
+        result->vertexCount() * result->vertexElementSizeInBytes()));
+
+    // Overlapping ranges, and meshes without texture coordinates, are rejected.
+    REQUIRE_THROWS_AS(generateTangents(*mesh, { { 0, 6 }, { 3, 3 } }), RuntimeCheckException);
+
+    auto positionsAndNormals = std::make_shared<InputLayoutDescription>(std::vector<InputAttribute> {
+        { InputAttribute::SemanticName::Position, 0, InputAttribute::StorageType::Float, 3 },
+        { InputAttribute::SemanticName::Normal, 0, InputAttribute::StorageType::Float, 3 }
+    });
+
+    auto untextured = std::make_unique<MeshData>(
+        std::make_unique<IndexBufferData>(mesh->indexCount(), std::unique_ptr<uint32_t[]>(new uint32_t[6]())),
+        std::make_unique<VertexBufferData>(
+            24 * 4,
+            std::unique_ptr<uint8_t[]>(new uint8_t[24 * 4]()),
+            positionsAndNormals));
+
+    REQUIRE_THROWS_AS(generateTangents(*untextured, { { 0, 6 } }), DaybreakDataException);
+}
@@ -0,0 +1,190 @@
+#include "stdafx.h"
+#include "Graphics/Mesh/VertexQuantization.h"
+#include "Graphics/Mesh/IndexBufferData.h"
+#include "Graphics/Mesh/VertexBufferData.h"
+#include "Graphics/Mesh/VertexFormat.h"
+#include "Graphics/Mesh/MeshData.h"
+#include "Graphics/InputLayoutDescription.h"
+#include "Common/Error.h"
+
+#include <array>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+#include "../../TestHelpers.h"
+
+using namespace Daybreak;
+
+namespace
+{
+    using SemanticName = InputAttribute::SemanticName;
+    using StorageType = InputAttribute::StorageType;
+
+    /** Create a mesh of one triangle with the given vertices. */
+    std::unique_ptr<MeshData> createTriangle(const vertex_ptn_t& a, const vertex_ptn_t& b, const vertex_ptn_t& c)
+    {
+        std::unique_ptr<vertex_ptn_t[]> vertices(new vertex_ptn_t[3]{ a, b, c });
+        std::unique_ptr<uint32_t[]> indices(new uint32_t[3]{ 0, 1, 2 });
+
+        return std::make_unique<MeshData>(
+            std::make_unique<IndexBufferData>(3, std::move(indices)),
+            std::make_unique<VertexBufferData>(3, std::move(vertices), vertex_ptn_t::inputLayout));
+    }
+
+    /** Read a value from a vertex of a mesh. */
+    template<typename T>
+    T readAttribute(const MeshData& mesh, size_t vertex, size_t attributeIndex)
+    {
+        T value;
+        std::memcpy(
+            &value,
+            static_cast<const uint8_t *>(mesh.rawVertexBufferData()) +
+                vertex * mesh.vertexElementSizeInBytes() +
+                mesh.vertexElementTypeRef().attributeOffsetByIndex(attributeIndex),
+            sizeof(T));
+
+        return value;
+    }
+
+    /** Unpack a signed normalized 10 bit value from a 10:10:10:2 packed value. */
+    float unpackSNorm10(uint32_t packed, int shift)
+    {
+        auto value = static_cast<int32_t>((packed >> shift) & 0x3FF);
+        value = (value >= 512 ? value - 1024 : value);
+
+        return std::max(static_cast<float>(value) / 511.0f, -1.0f);
+    }
+}
+
+TEST_CASE("Quantize_Vertices_Stores_Position_Texture_And_Normal_In_16_Bytes", "[graphics][VertexQuantization]")
+{
+    auto mesh = createTriangle(
+        { -2.0f, 1.0f, 3.0f,   0.0f, 0.25f,   0.0f, 1.0f, 0.0f },
+        { 2.0f, 5.0f, 3.0f,    1.0f, 0.5f,    0.0f, 0.0f, -1.0f },
+        { 0.0f, 3.0f, 7.0f,    0.5f, 1.0f,    0.6f, 0.0f, 0.8f });
+
+    position_dequantization_t dequantization;
+    auto quantized = quantizeVertices(*mesh, vertex_quantization_options_t(), dequantization);
+
+    REQUIRE(16 == quantized->vertexElementSizeInBytes());
+    REQUIRE(3 == quantized->vertexCount());
+    REQUIRE(IndexElementType::UnsignedInt == quantized->indexElementType());
+
+    const auto& layout = quantized->vertexElementTypeRef();
+    REQUIRE(InputAttribute(SemanticName::Position, 0, StorageType::UnsignedShort, 4, true) ==
+        layout.getAttributeByIndex(0));
+    REQUIRE(InputAttribute(SemanticName::Texture, 0, StorageType::UnsignedShort, 2, true) ==
+        layout.getAttributeByIndex(1));
+    REQUIRE(InputAttribute(SemanticName::Normal, 0, StorageType::PackedInt2101010, 4, true) ==
+        layout.getAttributeByIndex(2));
+
+    REQUIRE(glm::vec3(-2.0f, 1.0f, 3.0f) == dequantization.offset);
+    REQUIRE(glm::vec3(4.0f, 4.0f, 4.0f) == dequantization.scale);
+
+    for (size_t v = 0; v < 3; ++v)
+    {
+        const auto& expected = static_cast<const vertex_ptn_t *>(mesh->rawVertexBufferData())[v].elements;
+
+        const auto position = readAttribute<std::array<uint16_t, 4>>(*quantized, v, 0);
+        const auto uv = readAttribute<std::array<uint16_t, 2>>(*quantized, v, 1);
+        const auto normal = readAttribute<uint32_t>(*quantized, v, 2);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            const auto decoded = dequantization.offset[i] + position[i] / 65535.0f * dequantization.scale[i];
+            REQUIRE(std::abs(expected[i] - decoded) < 0.0001f);
+            REQUIRE(std::abs(expected[5 + i] - unpackSNorm10(normal, i * 10)) < 0.002f);
+        }
+
+        REQUIRE(65535 == position[3]);
+        REQUIRE(std::abs(expected[3] - uv[0] / 65535.0f) < 0.00001f);
+        REQUIRE(std::abs(expected[4] - uv[1] / 65535.0f) < 0.00001f);
+    }
+}
+
+TEST_CASE("Quantize_Vertices_Uses_Half_Floats_For_Textures_Outside_Unit_Range", "[graphics][VertexQuantization]")
+{
+    auto mesh = createTriangle(
+        { 0.0f, 0.0f, 0.0f,   -1.0f, 0.0f,   0.0f, 1.0f, 0.0f },
+        { 1.0f, 0.0f, 0.0f,   4.0f, 0.0f,    0.0f, 1.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f,   0.0f, 2.5f,    0.0f, 1.0f, 0.0f });
+
+    position_dequantization_t dequantization;
+    auto quantized = quantizeVertices(*mesh, vertex_quantization_options_t(), dequantization);
+
+    REQUIRE(InputAttribute(SemanticName::Texture, 0, StorageType::HalfFloat, 2) ==
+        quantized->vertexElementTypeRef().getAttributeByIndex(1));
+
+    const auto uv = glm::unpackHalf2x16(readAttribute<uint32_t>(*quantized, 1, 1));
+    REQUIRE(4.0f == uv.x);
+}
+
+TEST_CASE("Quantize_Vertices_Can_Store_Half_Positions_And_Octahedral_Normals", "[graphics][VertexQuantization]")
+{
+    auto mesh = createTriangle(
+        { 0.5f, -2.0f, 8.0f,   0.0f, 0.0f,   0.0f, 0.0f, -1.0f },
+        { 1.0f, 0.0f, 0.0f,    0.0f, 0.0f,   0.0f, 1.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f,    0.0f, 0.0f,   -0.6f, 0.0f, -0.8f });
+
+    vertex_quantization_options_t options;
+    options.position = PositionEncoding::HalfFloat;
+    options.normal = NormalEncoding::OctahedralSNorm16;
+    options.texture = TextureEncoding::Float;
+
+    position_dequantization_t dequantization;
+    auto quantized = quantizeVertices(*mesh, options, dequantization);
+
+    REQUIRE(20 == quantized->vertexElementSizeInBytes());
+    REQUIRE(glm::vec3(0.0f) == dequantization.offset);
+    REQUIRE(glm::vec3(1.0f) == dequantization.scale);
+
+    const auto position = glm::unpackHalf4x16(readAttribute<uint64_t>(*quantized, 0, 0));
+    REQUIRE(glm::vec4(0.5f, -2.0f, 8.0f, 1.0f) == position);
+
+    const auto normal = readAttribute<std::array<int16_t, 2>>(*quantized, 2, 2);
+    const auto decoded = decodeOctahedralNormal(glm::vec2(normal[0] / 32767.0f, normal[1] / 32767.0f));
+
+    REQUIRE(glm::length(decoded - glm::vec3(-0.6f, 0.0f, -0.8f)) < 0.001f);
+}
+
+TEST_CASE("Octahedral_Normals_Round_Trip", "[graphics][VertexQuantization]")
+{
+    const glm::vec3 normals[] =
+    {
+        { 0.0f, 0.0f, 1.0f },
+        { 0.0f, 0.0f, -1.0f },
+        { 1.0f, 0.0f, 0.0f },
+        { 0.0f, -1.0f, 0.0f },
+        glm::normalize(glm::vec3(1.0f, 2.0f, -3.0f)),
+        glm::normalize(glm::vec3(-4.0f, -1.0f, -0.5f)),
+        glm::normalize(glm::vec3(-0.2f, 0.7f, 0.1f))
+    };
+
+    for (const auto& normal : normals)
+    {
+        const auto encoded = encodeOctahedralNormal(normal);
+
+        REQUIRE(std::abs(encoded.x) <= 1.0f);
+        REQUIRE(std::abs(encoded.y) <= 1.0f);
+        REQUIRE(glm::length(decodeOctahedralNormal(encoded) - normal) < 0.0001f);
+    }
+}
+
+TEST_CASE("Quantize_Vertices_Requires_Float_Positions", "[graphics][VertexQuantization]")
+{
+    std::unique_ptr<uint8_t[]> vertices(new uint8_t[8]);
+    std::unique_ptr<uint32_t[]> indices(new uint32_t[1]{ 0 });
+
+    MeshData mesh(
+        std::make_unique<IndexBufferData>(1, std::move(indices)),
+        std::make_unique<VertexBufferData>(
+            8,
+            std::move(vertices),
+            std::make_shared<InputLayoutDescription>(std::vector<InputAttribute> {
+                { SemanticName::Texture, 0, StorageType::Float, 2 } })));
+
+    position_dequantization_t dequantization;
+    REQUIRE_THROWS_AS(
+        quantizeVertices(mesh, vertex_quantization_options_t(), dequantization),
+        DaybreakDataException);
+}
@@ -0,0 +1,177 @@
+#include "stdafx.h"
+#include "Utility/TextScanning.h"
+#include "Utility/TextUtils.h"
+
+#include <charconv>
+#include <cstring>
+#include <random>
+#include <string>
+
+#undef CHECK
+#include "catch2\catch.hpp"
+
+using namespace Daybreak::TextUtils;
+
+namespace
+{
+    void requireSameFloatAsFromChars(const std::string& text)
+    {
+        float expected = 0.0f;
+        auto expectedResult = std::from_chars(text.data(), text.data() + text.size(), expected);
+
+        float actual = 0.0f;
+        auto actualEnd = tryParseSimpleFloat(text.data(), text.data() + text.size(), actual);
+
+        // The fast parser is allowed to decline any input, but if it accepts a value it must match from_chars exactly.
+        if (actualEnd != nullptr)
+        {
+            INFO(text);
+            REQUIRE(expectedResult.ec == std::errc());
+            REQUIRE(actualEnd == expectedResult.ptr);
+            REQUIRE(std::memcmp(&expected, &actual, sizeof(float)) == 0);
+        }
+    }
+}
+
+TEST_CASE("Find_First_Of_Matches_Scalar_Search", "[core][textscanning]")
+{
+    for (size_t length = 0; length < 48; ++length)
+    {
+        for (size_t position = 0; position <= length; ++position)
+        {
+            std::string text(length, 'x');
+
+            if (position < length)
+            {
+                text[position] = (position % 2 == 0 ? '\n' : '#');
+            }
+
+            const auto first = text.data();
+            const auto last = text.data() + text.size();
+
+            REQUIRE(findFirstOf(first, last, '\n', '#') == findFirstOfScalar(first, last, '\n', '#'));
+            REQUIRE(findFirstOf(first, last, '\n', '#') == first + position);
+        }
+    }
+}
+
+TEST_CASE("Skip_And_Find_Blank_Space", "[core][textscanning]")
+{
+    std::string text = " \t  \t   \t \t      \t   hello world";
+    const auto first = text.data();
+    const auto last = text.data() + text.size();
+
+    auto word = skipBlankSpace(first, last);
+    REQUIRE(*word == 'h');
+
+    auto space = findBlankSpace(word, last);
+    REQUIRE(std::string_view(word, space - word) == "hello");
+
+    REQUIRE(skipBlankSpace(last, last) == last);
+    REQUIRE(findBlankSpace(space + 1, last) == last);
+}
+
+TEST_CASE("Read_Long_Lines_With_Comments_Uses_Last_Comment_Char", "[core][textscanning]")
+{
+    StringLineReader reader(
+        "v 0.123456 1.234567 2.345678 # first comment\r\n"
+        "v 1 2 3 # not # the # last\n"
+        "f 1/1/1 2/2/2 3/3/3\r"
+        "\n"
+        "# only a comment that is longer than sixteen characters",
+        '#');
+
+    REQUIRE(std::string_view("v 0.123456 1.234567 2.345678 ") == reader.readNextLine());
+    REQUIRE(std::string_view("v 1 2 3 # not # the ") == reader.readNextLine());
+    REQUIRE(std::string_view("f 1/1/1 2/2/2 3/3/3") == reader.readNextLine());
+    REQUIRE(std::string_view("") == reader.readNextLine());
+    REQUIRE(!reader.hasNextLine());
+}
+
+TEST_CASE("Split_Long_Text_On_Two_Separators", "[core][textscanning]")
+{
+    StringSplitter splitter("first\tsecond   third_token_is_long\t\tlast", " \t", true);
+
+    REQUIRE(std::string_view("first") == splitter.readNextToken());
+    REQUIRE(std::string_view("second") == splitter.readNextToken());
+    REQUIRE(std::string_view("third_token_is_long") == splitter.readNextToken());
+    REQUIRE(std::string_view("last") == splitter.readNextToken());
+    REQUIRE(!splitter.hasNextToken());
+}
+
+TEST_CASE("Parse_Simple_Float_Matches_From_Chars", "[core][textscanning]")
+{
+    const char * samples[] =
+    {
+        "0", "-0", "0.0", "1", "-1", "1.5", "-2.25", "0.000001", "123456.789", "3.14159265358979",
+        "1e5", "1E-5", "2.5e+3", "-7.125e-2", "1e", "1e+", "5.", ".5", "-.5", "16777217", "0.1", "0.2", "0.3",
+        "9999999999999999999", "99999999999999999999", "1e38", "1e39", "1e-38", "1e-45", "1.0000000596046448",
+        "33554431", "0.7071067811865476", "1.5 2.5", "1/2/3", "-", ".", "", "+1", "abc"
+    };
+
+    for (auto sample : samples)
+    {
+        requireSameFloatAsFromChars(sample);
+    }
+
+    float value = 0.0f;
+    std::string text = "-12.5 rest";
+    REQUIRE(tryParseSimpleFloat(text.data(), text.data() + text.size(), value) == text.data() + 5);
+    REQUIRE(value == -12.5f);
+
+    REQUIRE(tryParseSimpleFloat(text.data(), text.data(), value) == nullptr);
+}
+
+TEST_CASE("Parse_Random_Simple_Floats_Matches_From_Chars", "[core][textscanning]")
+{
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> digitCount(1, 12);
+    std::uniform_int_distribution<int> digit(0, 9);
+    std::uniform_int_distribution<int> exponent(-30, 30);
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        std::string text = (i % 2 == 0 ? "-" : "");
+        auto integerDigits = digitCount(random) / 2;
+        auto fractionDigits = digitCount(random);
+
+        for (int j = 0; j < integerDigits; ++j) { text += static_cast<char>('0' + digit(random)); }
+
+        text += '.';
+
+        for (int j = 0; j < fractionDigits; ++j) { text += static_cast<char>('0' + digit(random)); }
+
+        if (i % 5 == 0)
+        {
+            text += 'e' + std::to_string(exponent(random));
+        }
+
+        requireSameFloatAsFromChars(text);
+    }
+}
+
+TEST_CASE("Parse_Simple_Int", "[core][textscanning]")
+{
+    int value = 0;
+
+    std::string text = "42/7";
+    REQUIRE(tryParseSimpleInt(text.data(), text.data() + text.size(), value) == text.data() + 2);
+    REQUIRE(value == 42);
+
+    text = "-2147483648";
+    REQUIRE(tryParseSimpleInt(text.data(), text.data() + text.size(), value) == text.data() + text.size());
+    REQUIRE(value == -2147483647 - 1);
+
+    text = "2147483647";
+    REQUIRE(tryParseSimpleInt(text.data(), text.data() + text.size(), value) == text.data() + text.size());
+    REQUIRE(value == 2147483647);
+
+    text = "2147483648";
+    REQUIRE(tryParseSimpleInt(text.data(), text.data() + text.size(), value) == nullptr);
+
+    text = "-";
+    REQUIRE(tryParseSimpleInt(text.data(), text.data() + text.size(), value) == nullptr);
+
+    text = "";
+    REQUIRE(tryParseSimpleInt(text.data(), text.data() + text.size(), value) == nullptr);
+}
@@ -0,0 +1,22 @@
+#include "stdafx.h"
+#include "app/support/hash.h"
+
+#include "../TestHelpers.h"
+
+using namespace Daybreak;
+
+TEST_CASE("combine_hash with no values returns the seed", "[app][support][hash]")
+{
+    REQUIRE(combine_hash(42) == 42);
+}
+
+TEST_CASE("combine_hash uses every value", "[app][support][hash]")
+{
+    auto h = combine_hash(0, 1, 2, 3);
+
+    REQUIRE(h != combine_hash(0, 1));
+    REQUIRE(h != combine_hash(0, 1, 2));
+    REQUIRE(h != combine_hash(0, 1, 2, 4));
+    REQUIRE(h != combine_hash(0, 3, 2, 1));
+    REQUIRE(h == combine_hash(combine_hash(combine_hash(0, 1), 2), 3));
+}